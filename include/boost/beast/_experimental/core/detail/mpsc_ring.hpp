@@ -0,0 +1,138 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_DETAIL_MPSC_RING_HPP
+#define BOOST_BEAST_CORE_DETAIL_MPSC_RING_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/assert.hpp>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace boost {
+namespace beast {
+namespace detail {
+
+// A bounded, lock-free queue for many producers and one consumer.
+//
+// Each cell carries a sequence number which tells producers
+// and the consumer whose turn it is, after D. Vyukov's bounded
+// queue. Producers claim a position with a CAS on `tail_`;
+// the consumer owns `head_` and never contends on it.
+//
+template<class T>
+class mpsc_ring
+{
+    struct cell
+    {
+        std::atomic<std::size_t> seq;
+        T value;
+    };
+
+    std::unique_ptr<cell[]> cells_;
+    std::size_t mask_;
+
+    // Keep the producers' and the consumer's
+    // positions on separate cache lines.
+    char pad0_[64];
+    std::atomic<std::size_t> tail_;
+    char pad1_[64];
+    std::size_t head_ = 0;
+
+    static
+    std::size_t
+    round_up(std::size_t n) noexcept
+    {
+        std::size_t v = 2;
+        while(v < n)
+            v <<= 1;
+        return v;
+    }
+
+public:
+    explicit
+    mpsc_ring(std::size_t capacity)
+        : cells_(new cell[round_up(capacity)])
+        , mask_(round_up(capacity) - 1)
+        , tail_(0)
+    {
+        for(std::size_t i = 0; i <= mask_; ++i)
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    std::size_t
+    capacity() const noexcept
+    {
+        return mask_ + 1;
+    }
+
+    // Called by any thread. Returns `false` if the ring is full.
+    bool
+    try_push(T&& v)
+    {
+        auto pos = tail_.load(std::memory_order_relaxed);
+        for(;;)
+        {
+            auto& c = cells_[pos & mask_];
+            auto const seq = c.seq.load(std::memory_order_acquire);
+            auto const dif =
+                static_cast<std::ptrdiff_t>(seq) -
+                static_cast<std::ptrdiff_t>(pos);
+            if(dif == 0)
+            {
+                if(tail_.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed))
+                {
+                    c.value = std::move(v);
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if(dif < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Called by the consumer only. Returns `false` if the ring is empty.
+    bool
+    try_pop(T& v)
+    {
+        auto& c = cells_[head_ & mask_];
+        auto const seq = c.seq.load(std::memory_order_acquire);
+        if(seq != head_ + 1)
+            return false;
+        v = std::move(c.value);
+        c.value = T();
+        c.seq.store(head_ + mask_ + 1, std::memory_order_release);
+        ++head_;
+        return true;
+    }
+
+    // Called by the consumer only.
+    bool
+    empty() const noexcept
+    {
+        return cells_[head_ & mask_].seq.load(
+            std::memory_order_acquire) != head_ + 1;
+    }
+};
+
+} // detail
+} // beast
+} // boost
+
+#endif
@@ -0,0 +1,206 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_DETAIL_SESSION_LANE_HPP
+#define BOOST_BEAST_CORE_DETAIL_SESSION_LANE_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/detail/allocator.hpp>
+#include <boost/asio/execution/allocator.hpp>
+#include <boost/asio/query.hpp>
+#include <boost/core/empty_value.hpp>
+#include <boost/core/exchange.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+namespace boost {
+namespace beast {
+
+class work_stealing_pool;
+
+namespace detail {
+
+// A queued function object
+struct lane_op
+{
+    lane_op* next = nullptr;
+
+    // Destroys the object, then calls the function
+    virtual void invoke() = 0;
+
+    // Destroys the object without calling the function
+    virtual void destroy() = 0;
+
+protected:
+    ~lane_op() = default;
+};
+
+// A function object queued with the allocator associated
+// with it, which is also used to allocate the operation.
+template<class Function, class Alloc>
+struct lane_op_impl final : lane_op
+{
+    using alloc_type = typename
+        beast::detail::allocator_traits<
+            Alloc>::template rebind_alloc<lane_op_impl>;
+
+    using alloc_traits =
+        beast::detail::allocator_traits<alloc_type>;
+
+    struct ebo_pair : boost::empty_value<alloc_type>
+    {
+        Function f;
+
+        template<class F>
+        ebo_pair(
+            alloc_type const& a,
+            F&& f_)
+            : boost::empty_value<alloc_type>(
+                boost::empty_init_t{}, a)
+            , f(std::forward<F>(f_))
+        {
+        }
+    };
+
+    ebo_pair v_;
+
+    template<class F>
+    lane_op_impl(alloc_type const& a, F&& f)
+        : v_(a, std::forward<F>(f))
+    {
+    }
+
+    void
+    invoke() override
+    {
+        auto v = std::move(v_);
+        alloc_traits::destroy(v.get(), this);
+        alloc_traits::deallocate(v.get(), this, 1);
+        v.f();
+    }
+
+    void
+    destroy() override
+    {
+        auto v = std::move(v_);
+        alloc_traits::destroy(v.get(), this);
+        alloc_traits::deallocate(v.get(), this, 1);
+    }
+};
+
+template<class Function, class Allocator>
+lane_op*
+make_lane_op(Function&& f, Allocator const& alloc)
+{
+    using op_type = lane_op_impl<
+        typename std::decay<Function>::type, Allocator>;
+    using alloc_type = typename op_type::alloc_type;
+    using alloc_traits = typename op_type::alloc_traits;
+    struct storage
+    {
+        alloc_type a;
+        op_type* p;
+
+        explicit
+        storage(Allocator const& a_)
+            : a(a_)
+            , p(alloc_traits::allocate(a, 1))
+        {
+        }
+
+        ~storage()
+        {
+            if(p)
+                alloc_traits::deallocate(a, p, 1);
+        }
+    };
+    storage s(alloc);
+    alloc_traits::construct(s.a, s.p,
+        s.a, std::forward<Function>(f));
+    return boost::exchange(s.p, nullptr);
+}
+
+// Returns the allocator property of an executor, if it has one
+template<class Executor>
+auto
+lane_allocator(Executor const& ex, int) ->
+    decltype(net::query(ex, net::execution::allocator))
+{
+    return net::query(ex, net::execution::allocator);
+}
+
+template<class Executor>
+std::allocator<void>
+lane_allocator(Executor const&, long)
+{
+    return {};
+}
+
+// The ordered, non-concurrent queue of a session.
+//
+// A lane is scheduled as a whole onto one worker of the
+// pool at a time, so its functions never run concurrently.
+struct session_lane
+    : boost::enable_shared_from_this<session_lane>
+{
+    work_stealing_pool& pool;
+    std::mutex m;
+    lane_op* head = nullptr;
+    lane_op* tail = nullptr;
+
+    // The lane is in a ready queue or running
+    bool scheduled = false;
+
+    // The worker which last ran the lane
+    std::atomic<std::size_t> home;
+
+    // All lanes of the pool, so pending functions
+    // can be destroyed when the pool is destroyed.
+    session_lane* prev = nullptr;
+    session_lane* next = nullptr;
+
+    BOOST_BEAST_DECL
+    session_lane(work_stealing_pool& pool_, std::size_t home_);
+
+    BOOST_BEAST_DECL
+    ~session_lane();
+
+    // Returns the lane being run by the calling thread
+    BOOST_BEAST_DECL
+    static
+    session_lane*&
+    current() noexcept;
+
+    bool
+    running_in_this_thread() const noexcept
+    {
+        return current() == this;
+    }
+
+    // Remove the next function, or clear `scheduled` if empty
+    BOOST_BEAST_DECL
+    lane_op*
+    pop();
+
+    // Destroy all pending functions
+    BOOST_BEAST_DECL
+    void
+    clear();
+};
+
+} // detail
+} // beast
+} // boost
+
+#endif
@@ -0,0 +1,254 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_DETECT_PROTOCOL_HPP
+#define BOOST_BEAST_CORE_DETECT_PROTOCOL_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/stream_traits.hpp>
+#include <boost/asio/async_result.hpp>
+#include <cstddef>
+#include <type_traits>
+
+namespace boost {
+namespace beast {
+
+/// The protocols recognized by @ref detect_protocol
+enum class detected_protocol
+{
+    /// More bytes are needed to tell. Only @ref classify_protocol
+    /// returns this.
+    indeterminate,
+
+    /// None of the protocols below
+    unknown,
+
+    /// A TLS client_hello
+    tls,
+
+    /// An HTTP/1 request which is not a websocket upgrade
+    http,
+
+    /// The HTTP/2 connection preface, sent with prior knowledge
+    http2,
+
+    /// An HTTP/1.1 request to upgrade to websocket
+    websocket,
+
+    /// A PROXY protocol version 1 (text) header
+    proxy_v1,
+
+    /// A PROXY protocol version 2 (binary) header
+    proxy_v2
+};
+
+/** The default number of bytes to examine.
+
+    This is enough for the header of most HTTP requests,
+    including a websocket upgrade.
+*/
+std::size_t constexpr detect_protocol_limit = 4096;
+
+namespace detail {
+
+BOOST_BEAST_DECL
+detected_protocol
+classify_protocol(
+    char const* p, std::size_t n, std::size_t limit);
+
+} // detail
+
+/** Determine the protocol of the first bytes received on a connection.
+
+    The bytes at the beginning of the buffer are compared with the
+    first message of each protocol, in a single pass:
+
+    @li A TLS client_hello record.
+
+    @li A PROXY protocol version 1 or 2 signature.
+
+    @li The HTTP/2 connection preface.
+
+    @li An HTTP/1 request line. A websocket upgrade is reported as
+        soon as its Upgrade field is received. Otherwise the request
+        header must be complete, or be at least `limit` bytes long,
+        before the request is reported as @ref detected_protocol::http.
+
+    @param buffers The bytes received so far.
+
+    @param limit The most bytes which are examined.
+
+    @return The protocol, or @ref detected_protocol::indeterminate
+    if more bytes are needed to tell.
+*/
+template<class ConstBufferSequence>
+detected_protocol
+classify_protocol(
+    ConstBufferSequence const& buffers,
+    std::size_t limit = detect_protocol_limit);
+
+/** Detect the protocol of a connection.
+
+    This function reads from a stream until the protocol of the
+    connection is known, using @ref classify_protocol. Each read asks
+    for up to `limit` bytes, so that the first message is normally
+    received, and the protocol decided, with a single read.
+
+    Bytes read from the stream are stored in the dynamic buffer and
+    none are consumed. The buffer is then passed, without copying, to
+    the layer which handles the protocol: for example to the handshake
+    of an SSL stream, which accepts the bytes already received, or to
+    an HTTP read algorithm, which parses what is already buffered.
+
+    @param stream The stream to read from. This type must meet the
+    requirements of <em>SyncReadStream</em>.
+
+    @param buffer The dynamic buffer to use. This type must meet the
+    requirements of <em>DynamicBuffer</em>.
+
+    @param ec Set to the error if any occurred. If the stream ends
+    before the protocol is known, this is the error of the read.
+
+    @param limit The most bytes which are examined.
+
+    @return The protocol. This is @ref detected_protocol::unknown
+    on error.
+*/
+template<
+    class SyncReadStream,
+    class DynamicBuffer>
+detected_protocol
+detect_protocol(
+    SyncReadStream& stream,
+    DynamicBuffer& buffer,
+    error_code& ec,
+    std::size_t limit = detect_protocol_limit);
+
+/** Detect the protocol of a connection asynchronously.
+
+    This function reads from a stream until the protocol of the
+    connection is known, using @ref classify_protocol. Each read asks
+    for up to @ref detect_protocol_limit bytes, so that the first
+    message is normally received, and the protocol decided, with a
+    single read.
+
+    Bytes read from the stream are stored in the dynamic buffer and
+    none are consumed. The buffer is then passed, without copying, to
+    the layer which handles the protocol.
+
+    The program must ensure that no other calls to `async_read_some`
+    are performed until this operation completes.
+
+    @param stream The stream to read from. This type must meet the
+    requirements of <em>AsyncReadStream</em>.
+
+    @param buffer The dynamic buffer to use. This type must meet the
+    requirements of <em>DynamicBuffer</em>.
+
+    @param handler The completion handler to invoke when the
+    operation completes. The implementation takes ownership of
+    the handler by performing a decay-copy. The equivalent
+    function signature of the handler must be:
+    @code
+    void handler(
+        error_code const& error,        // Set to the error, if any
+        detected_protocol protocol      // The protocol, or unknown on error
+    );
+    @endcode
+    Regardless of whether the asynchronous operation completes
+    immediately or not, the handler will not be invoked from within
+    this function. Invocation of the handler will be performed in a
+    manner equivalent to using `net::post`.
+*/
+template<
+    class AsyncReadStream,
+    class DynamicBuffer,
+    BOOST_ASIO_COMPLETION_TOKEN_FOR(void(error_code, detected_protocol))
+        DetectHandler =
+            net::default_completion_token_t<
+                executor_type<AsyncReadStream>>
+#if ! BOOST_BEAST_DOXYGEN
+    ,class = typename std::enable_if<
+        ! std::is_integral<typename
+            std::decay<DetectHandler>::type>::value>::type
+#endif
+>
+BOOST_ASIO_INITFN_AUTO_RESULT_TYPE(
+    DetectHandler, void(error_code, detected_protocol))
+async_detect_protocol(
+    AsyncReadStream& stream,
+    DynamicBuffer& buffer,
+    DetectHandler&& handler =
+        net::default_completion_token_t<
+            executor_type<AsyncReadStream>>{});
+
+/** Detect the protocol of a connection asynchronously.
+
+    This function reads from a stream until the protocol of the
+    connection is known, using @ref classify_protocol. Each read asks
+    for up to `limit` bytes, so that the first message is normally
+    received, and the protocol decided, with a single read.
+
+    Bytes read from the stream are stored in the dynamic buffer and
+    none are consumed. The buffer is then passed, without copying, to
+    the layer which handles the protocol.
+
+    The program must ensure that no other calls to `async_read_some`
+    are performed until this operation completes.
+
+    @param stream The stream to read from. This type must meet the
+    requirements of <em>AsyncReadStream</em>.
+
+    @param buffer The dynamic buffer to use. This type must meet the
+    requirements of <em>DynamicBuffer</em>.
+
+    @param limit The most bytes which are examined.
+
+    @param handler The completion handler to invoke when the
+    operation completes. The implementation takes ownership of
+    the handler by performing a decay-copy. The equivalent
+    function signature of the handler must be:
+    @code
+    void handler(
+        error_code const& error,        // Set to the error, if any
+        detected_protocol protocol      // The protocol, or unknown on error
+    );
+    @endcode
+    Regardless of whether the asynchronous operation completes
+    immediately or not, the handler will not be invoked from within
+    this function. Invocation of the handler will be performed in a
+    manner equivalent to using `net::post`.
+*/
+template<
+    class AsyncReadStream,
+    class DynamicBuffer,
+    BOOST_ASIO_COMPLETION_TOKEN_FOR(void(error_code, detected_protocol))
+        DetectHandler =
+            net::default_completion_token_t<
+                executor_type<AsyncReadStream>>>
+BOOST_ASIO_INITFN_AUTO_RESULT_TYPE(
+    DetectHandler, void(error_code, detected_protocol))
+async_detect_protocol(
+    AsyncReadStream& stream,
+    DynamicBuffer& buffer,
+    std::size_t limit,
+    DetectHandler&& handler =
+        net::default_completion_token_t<
+            executor_type<AsyncReadStream>>{});
+
+} // beast
+} // boost
+
+#include <boost/beast/_experimental/core/impl/detect_protocol.hpp>
+#ifdef BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/_experimental/core/impl/detect_protocol.ipp>
+#endif
+
+#endif
@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_HAPPY_EYEBALLS_HPP
+#define BOOST_BEAST_CORE_HAPPY_EYEBALLS_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/basic_stream.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/connect.hpp>
+#include <chrono>
+#include <type_traits>
+
+namespace boost {
+namespace beast {
+
+/** Connect a stream using staggered, overlapping attempts.
+
+    This function establishes a connection to one of a sequence
+    of endpoints using the "Happy Eyeballs" algorithm described
+    in RFC 8305. Rather than waiting for each attempt to fail
+    before trying the next, as @ref basic_stream::async_connect
+    does, a new attempt is started every `delay` while earlier
+    attempts are still outstanding. The first attempt to succeed
+    wins, and the remaining attempts are canceled.
+
+    Endpoints are tried in an order which alternates between
+    address families, starting with IPv6 as RFC 8305 recommends.
+    Within a family, the order of the sequence is kept, so the
+    sorting done by the resolver still applies. A host whose IPv6
+    addresses are unreachable is thus connected over IPv4 after
+    roughly one delay, instead of after the IPv6 connect times out.
+
+    Each attempt uses its own socket. On success the connected
+    socket is moved into `stream`, replacing any socket it held.
+    An attempt which fails immediately, for example because the
+    address family is not supported, starts the next attempt
+    without waiting for the delay.
+
+    The attempts do not use the stream's own timeout, which only
+    applies to operations on its socket. Instead, `timeout` limits
+    the operation as a whole. If it expires before an attempt
+    succeeds, the outstanding attempts are canceled and the
+    operation completes with @ref error::timeout.
+
+    @param stream The stream to connect.
+
+    @param endpoints A sequence of endpoints. This object must
+    meet the requirements of <em>EndpointSequence</em>.
+
+    @param delay The time to wait for an attempt before starting
+    the next one. RFC 8305 recommends 250 milliseconds.
+
+    @param timeout The time allowed for the operation, measured
+    from the call to this function.
+
+    @param handler The completion handler to invoke when the
+    operation completes. The implementation takes ownership of
+    the handler by performing a decay-copy. The equivalent
+    function signature of the handler must be:
+    @code
+    void handler(
+        // Result of operation. if the sequence is empty, set to
+        // net::error::not_found. Otherwise, contains the
+        // error from the last connection attempt.
+        error_code const& error,
+
+        // On success, the successfully connected endpoint.
+        // Otherwise, a default-constructed endpoint.
+        typename Protocol::endpoint const& endpoint
+    );
+    @endcode
+    Regardless of whether the asynchronous operation completes
+    immediately or not, the handler will not be invoked from within
+    this function. Invocation of the handler will be performed in a
+    manner equivalent to using `net::post`.
+*/
+template<
+    class Protocol, class Executor, class RatePolicy,
+    class EndpointSequence,
+    BOOST_ASIO_COMPLETION_TOKEN_FOR(
+        void(error_code, typename Protocol::endpoint))
+        RangeConnectHandler =
+            net::default_completion_token_t<Executor>
+#if ! BOOST_BEAST_DOXYGEN
+    ,class = typename std::enable_if<
+        net::is_endpoint_sequence<
+            EndpointSequence>::value>::type
+#endif
+>
+BOOST_ASIO_INITFN_AUTO_RESULT_TYPE(
+    RangeConnectHandler,
+    void(error_code, typename Protocol::endpoint))
+async_connect_happy_eyeballs(
+    basic_stream<Protocol, Executor, RatePolicy>& stream,
+    EndpointSequence const& endpoints,
+    std::chrono::steady_clock::duration delay,
+    std::chrono::steady_clock::duration timeout,
+    RangeConnectHandler&& handler =
+        net::default_completion_token_t<Executor>{});
+
+} // beast
+} // boost
+
+#include <boost/beast/_experimental/core/impl/happy_eyeballs.hpp>
+
+#endif
@@ -0,0 +1,253 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_IMPL_DETECT_PROTOCOL_HPP
+#define BOOST_BEAST_CORE_IMPL_DETECT_PROTOCOL_HPP
+
+#include <boost/beast/core/async_base.hpp>
+#include <boost/beast/core/buffers_range.hpp>
+#include <boost/beast/core/read_size.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/coroutine.hpp>
+#include <algorithm>
+#include <string>
+#include <type_traits>
+
+namespace boost {
+namespace beast {
+
+namespace detail {
+
+// The most bytes examined from the dynamic buffer
+template<class DynamicBuffer>
+std::size_t
+clamp_detect_limit(
+    DynamicBuffer const& buffer, std::size_t limit)
+{
+    return (std::min)(limit, buffer.max_size());
+}
+
+template<
+    class DetectHandler,
+    class AsyncReadStream,
+    class DynamicBuffer>
+class detect_protocol_op
+    : public asio::coroutine
+    , public async_base<
+        DetectHandler, executor_type<AsyncReadStream>>
+{
+    AsyncReadStream& stream_;
+    DynamicBuffer& buffer_;
+    std::size_t limit_;
+    error_code ec_;
+    detected_protocol result_ =
+        detected_protocol::indeterminate;
+
+public:
+    template<class DetectHandler_>
+    detect_protocol_op(
+        DetectHandler_&& handler,
+        AsyncReadStream& stream,
+        DynamicBuffer& buffer,
+        std::size_t limit)
+        : async_base<
+            DetectHandler,
+            executor_type<AsyncReadStream>>(
+                std::forward<DetectHandler_>(handler),
+                stream.get_executor())
+        , stream_(stream)
+        , buffer_(buffer)
+        , limit_(detail::clamp_detect_limit(buffer, limit))
+    {
+        (*this)({}, 0, false);
+    }
+
+    void
+    operator()(
+        error_code ec,
+        std::size_t bytes_transferred,
+        bool cont = true)
+    {
+        BOOST_ASIO_CORO_REENTER(*this)
+        {
+            for(;;)
+            {
+                result_ = beast::classify_protocol(
+                    buffer_.data(), limit_);
+                if(result_ != detected_protocol::indeterminate)
+                    break;
+                BOOST_ASIO_CORO_YIELD
+                stream_.async_read_some(buffer_.prepare(
+                    read_size(buffer_, limit_)), std::move(*this));
+                buffer_.commit(bytes_transferred);
+                if(ec)
+                {
+                    result_ = detected_protocol::unknown;
+                    break;
+                }
+            }
+            if(! cont)
+            {
+                ec_ = ec;
+                BOOST_ASIO_CORO_YIELD
+                stream_.async_read_some(
+                    buffer_.prepare(0), std::move(*this));
+                ec = ec_;
+            }
+            this->complete_now(ec, result_);
+        }
+    }
+};
+
+struct run_detect_protocol_op
+{
+    template<
+        class DetectHandler,
+        class AsyncReadStream,
+        class DynamicBuffer>
+    void
+    operator()(
+        DetectHandler&& h,
+        AsyncReadStream* s,
+        DynamicBuffer* b,
+        std::size_t limit)
+    {
+        detect_protocol_op<
+            typename std::decay<DetectHandler>::type,
+            AsyncReadStream,
+            DynamicBuffer>(
+                std::forward<DetectHandler>(h), *s, *b, limit);
+    }
+};
+
+} // detail
+
+template<class ConstBufferSequence>
+detected_protocol
+classify_protocol(
+    ConstBufferSequence const& buffers,
+    std::size_t limit)
+{
+    static_assert(
+        net::is_const_buffer_sequence<ConstBufferSequence>::value,
+        "ConstBufferSequence type requirements not met");
+
+    // The bytes are usually in one buffer, and
+    // are only copied when they are not.
+    auto const first = net::buffer_sequence_begin(buffers);
+    auto const last = net::buffer_sequence_end(buffers);
+    if(first == last)
+        return detail::classify_protocol(nullptr, 0, limit);
+    {
+        auto it = first;
+        ++it;
+        net::const_buffer const b = *first;
+        if( it == last ||
+            b.size() >= limit ||
+            net::buffer_size(buffers) == b.size())
+            return detail::classify_protocol(
+                static_cast<char const*>(b.data()), b.size(), limit);
+    }
+    std::string s;
+    s.reserve((std::min)(limit, net::buffer_size(buffers)));
+    for(auto const b : buffers_range_ref(buffers))
+    {
+        if(s.size() >= limit)
+            break;
+        s.append(static_cast<char const*>(b.data()),
+            (std::min)(b.size(), limit - s.size()));
+    }
+    return detail::classify_protocol(s.data(), s.size(), limit);
+}
+
+template<
+    class SyncReadStream,
+    class DynamicBuffer>
+detected_protocol
+detect_protocol(
+    SyncReadStream& stream,
+    DynamicBuffer& buffer,
+    error_code& ec,
+    std::size_t limit)
+{
+    static_assert(
+        is_sync_read_stream<SyncReadStream>::value,
+        "SyncReadStream type requirements not met");
+    static_assert(
+        net::is_dynamic_buffer<DynamicBuffer>::value,
+        "DynamicBuffer type requirements not met");
+
+    limit = detail::clamp_detect_limit(buffer, limit);
+    ec = {};
+    for(;;)
+    {
+        auto const result =
+            classify_protocol(buffer.data(), limit);
+        if(result != detected_protocol::indeterminate)
+            return result;
+        auto const n = stream.read_some(
+            buffer.prepare(read_size(buffer, limit)), ec);
+        buffer.commit(n);
+        if(ec)
+            return detected_protocol::unknown;
+    }
+}
+
+template<
+    class AsyncReadStream,
+    class DynamicBuffer,
+    BOOST_ASIO_COMPLETION_TOKEN_FOR(void(error_code, detected_protocol))
+        DetectHandler,
+    class>
+BOOST_ASIO_INITFN_AUTO_RESULT_TYPE(
+    DetectHandler, void(error_code, detected_protocol))
+async_detect_protocol(
+    AsyncReadStream& stream,
+    DynamicBuffer& buffer,
+    DetectHandler&& handler)
+{
+    return async_detect_protocol(stream, buffer,
+        detect_protocol_limit,
+        std::forward<DetectHandler>(handler));
+}
+
+template<
+    class AsyncReadStream,
+    class DynamicBuffer,
+    BOOST_ASIO_COMPLETION_TOKEN_FOR(void(error_code, detected_protocol))
+        DetectHandler>
+BOOST_ASIO_INITFN_AUTO_RESULT_TYPE(
+    DetectHandler, void(error_code, detected_protocol))
+async_detect_protocol(
+    AsyncReadStream& stream,
+    DynamicBuffer& buffer,
+    std::size_t limit,
+    DetectHandler&& handler)
+{
+    static_assert(
+        is_async_read_stream<AsyncReadStream>::value,
+        "AsyncReadStream type requirements not met");
+    static_assert(
+        net::is_dynamic_buffer<DynamicBuffer>::value,
+        "DynamicBuffer type requirements not met");
+
+    return net::async_initiate<
+        DetectHandler,
+        void(error_code, detected_protocol)>(
+            detail::run_detect_protocol_op{},
+            handler,
+            &stream,
+            &buffer,
+            limit);
+}
+
+} // beast
+} // boost
+
+#endif
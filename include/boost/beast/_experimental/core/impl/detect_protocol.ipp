@@ -0,0 +1,177 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_IMPL_DETECT_PROTOCOL_IPP
+#define BOOST_BEAST_CORE_IMPL_DETECT_PROTOCOL_IPP
+
+#include <boost/beast/_experimental/core/detect_protocol.hpp>
+#include <boost/beast/core/detect_ssl.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/beast/http/detail/rfc7230.hpp>
+#include <cstring>
+
+namespace boost {
+namespace beast {
+namespace detail {
+
+// Compares the bytes with the start of a signature:
+// 1 if they match it, 0 if they do not, and -1 if
+// they match but are shorter than the signature.
+inline
+int
+match_prefix(
+    char const* p, std::size_t n,
+    char const* sig, std::size_t len)
+{
+    std::size_t const m = n < len ? n : len;
+    if(std::memcmp(p, sig, m) != 0)
+        return 0;
+    return m == len ? 1 : -1;
+}
+
+inline
+char const*
+find_crlf(char const* first, char const* last)
+{
+    for(; last - first >= 2; ++first)
+        if(first[0] == '\r' && first[1] == '\n')
+            return first;
+    return nullptr;
+}
+
+inline
+string_view
+trim(string_view s)
+{
+    while(! s.empty() && (s.front() == ' ' || s.front() == '\t'))
+        s.remove_prefix(1);
+    while(! s.empty() && (s.back() == ' ' || s.back() == '\t'))
+        s.remove_suffix(1);
+    return s;
+}
+
+// Returns true if the Upgrade field value lists websocket
+inline
+bool
+lists_websocket(string_view value)
+{
+    for(;;)
+    {
+        auto const comma = value.find(',');
+        if(iequals(trim(value.substr(0, comma)), "websocket"))
+            return true;
+        if(comma == string_view::npos)
+            return false;
+        value.remove_prefix(comma + 1);
+    }
+}
+
+detected_protocol
+classify_protocol(
+    char const* p, std::size_t n, std::size_t limit)
+{
+    // The signatures of the PROXY protocol headers
+    // and of the HTTP/2 connection preface.
+    static char const proxy_v2[] = "\r\n\r\n\0\r\nQUIT\n";
+    static char const proxy_v1[] = "PROXY ";
+    static char const preface[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+    if(n > limit)
+        n = limit;
+    bool const full = n >= limit;
+    auto const more =
+        full ? detected_protocol::unknown :
+        detected_protocol::indeterminate;
+    if(n == 0)
+        return more;
+
+    switch(p[0])
+    {
+    case 0x16:
+    {
+        auto const result = is_tls_client_hello(
+            net::const_buffer(p, n));
+        if(boost::indeterminate(result))
+            return more;
+        return result ?
+            detected_protocol::tls :
+            detected_protocol::unknown;
+    }
+
+    case '\r':
+        switch(match_prefix(p, n, proxy_v2, sizeof(proxy_v2) - 1))
+        {
+        case 1:  return detected_protocol::proxy_v2;
+        case -1: return more;
+        default: return detected_protocol::unknown;
+        }
+
+    case 'P':
+        switch(match_prefix(p, n, proxy_v1, sizeof(proxy_v1) - 1))
+        {
+        case 1:  return detected_protocol::proxy_v1;
+        case -1: return more;
+        default: break;
+        }
+        switch(match_prefix(p, n, preface, sizeof(preface) - 1))
+        {
+        case 1:  return detected_protocol::http2;
+        case -1: return more;
+        default: break;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    // An HTTP/1 request line begins with a method token
+    char const* const last = p + n;
+    char const* it = p;
+    for(; it != last && *it != ' '; ++it)
+        if(! http::detail::is_token_char(*it))
+            return detected_protocol::unknown;
+    if(it == last)
+        return more;
+    if(it == p)
+        return detected_protocol::unknown;
+
+    // and ends with the version
+    auto const eol = find_crlf(it, last);
+    if(! eol)
+        return full ? detected_protocol::http : more;
+    if( eol - p < 9 ||
+        std::memcmp(eol - 9, " HTTP/1.", 8) != 0)
+        return detected_protocol::unknown;
+
+    // Look for Upgrade: websocket in the header
+    auto line = eol + 2;
+    for(;;)
+    {
+        auto const end = find_crlf(line, last);
+        if(! end)
+            return full ? detected_protocol::http : more;
+        if(end == line)
+            return detected_protocol::http;
+        string_view const s(line,
+            static_cast<std::size_t>(end - line));
+        auto const colon = s.find(':');
+        if( colon != string_view::npos &&
+            iequals(s.substr(0, colon), "upgrade") &&
+            lists_websocket(s.substr(colon + 1)))
+            return detected_protocol::websocket;
+        line = end + 2;
+    }
+}
+
+} // detail
+} // beast
+} // boost
+
+#endif
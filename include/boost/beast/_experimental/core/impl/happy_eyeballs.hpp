@@ -0,0 +1,292 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_IMPL_HAPPY_EYEBALLS_HPP
+#define BOOST_BEAST_CORE_IMPL_HAPPY_EYEBALLS_HPP
+
+#include <boost/beast/core/async_base.hpp>
+#include <boost/beast/core/detail/is_invocable.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/coroutine.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/core/ignore_unused.hpp>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace detail {
+
+template<
+    class Protocol, class Executor, class RatePolicy,
+    class Handler>
+class happy_eyeballs_op
+    : public stable_async_base<Handler, Executor>
+    , public asio::coroutine
+{
+    using stream_type = basic_stream<Protocol, Executor, RatePolicy>;
+    using socket_type = typename stream_type::socket_type;
+    using endpoint_type = typename Protocol::endpoint;
+    using clock_type = std::chrono::steady_clock;
+    using timer_type = net::basic_waitable_timer<
+        clock_type,
+        net::wait_traits<clock_type>,
+        Executor>;
+
+    // The attempts complete into this state and cancel the
+    // timer, on which the operation itself always waits.
+    struct state
+    {
+        timer_type timer;
+        std::vector<endpoint_type> eps;
+        std::vector<std::unique_ptr<socket_type>> socks;
+        std::size_t next = 0;       // next endpoint to try
+        std::size_t attempts = 0;   // outstanding connects
+        std::size_t winner = 0;
+        bool won = false;
+        bool closing = false;       // the result is known
+        error_code ec;
+
+        explicit
+        state(Executor const& ex)
+            : timer(ex)
+        {
+        }
+    };
+
+    struct connect_handler
+    {
+        state* st;
+        std::size_t i;
+
+        void
+        operator()(error_code ec)
+        {
+            --st->attempts;
+            if(! ec && ! st->closing)
+            {
+                st->won = true;
+                st->closing = true;
+                st->winner = i;
+            }
+            else
+            {
+                if(! st->closing)
+                    st->ec = ec;
+                st->socks[i].reset();
+            }
+            st->timer.cancel();
+        }
+    };
+
+    stream_type& stream_;
+    state& st_;
+    clock_type::duration delay_;
+    clock_type::time_point deadline_;
+
+public:
+    template<class Handler_, class EndpointSequence>
+    happy_eyeballs_op(
+        Handler_&& h,
+        stream_type& s,
+        EndpointSequence const& endpoints,
+        clock_type::duration delay,
+        clock_type::duration timeout)
+        : stable_async_base<Handler, Executor>(
+            std::forward<Handler_>(h), s.get_executor())
+        , stream_(s)
+        , st_(beast::allocate_stable<state>(
+            *this, s.get_executor()))
+        , delay_(delay)
+    {
+        auto const now = clock_type::now();
+        deadline_ = timeout < stream_base::never() - now ?
+            now + timeout : stream_base::never();
+
+        // Alternate address families, IPv6 first as RFC 8305
+        // recommends. The order within a family is kept.
+        std::vector<endpoint_type> a;
+        std::vector<endpoint_type> b;
+        for(auto const& e : endpoints)
+        {
+            endpoint_type const ep(e);
+            if(ep.address().is_v6())
+                a.push_back(ep);
+            else
+                b.push_back(ep);
+        }
+        st_.eps.reserve(a.size() + b.size());
+        for(std::size_t i = 0; i < a.size() || i < b.size(); ++i)
+        {
+            if(i < a.size())
+                st_.eps.push_back(a[i]);
+            if(i < b.size())
+                st_.eps.push_back(b[i]);
+        }
+        st_.socks.resize(st_.eps.size());
+        (*this)({}, false);
+    }
+
+    void
+    operator()(error_code ec = {}, bool cont = true)
+    {
+        boost::ignore_unused(ec);
+        BOOST_ASIO_CORO_REENTER(*this)
+        {
+            if(st_.eps.empty())
+            {
+                st_.ec = net::error::not_found;
+                goto upcall;
+            }
+            for(;;)
+            {
+                start_next();
+                if(st_.attempts == 0)
+                    break;
+
+                // Wait for the delay, or for an attempt to complete
+                if(st_.next < st_.eps.size() &&
+                    clock_type::now() + delay_ < deadline_)
+                    st_.timer.expires_after(delay_);
+                else
+                    st_.timer.expires_at(deadline_);
+                BOOST_ASIO_CORO_YIELD
+                st_.timer.async_wait(std::move(*this));
+                if(st_.won)
+                    break;
+                if(clock_type::now() >= deadline_)
+                {
+                    st_.ec = beast::error::timeout;
+                    break;
+                }
+            }
+
+            // Cancel the other attempts and wait for them
+            st_.closing = true;
+            for(std::size_t i = 0; i < st_.socks.size(); ++i)
+            {
+                if(st_.socks[i] && ! (st_.won && i == st_.winner))
+                {
+                    error_code ignored;
+                    st_.socks[i]->close(ignored);
+                }
+            }
+            while(st_.attempts > 0)
+            {
+                st_.timer.expires_at(stream_base::never());
+                BOOST_ASIO_CORO_YIELD
+                st_.timer.async_wait(std::move(*this));
+            }
+
+        upcall:
+            if(st_.won)
+            {
+                auto const ep = st_.eps[st_.winner];
+                stream_.socket() = std::move(
+                    *st_.socks[st_.winner]);
+                return this->complete(cont, error_code{}, ep);
+            }
+            this->complete(cont, st_.ec, endpoint_type{});
+        }
+    }
+
+private:
+    // Start attempts until one is in flight
+    void
+    start_next()
+    {
+        while(st_.next < st_.eps.size())
+        {
+            auto const i = st_.next++;
+            auto& sock = st_.socks[i];
+            sock.reset(new socket_type(stream_.get_executor()));
+            error_code ec;
+            sock->open(st_.eps[i].protocol(), ec);
+            if(ec)
+            {
+                st_.ec = ec;
+                sock.reset();
+                continue;
+            }
+            ++st_.attempts;
+            sock->async_connect(st_.eps[i],
+                net::bind_executor(this->get_executor(),
+                    connect_handler{&st_, i}));
+            return;
+        }
+    }
+};
+
+struct run_happy_eyeballs_op
+{
+    template<
+        class RangeConnectHandler,
+        class Protocol, class Executor, class RatePolicy,
+        class EndpointSequence>
+    void
+    operator()(
+        RangeConnectHandler&& h,
+        basic_stream<Protocol, Executor, RatePolicy>* s,
+        EndpointSequence const& eps,
+        std::chrono::steady_clock::duration delay,
+        std::chrono::steady_clock::duration timeout)
+    {
+        // If you get an error on the following line it means
+        // that your handler does not meet the documented type
+        // requirements for the handler.
+
+        static_assert(
+            beast::detail::is_invocable<RangeConnectHandler,
+                void(error_code, typename Protocol::endpoint)>::value,
+            "RangeConnectHandler type requirements not met");
+
+        happy_eyeballs_op<
+            Protocol, Executor, RatePolicy,
+            typename std::decay<RangeConnectHandler>::type>(
+                std::forward<RangeConnectHandler>(h),
+                    *s, eps, delay, timeout);
+    }
+};
+
+} // detail
+
+template<
+    class Protocol, class Executor, class RatePolicy,
+    class EndpointSequence,
+    BOOST_ASIO_COMPLETION_TOKEN_FOR(
+        void(error_code, typename Protocol::endpoint))
+        RangeConnectHandler,
+    class>
+BOOST_ASIO_INITFN_AUTO_RESULT_TYPE(
+    RangeConnectHandler,
+    void(error_code, typename Protocol::endpoint))
+async_connect_happy_eyeballs(
+    basic_stream<Protocol, Executor, RatePolicy>& stream,
+    EndpointSequence const& endpoints,
+    std::chrono::steady_clock::duration delay,
+    std::chrono::steady_clock::duration timeout,
+    RangeConnectHandler&& handler)
+{
+    return net::async_initiate<
+        RangeConnectHandler,
+        void(error_code, typename Protocol::endpoint)>(
+            detail::run_happy_eyeballs_op{},
+            handler,
+            &stream,
+            endpoints,
+            delay,
+            timeout);
+}
+
+} // beast
+} // boost
+
+#endif
@@ -0,0 +1,378 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_IMPL_PROXY_PROTOCOL_STREAM_HPP
+#define BOOST_BEAST_CORE_IMPL_PROXY_PROTOCOL_STREAM_HPP
+
+#include <boost/beast/core/async_base.hpp>
+#include <boost/beast/core/stream_traits.hpp>
+#include <boost/beast/core/detail/is_invocable.hpp>
+#include <boost/beast/websocket/teardown.hpp>
+#include <boost/asio/coroutine.hpp>
+#include <boost/throw_exception.hpp>
+#include <utility>
+
+namespace boost {
+namespace system {
+template<>
+struct is_error_code_enum<
+    boost::beast::proxy_error>
+        : std::true_type
+{
+};
+} // system
+} // boost
+
+namespace boost {
+namespace beast {
+
+BOOST_BEAST_DECL
+error_code
+make_error_code(proxy_error e) noexcept;
+
+template<class NextLayer>
+struct proxy_protocol_stream<NextLayer>::ops
+{
+
+template<class Handler>
+class handshake_op
+    : public beast::async_base<Handler,
+        beast::executor_type<proxy_protocol_stream>>
+    , public asio::coroutine
+{
+    proxy_protocol_stream& s_;
+    error_code ec_;
+
+public:
+    template<class Handler_>
+    handshake_op(
+        Handler_&& h,
+        proxy_protocol_stream& s)
+        : async_base<Handler,
+            beast::executor_type<proxy_protocol_stream>>(
+                std::forward<Handler_>(h), s.get_executor())
+        , s_(s)
+    {
+        (*this)({}, 0, false);
+    }
+
+    void
+    operator()(
+        error_code ec,
+        std::size_t bytes_transferred,
+        bool cont = true)
+    {
+        BOOST_ASIO_CORO_REENTER(*this)
+        {
+            while(! s_.rd_.done())
+            {
+                BOOST_ASIO_CORO_YIELD
+                s_.stream_.async_read_some(
+                    s_.rd_.prepare(), std::move(*this));
+                if(ec)
+                    break;
+                s_.rd_.commit(bytes_transferred, ec);
+                if(ec)
+                    break;
+            }
+            if(! cont)
+            {
+                ec_ = ec;
+                BOOST_ASIO_CORO_YIELD
+                s_.stream_.async_read_some(
+                    net::mutable_buffer{}, std::move(*this));
+                ec = ec_;
+            }
+            this->complete_now(ec);
+        }
+    }
+};
+
+template<class Buffers, class Handler>
+class read_op
+    : public beast::async_base<Handler,
+        beast::executor_type<proxy_protocol_stream>>
+    , public asio::coroutine
+{
+    proxy_protocol_stream& s_;
+    Buffers b_;
+    std::size_t n_ = 0;
+    error_code ec_;
+
+public:
+    template<class Handler_>
+    read_op(
+        Handler_&& h,
+        proxy_protocol_stream& s,
+        Buffers const& b)
+        : async_base<Handler,
+            beast::executor_type<proxy_protocol_stream>>(
+                std::forward<Handler_>(h), s.get_executor())
+        , s_(s)
+        , b_(b)
+    {
+        (*this)({}, 0, false);
+    }
+
+    void
+    operator()(error_code ec)
+    {
+        (*this)(ec, 0);
+    }
+
+    void
+    operator()(
+        error_code ec,
+        std::size_t bytes_transferred,
+        bool cont = true)
+    {
+        BOOST_ASIO_CORO_REENTER(*this)
+        {
+            if(! s_.rd_.done())
+            {
+                BOOST_ASIO_CORO_YIELD
+                s_.async_handshake(std::move(*this));
+                if(ec)
+                    goto upcall;
+            }
+            if(! s_.rd_.pass())
+            {
+                bytes_transferred = s_.rd_.read(b_);
+            }
+            else
+            {
+                BOOST_ASIO_CORO_YIELD
+                s_.stream_.async_read_some(
+                    b_, std::move(*this));
+            }
+        upcall:
+            if(! cont)
+            {
+                ec_ = ec;
+                n_ = bytes_transferred;
+                BOOST_ASIO_CORO_YIELD
+                s_.stream_.async_read_some(
+                    net::mutable_buffer{},
+                    std::move(*this));
+                ec = ec_;
+                bytes_transferred = n_;
+            }
+            this->complete_now(ec, bytes_transferred);
+        }
+    }
+};
+
+struct run_handshake_op
+{
+    template<class HandshakeHandler>
+    void
+    operator()(
+        HandshakeHandler&& h,
+        proxy_protocol_stream* s)
+    {
+        // If you get an error on the following line it means
+        // that your handler does not meet the documented type
+        // requirements for the handler.
+
+        static_assert(
+            beast::detail::is_invocable<HandshakeHandler,
+            void(error_code)>::value,
+            "HandshakeHandler type requirements not met");
+
+        handshake_op<
+            typename std::decay<HandshakeHandler>::type>(
+                std::forward<HandshakeHandler>(h), *s);
+    }
+};
+
+struct run_read_op
+{
+    template<class ReadHandler, class Buffers>
+    void
+    operator()(
+        ReadHandler&& h,
+        proxy_protocol_stream* s,
+        Buffers const& b)
+    {
+        // If you get an error on the following line it means
+        // that your handler does not meet the documented type
+        // requirements for the handler.
+
+        static_assert(
+            beast::detail::is_invocable<ReadHandler,
+            void(error_code, std::size_t)>::value,
+            "ReadHandler type requirements not met");
+
+        // After the header, the handler goes straight to the next layer
+        if(s->rd_.pass())
+        {
+            s->stream_.async_read_some(
+                b, std::forward<ReadHandler>(h));
+            return;
+        }
+
+        read_op<
+            Buffers,
+            typename std::decay<ReadHandler>::type>(
+                std::forward<ReadHandler>(h), *s, b);
+    }
+};
+
+};
+
+//------------------------------------------------------------------------------
+
+template<class NextLayer>
+template<class... Args>
+proxy_protocol_stream<NextLayer>::
+proxy_protocol_stream(Args&&... args)
+    : stream_(std::forward<Args>(args)...)
+{
+}
+
+template<class NextLayer>
+void
+proxy_protocol_stream<NextLayer>::
+handshake(error_code& ec)
+{
+    static_assert(is_sync_read_stream<next_layer_type>::value,
+        "SyncReadStream type requirements not met");
+    ec = {};
+    while(! rd_.done())
+    {
+        auto const n = stream_.read_some(rd_.prepare(), ec);
+        if(ec)
+            return;
+        rd_.commit(n, ec);
+        if(ec)
+            return;
+    }
+}
+
+template<class NextLayer>
+void
+proxy_protocol_stream<NextLayer>::
+handshake()
+{
+    error_code ec;
+    handshake(ec);
+    if(ec)
+        BOOST_THROW_EXCEPTION(system_error{ec});
+}
+
+template<class NextLayer>
+template<BOOST_BEAST_ASYNC_TPARAM1 HandshakeHandler>
+BOOST_BEAST_ASYNC_RESULT1(HandshakeHandler)
+proxy_protocol_stream<NextLayer>::
+async_handshake(HandshakeHandler&& handler)
+{
+    static_assert(is_async_read_stream<next_layer_type>::value,
+        "AsyncReadStream type requirements not met");
+    return net::async_initiate<
+        HandshakeHandler,
+        void(error_code)>(
+            typename ops::run_handshake_op{},
+            handler,
+            this);
+}
+
+template<class NextLayer>
+template<class MutableBufferSequence>
+std::size_t
+proxy_protocol_stream<NextLayer>::
+read_some(MutableBufferSequence const& buffers)
+{
+    static_assert(is_sync_read_stream<next_layer_type>::value,
+        "SyncReadStream type requirements not met");
+    static_assert(net::is_mutable_buffer_sequence<
+        MutableBufferSequence>::value,
+            "MutableBufferSequence type requirements not met");
+    error_code ec;
+    auto n = read_some(buffers, ec);
+    if(ec)
+        BOOST_THROW_EXCEPTION(system_error{ec});
+    return n;
+}
+
+template<class NextLayer>
+template<class MutableBufferSequence>
+std::size_t
+proxy_protocol_stream<NextLayer>::
+read_some(MutableBufferSequence const& buffers, error_code& ec)
+{
+    static_assert(is_sync_read_stream<next_layer_type>::value,
+        "SyncReadStream type requirements not met");
+    static_assert(net::is_mutable_buffer_sequence<
+        MutableBufferSequence>::value,
+            "MutableBufferSequence type requirements not met");
+    if(! rd_.pass())
+    {
+        if(! rd_.done())
+        {
+            handshake(ec);
+            if(ec)
+                return 0;
+        }
+        if(! rd_.pass())
+            return rd_.read(buffers);
+    }
+    return stream_.read_some(buffers, ec);
+}
+
+template<class NextLayer>
+template<
+    class MutableBufferSequence,
+    BOOST_BEAST_ASYNC_TPARAM2 ReadHandler>
+BOOST_BEAST_ASYNC_RESULT2(ReadHandler)
+proxy_protocol_stream<NextLayer>::
+async_read_some(
+    MutableBufferSequence const& buffers,
+    ReadHandler&& handler)
+{
+    static_assert(is_async_read_stream<next_layer_type>::value,
+        "AsyncReadStream type requirements not met");
+    static_assert(net::is_mutable_buffer_sequence<
+            MutableBufferSequence >::value,
+        "MutableBufferSequence type requirements not met");
+    return net::async_initiate<
+        ReadHandler,
+        void(error_code, std::size_t)>(
+            typename ops::run_read_op{},
+            handler,
+            this,
+            buffers);
+}
+
+template<class NextLayer>
+void
+teardown(
+    role_type role,
+    proxy_protocol_stream<NextLayer>& stream,
+    error_code& ec)
+{
+    using boost::beast::websocket::teardown;
+    teardown(role, stream.next_layer(), ec);
+}
+
+template<class NextLayer, class TeardownHandler>
+void
+async_teardown(
+    role_type role,
+    proxy_protocol_stream<NextLayer>& stream,
+    TeardownHandler&& handler)
+{
+    using boost::beast::websocket::async_teardown;
+    async_teardown(role, stream.next_layer(),
+        std::forward<TeardownHandler>(handler));
+}
+
+} // beast
+} // boost
+
+#endif
@@ -0,0 +1,335 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_IMPL_PROXY_PROTOCOL_STREAM_IPP
+#define BOOST_BEAST_CORE_IMPL_PROXY_PROTOCOL_STREAM_IPP
+
+#include <boost/beast/_experimental/core/proxy_protocol_stream.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/assert.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace boost {
+namespace beast {
+
+namespace detail {
+
+class proxy_error_codes : public error_category
+{
+public:
+    BOOST_BEAST_DECL
+    const char*
+    name() const noexcept override
+    {
+        return "boost.beast.proxy";
+    }
+
+    BOOST_BEAST_DECL
+    std::string
+    message(int ev) const override
+    {
+        switch(static_cast<proxy_error>(ev))
+        {
+        case proxy_error::bad_signature: return
+            "The connection does not begin with a PROXY protocol header";
+        default:
+        case proxy_error::bad_header: return
+            "The PROXY protocol header is malformed";
+        }
+    }
+
+    BOOST_BEAST_DECL
+    error_condition
+    default_error_condition(int ev) const noexcept override
+    {
+        return error_condition{ev, *this};
+    }
+};
+
+// The longest version 1 header, including the CRLF
+std::size_t constexpr proxy_v1_limit = 107;
+
+std::size_t constexpr proxy_v2_size = 16;
+
+inline
+unsigned char
+octet(char const* p, std::size_t i)
+{
+    return static_cast<unsigned char>(p[i]);
+}
+
+inline
+std::uint16_t
+big_endian16(char const* p)
+{
+    return static_cast<std::uint16_t>(
+        (octet(p, 0) << 8) | octet(p, 1));
+}
+
+inline
+bool
+parse_port(string_view s, unsigned short& port)
+{
+    if(s.empty() || s.size() > 5)
+        return false;
+    unsigned long v = 0;
+    for(char c : s)
+    {
+        if(c < '0' || c > '9')
+            return false;
+        v = 10 * v + static_cast<unsigned long>(c - '0');
+    }
+    if(v > 65535)
+        return false;
+    port = static_cast<unsigned short>(v);
+    return true;
+}
+
+inline
+bool
+parse_address(string_view s, bool v6, net::ip::address& addr)
+{
+    // The address functions want a null-terminated string
+    char buf[64];
+    if(s.empty() || s.size() >= sizeof(buf))
+        return false;
+    std::memcpy(buf, s.data(), s.size());
+    buf[s.size()] = 0;
+    error_code ec;
+    if(v6)
+        addr = net::ip::make_address_v6(buf, ec);
+    else
+        addr = net::ip::make_address_v4(buf, ec);
+    return ! ec;
+}
+
+// PROXY TCP4 192.0.2.1 192.0.2.2 56324 443\r\n
+inline
+std::size_t
+parse_v1(
+    char const* p, std::size_t n,
+    proxy_header& h, error_code& ec)
+{
+    auto const m = n < proxy_v1_limit ? n : proxy_v1_limit;
+    auto const lf = static_cast<char const*>(
+        std::memchr(p, '\n', m));
+    if(! lf)
+    {
+        if(n >= proxy_v1_limit)
+            ec = proxy_error::bad_header;
+        return 0;
+    }
+    auto const size = static_cast<std::size_t>(lf - p) + 1;
+    if(lf[-1] != '\r')
+    {
+        ec = proxy_error::bad_header;
+        return 0;
+    }
+    string_view line(p + 6, size - 8);
+    h.version = 1;
+    if(line.substr(0, 7) == "UNKNOWN")
+        return size;
+
+    string_view tok[5];
+    for(auto& t : tok)
+    {
+        auto const sp = line.find(' ');
+        t = line.substr(0, sp);
+        line = sp == string_view::npos ?
+            string_view{} : line.substr(sp + 1);
+    }
+    bool v6;
+    if(tok[0] == "TCP4")
+        v6 = false;
+    else if(tok[0] == "TCP6")
+        v6 = true;
+    else
+        tok[0] = {};
+    net::ip::address src;
+    net::ip::address dst;
+    unsigned short src_port;
+    unsigned short dst_port;
+    if( tok[0].empty() || ! line.empty() ||
+        ! parse_address(tok[1], v6, src) ||
+        ! parse_address(tok[2], v6, dst) ||
+        ! parse_port(tok[3], src_port) ||
+        ! parse_port(tok[4], dst_port))
+    {
+        ec = proxy_error::bad_header;
+        return 0;
+    }
+    h.proxied = true;
+    h.source = {src, src_port};
+    h.destination = {dst, dst_port};
+    return size;
+}
+
+// The fixed 16 bytes, then the addresses, then TLVs.
+// Only the bytes up to the end of the addresses are needed.
+inline
+std::size_t
+parse_v2(
+    char const* p, std::size_t n,
+    proxy_header& h, error_code& ec)
+{
+    if(n < proxy_v2_size)
+        return 0;
+    auto const ver_cmd = octet(p, 12);
+    auto const family = octet(p, 13);
+    std::size_t const size =
+        proxy_v2_size + big_endian16(p + 14);
+    if((ver_cmd >> 4) != 2 || (ver_cmd & 0x0f) > 1)
+    {
+        ec = proxy_error::bad_header;
+        return 0;
+    }
+    h.version = 2;
+
+    // LOCAL
+    if((ver_cmd & 0x0f) == 0)
+        return size;
+
+    p += proxy_v2_size;
+    switch(family)
+    {
+    case 0x11: // TCP over IPv4
+    {
+        if(size < proxy_v2_size + 12)
+            break;
+        if(n < proxy_v2_size + 12)
+            return 0;
+        net::ip::address_v4::bytes_type src;
+        net::ip::address_v4::bytes_type dst;
+        std::memcpy(src.data(), p, 4);
+        std::memcpy(dst.data(), p + 4, 4);
+        h.proxied = true;
+        h.source = {net::ip::address_v4(src), big_endian16(p + 8)};
+        h.destination = {net::ip::address_v4(dst), big_endian16(p + 10)};
+        return size;
+    }
+
+    case 0x21: // TCP over IPv6
+    {
+        if(size < proxy_v2_size + 36)
+            break;
+        if(n < proxy_v2_size + 36)
+            return 0;
+        net::ip::address_v6::bytes_type src;
+        net::ip::address_v6::bytes_type dst;
+        std::memcpy(src.data(), p, 16);
+        std::memcpy(dst.data(), p + 16, 16);
+        h.proxied = true;
+        h.source = {net::ip::address_v6(src), big_endian16(p + 32)};
+        h.destination = {net::ip::address_v6(dst), big_endian16(p + 34)};
+        return size;
+    }
+
+    default:
+        // Other families are accepted without their addresses
+        return size;
+    }
+    ec = proxy_error::bad_header;
+    return 0;
+}
+
+// Returns the size of the header, or 0 if more bytes are needed
+inline
+std::size_t
+parse_proxy_header(
+    char const* p, std::size_t n,
+    proxy_header& h, error_code& ec)
+{
+    static char const proxy_v1_sig[] = "PROXY ";
+    static char const proxy_v2_sig[] = "\r\n\r\n\0\r\nQUIT\n";
+
+    h = {};
+    if(n == 0)
+        return 0;
+    if(p[0] == 'P')
+    {
+        auto const m = (std::min)(n, sizeof(proxy_v1_sig) - 1);
+        if(std::memcmp(p, proxy_v1_sig, m) != 0)
+        {
+            ec = proxy_error::bad_signature;
+            return 0;
+        }
+        if(m < sizeof(proxy_v1_sig) - 1)
+            return 0;
+        return parse_v1(p, n, h, ec);
+    }
+    auto const m = (std::min)(n, sizeof(proxy_v2_sig) - 1);
+    if(std::memcmp(p, proxy_v2_sig, m) != 0)
+    {
+        ec = proxy_error::bad_signature;
+        return 0;
+    }
+    return parse_v2(p, n, h, ec);
+}
+
+net::mutable_buffer
+proxy_header_reader::
+prepare() noexcept
+{
+    BOOST_ASSERT(! done_);
+    if(skip_ > 0)
+        return {buf_, sizeof(buf_)};
+    BOOST_ASSERT(n_ < sizeof(buf_));
+    return {buf_ + n_, sizeof(buf_) - n_};
+}
+
+void
+proxy_header_reader::
+commit(std::size_t bytes_transferred, error_code& ec)
+{
+    if(skip_ > 0)
+    {
+        // Discarding TLVs; what follows them is kept
+        if(bytes_transferred <= skip_)
+        {
+            skip_ -= bytes_transferred;
+            done_ = skip_ == 0;
+            return;
+        }
+        pos_ = skip_;
+        n_ = bytes_transferred;
+        skip_ = 0;
+        done_ = true;
+        return;
+    }
+    n_ += bytes_transferred;
+    auto const size = parse_proxy_header(buf_, n_, header, ec);
+    if(ec || size == 0)
+        return;
+    if(size <= n_)
+    {
+        pos_ = size;
+        done_ = true;
+        return;
+    }
+    skip_ = size - n_;
+    n_ = 0;
+    pos_ = 0;
+}
+
+} // detail
+
+error_code
+make_error_code(proxy_error e) noexcept
+{
+    static detail::proxy_error_codes const cat{};
+    return error_code{static_cast<
+        std::underlying_type<proxy_error>::type>(e), cat};
+}
+
+} // beast
+} // boost
+
+#endif
@@ -0,0 +1,431 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_IMPL_RESOLVER_CACHE_HPP
+#define BOOST_BEAST_CORE_IMPL_RESOLVER_CACHE_HPP
+
+#include <boost/beast/core/async_base.hpp>
+#include <boost/beast/core/saved_handler.hpp>
+#include <boost/beast/core/detail/is_invocable.hpp>
+#include <boost/asio/coroutine.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/assert.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/weak_ptr.hpp>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace boost {
+namespace beast {
+
+template<class Resolver>
+struct basic_resolver_cache<Resolver>::impl_type
+{
+    struct entry
+    {
+        results_type results;
+        error_code ec;
+        clock_type::time_point expires;
+
+        // A lookup is in progress
+        bool pending = true;
+
+        // Operations waiting for the lookup
+        std::vector<saved_handler> waiters;
+    };
+
+    Resolver resolver;
+    options opt;
+    std::unordered_map<std::string, entry> entries;
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+
+    template<class... Args>
+    explicit
+    impl_type(Args&&... args)
+        : resolver(std::forward<Args>(args)...)
+    {
+    }
+
+    static
+    std::string
+    make_key(string_view host, string_view service)
+    {
+        std::string s;
+        s.reserve(host.size() + service.size() + 1);
+        s.append(host.data(), host.size());
+        s.push_back('\0');
+        s.append(service.data(), service.size());
+        return s;
+    }
+
+    // Return `true` if a result for the key is available.
+    // Waiters resuming after a lookup accept the result even
+    // if it already expired, it is as fresh as it can be.
+    bool
+    lookup(
+        std::string const& key,
+        error_code& ec,
+        results_type& results,
+        bool waited)
+    {
+        auto const it = entries.find(key);
+        if(it == entries.end())
+            return false;
+        auto& e = it->second;
+        if(e.pending)
+            return false;
+        if(! waited && clock_type::now() >= e.expires)
+        {
+            entries.erase(it);
+            return false;
+        }
+        ++hits;
+        ec = e.ec;
+        results = e.results;
+        return true;
+    }
+
+    bool
+    is_pending(std::string const& key) const
+    {
+        auto const it = entries.find(key);
+        return it != entries.end() && it->second.pending;
+    }
+
+    // Make room for one more entry, preferring to discard
+    // expired entries, then the one closest to expiring.
+    // Returns `false` if every entry is a pending lookup.
+    bool
+    evict()
+    {
+        if(entries.size() < opt.max_entries)
+            return true;
+        auto const now = clock_type::now();
+        auto oldest = entries.end();
+        for(auto it = entries.begin(); it != entries.end();)
+        {
+            if(it->second.pending)
+            {
+                ++it;
+                continue;
+            }
+            if(it->second.expires <= now)
+            {
+                it = entries.erase(it);
+                continue;
+            }
+            if( oldest == entries.end() ||
+                it->second.expires < oldest->second.expires)
+                oldest = it;
+            ++it;
+        }
+        if( entries.size() >= opt.max_entries &&
+            oldest != entries.end())
+            entries.erase(oldest);
+        return entries.size() < opt.max_entries;
+    }
+
+    // Store the outcome of a lookup and resume the waiters
+    void
+    finish(
+        std::string const& key,
+        error_code const& ec,
+        results_type const& results)
+    {
+        auto const it = entries.find(key);
+        BOOST_ASSERT(it != entries.end());
+        auto& e = it->second;
+        BOOST_ASSERT(e.pending);
+        auto waiters = std::move(e.waiters);
+        if(ec == net::error::operation_aborted)
+        {
+            // not an answer, the waiters start over
+            entries.erase(it);
+        }
+        else
+        {
+            e.pending = false;
+            e.ec = ec;
+            e.results = results;
+            e.expires = clock_type::now() +
+                (ec ? opt.negative_ttl : opt.ttl);
+        }
+        for(auto& w : waiters)
+            w.invoke();
+    }
+
+    void
+    shutdown()
+    {
+        std::vector<saved_handler> v;
+        for(auto& e : entries)
+            for(auto& w : e.second.waiters)
+                v.emplace_back(std::move(w));
+        entries.clear();
+        resolver.cancel();
+        for(auto& w : v)
+            w.invoke();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+template<class Resolver>
+template<class Handler>
+class basic_resolver_cache<Resolver>::resolve_op
+    : public beast::async_base<Handler, executor_type>
+    , public asio::coroutine
+{
+    boost::weak_ptr<impl_type> wp_;
+    std::string host_;
+    std::string service_;
+    std::string key_;
+    bool waited_ = false;
+
+public:
+    template<class Handler_>
+    resolve_op(
+        Handler_&& h,
+        boost::shared_ptr<impl_type> const& sp,
+        string_view host,
+        string_view service)
+        : async_base<Handler, executor_type>(
+            std::forward<Handler_>(h),
+                sp->resolver.get_executor())
+        , wp_(sp)
+        , host_(host)
+        , service_(service)
+        , key_(impl_type::make_key(host, service))
+    {
+        (*this)({}, {}, false);
+    }
+
+    void
+    operator()(
+        error_code ec = {},
+        results_type results = {},
+        bool cont = true)
+    {
+        auto sp = wp_.lock();
+        BOOST_ASIO_CORO_REENTER(*this)
+        {
+            for(;;)
+            {
+                if(! sp)
+                {
+                    ec = net::error::operation_aborted;
+                    break;
+                }
+                if(sp->lookup(key_, ec, results, waited_))
+                    break;
+                if(sp->is_pending(key_))
+                {
+                    // Wait for the lookup in progress
+                    BOOST_ASIO_CORO_YIELD
+                    {
+                        auto& w = sp->entries[key_].waiters;
+                        w.emplace_back();
+                        w.back().emplace(std::move(*this));
+                    }
+                    BOOST_ASIO_CORO_YIELD
+                    net::post(std::move(*this));
+                    waited_ = true;
+                    continue;
+                }
+
+                // Perform the lookup
+                ++sp->misses;
+                if(! sp->evict())
+                {
+                    // No room, the result is not kept
+                    BOOST_ASIO_CORO_YIELD
+                    sp->resolver.async_resolve(
+                        host_, service_, std::move(*this));
+                    if(! sp)
+                        ec = net::error::operation_aborted;
+                    break;
+                }
+                sp->entries.emplace(key_,
+                    typename impl_type::entry{});
+                BOOST_ASIO_CORO_YIELD
+                sp->resolver.async_resolve(
+                    host_, service_, std::move(*this));
+                if(sp)
+                    sp->finish(key_, ec, results);
+                else
+                    ec = net::error::operation_aborted;
+                break;
+            }
+            this->complete(cont, ec, std::move(results));
+        }
+    }
+};
+
+template<class Resolver>
+struct basic_resolver_cache<Resolver>::run_resolve_op
+{
+    template<class ResolveHandler>
+    void
+    operator()(
+        ResolveHandler&& h,
+        boost::shared_ptr<impl_type> const& sp,
+        string_view host,
+        string_view service)
+    {
+        // If you get an error on the following line it means
+        // that your handler does not meet the documented type
+        // requirements for the handler.
+
+        static_assert(
+            beast::detail::is_invocable<ResolveHandler,
+                void(error_code, results_type)>::value,
+            "ResolveHandler type requirements not met");
+
+        resolve_op<
+            typename std::decay<ResolveHandler>::type>(
+                std::forward<ResolveHandler>(h),
+                    sp, host, service);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+template<class Resolver>
+basic_resolver_cache<Resolver>::
+~basic_resolver_cache()
+{
+    impl_->shutdown();
+}
+
+template<class Resolver>
+template<class... Args>
+basic_resolver_cache<Resolver>::
+basic_resolver_cache(Args&&... args)
+    : impl_(boost::make_shared<impl_type>(
+        std::forward<Args>(args)...))
+{
+}
+
+
+template<class Resolver>
+auto
+basic_resolver_cache<Resolver>::
+get_executor() noexcept ->
+    executor_type
+{
+    return impl_->resolver.get_executor();
+}
+
+template<class Resolver>
+auto
+basic_resolver_cache<Resolver>::
+resolver() noexcept ->
+    resolver_type&
+{
+    return impl_->resolver;
+}
+
+template<class Resolver>
+void
+basic_resolver_cache<Resolver>::
+set_options(options const& opt)
+{
+    impl_->opt = opt;
+}
+
+template<class Resolver>
+auto
+basic_resolver_cache<Resolver>::
+get_options() const noexcept ->
+    options const&
+{
+    return impl_->opt;
+}
+
+template<class Resolver>
+std::size_t
+basic_resolver_cache<Resolver>::
+size() const noexcept
+{
+    return impl_->entries.size();
+}
+
+template<class Resolver>
+std::size_t
+basic_resolver_cache<Resolver>::
+hits() const noexcept
+{
+    return impl_->hits;
+}
+
+template<class Resolver>
+std::size_t
+basic_resolver_cache<Resolver>::
+misses() const noexcept
+{
+    return impl_->misses;
+}
+
+template<class Resolver>
+void
+basic_resolver_cache<Resolver>::
+erase(string_view host, string_view service)
+{
+    auto const it = impl_->entries.find(
+        impl_type::make_key(host, service));
+    if( it != impl_->entries.end() &&
+        ! it->second.pending)
+        impl_->entries.erase(it);
+}
+
+template<class Resolver>
+void
+basic_resolver_cache<Resolver>::
+clear()
+{
+    auto& m = impl_->entries;
+    for(auto it = m.begin(); it != m.end();)
+    {
+        if(it->second.pending)
+            ++it;
+        else
+            it = m.erase(it);
+    }
+}
+
+template<class Resolver>
+template<
+    BOOST_ASIO_COMPLETION_TOKEN_FOR(void(error_code,
+        typename basic_resolver_cache<Resolver>::results_type))
+            ResolveHandler>
+BOOST_ASIO_INITFN_AUTO_RESULT_TYPE(
+    ResolveHandler, void(error_code,
+        typename basic_resolver_cache<Resolver>::results_type))
+basic_resolver_cache<Resolver>::
+async_resolve(
+    string_view host,
+    string_view service,
+    ResolveHandler&& handler)
+{
+    return net::async_initiate<
+        ResolveHandler,
+        void(error_code, results_type)>(
+            run_resolve_op{},
+            handler,
+            impl_,
+            host,
+            service);
+}
+
+} // beast
+} // boost
+
+#endif
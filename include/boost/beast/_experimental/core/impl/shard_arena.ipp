@@ -0,0 +1,104 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_IMPL_SHARD_ARENA_IPP
+#define BOOST_BEAST_CORE_IMPL_SHARD_ARENA_IPP
+
+#include <boost/beast/_experimental/core/shard_arena.hpp>
+#include <new>
+
+namespace boost {
+namespace beast {
+
+std::size_t
+shard_arena::
+size_class(std::size_t n) noexcept
+{
+    std::size_t c = 0;
+    std::size_t size = min_size;
+    while(size < n)
+    {
+        size <<= 1;
+        ++c;
+    }
+    return c;
+}
+
+shard_arena::
+~shard_arena()
+{
+    for(std::size_t c = 0; c < classes; ++c)
+    {
+        while(free_[c])
+        {
+            auto const p = free_[c];
+            free_[c] = p->next;
+            ::operator delete(p);
+        }
+    }
+}
+
+shard_arena::
+shard_arena(std::size_t max_cached)
+    : max_cached_(max_cached)
+{
+}
+
+void*
+shard_arena::
+allocate(std::size_t n)
+{
+    if(n > max_size)
+    {
+        ++misses_;
+        return ::operator new(n);
+    }
+    auto const c = size_class(n);
+    if(auto const p = free_[c])
+    {
+        ++hits_;
+        free_[c] = p->next;
+        --count_[c];
+        return p;
+    }
+    ++misses_;
+    return ::operator new(min_size << c);
+}
+
+void
+shard_arena::
+deallocate(void* p, std::size_t n) noexcept
+{
+    if(! p)
+        return;
+    if(n > max_size)
+        return ::operator delete(p);
+    auto const c = size_class(n);
+    if(count_[c] >= max_cached_)
+        return ::operator delete(p);
+    auto const b = ::new(p) node;
+    b->next = free_[c];
+    free_[c] = b;
+    ++count_[c];
+}
+
+std::size_t
+shard_arena::
+cached_bytes() const noexcept
+{
+    std::size_t n = 0;
+    for(std::size_t c = 0; c < classes; ++c)
+        n += count_[c] * (min_size << c);
+    return n;
+}
+
+} // beast
+} // boost
+
+#endif
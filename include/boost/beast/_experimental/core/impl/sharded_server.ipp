@@ -0,0 +1,261 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_IMPL_SHARDED_SERVER_IPP
+#define BOOST_BEAST_CORE_IMPL_SHARDED_SERVER_IPP
+
+#include <boost/beast/_experimental/core/sharded_server.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/throw_exception.hpp>
+#include <thread>
+#include <utility>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if ! defined(_WIN32)
+#include <sys/socket.h>
+#endif
+
+namespace boost {
+namespace beast {
+
+struct sharded_server::accept_op
+{
+    sharded_server* self;
+    shard* from;
+    shard* to;
+
+    void
+    operator()(
+        error_code ec,
+        net::basic_stream_socket<net::ip::tcp,
+            net::io_context::executor_type> sock)
+    {
+        if(ec == net::error::operation_aborted)
+            return;
+        if(ec)
+        {
+            // Errors such as running out of descriptors
+            // are transient, keep accepting after a pause.
+            self->retry_accept(*from);
+            return;
+        }
+        net::ip::tcp::socket s(std::move(sock));
+        if(to == from)
+        {
+            ++to->accepted_;
+            self->handler_(*to, std::move(s));
+        }
+        else
+        {
+            // Hand the connection to its shard
+            net::post(to->ioc_, deliver{self, to, std::move(s)});
+        }
+        self->do_accept(*from);
+    }
+
+    struct deliver
+    {
+        sharded_server* self;
+        shard* to;
+        net::ip::tcp::socket sock;
+
+        void
+        operator()()
+        {
+            ++to->accepted_;
+            self->handler_(*to, std::move(sock));
+        }
+    };
+};
+
+sharded_server::
+shard::
+shard(std::size_t index, std::size_t max_cached)
+    : arena_(max_cached)
+    , ioc_(1)
+    , acceptor_(ioc_)
+    , retry_timer_(ioc_)
+    , index_(index)
+{
+}
+
+sharded_server::
+~sharded_server()
+{
+    stop();
+    for(auto& s : shards_)
+        s->work_.reset();
+}
+
+sharded_server::
+sharded_server(
+    net::ip::tcp::endpoint const& ep,
+    accept_handler handler,
+    options const& opt)
+    : handler_(std::move(handler))
+    , opt_(opt)
+{
+    auto n = opt_.shards;
+    if(n == 0)
+        n = std::thread::hardware_concurrency();
+    if(n == 0)
+        n = 1;
+    shards_.reserve(n);
+    for(std::size_t i = 0; i < n; ++i)
+        shards_.emplace_back(new shard(i, opt_.arena_max_cached));
+
+    auto const listen =
+        [&](shard& s, net::ip::tcp::endpoint const& at, bool reuse)
+        {
+            auto& a = s.acceptor_;
+            a.open(at.protocol());
+            a.set_option(net::socket_base::reuse_address(true));
+            if(reuse)
+            {
+            #if defined(SO_REUSEPORT)
+                int one = 1;
+                if(::setsockopt(a.native_handle(), SOL_SOCKET,
+                    SO_REUSEPORT, &one, sizeof(one)) != 0)
+                {
+                    error_code ec;
+                    a.close(ec);
+                    return false;
+                }
+            #else
+                error_code ec;
+                a.close(ec);
+                return false;
+            #endif
+            }
+            a.bind(at);
+            a.listen(opt_.backlog);
+            return true;
+        };
+
+    reuse_port_ = opt_.reuse_port && n > 1;
+    if(reuse_port_ && ! listen(*shards_[0], ep, true))
+        reuse_port_ = false;
+    if(! reuse_port_)
+    {
+        listen(*shards_[0], ep, false);
+        return;
+    }
+
+    // Every shard binds the port chosen by the first
+    auto const at = shards_[0]->acceptor_.local_endpoint();
+    for(std::size_t i = 1; i < n; ++i)
+        listen(*shards_[i], at, true);
+}
+
+sharded_server::
+sharded_server(
+    net::ip::tcp::endpoint const& ep,
+    accept_handler handler)
+    : sharded_server(ep, std::move(handler), options{})
+{
+}
+
+net::ip::tcp::endpoint
+sharded_server::
+local_endpoint() const
+{
+    return shards_[0]->acceptor_.local_endpoint();
+}
+
+void
+sharded_server::
+run()
+{
+    for(auto& s : shards_)
+    {
+        s->ioc_.restart();
+        s->work_.emplace(s->ioc_.get_executor());
+        if(s->acceptor_.is_open())
+            net::post(s->ioc_,
+                [this, &s]
+                {
+                    do_accept(*s);
+                });
+    }
+
+    auto const run_shard =
+        [this](std::size_t i)
+        {
+            if(opt_.pin_threads)
+                pin_thread(i);
+            shards_[i]->ioc_.run();
+        };
+
+    std::vector<std::thread> v;
+    v.reserve(shards_.size() - 1);
+    for(std::size_t i = 1; i < shards_.size(); ++i)
+        v.emplace_back(run_shard, i);
+    run_shard(0);
+    for(auto& t : v)
+        t.join();
+}
+
+void
+sharded_server::
+stop()
+{
+    for(auto& s : shards_)
+        s->ioc_.stop();
+}
+
+void
+sharded_server::
+do_accept(shard& s)
+{
+    auto& to = reuse_port_ ? s :
+        *shards_[next_++ % shards_.size()];
+    s.acceptor_.async_accept(to.ioc_,
+        accept_op{this, &s, &to});
+}
+
+void
+sharded_server::
+retry_accept(shard& s)
+{
+    s.retry_timer_.expires_after(opt_.accept_retry_delay);
+    s.retry_timer_.async_wait(
+        [this, &s](error_code ec)
+        {
+            if(ec == net::error::operation_aborted)
+                return;
+            do_accept(s);
+        });
+}
+
+void
+sharded_server::
+pin_thread(std::size_t i)
+{
+#if defined(__linux__)
+    auto const n = std::thread::hardware_concurrency();
+    if(n == 0)
+        return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(static_cast<int>(i % n), &set);
+    ::pthread_setaffinity_np(
+        ::pthread_self(), sizeof(set), &set);
+#else
+    (void)i;
+#endif
+}
+
+} // beast
+} // boost
+
+#endif
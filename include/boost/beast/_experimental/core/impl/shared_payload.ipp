@@ -0,0 +1,149 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_IMPL_SHARED_PAYLOAD_IPP
+#define BOOST_BEAST_CORE_IMPL_SHARED_PAYLOAD_IPP
+
+#include <boost/beast/_experimental/core/shared_payload.hpp>
+#include <mutex>
+#include <new>
+
+namespace boost {
+namespace beast {
+
+namespace detail {
+
+// Free lists of payload blocks, by capacity
+class payload_pool
+{
+    struct node
+    {
+        node* next;
+    };
+
+    struct list
+    {
+        std::mutex m;
+        node* head = nullptr;
+        std::size_t count = 0;
+    };
+
+public:
+    static std::size_t constexpr min_size = 32;
+    static std::size_t constexpr classes = 12; // 32 to 65536 bytes
+
+private:
+    static std::size_t constexpr max_cached = 256;
+
+    list lists_[classes];
+
+public:
+    // Never destroyed, since payloads may outlive static objects
+    static
+    payload_pool&
+    get()
+    {
+        static payload_pool* const p = new payload_pool;
+        return *p;
+    }
+
+    static
+    std::size_t
+    size_class(std::size_t n) noexcept
+    {
+        std::size_t c = 0;
+        std::size_t size = min_size;
+        while(size < n)
+        {
+            size <<= 1;
+            ++c;
+        }
+        return c;
+    }
+
+    void*
+    allocate(std::size_t c, std::size_t bytes)
+    {
+        auto& l = lists_[c];
+        {
+            std::lock_guard<std::mutex> lock(l.m);
+            if(auto const p = l.head)
+            {
+                l.head = p->next;
+                --l.count;
+                return p;
+            }
+        }
+        return ::operator new(bytes);
+    }
+
+    void
+    deallocate(std::size_t c, void* p) noexcept
+    {
+        auto& l = lists_[c];
+        {
+            std::lock_guard<std::mutex> lock(l.m);
+            if(l.count < max_cached)
+            {
+                auto const n = ::new(p) node;
+                n->next = l.head;
+                l.head = n;
+                ++l.count;
+                return;
+            }
+        }
+        ::operator delete(p);
+    }
+};
+
+} // detail
+
+auto
+shared_payload::
+allocate(std::size_t size) ->
+    header*
+{
+    using pool = detail::payload_pool;
+    void* p;
+    std::size_t capacity;
+    if(size <= max_pooled)
+    {
+        auto const c = pool::size_class(size);
+        capacity = pool::min_size << c;
+        p = pool::get().allocate(c, sizeof(header) + capacity);
+    }
+    else
+    {
+        capacity = size;
+        p = ::operator new(sizeof(header) + capacity);
+    }
+    auto const h = ::new(p) header;
+    h->refs.store(1, std::memory_order_relaxed);
+    h->buffer = net::const_buffer(data_of(h), size);
+    h->capacity = capacity;
+    return h;
+}
+
+void
+shared_payload::
+release(header* h) noexcept
+{
+    using pool = detail::payload_pool;
+    auto const capacity = h->capacity;
+    h->~header();
+    if(capacity <= max_pooled)
+        pool::get().deallocate(pool::size_class(capacity), h);
+    else
+        ::operator delete(h);
+}
+
+} // beast
+} // boost
+
+#endif
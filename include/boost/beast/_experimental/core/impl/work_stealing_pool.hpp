@@ -0,0 +1,76 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_IMPL_WORK_STEALING_POOL_HPP
+#define BOOST_BEAST_CORE_IMPL_WORK_STEALING_POOL_HPP
+
+namespace boost {
+namespace beast {
+
+template<class Executor>
+basic_session_executor<Executor>::
+basic_session_executor(
+    Executor const& ex,
+    boost::shared_ptr<detail::session_lane> lane) noexcept
+    : ex_(ex)
+    , lane_(std::move(lane))
+{
+}
+
+template<class Executor>
+template<class Function, class Allocator>
+void
+basic_session_executor<Executor>::
+enqueue(Function&& f, Allocator const& alloc) const
+{
+    lane_->pool.enqueue(lane_, detail::make_lane_op(
+        std::forward<Function>(f), alloc));
+}
+
+template<class Executor>
+template<class Function>
+void
+basic_session_executor<Executor>::
+execute(Function&& f) const
+{
+    if( net::query(ex_, net::execution::blocking) !=
+            net::execution::blocking.never &&
+        lane_->running_in_this_thread())
+    {
+        typename std::decay<Function>::type tmp(
+            std::forward<Function>(f));
+        tmp();
+        return;
+    }
+    enqueue(std::forward<Function>(f),
+        detail::lane_allocator(ex_, 0));
+}
+
+#if ! defined(BOOST_ASIO_NO_TS_EXECUTORS)
+template<class Executor>
+template<class Function, class Allocator>
+void
+basic_session_executor<Executor>::
+dispatch(Function&& f, Allocator const& a) const
+{
+    if(lane_->running_in_this_thread())
+    {
+        typename std::decay<Function>::type tmp(
+            std::forward<Function>(f));
+        tmp();
+        return;
+    }
+    enqueue(std::forward<Function>(f), a);
+}
+#endif
+
+} // beast
+} // boost
+
+#endif
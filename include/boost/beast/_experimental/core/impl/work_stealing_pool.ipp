@@ -0,0 +1,355 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_IMPL_WORK_STEALING_POOL_IPP
+#define BOOST_BEAST_CORE_IMPL_WORK_STEALING_POOL_IPP
+
+#include <boost/beast/_experimental/core/work_stealing_pool.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/make_shared.hpp>
+#include <deque>
+#include <thread>
+
+namespace boost {
+namespace beast {
+
+namespace detail {
+
+session_lane::
+session_lane(work_stealing_pool& pool_, std::size_t home_)
+    : pool(pool_)
+    , home(home_)
+{
+    std::lock_guard<std::mutex> lock(pool.lanes_m_);
+    next = pool.lanes_;
+    if(next)
+        next->prev = this;
+    pool.lanes_ = this;
+}
+
+session_lane::
+~session_lane()
+{
+    {
+        std::lock_guard<std::mutex> lock(pool.lanes_m_);
+        if(prev)
+            prev->next = next;
+        else
+            pool.lanes_ = next;
+        if(next)
+            next->prev = prev;
+    }
+    clear();
+}
+
+void
+session_lane::
+clear()
+{
+    lane_op* op;
+    {
+        std::lock_guard<std::mutex> lock(m);
+        op = head;
+        head = nullptr;
+        tail = nullptr;
+    }
+    // Destroying a function may destroy other lanes
+    while(op)
+    {
+        auto const next_op = op->next;
+        op->destroy();
+        op = next_op;
+    }
+}
+
+session_lane*&
+session_lane::
+current() noexcept
+{
+    static thread_local session_lane* p = nullptr;
+    return p;
+}
+
+lane_op*
+session_lane::
+pop()
+{
+    std::lock_guard<std::mutex> lock(m);
+    auto const op = head;
+    if(! op)
+    {
+        scheduled = false;
+        return nullptr;
+    }
+    head = op->next;
+    if(! head)
+        tail = nullptr;
+    return op;
+}
+
+} // detail
+
+//------------------------------------------------------------------------------
+
+struct work_stealing_pool::worker
+{
+    std::mutex m;
+    std::deque<boost::shared_ptr<detail::session_lane>> ready;
+    std::atomic<bool> idle;
+    std::thread thread;
+
+    worker()
+        : idle(false)
+    {
+    }
+};
+
+work_stealing_pool::
+~work_stealing_pool()
+{
+    stop();
+    join();
+
+    // Break the cycles between sessions, which own I/O objects,
+    // and the lanes holding their queued completion handlers.
+    std::vector<boost::shared_ptr<detail::session_lane>> v;
+    {
+        std::lock_guard<std::mutex> lock(lanes_m_);
+        for(auto p = lanes_; p; p = p->next)
+            if(auto sp = p->weak_from_this().lock())
+                v.emplace_back(std::move(sp));
+    }
+    for(auto& sp : v)
+        sp->clear();
+    v.clear();
+    for(auto& w : workers_)
+        w->ready.clear();
+}
+
+work_stealing_pool::
+work_stealing_pool(
+    std::size_t threads,
+    std::size_t budget)
+    : next_(0)
+    , steals_(0)
+    , stopped_(false)
+    , notified_(false)
+    , budget_(budget ? budget : 1)
+    , work_(ioc_.get_executor())
+{
+    if(threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if(threads == 0)
+        threads = 1;
+    workers_.reserve(threads);
+    for(std::size_t i = 0; i < threads; ++i)
+        workers_.emplace_back(new worker);
+    for(std::size_t i = 0; i < threads; ++i)
+        workers_[i]->thread = std::thread(
+            [this, i]
+            {
+                run(i);
+            });
+}
+
+auto
+work_stealing_pool::
+make_executor() ->
+    executor_type
+{
+    auto const i = next_++ % workers_.size();
+    return executor_type(
+        ioc_.get_executor(),
+        boost::make_shared<detail::session_lane>(*this, i));
+}
+
+void
+work_stealing_pool::
+stop()
+{
+    stopped_ = true;
+    ioc_.stop();
+}
+
+void
+work_stealing_pool::
+join()
+{
+    for(auto& w : workers_)
+        if(w->thread.joinable())
+            w->thread.join();
+}
+
+void
+work_stealing_pool::
+enqueue(
+    boost::shared_ptr<detail::session_lane> const& lane,
+    detail::lane_op* op)
+{
+    bool first;
+    {
+        std::lock_guard<std::mutex> lock(lane->m);
+        if(lane->tail)
+            lane->tail->next = op;
+        else
+            lane->head = op;
+        lane->tail = op;
+        first = ! lane->scheduled;
+        lane->scheduled = true;
+    }
+    if(first)
+        schedule(lane);
+}
+
+void
+work_stealing_pool::
+schedule(boost::shared_ptr<detail::session_lane> lane)
+{
+    auto const i = lane->home.load(std::memory_order_relaxed);
+    auto& w = *workers_[i];
+    {
+        std::lock_guard<std::mutex> lock(w.m);
+        w.ready.push_back(std::move(lane));
+    }
+
+    // Wake a sleeping worker, if the home worker
+    // is busy another one may take the session.
+    for(auto const& v : workers_)
+        if(v->idle)
+            return wake();
+}
+
+void
+work_stealing_pool::
+wake()
+{
+    // The reactor is shared, so this wakes any one
+    // sleeping worker, which then runs or takes the session.
+    if(! notified_.exchange(true))
+        net::post(ioc_,
+            [this]
+            {
+                notified_ = false;
+            });
+}
+
+auto
+work_stealing_pool::
+pop(std::size_t i) ->
+    boost::shared_ptr<detail::session_lane>
+{
+    auto& w = *workers_[i];
+    std::lock_guard<std::mutex> lock(w.m);
+    if(w.ready.empty())
+        return nullptr;
+    auto lane = std::move(w.ready.front());
+    w.ready.pop_front();
+    return lane;
+}
+
+auto
+work_stealing_pool::
+steal(std::size_t i) ->
+    boost::shared_ptr<detail::session_lane>
+{
+    for(std::size_t j = 1; j < workers_.size(); ++j)
+    {
+        auto& w = *workers_[(i + j) % workers_.size()];
+
+        // Take the session queued last, which would
+        // otherwise wait longest. The victim may be asleep,
+        // if the wakeup reached this worker instead.
+        std::unique_lock<std::mutex> lock(w.m, std::try_to_lock);
+        if(! lock.owns_lock() || w.ready.empty())
+            continue;
+        auto lane = std::move(w.ready.back());
+        w.ready.pop_back();
+        ++steals_;
+        return lane;
+    }
+    return nullptr;
+}
+
+void
+work_stealing_pool::
+run_lane(
+    std::size_t i,
+    boost::shared_ptr<detail::session_lane> lane)
+{
+    // The session now belongs to this worker
+    lane->home.store(i, std::memory_order_relaxed);
+
+    auto& current = detail::session_lane::current();
+    current = lane.get();
+    std::size_t n = 0;
+    for(; n < budget_; ++n)
+    {
+        auto const op = lane->pop();
+        if(! op)
+            break;
+        op->invoke();
+    }
+    current = nullptr;
+    if(n < budget_)
+        return;
+
+    // Budget exhausted, queue the session behind the others
+    {
+        std::lock_guard<std::mutex> lock(lane->m);
+        if(! lane->head)
+        {
+            lane->scheduled = false;
+            return;
+        }
+    }
+    auto& w = *workers_[i];
+    std::lock_guard<std::mutex> lock(w.m);
+    w.ready.push_back(std::move(lane));
+}
+
+void
+work_stealing_pool::
+run(std::size_t i)
+{
+    auto& w = *workers_[i];
+    while(! stopped_)
+    {
+        // Deliver I/O completions, which queue sessions
+        ioc_.poll();
+
+        auto lane = pop(i);
+        if(! lane)
+            lane = steal(i);
+        if(lane)
+        {
+            run_lane(i, std::move(lane));
+            continue;
+        }
+
+        w.idle = true;
+        lane = pop(i);
+        if(! lane)
+            lane = steal(i);
+        if(lane)
+        {
+            w.idle = false;
+            run_lane(i, std::move(lane));
+            continue;
+        }
+
+        // Sleep until I/O completes or a session is queued
+        ioc_.run_one();
+        w.idle = false;
+    }
+}
+
+} // beast
+} // boost
+
+#endif
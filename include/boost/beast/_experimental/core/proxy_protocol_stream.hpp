@@ -0,0 +1,461 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_PROXY_PROTOCOL_STREAM_HPP
+#define BOOST_BEAST_CORE_PROXY_PROTOCOL_STREAM_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/role.hpp>
+#include <boost/beast/core/stream_traits.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <cstddef>
+#include <type_traits>
+
+namespace boost {
+namespace beast {
+
+/// Error codes returned by @ref proxy_protocol_stream
+enum class proxy_error
+{
+    /// The connection does not begin with a PROXY protocol signature
+    bad_signature = 1,
+
+    /// The PROXY protocol header is malformed
+    bad_header
+};
+
+/** The header received by a @ref proxy_protocol_stream
+
+    The PROXY protocol is prepended to a connection by a load
+    balancer or other proxy, to convey the addresses of the
+    connection it accepted from the client.
+*/
+struct proxy_header
+{
+    /// The version of the header, 1 (text) or 2 (binary)
+    int version = 0;
+
+    /** `true` if the addresses below are those of a proxied connection.
+
+        This is `false` for a version 1 `UNKNOWN` header, for the
+        version 2 `LOCAL` command, which a proxy sends for its own
+        connections such as health checks, and for address families
+        other than TCP over IPv4 or IPv6. The addresses are then left
+        unset, and those of the next layer are the ones to use.
+    */
+    bool proxied = false;
+
+    /// The address of the client which connected to the proxy
+    net::ip::tcp::endpoint source;
+
+    /// The address on which the proxy accepted the connection
+    net::ip::tcp::endpoint destination;
+};
+
+namespace detail {
+
+// Receives the header into a small inline buffer. Bytes
+// read past the header are kept and returned by the next
+// reads of the stream; version 2 TLVs are skipped.
+class proxy_header_reader
+{
+public:
+    proxy_header header;
+
+    BOOST_BEAST_DECL
+    net::mutable_buffer
+    prepare() noexcept;
+
+    BOOST_BEAST_DECL
+    void
+    commit(std::size_t bytes_transferred, error_code& ec);
+
+    // Copies bytes received after the header
+    template<class MutableBufferSequence>
+    std::size_t
+    read(MutableBufferSequence const& buffers)
+    {
+        auto const n = net::buffer_copy(buffers,
+            net::const_buffer(buf_ + pos_, n_ - pos_));
+        pos_ += n;
+        return n;
+    }
+
+    bool
+    done() const noexcept
+    {
+        return done_;
+    }
+
+    // True once the header and the bytes after it are consumed
+    bool
+    pass() const noexcept
+    {
+        return done_ && pos_ == n_;
+    }
+
+private:
+    std::size_t skip_ = 0;
+    std::size_t n_ = 0;
+    std::size_t pos_ = 0;
+    bool done_ = false;
+
+    // Large enough for any version 1 header, and
+    // for a version 2 header with its addresses.
+    char buf_[256];
+};
+
+} // detail
+
+/** A stream which receives a PROXY protocol header
+
+    This wrapper reads the PROXY protocol header, version 1 (text)
+    or version 2 (binary), which a load balancer prepends to a
+    connection, and makes the original addresses of the client
+    available through @ref header. The bytes which follow the header
+    are returned by the read functions.
+
+    The header is received by @ref handshake or @ref async_handshake,
+    or by the first read if neither is called. The header is read
+    into a small buffer inside the object, in as few reads as the
+    next layer allows; version 2 TLVs are not kept. Once the header
+    and any bytes received with it are consumed, reads and writes
+    are passed directly to the next layer.
+
+    The stream must only be used on connections which are known to
+    begin with the header, such as those accepted from a listener
+    which only the proxy can reach. Otherwise a client could send
+    a header of its own.
+
+    @par Thread Safety
+    @e Distinct @e objects: Safe.@n
+    @e Shared @e objects: Unsafe.
+    The application must also ensure that all asynchronous
+    operations are performed within the same implicit or explicit strand.
+
+    @par Example
+    @code
+    proxy_protocol_stream<tcp_stream> stream(std::move(socket));
+    stream.async_handshake(
+        [&](error_code ec)
+        {
+            if(! ec && stream.header().proxied)
+                std::cout << stream.header().source << "\n";
+        });
+    @endcode
+
+    @tparam NextLayer The type representing the next layer, to which
+    data will be read and written during operations. For synchronous
+    operations, the type must support the <em>SyncStream</em> concept.
+    For asynchronous operations, the type must support the
+    <em>AsyncStream</em> concept.
+
+    @note A stream object must not be moved or destroyed while there
+    are pending asynchronous operations associated with it.
+
+    @par Concepts
+    <em>AsyncStream</em>, <em>SyncStream</em>
+
+    @see https://www.haproxy.org/download/2.8/doc/proxy-protocol.txt
+*/
+template<class NextLayer>
+class proxy_protocol_stream
+{
+    NextLayer stream_;
+    detail::proxy_header_reader rd_;
+
+    struct ops;
+
+public:
+    /// The type of the next layer.
+    using next_layer_type =
+        typename std::remove_reference<NextLayer>::type;
+
+    /// The type of the executor associated with the object.
+    using executor_type = typename next_layer_type::executor_type;
+
+    proxy_protocol_stream(proxy_protocol_stream&&) = default;
+    proxy_protocol_stream& operator=(proxy_protocol_stream&&) = default;
+
+    /** Destructor
+
+        The treatment of pending operations will be the same as that
+        of the next layer.
+    */
+    ~proxy_protocol_stream() = default;
+
+    /** Constructor
+
+        Arguments, if any, are forwarded to the next layer's constructor.
+    */
+    template<class... Args>
+    explicit
+    proxy_protocol_stream(Args&&... args);
+
+    //--------------------------------------------------------------------------
+
+    /// Get the executor associated with the object.
+    executor_type
+    get_executor() noexcept
+    {
+        return stream_.get_executor();
+    }
+
+    /// Get a reference to the next layer
+    next_layer_type&
+    next_layer() noexcept
+    {
+        return stream_;
+    }
+
+    /// Get a reference to the next layer
+    next_layer_type const&
+    next_layer() const noexcept
+    {
+        return stream_;
+    }
+
+    /** Return the header.
+
+        The header is only valid once @ref is_header_done
+        returns `true`.
+    */
+    proxy_header const&
+    header() const noexcept
+    {
+        return rd_.header;
+    }
+
+    /// Returns `true` if the header has been received
+    bool
+    is_header_done() const noexcept
+    {
+        return rd_.done();
+    }
+
+    //--------------------------------------------------------------------------
+
+    /** Receive the header.
+
+        This function reads from the next layer until the header
+        is received. It returns immediately if the header has
+        already been received.
+
+        @param ec Set to the error, if any occurred. This is
+        @ref proxy_error::bad_signature if the connection does
+        not begin with a PROXY protocol header.
+    */
+    void
+    handshake(error_code& ec);
+
+    /** Receive the header.
+
+        This function reads from the next layer until the header
+        is received. It returns immediately if the header has
+        already been received.
+
+        @throws system_error Thrown on failure.
+    */
+    void
+    handshake();
+
+    /** Receive the header asynchronously.
+
+        This function reads from the next layer until the header
+        is received. It completes immediately if the header has
+        already been received.
+
+        @param handler The completion handler to invoke when the operation
+        completes. The implementation takes ownership of the handler by
+        performing a decay-copy. The equivalent function signature of
+        the handler must be:
+        @code
+        void handler(
+            error_code const& ec    // Result of operation
+        );
+        @endcode
+        Regardless of whether the asynchronous operation completes
+        immediately or not, the handler will not be invoked from within
+        this function. Invocation of the handler will be performed in a
+        manner equivalent to using `net::post`.
+    */
+    template<
+        BOOST_BEAST_ASYNC_TPARAM1 HandshakeHandler =
+            net::default_completion_token_t<executor_type>
+    >
+    BOOST_BEAST_ASYNC_RESULT1(HandshakeHandler)
+    async_handshake(
+        HandshakeHandler&& handler =
+            net::default_completion_token_t<executor_type>{});
+
+    //--------------------------------------------------------------------------
+
+    /** Read some data from the stream.
+
+        If the header has not been received, it is received first.
+
+        @param buffers The buffers into which the data will be read.
+
+        @returns The number of bytes read.
+
+        @throws system_error Thrown on failure.
+    */
+    template<class MutableBufferSequence>
+    std::size_t
+    read_some(MutableBufferSequence const& buffers);
+
+    /** Read some data from the stream.
+
+        If the header has not been received, it is received first.
+
+        @param buffers The buffers into which the data will be read.
+
+        @param ec Set to indicate what error occurred, if any.
+
+        @returns The number of bytes read.
+    */
+    template<class MutableBufferSequence>
+    std::size_t
+    read_some(
+        MutableBufferSequence const& buffers,
+        error_code& ec);
+
+    /** Start an asynchronous read.
+
+        If the header has not been received, it is received first.
+
+        @param buffers The buffers into which the data will be read. Although the
+        buffers object may be copied as necessary, ownership of the underlying
+        buffers is retained by the caller, which must guarantee that they remain
+        valid until the handler is called.
+
+        @param handler The completion handler to invoke when the operation
+        completes. The implementation takes ownership of the handler by
+        performing a decay-copy. The equivalent function signature of
+        the handler must be:
+        @code
+        void handler(
+          const boost::system::error_code& error, // Result of operation.
+          std::size_t bytes_transferred           // Number of bytes read.
+        );
+        @endcode
+        Regardless of whether the asynchronous operation completes
+        immediately or not, the handler will not be invoked from within
+        this function. Invocation of the handler will be performed in a
+        manner equivalent to using `net::post`.
+    */
+    template<
+        class MutableBufferSequence,
+        BOOST_BEAST_ASYNC_TPARAM2 ReadHandler =
+            net::default_completion_token_t<executor_type>
+    >
+    BOOST_BEAST_ASYNC_RESULT2(ReadHandler)
+    async_read_some(
+        MutableBufferSequence const& buffers,
+        ReadHandler&& handler =
+            net::default_completion_token_t<executor_type>{});
+
+    /** Write some data to the stream.
+
+        @param buffers The data to be written.
+
+        @returns The number of bytes written.
+
+        @throws system_error Thrown on failure.
+    */
+    template<class ConstBufferSequence>
+    std::size_t
+    write_some(ConstBufferSequence const& buffers)
+    {
+        return stream_.write_some(buffers);
+    }
+
+    /** Write some data to the stream.
+
+        @param buffers The data to be written.
+
+        @param ec Set to indicate what error occurred, if any.
+
+        @returns The number of bytes written.
+    */
+    template<class ConstBufferSequence>
+    std::size_t
+    write_some(
+        ConstBufferSequence const& buffers,
+        error_code& ec)
+    {
+        return stream_.write_some(buffers, ec);
+    }
+
+    /** Start an asynchronous write.
+
+        @param buffers The data to be written to the stream. Although the buffers
+        object may be copied as necessary, ownership of the underlying buffers is
+        retained by the caller, which must guarantee that they remain valid until
+        the handler is called.
+
+        @param handler The completion handler to invoke when the operation
+        completes. The implementation takes ownership of the handler by
+        performing a decay-copy. The equivalent function signature of
+        the handler must be:
+        @code
+        void handler(
+          error_code const& error,          // Result of operation.
+          std::size_t bytes_transferred     // Number of bytes written.
+        );
+        @endcode
+        Regardless of whether the asynchronous operation completes
+        immediately or not, the handler will not be invoked from within
+        this function. Invocation of the handler will be performed in a
+        manner equivalent to using `net::post`.
+    */
+    template<
+        class ConstBufferSequence,
+        BOOST_BEAST_ASYNC_TPARAM2 WriteHandler =
+            net::default_completion_token_t<executor_type>
+    >
+    BOOST_BEAST_ASYNC_RESULT2(WriteHandler)
+    async_write_some(
+        ConstBufferSequence const& buffers,
+        WriteHandler&& handler =
+            net::default_completion_token_t<executor_type>{})
+    {
+        return stream_.async_write_some(
+            buffers, std::forward<WriteHandler>(handler));
+    }
+};
+
+#if ! BOOST_BEAST_DOXYGEN
+template<class NextLayer>
+void
+teardown(
+    role_type role,
+    proxy_protocol_stream<NextLayer>& stream,
+    error_code& ec);
+
+template<class NextLayer, class TeardownHandler>
+void
+async_teardown(
+    role_type role,
+    proxy_protocol_stream<NextLayer>& stream,
+    TeardownHandler&& handler);
+#endif
+
+} // beast
+} // boost
+
+#include <boost/beast/_experimental/core/impl/proxy_protocol_stream.hpp>
+#ifdef BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/_experimental/core/impl/proxy_protocol_stream.ipp>
+#endif
+
+#endif
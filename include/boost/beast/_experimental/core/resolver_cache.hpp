@@ -0,0 +1,203 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_RESOLVER_CACHE_HPP
+#define BOOST_BEAST_CORE_RESOLVER_CACHE_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/shared_ptr.hpp>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace boost {
+namespace beast {
+
+/** A caching wrapper around a name resolver.
+
+    Objects of this type resolve host and service names using
+    an owned resolver, and remember the results so that later
+    requests for the same name complete without a lookup. Each
+    successful result is kept for a configurable time to live,
+    and failures are kept for a separate, usually shorter, time
+    so that a failing name does not cause a lookup storm.
+
+    Concurrent requests for a name which is already being
+    resolved do not start a second lookup; they wait for the
+    outstanding one and receive its result.
+
+    The system resolver does not report record lifetimes, so
+    the time to live is a property of the cache rather than of
+    the individual records.
+
+    @par Thread Safety
+    @e Distinct @e objects: Safe.@n
+    @e Shared @e objects: Unsafe. The application must also ensure
+    that all asynchronous operations are performed within the same
+    implicit or explicit strand.
+
+    @tparam Resolver The resolver type, such as `net::ip::tcp::resolver`.
+    It must provide `executor_type`, `results_type`, and an
+    `async_resolve(host, service, handler)` member function.
+*/
+template<class Resolver>
+class basic_resolver_cache
+{
+    struct impl_type;
+
+    template<class Handler>
+    class resolve_op;
+
+    struct run_resolve_op;
+
+    boost::shared_ptr<impl_type> impl_;
+
+public:
+    /// The type of resolver used to perform lookups.
+    using resolver_type = Resolver;
+
+    /// The type of the executor associated with the object.
+    using executor_type = typename Resolver::executor_type;
+
+    /// The type of results produced by the resolver.
+    using results_type = typename Resolver::results_type;
+
+    /// The clock used to expire entries.
+    using clock_type = std::chrono::steady_clock;
+
+    /// Cache settings
+    struct options
+    {
+        /// How long a successful result is reused.
+        clock_type::duration ttl = std::chrono::seconds(60);
+
+        /// How long a failed lookup is reused.
+        clock_type::duration negative_ttl = std::chrono::seconds(5);
+
+        /** Maximum number of names kept in the cache.
+
+            Names being resolved count towards the limit and are
+            not evicted. When every entry is such a name, a request
+            for another name performs a lookup whose result is not
+            kept, and which is not shared with other requests.
+        */
+        std::size_t max_entries = 1024;
+    };
+
+    basic_resolver_cache(basic_resolver_cache const&) = delete;
+    basic_resolver_cache& operator=(basic_resolver_cache const&) = delete;
+
+    /** Destructor
+
+        Pending lookups complete with `net::error::operation_aborted`.
+    */
+    ~basic_resolver_cache();
+
+    /** Constructor
+
+        @param args Arguments forwarded to the resolver's
+        constructor, typically an executor or execution context.
+    */
+    template<class... Args>
+    explicit
+    basic_resolver_cache(Args&&... args);
+
+    /// Return the executor associated with the object.
+    executor_type
+    get_executor() noexcept;
+
+    /// Return the owned resolver.
+    resolver_type&
+    resolver() noexcept;
+
+    /** Set the cache settings.
+
+        The new settings apply to results stored after the call.
+    */
+    void
+    set_options(options const& opt);
+
+    /// Return the cache settings.
+    options const&
+    get_options() const noexcept;
+
+    /// Return the number of names in the cache.
+    std::size_t
+    size() const noexcept;
+
+    /// Return the number of requests answered from the cache.
+    std::size_t
+    hits() const noexcept;
+
+    /// Return the number of requests which performed a lookup.
+    std::size_t
+    misses() const noexcept;
+
+    /** Remove a name from the cache.
+
+        A lookup in progress for the name is not affected.
+    */
+    void
+    erase(string_view host, string_view service);
+
+    /// Remove all names not currently being resolved.
+    void
+    clear();
+
+    /** Asynchronously resolve a host and service name.
+
+        If an unexpired result for the name is in the cache, it
+        is delivered without performing a lookup. Otherwise the
+        resolver is used, and the result is stored in the cache.
+
+        @param host The host name to resolve.
+
+        @param service The service name or port number.
+
+        @param handler The completion handler to invoke when the
+        operation completes. The implementation takes ownership of
+        the handler by performing a decay-copy. The equivalent
+        function signature of the handler must be:
+        @code
+        void handler(
+            error_code const& error,    // result of operation
+            results_type results        // resolved endpoints
+        );
+        @endcode
+        Regardless of whether the asynchronous operation completes
+        immediately or not, the handler will not be invoked from within
+        this function. Invocation of the handler will be performed in a
+        manner equivalent to using `net::post`.
+    */
+    template<
+        BOOST_ASIO_COMPLETION_TOKEN_FOR(void(error_code, results_type))
+            ResolveHandler =
+                net::default_completion_token_t<executor_type>>
+    BOOST_ASIO_INITFN_AUTO_RESULT_TYPE(
+        ResolveHandler, void(error_code, results_type))
+    async_resolve(
+        string_view host,
+        string_view service,
+        ResolveHandler&& handler =
+            net::default_completion_token_t<executor_type>{});
+};
+
+/// A resolver cache for TCP/IP names.
+using resolver_cache = basic_resolver_cache<net::ip::tcp::resolver>;
+
+} // beast
+} // boost
+
+#include <boost/beast/_experimental/core/impl/resolver_cache.hpp>
+
+#endif
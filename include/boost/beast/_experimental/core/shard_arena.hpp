@@ -0,0 +1,218 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_SHARD_ARENA_HPP
+#define BOOST_BEAST_CORE_SHARD_ARENA_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <cstddef>
+#include <type_traits>
+
+namespace boost {
+namespace beast {
+
+/** A single-threaded caching memory resource.
+
+    This object keeps freed blocks of memory in size-segregated
+    free lists and hands them out again, so that steady-state
+    allocation on the request path does not reach the global
+    heap. Requests larger than the largest size class are passed
+    through to `operator new`.
+
+    An arena is meant to be owned by one thread, such as a shard
+    of a @ref sharded_server, and used by all connections served
+    on that thread. Because no locking is performed, memory
+    obtained from an arena must be returned to it on the same
+    thread.
+
+    @par Thread Safety
+    @e Distinct @e objects: Safe.@n
+    @e Shared @e objects: Unsafe.
+
+    @see arena_allocator
+*/
+class shard_arena
+{
+    struct node
+    {
+        node* next;
+    };
+
+    static std::size_t constexpr min_size = 16;
+    static std::size_t constexpr classes = 9; // 16 to 4096 bytes
+
+    node* free_[classes] = {};
+    std::size_t count_[classes] = {};
+    std::size_t max_cached_;
+    std::size_t hits_ = 0;
+    std::size_t misses_ = 0;
+
+    static
+    std::size_t
+    size_class(std::size_t n) noexcept;
+
+public:
+    /// The largest allocation served from the free lists.
+    static std::size_t constexpr max_size = min_size << (classes - 1);
+
+    shard_arena(shard_arena const&) = delete;
+    shard_arena& operator=(shard_arena const&) = delete;
+
+    /// Destructor, releasing all cached blocks.
+    BOOST_BEAST_DECL
+    ~shard_arena();
+
+    /** Constructor
+
+        @param max_cached The maximum number of free blocks kept
+        for each size class. Blocks freed beyond this limit are
+        returned to the global heap.
+    */
+    BOOST_BEAST_DECL
+    explicit
+    shard_arena(std::size_t max_cached = 4096);
+
+    /** Allocate memory.
+
+        The returned memory is suitably aligned for any object
+        with fundamental alignment.
+
+        @throws std::bad_alloc if the memory could not be obtained.
+    */
+    BOOST_BEAST_DECL
+    void*
+    allocate(std::size_t n);
+
+    /** Deallocate memory.
+
+        @param p A pointer returned by @ref allocate on this arena.
+
+        @param n The size passed to @ref allocate.
+    */
+    BOOST_BEAST_DECL
+    void
+    deallocate(void* p, std::size_t n) noexcept;
+
+    /// Return the number of allocations served from the free lists.
+    std::size_t
+    hits() const noexcept
+    {
+        return hits_;
+    }
+
+    /// Return the number of allocations which reached the global heap.
+    std::size_t
+    misses() const noexcept
+    {
+        return misses_;
+    }
+
+    /// Return the number of bytes held in the free lists.
+    BOOST_BEAST_DECL
+    std::size_t
+    cached_bytes() const noexcept;
+};
+
+/** An allocator which obtains memory from a @ref shard_arena.
+
+    This allocator may be used with @ref http::basic_fields,
+    strings, and other allocator-aware containers. Copies
+    refer to the same arena, and compare equal.
+
+    @par Example
+    @code
+    using fields = http::basic_fields<arena_allocator<char>>;
+
+    fields f(arena_allocator<char>(shard.arena()));
+    @endcode
+*/
+template<class T>
+class arena_allocator
+{
+    template<class U>
+    friend class arena_allocator;
+
+    shard_arena* arena_;
+
+public:
+    using value_type = T;
+    using is_always_equal = std::false_type;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    template<class U>
+    struct rebind
+    {
+        using other = arena_allocator<U>;
+    };
+
+    /// Constructor
+    explicit
+    arena_allocator(shard_arena& arena) noexcept
+        : arena_(&arena)
+    {
+    }
+
+    /// Constructor
+    template<class U>
+    arena_allocator(arena_allocator<U> const& other) noexcept
+        : arena_(other.arena_)
+    {
+    }
+
+    /// Return the arena used by this allocator.
+    shard_arena&
+    arena() const noexcept
+    {
+        return *arena_;
+    }
+
+    value_type*
+    allocate(std::size_t n)
+    {
+        return static_cast<value_type*>(
+            arena_->allocate(n * sizeof(T)));
+    }
+
+    void
+    deallocate(value_type* p, std::size_t n) noexcept
+    {
+        arena_->deallocate(p, n * sizeof(T));
+    }
+
+    template<class U>
+    friend
+    bool
+    operator==(
+        arena_allocator const& lhs,
+        arena_allocator<U> const& rhs) noexcept
+    {
+        return &lhs.arena() == &rhs.arena();
+    }
+
+    template<class U>
+    friend
+    bool
+    operator!=(
+        arena_allocator const& lhs,
+        arena_allocator<U> const& rhs) noexcept
+    {
+        return &lhs.arena() != &rhs.arena();
+    }
+};
+
+} // beast
+} // boost
+
+#ifdef BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/_experimental/core/impl/shard_arena.ipp>
+#endif
+
+#endif
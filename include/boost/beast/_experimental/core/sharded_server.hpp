@@ -0,0 +1,295 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_SHARDED_SERVER_HPP
+#define BOOST_BEAST_CORE_SHARDED_SERVER_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/_experimental/core/shard_arena.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/optional.hpp>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace boost {
+namespace beast {
+
+/** A thread-per-core TCP server engine.
+
+    This object runs a fixed number of shards. Each shard owns an
+    `io_context` run by exactly one thread, optionally pinned to a
+    CPU, along with its own listening socket and a @ref shard_arena
+    for per-connection allocations. An accepted connection belongs
+    to one shard for its entire lifetime, so nothing on the request
+    path is shared between threads and no strands are needed.
+
+    Where the operating system supports `SO_REUSEPORT`, each shard
+    listens on its own socket bound to the same endpoint, and the
+    kernel spreads incoming connections across them. Otherwise a
+    single socket owned by the first shard accepts connections
+    directly into the other shards' contexts in round-robin order.
+
+    The engine does not know about HTTP or WebSocket. For every
+    accepted connection it invokes a user-supplied function on the
+    thread of the owning shard, which typically launches a session:
+
+    @code
+    beast::sharded_server server(
+        {net::ip::make_address("0.0.0.0"), 8080},
+        [](beast::sharded_server::shard& s, net::ip::tcp::socket sock)
+        {
+            std::make_shared<session>(std::move(sock), s.arena())->run();
+        });
+    server.run();
+    @endcode
+
+    @par Thread Safety
+    @e Distinct @e objects: Safe.@n
+    @e Shared @e objects: Unsafe, except for @ref stop which
+    may be called from any thread.
+*/
+class sharded_server
+{
+public:
+    class shard;
+
+    /// The type of function invoked for each accepted connection.
+    using accept_handler =
+        std::function<void(shard&, net::ip::tcp::socket)>;
+
+    /// Engine settings
+    struct options
+    {
+        /** The number of shards.
+
+            A value of zero uses one shard per hardware thread.
+        */
+        std::size_t shards = 0;
+
+        /** Pin each shard's thread to a CPU.
+
+            Shard `i` runs on CPU `i` modulo the number of CPUs.
+            This has no effect on systems without thread affinity.
+            It is off by default, because it ignores other processes
+            on the machine and any CPU set the process was given.
+        */
+        bool pin_threads = false;
+
+        /// Use a listening socket per shard, if supported.
+        bool reuse_port = true;
+
+        /// The listen backlog of each listening socket.
+        int backlog = net::socket_base::max_listen_connections;
+
+        /// The maximum number of free blocks cached by each arena.
+        std::size_t arena_max_cached = 4096;
+
+        /** The time to wait before accepting again after an error.
+
+            Errors such as running out of file descriptors do not
+            clear up by retrying at once, so a listening socket
+            pauses for this long before it accepts again.
+        */
+        std::chrono::steady_clock::duration accept_retry_delay =
+            std::chrono::milliseconds(100);
+    };
+
+    /// One thread's share of the server.
+    class shard
+    {
+        friend class sharded_server;
+
+        // The arena outlives connections destroyed with the context
+        shard_arena arena_;
+        net::io_context ioc_;
+        net::ip::tcp::acceptor acceptor_;
+        net::steady_timer retry_timer_;
+        boost::optional<net::executor_work_guard<
+            net::io_context::executor_type>> work_;
+        std::size_t index_;
+        std::size_t accepted_ = 0;
+
+    public:
+        /// The type of executor used by this shard.
+        using executor_type = net::io_context::executor_type;
+
+        BOOST_BEAST_DECL
+        shard(std::size_t index, std::size_t max_cached);
+
+        /// Return the executor of this shard.
+        executor_type
+        get_executor() noexcept
+        {
+            return ioc_.get_executor();
+        }
+
+        /// Return the execution context of this shard.
+        net::io_context&
+        context() noexcept
+        {
+            return ioc_;
+        }
+
+        /// Return the memory arena of this shard.
+        shard_arena&
+        arena() noexcept
+        {
+            return arena_;
+        }
+
+        /// Return the index of this shard.
+        std::size_t
+        index() const noexcept
+        {
+            return index_;
+        }
+
+        /** Return the number of connections accepted by this shard.
+
+            This must only be called from the shard's own thread,
+            or when the server is not running.
+        */
+        std::size_t
+        accepted() const noexcept
+        {
+            return accepted_;
+        }
+    };
+
+    sharded_server(sharded_server const&) = delete;
+    sharded_server& operator=(sharded_server const&) = delete;
+
+    /// Destructor
+    BOOST_BEAST_DECL
+    ~sharded_server();
+
+    /** Constructor
+
+        The listening sockets are opened and bound by the
+        constructor, so that errors are reported immediately and
+        @ref local_endpoint can be used before calling @ref run.
+
+        @param ep The endpoint to listen on. If the port is zero,
+        an ephemeral port is chosen and shared by all shards.
+
+        @param handler The function to invoke for each accepted
+        connection.
+
+        @param opt The engine settings.
+
+        @throws system_error on failure.
+    */
+    BOOST_BEAST_DECL
+    sharded_server(
+        net::ip::tcp::endpoint const& ep,
+        accept_handler handler,
+        options const& opt);
+
+    /** Constructor
+
+        This constructs the server with default settings.
+
+        @param ep The endpoint to listen on.
+
+        @param handler The function to invoke for each accepted
+        connection.
+
+        @throws system_error on failure.
+    */
+    BOOST_BEAST_DECL
+    sharded_server(
+        net::ip::tcp::endpoint const& ep,
+        accept_handler handler);
+
+    /// Return the number of shards.
+    std::size_t
+    size() const noexcept
+    {
+        return shards_.size();
+    }
+
+    /// Return a shard by index.
+    shard&
+    get_shard(std::size_t i) noexcept
+    {
+        return *shards_[i];
+    }
+
+    /// Return the endpoint the server is listening on.
+    BOOST_BEAST_DECL
+    net::ip::tcp::endpoint
+    local_endpoint() const;
+
+    /// Returns `true` if each shard has its own listening socket.
+    bool
+    reuse_port() const noexcept
+    {
+        return reuse_port_;
+    }
+
+    /** Run the server until @ref stop is called.
+
+        Shard zero runs on the calling thread, and a new thread is
+        started for each other shard. If threads are pinned, the
+        affinity of the calling thread is changed as well. This
+        function returns after all threads have finished.
+    */
+    BOOST_BEAST_DECL
+    void
+    run();
+
+    /** Stop the server.
+
+        All shards stop running as soon as possible, and @ref run
+        returns. Connections are not closed until the server is
+        destroyed or run again. This function may be called from
+        any thread, including from within a shard.
+    */
+    BOOST_BEAST_DECL
+    void
+    stop();
+
+private:
+    struct accept_op;
+
+    BOOST_BEAST_DECL
+    void
+    do_accept(shard& s);
+
+    BOOST_BEAST_DECL
+    void
+    retry_accept(shard& s);
+
+    BOOST_BEAST_DECL
+    static
+    void
+    pin_thread(std::size_t i);
+
+    std::vector<std::unique_ptr<shard>> shards_;
+    accept_handler handler_;
+    options opt_;
+    std::size_t next_ = 0;
+    bool reuse_port_ = false;
+};
+
+} // beast
+} // boost
+
+#ifdef BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/_experimental/core/impl/sharded_server.ipp>
+#endif
+
+#endif
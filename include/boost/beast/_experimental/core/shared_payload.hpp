@@ -0,0 +1,271 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_SHARED_PAYLOAD_HPP
+#define BOOST_BEAST_CORE_SHARED_PAYLOAD_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/buffer_traits.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/core/exchange.hpp>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace boost {
+namespace beast {
+
+/** An immutable, reference counted buffer.
+
+    This object holds a copy of a sequence of bytes which may be
+    shared by many owners, such as every session in a broadcast.
+    Copies of the object refer to the same bytes; the count of
+    owners is kept in a small header in front of the data, so
+    copying a payload costs an atomic increment and no allocation.
+    The storage is released when the last copy is destroyed,
+    which may happen on any thread.
+
+    Storage for small and medium payloads is obtained from a
+    process wide pool of size-segregated free lists, so that a
+    steady stream of messages of similar size does not reach the
+    global heap.
+
+    The object meets the requirements of <em>ConstBufferSequence</em>,
+    and may be passed directly to write operations, for example
+    `websocket::stream::async_write`. The @ref http::shared_payload_body
+    body type uses it as the body of an HTTP message.
+
+    @par Example
+    @code
+    shared_payload const p(string_view("Hello, world!"));
+    for(auto& session : sessions)
+        session->send(p);
+    @endcode
+
+    @par Thread Safety
+    @e Distinct @e objects: Safe.@n
+    @e Shared @e objects: Safe for const member functions.
+*/
+class shared_payload
+{
+    struct header
+    {
+        std::atomic<std::size_t> refs;
+        net::const_buffer buffer;
+        std::size_t capacity;
+    };
+
+    header* h_ = nullptr;
+
+    BOOST_BEAST_DECL
+    static
+    header*
+    allocate(std::size_t size);
+
+    BOOST_BEAST_DECL
+    static
+    void
+    release(header* h) noexcept;
+
+    static
+    char*
+    data_of(header* h) noexcept
+    {
+        return reinterpret_cast<char*>(h + 1);
+    }
+
+public:
+    /// The type of buffer in the sequence
+    using value_type = net::const_buffer;
+
+    /// The type of iterator used to represent the sequence
+    using const_iterator = net::const_buffer const*;
+
+    /// The largest payload whose storage is pooled
+    static std::size_t constexpr max_pooled = 65536;
+
+    /// Constructor, for an empty payload
+    shared_payload() = default;
+
+    /// Constructor, sharing the payload of `other`
+    shared_payload(shared_payload const& other) noexcept
+        : h_(other.h_)
+    {
+        if(h_)
+            h_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Constructor, taking the payload of `other`
+    shared_payload(shared_payload&& other) noexcept
+        : h_(boost::exchange(other.h_, nullptr))
+    {
+    }
+
+    /// Assignment, sharing the payload of `other`
+    shared_payload&
+    operator=(shared_payload const& other) noexcept
+    {
+        shared_payload(other).swap(*this);
+        return *this;
+    }
+
+    /// Assignment, taking the payload of `other`
+    shared_payload&
+    operator=(shared_payload&& other) noexcept
+    {
+        shared_payload(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    /// Destructor
+    ~shared_payload()
+    {
+        if(h_ && h_->refs.fetch_sub(
+                1, std::memory_order_acq_rel) == 1)
+            release(h_);
+    }
+
+    /** Constructor, copying a string.
+
+        @throws std::bad_alloc if the memory could not be obtained.
+    */
+    explicit
+    shared_payload(string_view s)
+        : shared_payload(net::const_buffer(s.data(), s.size()))
+    {
+    }
+
+    /** Constructor, copying a buffer sequence.
+
+        @throws std::bad_alloc if the memory could not be obtained.
+    */
+    template<class ConstBufferSequence
+#if ! BOOST_BEAST_DOXYGEN
+        , class = typename std::enable_if<
+            net::is_const_buffer_sequence<
+                ConstBufferSequence>::value &&
+            ! std::is_same<ConstBufferSequence,
+                shared_payload>::value>::type
+#endif
+    >
+    explicit
+    shared_payload(ConstBufferSequence const& buffers)
+    {
+        auto const n = buffer_bytes(buffers);
+        if(n == 0)
+            return;
+        h_ = allocate(n);
+        net::buffer_copy(
+            net::mutable_buffer(data_of(h_), n), buffers);
+    }
+
+    /** Constructor, filling a new payload.
+
+        The function is invoked once with a `net::mutable_buffer`
+        referring to the uninitialized storage, which it must fill.
+        The storage is immutable after construction.
+
+        @param size The size of the payload in bytes.
+
+        @param fill The function to invoke.
+    */
+    template<class Fill>
+    shared_payload(std::size_t size, Fill&& fill)
+    {
+        if(size == 0)
+            return;
+        struct guard
+        {
+            header* h;
+
+            ~guard()
+            {
+                if(h)
+                    release(h);
+            }
+        } g{allocate(size)};
+        fill(net::mutable_buffer(data_of(g.h), size));
+        h_ = boost::exchange(g.h, nullptr);
+    }
+
+    /// Return a pointer to the first byte of the payload
+    char const*
+    data() const noexcept
+    {
+        return h_ ? data_of(h_) : nullptr;
+    }
+
+    /// Return the size of the payload in bytes
+    std::size_t
+    size() const noexcept
+    {
+        return h_ ? h_->buffer.size() : 0;
+    }
+
+    /// Returns `true` if the payload is empty
+    bool
+    empty() const noexcept
+    {
+        return h_ == nullptr;
+    }
+
+    /// Return the number of objects sharing the payload
+    std::size_t
+    use_count() const noexcept
+    {
+        return h_ ? h_->refs.load(std::memory_order_relaxed) : 0;
+    }
+
+    /// Return the payload as a string
+    string_view
+    str() const noexcept
+    {
+        return {data(), size()};
+    }
+
+    /// Return an iterator to the beginning of the sequence
+    const_iterator
+    begin() const noexcept
+    {
+        return h_ ? &h_->buffer : nullptr;
+    }
+
+    /// Return an iterator to the end of the sequence
+    const_iterator
+    end() const noexcept
+    {
+        return h_ ? &h_->buffer + 1 : nullptr;
+    }
+
+    /// Exchange this payload with another
+    void
+    swap(shared_payload& other) noexcept
+    {
+        std::swap(h_, other.h_);
+    }
+
+    /// Exchange two payloads
+    friend
+    void
+    swap(shared_payload& lhs, shared_payload& rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+};
+
+} // beast
+} // boost
+
+#ifdef BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/_experimental/core/impl/shared_payload.ipp>
+#endif
+
+#endif
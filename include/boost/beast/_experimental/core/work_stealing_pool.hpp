@@ -0,0 +1,375 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_WORK_STEALING_POOL_HPP
+#define BOOST_BEAST_CORE_WORK_STEALING_POOL_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/_experimental/core/detail/session_lane.hpp>
+#include <boost/asio/execution.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/prefer.hpp>
+#include <boost/asio/query.hpp>
+#include <boost/asio/require.hpp>
+#include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace boost {
+namespace beast {
+
+/** An executor which serializes the functions of one session.
+
+    Like a strand, functions submitted through copies of the same
+    session executor never run concurrently, and run in the order
+    they were submitted. Unlike a strand, the session is scheduled
+    as a unit onto one worker of a @ref work_stealing_pool, and keeps
+    returning to that worker, so its state stays warm in that CPU's
+    cache. A worker with nothing to do takes waiting sessions from a
+    busy worker, and the session then stays with its new worker.
+
+    Objects of this type are obtained from
+    @ref work_stealing_pool::make_executor, and may be used wherever
+    an I/O executor is required, such as with @ref basic_stream or
+    `websocket::stream`:
+
+    @code
+    work_stealing_pool pool(4);
+    websocket::stream<basic_stream<
+        net::ip::tcp, work_stealing_pool::executor_type>> ws(
+            pool.make_executor());
+    @endcode
+
+    I/O objects created with the executor are registered with the
+    one reactor shared by all workers, so a session may be taken by
+    another worker while it has asynchronous operations pending,
+    such as a websocket session waiting on a read. Completions are
+    delivered through the session executor, and so run on whichever
+    worker the session belongs to at that time.
+
+    @tparam Executor The underlying executor, which determines the
+    execution context and properties other than ordering.
+*/
+template<class Executor>
+class basic_session_executor
+{
+    template<class>
+    friend class basic_session_executor;
+
+    friend class work_stealing_pool;
+
+    Executor ex_;
+    boost::shared_ptr<detail::session_lane> lane_;
+
+    basic_session_executor(
+        Executor const& ex,
+        boost::shared_ptr<detail::session_lane> lane) noexcept;
+
+    template<class Function, class Allocator>
+    void
+    enqueue(Function&& f, Allocator const& alloc) const;
+
+public:
+    /// The type of the underlying executor.
+    using inner_executor_type = Executor;
+
+    /// Return the underlying executor.
+    inner_executor_type
+    get_inner_executor() const noexcept
+    {
+        return ex_;
+    }
+
+    /// Returns `true` if the calling thread is running a function of this session.
+    bool
+    running_in_this_thread() const noexcept
+    {
+        return lane_->running_in_this_thread();
+    }
+
+    /// Forward a query to the underlying executor.
+    template<class Property>
+    typename std::enable_if<
+        net::can_query<Executor const&, Property>::value,
+        typename net::query_result<Executor const&, Property>::type
+    >::type
+    query(Property const& p) const noexcept(
+        net::is_nothrow_query<Executor const&, Property>::value)
+    {
+        return net::query(ex_, p);
+    }
+
+    /// Forward a requirement to the underlying executor.
+    template<class Property>
+    typename std::enable_if<
+        net::can_require<Executor const&, Property>::value,
+        basic_session_executor<typename std::decay<
+            typename net::require_result<
+                Executor const&, Property>::type>::type>
+    >::type
+    require(Property const& p) const noexcept(
+        net::is_nothrow_require<Executor const&, Property>::value)
+    {
+        return {net::require(ex_, p), lane_};
+    }
+
+    /// Forward a preference to the underlying executor.
+    template<class Property>
+    typename std::enable_if<
+        net::can_prefer<Executor const&, Property>::value,
+        basic_session_executor<typename std::decay<
+            typename net::prefer_result<
+                Executor const&, Property>::type>::type>
+    >::type
+    prefer(Property const& p) const noexcept(
+        net::is_nothrow_prefer<Executor const&, Property>::value)
+    {
+        return {net::prefer(ex_, p), lane_};
+    }
+
+    /** Submit a function object for execution.
+
+        If the underlying executor permits blocking and the calling
+        thread is already running a function of this session, the
+        function object is invoked immediately. Otherwise it is queued,
+        in memory obtained from the allocator property of the underlying
+        executor. Asio sets this property to the allocator associated
+        with the completion handler.
+    */
+    template<class Function>
+    void
+    execute(Function&& f) const;
+
+#if ! defined(BOOST_ASIO_NO_TS_EXECUTORS)
+    /// Return the underlying execution context.
+    net::execution_context&
+    context() const noexcept
+    {
+        return ex_.context();
+    }
+
+    /// Inform the executor that it has some outstanding work to do.
+    void
+    on_work_started() const noexcept
+    {
+        ex_.on_work_started();
+    }
+
+    /// Inform the executor that some work is no longer outstanding.
+    void
+    on_work_finished() const noexcept
+    {
+        ex_.on_work_finished();
+    }
+
+    /// Invoke a function object, inline if running in the session.
+    template<class Function, class Allocator>
+    void
+    dispatch(Function&& f, Allocator const&) const;
+
+    /// Queue a function object for execution.
+    template<class Function, class Allocator>
+    void
+    post(Function&& f, Allocator const& a) const
+    {
+        enqueue(std::forward<Function>(f), a);
+    }
+
+    /// Queue a function object for execution.
+    template<class Function, class Allocator>
+    void
+    defer(Function&& f, Allocator const& a) const
+    {
+        enqueue(std::forward<Function>(f), a);
+    }
+#endif
+
+    /// Returns `true` if both executors refer to the same session.
+    friend
+    bool
+    operator==(
+        basic_session_executor const& lhs,
+        basic_session_executor const& rhs) noexcept
+    {
+        return lhs.lane_ == rhs.lane_ && lhs.ex_ == rhs.ex_;
+    }
+
+    /// Returns `true` if the executors refer to different sessions.
+    friend
+    bool
+    operator!=(
+        basic_session_executor const& lhs,
+        basic_session_executor const& rhs) noexcept
+    {
+        return ! (lhs == rhs);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/** A thread pool which schedules sessions with work stealing.
+
+    The workers share one `io_context`, used as the reactor for the
+    I/O objects of all sessions, and each owns a queue of sessions
+    ready to run. A completion queues its session on the worker
+    which last ran it. A worker runs the sessions in its own queue,
+    and when that is empty, takes a waiting session from another
+    worker, whether or not the session has I/O pending. Sessions
+    are represented by @ref basic_session_executor objects, which
+    provide the same ordering guarantee as a strand, while their
+    functions run from the workers' queues rather than from the
+    queue of the `io_context`, which only delivers completions.
+
+    The pool must outlive all I/O objects and executors created
+    from it.
+
+    @par Thread Safety
+    @e Distinct @e objects: Safe.@n
+    @e Shared @e objects: Safe.
+*/
+class work_stealing_pool
+{
+    struct worker;
+
+    friend struct detail::session_lane;
+
+    template<class>
+    friend class basic_session_executor;
+
+    std::vector<std::unique_ptr<worker>> workers_;
+    std::mutex lanes_m_;
+    detail::session_lane* lanes_ = nullptr;
+    std::atomic<std::size_t> next_;
+    std::atomic<std::size_t> steals_;
+    std::atomic<bool> stopped_;
+    std::atomic<bool> notified_;
+    std::size_t budget_;
+
+    // Declared after the lanes, which queued
+    // handlers destroyed with it may refer to.
+    net::io_context ioc_;
+    boost::optional<net::executor_work_guard<
+        net::io_context::executor_type>> work_;
+
+    BOOST_BEAST_DECL
+    void
+    schedule(boost::shared_ptr<detail::session_lane> lane);
+
+    BOOST_BEAST_DECL
+    void
+    enqueue(
+        boost::shared_ptr<detail::session_lane> const& lane,
+        detail::lane_op* op);
+
+    BOOST_BEAST_DECL
+    boost::shared_ptr<detail::session_lane>
+    pop(std::size_t i);
+
+    BOOST_BEAST_DECL
+    boost::shared_ptr<detail::session_lane>
+    steal(std::size_t i);
+
+    BOOST_BEAST_DECL
+    void
+    run_lane(std::size_t i,
+        boost::shared_ptr<detail::session_lane> lane);
+
+    BOOST_BEAST_DECL
+    void
+    wake();
+
+    BOOST_BEAST_DECL
+    void
+    run(std::size_t i);
+
+public:
+    /// The type of executor used to run sessions.
+    using executor_type =
+        basic_session_executor<net::io_context::executor_type>;
+
+    work_stealing_pool(work_stealing_pool const&) = delete;
+    work_stealing_pool& operator=(work_stealing_pool const&) = delete;
+
+    /** Destructor
+
+        Stops the pool and waits for the threads to exit.
+    */
+    BOOST_BEAST_DECL
+    ~work_stealing_pool();
+
+    /** Constructor
+
+        The worker threads are started immediately.
+
+        @param threads The number of worker threads. If zero, one
+        thread per hardware thread is started.
+
+        @param budget The maximum number of functions of one session
+        run in a row before the worker moves on to the next session.
+    */
+    BOOST_BEAST_DECL
+    explicit
+    work_stealing_pool(
+        std::size_t threads = 0,
+        std::size_t budget = 64);
+
+    /// Return the number of worker threads.
+    std::size_t
+    size() const noexcept
+    {
+        return workers_.size();
+    }
+
+    /// Return the number of sessions taken from another worker.
+    std::size_t
+    steals() const noexcept
+    {
+        return steals_.load(std::memory_order_relaxed);
+    }
+
+    /** Return an executor for a new session.
+
+        Sessions are assigned to workers in round-robin order.
+        All I/O objects and completion handlers of the session
+        should use copies of the returned executor.
+    */
+    BOOST_BEAST_DECL
+    executor_type
+    make_executor();
+
+    /** Stop the worker threads.
+
+        Queued functions which have not run are discarded when
+        their session is destroyed.
+    */
+    BOOST_BEAST_DECL
+    void
+    stop();
+
+    /// Wait for the worker threads to exit.
+    BOOST_BEAST_DECL
+    void
+    join();
+};
+
+} // beast
+} // boost
+
+#include <boost/beast/_experimental/core/impl/work_stealing_pool.hpp>
+#ifdef BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/_experimental/core/impl/work_stealing_pool.ipp>
+#endif
+
+#endif
@@ -0,0 +1,293 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_AWAITABLE_HPP
+#define BOOST_BEAST_HTTP_AWAITABLE_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/http/basic_parser.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/serializer.hpp>
+#include <boost/beast/http/type_traits.hpp>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+
+#if BOOST_ASIO_HAS_CO_AWAIT
+
+#include <cstddef>
+#include <type_traits>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+/** Read a complete message from a stream using a coroutine.
+
+    This function is the `co_await` counterpart of @ref async_read.
+    The operation is implemented as a coroutine, so its state is
+    kept in the coroutine frame instead of a composed operation,
+    and octets already present in `buffer` are parsed directly.
+    If the buffer holds the complete message, the function returns
+    without suspending and without performing any I/O; the
+    equivalent composed operation would post its completion to
+    the executor instead.
+
+    @code
+    net::awaitable<void>
+    session(beast::tcp_stream& stream)
+    {
+        beast::flat_buffer buffer;
+        for(;;)
+        {
+            http::request<http::string_body> req;
+            co_await http::co_read(stream, buffer, req);
+            ...
+        }
+    }
+    @endcode
+
+    @param stream The stream from which the data is to be read.
+    The type must meet the <em>AsyncReadStream</em> requirements.
+
+    @param buffer Storage for additional bytes read by the
+    implementation from the stream. This is both an input and an
+    output parameter; on entry, the parser will be presented
+    with any remaining data in the dynamic buffer's readable
+    bytes sequence first.
+
+    @param parser The parser to use.
+
+    @param ec Set to the error, if any occurred.
+
+    @return The number of bytes transferred from the buffer to
+    the parser.
+
+    @tparam Executor The executor type of the calling coroutine.
+*/
+template<
+    class Executor = net::any_io_executor,
+    class AsyncReadStream,
+    class DynamicBuffer,
+    bool isRequest>
+net::awaitable<std::size_t, Executor>
+co_read(
+    AsyncReadStream& stream,
+    DynamicBuffer& buffer,
+    basic_parser<isRequest>& parser,
+    error_code& ec);
+
+/** Read a complete message from a stream using a coroutine.
+
+    This function behaves like the overload taking an
+    `error_code`, except that errors are reported by throwing
+    `system_error`.
+*/
+template<
+    class Executor = net::any_io_executor,
+    class AsyncReadStream,
+    class DynamicBuffer,
+    bool isRequest>
+net::awaitable<std::size_t, Executor>
+co_read(
+    AsyncReadStream& stream,
+    DynamicBuffer& buffer,
+    basic_parser<isRequest>& parser);
+
+/** Read a complete message from a stream using a coroutine.
+
+    The parser used to receive the message lives in the frame of
+    the coroutine. Octets already present in `buffer` are parsed
+    without suspending. See the overload taking a parser for
+    details.
+
+    @param stream The stream from which the data is to be read.
+    The type must meet the <em>AsyncReadStream</em> requirements.
+
+    @param buffer Storage for additional bytes read by the
+    implementation from the stream.
+
+    @param msg The container in which to store the message
+    contents. This message container should not have previous
+    contents, otherwise the behavior is undefined.
+
+    @param ec Set to the error, if any occurred.
+
+    @return The number of bytes transferred from the buffer to
+    the parser.
+*/
+template<
+    class Executor = net::any_io_executor,
+    class AsyncReadStream,
+    class DynamicBuffer,
+    bool isRequest, class Body, class Allocator>
+net::awaitable<std::size_t, Executor>
+co_read(
+    AsyncReadStream& stream,
+    DynamicBuffer& buffer,
+    message<isRequest, Body, basic_fields<Allocator>>& msg,
+    error_code& ec);
+
+/** Read a complete message from a stream using a coroutine.
+
+    This function behaves like the overload taking an
+    `error_code`, except that errors are reported by throwing
+    `system_error`.
+*/
+template<
+    class Executor = net::any_io_executor,
+    class AsyncReadStream,
+    class DynamicBuffer,
+    bool isRequest, class Body, class Allocator>
+net::awaitable<std::size_t, Executor>
+co_read(
+    AsyncReadStream& stream,
+    DynamicBuffer& buffer,
+    message<isRequest, Body, basic_fields<Allocator>>& msg);
+
+//------------------------------------------------------------------------------
+
+/** Write a complete message to a stream using a coroutine.
+
+    This function is the `co_await` counterpart of @ref async_write.
+    Each group of buffers produced by the serializer is sent with
+    one call to the stream's `async_write_some`, directly from the
+    coroutine frame.
+
+    @param stream The stream to which the data is to be written.
+    The type must meet the <em>AsyncWriteStream</em> requirements.
+
+    @param sr The serializer to use.
+
+    @param ec Set to the error, if any occurred.
+
+    @return The number of bytes written to the stream.
+
+    @tparam Executor The executor type of the calling coroutine.
+*/
+template<
+    class Executor = net::any_io_executor,
+    class AsyncWriteStream,
+    bool isRequest, class Body, class Fields>
+net::awaitable<std::size_t, Executor>
+co_write(
+    AsyncWriteStream& stream,
+    serializer<isRequest, Body, Fields>& sr,
+    error_code& ec);
+
+/** Write a complete message to a stream using a coroutine.
+
+    This function behaves like the overload taking an
+    `error_code`, except that errors are reported by throwing
+    `system_error`.
+*/
+template<
+    class Executor = net::any_io_executor,
+    class AsyncWriteStream,
+    bool isRequest, class Body, class Fields>
+net::awaitable<std::size_t, Executor>
+co_write(
+    AsyncWriteStream& stream,
+    serializer<isRequest, Body, Fields>& sr);
+
+/** Write a complete message to a stream using a coroutine.
+
+    The serializer used to send the message lives in the frame
+    of the coroutine.
+
+    @param stream The stream to which the data is to be written.
+    The type must meet the <em>AsyncWriteStream</em> requirements.
+
+    @param msg The message to write.
+
+    @param ec Set to the error, if any occurred.
+
+    @return The number of bytes written to the stream.
+*/
+template<
+    class Executor = net::any_io_executor,
+    class AsyncWriteStream,
+    bool isRequest, class Body, class Fields>
+typename std::enable_if<
+    is_mutable_body_writer<Body>::value,
+    net::awaitable<std::size_t, Executor>>::type
+co_write(
+    AsyncWriteStream& stream,
+    message<isRequest, Body, Fields>& msg,
+    error_code& ec);
+
+/** Write a complete message to a stream using a coroutine.
+
+    The serializer used to send the message lives in the frame
+    of the coroutine.
+
+    @param stream The stream to which the data is to be written.
+    The type must meet the <em>AsyncWriteStream</em> requirements.
+
+    @param msg The message to write.
+
+    @param ec Set to the error, if any occurred.
+
+    @return The number of bytes written to the stream.
+*/
+template<
+    class Executor = net::any_io_executor,
+    class AsyncWriteStream,
+    bool isRequest, class Body, class Fields>
+typename std::enable_if<
+    ! is_mutable_body_writer<Body>::value,
+    net::awaitable<std::size_t, Executor>>::type
+co_write(
+    AsyncWriteStream& stream,
+    message<isRequest, Body, Fields> const& msg,
+    error_code& ec);
+
+/** Write a complete message to a stream using a coroutine.
+
+    This function behaves like the overload taking an
+    `error_code`, except that errors are reported by throwing
+    `system_error`.
+*/
+template<
+    class Executor = net::any_io_executor,
+    class AsyncWriteStream,
+    bool isRequest, class Body, class Fields>
+typename std::enable_if<
+    is_mutable_body_writer<Body>::value,
+    net::awaitable<std::size_t, Executor>>::type
+co_write(
+    AsyncWriteStream& stream,
+    message<isRequest, Body, Fields>& msg);
+
+/** Write a complete message to a stream using a coroutine.
+
+    This function behaves like the overload taking an
+    `error_code`, except that errors are reported by throwing
+    `system_error`.
+*/
+template<
+    class Executor = net::any_io_executor,
+    class AsyncWriteStream,
+    bool isRequest, class Body, class Fields>
+typename std::enable_if<
+    ! is_mutable_body_writer<Body>::value,
+    net::awaitable<std::size_t, Executor>>::type
+co_write(
+    AsyncWriteStream& stream,
+    message<isRequest, Body, Fields> const& msg);
+
+} // http
+} // beast
+} // boost
+
+#include <boost/beast/_experimental/http/impl/awaitable.hpp>
+
+#endif
+
+#endif
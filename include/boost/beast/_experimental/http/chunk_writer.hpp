@@ -0,0 +1,214 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_CHUNK_WRITER_HPP
+#define BOOST_BEAST_HTTP_CHUNK_WRITER_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/stream_traits.hpp>
+#include <cstddef>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+/** A writer for the body of a chunked message sent over time.
+
+    This object frames caller data as chunks of the chunked
+    Transfer-Encoding and batches them: chunks appended while
+    nothing is being written accumulate in a pending buffer, and
+    a flush sends all of them with a single write. Chunks appended
+    while a flush is in progress go to a second buffer, which the
+    same flush sends next. It is meant for long-lived streaming
+    responses such as event streams and log tails, where many
+    small chunks are produced each second.
+
+    Chunk data is copied into the buffers along with its framing,
+    so the caller's memory may be reused as soon as @ref append
+    returns. Once the two buffers reach their working size, no
+    memory is allocated per chunk. Chunk extensions are not
+    supported.
+
+    The header of the message must be written first, for example
+    with @ref write_header on a @ref serializer for a response
+    with chunked encoding:
+
+    @code
+    response<empty_body> res{status::ok, 11};
+    res.set(field::content_type, "text/event-stream");
+    res.chunked(true);
+    response_serializer<empty_body> sr{res};
+    write_header(stream, sr);
+
+    chunk_writer<tcp_stream> cw{stream};
+    cw.append(net::buffer("data: one\n\n", 11));
+    cw.append(net::buffer("data: two\n\n", 11));
+    cw.flush();                     // one write, two chunks
+    ...
+    cw.append_last();
+    cw.flush();
+    @endcode
+
+    @par Thread Safety
+    @e Distinct @e objects: Safe.@n
+    @e Shared @e objects: Unsafe. The application must also ensure
+    that all asynchronous operations are performed within the same
+    implicit or explicit strand.
+
+    @tparam Stream The stream type to write to. It must provide
+    `get_executor`, and meet the requirements of <em>SyncWriteStream</em>
+    or <em>AsyncWriteStream</em> for the functions which are used.
+
+    @tparam DynamicBuffer The type of the two buffers holding
+    framed chunks.
+*/
+template<
+    class Stream,
+    class DynamicBuffer = flat_buffer>
+class chunk_writer
+{
+    template<class Handler>
+    class flush_op;
+
+    struct run_flush_op;
+
+    Stream& stream_;
+    DynamicBuffer buf_[2];
+    int in_ = 0;
+    bool flushing_ = false;
+
+public:
+    /// The type of the stream chunks are written to.
+    using stream_type = Stream;
+
+    /// The type of the buffers holding framed chunks.
+    using buffer_type = DynamicBuffer;
+
+    chunk_writer(chunk_writer const&) = delete;
+    chunk_writer& operator=(chunk_writer const&) = delete;
+
+    /** Constructor
+
+        @param stream The stream to write to. It must outlive
+        the writer.
+
+        @param args Arguments forwarded to the constructor
+        of each of the two buffers.
+    */
+    template<class... Args>
+    explicit
+    chunk_writer(Stream& stream, Args const&... args);
+
+    /// Returns the stream chunks are written to.
+    Stream&
+    stream() noexcept
+    {
+        return stream_;
+    }
+
+    /// Returns the number of framed bytes waiting to be written.
+    std::size_t
+    pending() const noexcept
+    {
+        return buf_[0].size() + buf_[1].size();
+    }
+
+    /// Returns `true` if an asynchronous flush is in progress.
+    bool
+    is_flushing() const noexcept
+    {
+        return flushing_;
+    }
+
+    /** Append a chunk.
+
+        The chunk-size line, the data and the trailing CRLF are
+        copied into the pending buffer. No I/O is performed. An
+        empty buffer sequence is ignored, since a chunk of size
+        zero ends the body.
+
+        @param buffers The data of the chunk.
+
+        @throws std::length_error if the buffer would exceed
+        its maximum size.
+    */
+    template<class ConstBufferSequence>
+    void
+    append(ConstBufferSequence const& buffers);
+
+    /** Append the last chunk.
+
+        This appends the zero-sized chunk and the empty trailer
+        which end the body. No more chunks may be appended after.
+    */
+    void
+    append_last();
+
+    /** Write all pending chunks.
+
+        @return The number of bytes written.
+
+        @throws system_error Thrown on failure.
+    */
+    std::size_t
+    flush();
+
+    /** Write all pending chunks.
+
+        @param ec Set to indicate what error occurred, if any.
+
+        @return The number of bytes written.
+    */
+    std::size_t
+    flush(error_code& ec);
+
+    /** Write all pending chunks asynchronously.
+
+        The operation writes the pending buffer with one call to
+        `net::async_write`. Chunks appended during that write are
+        written next, by the same operation, which completes when
+        nothing is left. The program must not start another flush
+        until this operation completes; @ref is_flushing reports
+        whether one is in progress.
+
+        @param handler The completion handler to invoke when the
+        operation completes. The implementation takes ownership of
+        the handler by performing a decay-copy. The equivalent
+        function signature of the handler must be:
+        @code
+        void handler(
+            error_code const& ec,       // Result of operation
+            std::size_t bytes_written   // Number of bytes written
+        );
+        @endcode
+        Regardless of whether the asynchronous operation completes
+        immediately or not, the handler will not be invoked from within
+        this function. Invocation of the handler will be performed in a
+        manner equivalent to using `net::post`.
+    */
+    template<
+        BOOST_BEAST_ASYNC_TPARAM2 WriteHandler =
+            net::default_completion_token_t<
+                executor_type<Stream>>>
+    BOOST_BEAST_ASYNC_RESULT2(WriteHandler)
+    async_flush(
+        WriteHandler&& handler =
+            net::default_completion_token_t<
+                executor_type<Stream>>{});
+};
+
+} // http
+} // beast
+} // boost
+
+#include <boost/beast/_experimental/http/impl/chunk_writer.hpp>
+
+#endif
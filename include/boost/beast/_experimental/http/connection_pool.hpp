@@ -0,0 +1,413 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_CONNECTION_POOL_HPP
+#define BOOST_BEAST_HTTP_CONNECTION_POOL_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/saved_handler.hpp>
+#include <boost/beast/core/stream_traits.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/basic_waitable_timer.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+/** Identifies the origin served by a pooled connection.
+
+    Connections are only shared between requests whose keys
+    compare equal. The `context` member may be set to the
+    address of an SSL context (or any other object) so that
+    connections established with different TLS settings to
+    the same host and port are kept apart.
+*/
+struct pool_key
+{
+    /// The host name, as it would appear in the `Host` field.
+    std::string host;
+
+    /// The service name or port number.
+    std::string port;
+
+    /// An optional opaque identity, typically the TLS context.
+    void const* context = nullptr;
+
+    /// Constructor
+    pool_key() = default;
+
+    /// Constructor
+    pool_key(
+        std::string host_,
+        std::string port_,
+        void const* context_ = nullptr)
+        : host(std::move(host_))
+        , port(std::move(port_))
+        , context(context_)
+    {
+    }
+
+    /// Returns `true` if two keys identify the same origin.
+    friend
+    bool
+    operator==(pool_key const& lhs, pool_key const& rhs) noexcept
+    {
+        return
+            lhs.context == rhs.context &&
+            lhs.port == rhs.port &&
+            lhs.host == rhs.host;
+    }
+
+    /// Returns `true` if two keys identify different origins.
+    friend
+    bool
+    operator!=(pool_key const& lhs, pool_key const& rhs) noexcept
+    {
+        return ! (lhs == rhs);
+    }
+};
+
+/** A keep-alive pool of client connections.
+
+    This container hands out exclusive leases on stream objects,
+    keyed by origin. When a lease is released with keep-alive
+    the stream is returned to the pool and handed to the next
+    request for the same origin, avoiding the cost of a new
+    connect and TLS handshake.
+
+    The pool does not connect or handshake streams itself.
+    Newly created streams are produced by a user-supplied
+    factory, and the lease reports @ref lease::is_new so the
+    caller knows to establish the connection before use. This
+    keeps the pool independent of the stream stack, allowing
+    it to hold @ref tcp_stream, @ref ssl_stream, or any other
+    layered stream type.
+
+    The pool enforces these limits:
+
+    @li A maximum number of connections per origin. When the
+        limit is reached, @ref async_acquire waits until a
+        lease for the same origin is released. Waiting operations
+        are served in the order they were started, and each
+        released connection, or the slot it frees, is handed
+        to the oldest of them.
+
+    @li A maximum number of idle connections kept per origin.
+
+    @li An idle timeout, after which an unused connection is
+        closed.
+
+    @li An optional maximum number of requests per connection.
+
+    While a lease is held the caller has exclusive use of the
+    stream, and may pipeline requests by writing several
+    messages before reading the corresponding responses. The
+    pool itself does not pipeline: requests made through
+    different leases never share a connection at the same time,
+    and a request waits for a free connection, or opens a new
+    one, rather than queueing behind another on a busy one.
+
+    The pool does not perform TLS handshakes, and so does not
+    resume TLS sessions by itself. Resumption is arranged in the
+    factory, for instance with `ssl_client_session_store`, which
+    associates each new stream with its origin before the caller
+    performs the handshake:
+
+    @code
+    ssl_client_session_store store;
+    net::ssl::context ctx{net::ssl::context::tlsv12_client};
+    store.install(ctx);
+
+    http::connection_pool<beast::ssl_stream<beast::tcp_stream>> pool(
+        ioc.get_executor(),
+        [&](http::pool_key const& key)
+        {
+            beast::ssl_stream<beast::tcp_stream> stream(ioc, ctx);
+            SSL_set_tlsext_host_name(
+                stream.native_handle(), key.host.c_str());
+            store.prepare(stream, key.host + ":" + key.port);
+            return stream;
+        });
+    @endcode
+
+    A connection which is reused from the pool needs no handshake
+    at all; the store only shortens the handshakes of new ones.
+
+    @par Example
+    @code
+    http::connection_pool<beast::tcp_stream> pool(
+        ioc.get_executor(),
+        [&ioc](http::pool_key const&)
+        {
+            return beast::tcp_stream(ioc);
+        });
+
+    pool.async_acquire({"example.com", "80"},
+        [&](beast::error_code ec,
+            http::connection_pool<beast::tcp_stream>::lease conn)
+        {
+            if(conn.is_new())
+            {
+                // resolve and connect conn.stream()
+            }
+            // ... write a request, read the response
+            conn.release(res.keep_alive());
+        });
+    @endcode
+
+    @par Thread Safety
+    @e Distinct @e objects: Safe.@n
+    @e Shared @e objects: Unsafe. The application must also ensure
+    that all asynchronous operations and calls to @ref lease::release
+    are performed within the same implicit or explicit strand.
+
+    @tparam Stream The type of stream held by the pool. It must be
+    <em>MoveConstructible</em>.
+*/
+template<class Stream>
+class connection_pool
+{
+    struct impl_type;
+    struct connection;
+
+    template<class Handler>
+    class acquire_op;
+
+    struct run_acquire_op;
+
+    boost::shared_ptr<impl_type> impl_;
+
+public:
+    /// The type of stream held in the pool.
+    using stream_type = Stream;
+
+    /// The type of the executor associated with the pool.
+    using executor_type = beast::executor_type<Stream>;
+
+    /// The clock used for idle timeouts.
+    using clock_type = std::chrono::steady_clock;
+
+    /// The type of function used to create new streams.
+    using factory_type = std::function<Stream(pool_key const&)>;
+
+    /// Limits applied by the pool
+    struct options
+    {
+        /** Maximum number of connections per origin.
+
+            This counts both leased and idle connections. A value
+            of zero means no limit.
+        */
+        std::size_t max_per_host = 6;
+
+        /// Maximum number of idle connections kept per origin.
+        std::size_t max_idle_per_host = 6;
+
+        /// Idle connections older than this are closed.
+        clock_type::duration idle_timeout = std::chrono::seconds(30);
+
+        /** Maximum number of leases per connection.
+
+            After a connection has been leased this many times
+            it is closed instead of being returned to the pool.
+            A value of zero means no limit.
+        */
+        std::size_t max_requests = 0;
+    };
+
+    /** An exclusive lease on a pooled stream.
+
+        Objects of this type are delivered to the completion
+        handler of @ref async_acquire. The lease is returned to the
+        pool by calling @ref release, or when the lease is destroyed,
+        in which case the stream is closed.
+    */
+    class lease
+    {
+        friend class connection_pool;
+        friend struct impl_type;
+
+        boost::weak_ptr<impl_type> wp_;
+        std::unique_ptr<connection> c_;
+
+        lease(
+            boost::weak_ptr<impl_type> wp,
+            std::unique_ptr<connection> c);
+
+    public:
+        /// Constructor (default)
+        lease() = default;
+
+        /// Constructor (move)
+        lease(lease&&) = default;
+
+        /// Assignment (move)
+        lease&
+        operator=(lease&& other);
+
+        /** Destructor
+
+            If the lease is still held, the stream is closed
+            and its slot is released to the pool.
+        */
+        ~lease();
+
+        /// Returns `true` if the lease holds a stream.
+        explicit
+        operator bool() const noexcept
+        {
+            return c_ != nullptr;
+        }
+
+        /** Return the leased stream.
+
+            @par Preconditions
+            `static_cast<bool>(*this) == true`
+        */
+        stream_type&
+        stream() noexcept;
+
+        /** Return `true` if the stream was newly created.
+
+            New streams have not been connected yet. The caller
+            is responsible for connecting them and performing any
+            handshake before use.
+        */
+        bool
+        is_new() const noexcept;
+
+        /// Return the number of times this connection was leased.
+        std::size_t
+        use_count() const noexcept;
+
+        /** Return the stream to the pool.
+
+            @param keep_alive If `true`, the stream is kept open
+            for reuse by a future request to the same origin.
+            Otherwise the stream is destroyed. Callers should pass
+            the result of `message::keep_alive()` for the last
+            response read on the stream, and `false` if any error
+            occurred.
+        */
+        void
+        release(bool keep_alive);
+    };
+
+    connection_pool(connection_pool const&) = delete;
+    connection_pool& operator=(connection_pool const&) = delete;
+
+    /** Destructor
+
+        Idle connections are closed, and pending operations
+        complete with `net::error::operation_aborted`.
+    */
+    ~connection_pool();
+
+    /** Constructor
+
+        @param ex The executor used for the idle timer and as the
+        default executor of completion handlers.
+
+        @param factory A function which creates new streams for
+        a given origin.
+
+        @param opt The limits applied by the pool.
+    */
+    connection_pool(
+        executor_type const& ex,
+        factory_type factory,
+        options const& opt = {});
+
+    /// Return the executor associated with the pool.
+    executor_type
+    get_executor() const noexcept;
+
+    /// Return the limits applied by the pool.
+    options const&
+    get_options() const noexcept;
+
+    /** Return the number of connections to an origin.
+
+        This counts both idle and leased connections.
+    */
+    std::size_t
+    size(pool_key const& key) const;
+
+    /// Return the number of idle connections to an origin.
+    std::size_t
+    idle(pool_key const& key) const;
+
+    /** Acquire a stream for an origin.
+
+        This function is used to asynchronously obtain an exclusive
+        lease on a stream for the specified origin. If an idle
+        connection to the origin is available it is reused,
+        otherwise a new stream is created if the per-origin limit
+        allows it. If not, the operation waits until another lease
+        for the same origin is released.
+
+        @param key The origin to acquire a stream for.
+
+        @param handler The completion handler to invoke when the
+        operation completes. The implementation takes ownership of
+        the handler by performing a decay-copy. The equivalent
+        function signature of the handler must be:
+        @code
+        void handler(
+            error_code const& error,    // result of operation
+            lease l                     // the acquired stream
+        );
+        @endcode
+        Regardless of whether the asynchronous operation completes
+        immediately or not, the handler will not be invoked from within
+        this function. Invocation of the handler will be performed in a
+        manner equivalent to using `net::post`.
+    */
+    template<
+        BOOST_ASIO_COMPLETION_TOKEN_FOR(void(error_code, lease))
+            AcquireHandler =
+                net::default_completion_token_t<executor_type>>
+    BOOST_ASIO_INITFN_AUTO_RESULT_TYPE(
+        AcquireHandler, void(error_code, lease))
+    async_acquire(
+        pool_key const& key,
+        AcquireHandler&& handler =
+            net::default_completion_token_t<executor_type>{});
+
+    /** Close all idle connections and abort pending operations.
+
+        Pending calls to @ref async_acquire complete with
+        `net::error::operation_aborted`, as will any subsequent
+        calls. Outstanding leases remain valid, but their streams
+        are destroyed when released.
+    */
+    void
+    close();
+};
+
+} // http
+} // beast
+} // boost
+
+#include <boost/beast/_experimental/http/impl/connection_pool.hpp>
+
+#endif
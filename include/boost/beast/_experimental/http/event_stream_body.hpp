@@ -0,0 +1,233 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_EVENT_STREAM_BODY_HPP
+#define BOOST_BEAST_HTTP_EVENT_STREAM_BODY_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+/** A <em>Body</em> for a stream of Server-Sent Events.
+
+    The body of a message using this type is a queue of events
+    which producers fill from any thread while the response is
+    being sent. Each time the serializer asks for more body data,
+    everything queued so far is taken at once, so events which
+    accumulate during a write are sent together as a single chunk
+    by the next write.
+
+    When the queue is empty, the serializer reports
+    @ref error::need_buffer, and the write operation completes
+    with that error. The callback set with
+    @ref value_type::on_ready is invoked once the next event
+    arrives, and the session then writes again. Because of this,
+    the header must be sent first using @ref write_header or
+    @ref async_write_header, as with @ref buffer_body.
+
+    @code
+    // In the session, on its strand
+    res_.chunked(true);
+    res_.set(field::content_type, "text/event-stream");
+    res_.body().on_ready(
+        [self = weak_from_this()]
+        {
+            if(auto sp = self.lock())
+                net::post(sp->stream_.get_executor(),
+                    [sp]{ sp->do_write(); });
+        });
+
+    void do_write()
+    {
+        if(writing_)
+            return;
+        writing_ = true;
+        http::async_write(stream_, sr_,
+            beast::bind_front_handler(
+                &session::on_write, shared_from_this()));
+    }
+
+    void on_write(beast::error_code ec, std::size_t)
+    {
+        writing_ = false;
+        if(ec == http::error::need_buffer)
+        {
+            // An event may have arrived since the
+            // serializer found the queue empty.
+            if(res_.body().size() > 0)
+                do_write();
+            return;
+        }
+        ...
+    }
+
+    // From any thread
+    events.push("{\"cpu\":42}", "load");
+    @endcode
+
+    The queue holds at most @ref value_type::limit bytes of
+    formatted events. When it is full, @ref value_type::push
+    returns `false` and the producer decides whether to drop
+    the event or slow down.
+*/
+struct event_stream_body
+{
+    class writer;
+
+    /** The type of the body member when used in a message.
+
+        Copies refer to the same queue, so producers may hold
+        a copy of the body of a response being sent.
+
+        @par Thread Safety
+        @e Distinct @e objects: Safe.@n
+        @e Shared @e objects: Safe.
+    */
+    class value_type
+    {
+        friend class writer;
+
+        struct state;
+
+        boost::shared_ptr<state> sp_;
+
+    public:
+        /** Constructor
+
+            @param limit The maximum number of bytes of
+            formatted events which may be queued.
+        */
+        BOOST_BEAST_DECL
+        explicit
+        value_type(std::size_t limit = 1024 * 1024);
+
+        /// Returns the maximum number of bytes which may be queued.
+        BOOST_BEAST_DECL
+        std::size_t
+        limit() const;
+
+        /// Set the maximum number of bytes which may be queued.
+        BOOST_BEAST_DECL
+        void
+        limit(std::size_t n);
+
+        /// Returns the number of bytes waiting to be sent.
+        BOOST_BEAST_DECL
+        std::size_t
+        size() const;
+
+        /// Returns `true` if the stream accepts events.
+        BOOST_BEAST_DECL
+        bool
+        is_open() const;
+
+        /** Queue an event.
+
+            The event is formatted into the queue immediately. Each
+            line of `data` becomes a `data:` field, and a blank line
+            ends the event.
+
+            @param data The data of the event.
+
+            @param type The event type, sent in an `event:` field
+            when not empty. It must not contain line breaks.
+
+            @param id The event id, sent in an `id:` field when not
+            empty. It must not contain line breaks.
+
+            @return `true` if the event was queued, or `false` if
+            the queue is full or closed.
+        */
+        BOOST_BEAST_DECL
+        bool
+        push(
+            string_view data,
+            string_view type = {},
+            string_view id = {});
+
+        /** End the stream.
+
+            Events already queued are still sent, followed by the
+            end of the body. Later calls to @ref push fail.
+        */
+        BOOST_BEAST_DECL
+        void
+        close();
+
+        /** Set the function invoked when events are ready.
+
+            The function is invoked once each time an event is
+            queued, or the stream is closed, after the serializer
+            found the queue empty. It is called from the thread
+            which queued the event, without any lock held, and
+            should post the next write to the session's executor.
+        */
+        BOOST_BEAST_DECL
+        void
+        on_ready(std::function<void()> f);
+    };
+
+    /** The algorithm for serializing the body
+
+        Meets the requirements of <em>BodyWriter</em>.
+    */
+#if BOOST_BEAST_DOXYGEN
+    using writer = __implementation_defined__;
+#else
+    class writer
+    {
+        boost::shared_ptr<value_type::state> sp_;
+        flat_buffer buf_;
+
+    public:
+        using const_buffers_type =
+            net::const_buffer;
+
+        template<bool isRequest, class Fields>
+        explicit
+        writer(header<isRequest, Fields> const&, value_type const& b)
+            : sp_(b.sp_)
+        {
+        }
+
+        void
+        init(error_code& ec)
+        {
+            ec = {};
+        }
+
+        BOOST_BEAST_DECL
+        boost::optional<
+            std::pair<const_buffers_type, bool>>
+        get(error_code& ec);
+    };
+#endif
+};
+
+} // http
+} // beast
+} // boost
+
+#ifdef BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/_experimental/http/impl/event_stream_body.ipp>
+#endif
+
+#endif
@@ -0,0 +1,345 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_IMPL_AWAITABLE_HPP
+#define BOOST_BEAST_HTTP_IMPL_AWAITABLE_HPP
+
+#include <boost/beast/http/error.hpp>
+#include <boost/beast/http/parser.hpp>
+#include <boost/beast/core/read_size.hpp>
+#include <boost/beast/core/span.hpp>
+#include <boost/beast/core/stream_traits.hpp>
+#include <boost/beast/core/detail/buffer.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/throw_exception.hpp>
+#include <array>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+namespace detail {
+
+// Parse the buffered octets, reading from the
+// stream only when the parser needs more.
+template<
+    class Executor,
+    class AsyncReadStream,
+    class DynamicBuffer,
+    bool isRequest>
+net::awaitable<std::size_t, Executor>
+co_read_some(
+    AsyncReadStream& s,
+    DynamicBuffer& b,
+    basic_parser<isRequest>& p,
+    error_code& ec)
+{
+    std::size_t total = 0;
+    ec = {};
+    if(b.size() > 0)
+    {
+        auto const used = p.put(b.data(), ec);
+        total += used;
+        b.consume(used);
+        if(ec != http::error::need_more)
+            co_return total;
+    }
+    for(;;)
+    {
+        auto const size = read_size(b, 65536);
+        if(size == 0)
+        {
+            ec = error::buffer_overflow;
+            co_return total;
+        }
+        auto const mb =
+            beast::detail::dynamic_buffer_prepare(
+                b, size, ec, error::buffer_overflow);
+        if(ec)
+            co_return total;
+        auto const bytes_transferred =
+            co_await s.async_read_some(*mb,
+                net::redirect_error(
+                    net::use_awaitable_t<Executor>{}, ec));
+        b.commit(bytes_transferred);
+        if(ec == net::error::eof)
+        {
+            BOOST_ASSERT(bytes_transferred == 0);
+            if(p.got_some())
+            {
+                // caller sees EOF on next read
+                ec = {};
+                p.put_eof(ec);
+                BOOST_ASSERT(ec || p.is_done());
+                co_return total;
+            }
+            ec = error::end_of_stream;
+            co_return total;
+        }
+        if(ec)
+            co_return total;
+        auto const used = p.put(b.data(), ec);
+        total += used;
+        b.consume(used);
+        if(ec != http::error::need_more)
+            co_return total;
+    }
+}
+
+} // detail
+
+//------------------------------------------------------------------------------
+
+template<
+    class Executor,
+    class AsyncReadStream,
+    class DynamicBuffer,
+    bool isRequest>
+net::awaitable<std::size_t, Executor>
+co_read(
+    AsyncReadStream& stream,
+    DynamicBuffer& buffer,
+    basic_parser<isRequest>& parser,
+    error_code& ec)
+{
+    static_assert(
+        is_async_read_stream<AsyncReadStream>::value,
+        "AsyncReadStream type requirements not met");
+    static_assert(
+        net::is_dynamic_buffer<DynamicBuffer>::value,
+        "DynamicBuffer type requirements not met");
+    parser.eager(true);
+    ec = {};
+    std::size_t total = 0;
+    while(! parser.is_done())
+    {
+        total += co_await detail::co_read_some<Executor>(
+            stream, buffer, parser, ec);
+        if(ec)
+            break;
+    }
+    co_return total;
+}
+
+template<
+    class Executor,
+    class AsyncReadStream,
+    class DynamicBuffer,
+    bool isRequest>
+net::awaitable<std::size_t, Executor>
+co_read(
+    AsyncReadStream& stream,
+    DynamicBuffer& buffer,
+    basic_parser<isRequest>& parser)
+{
+    error_code ec;
+    auto const bytes_transferred =
+        co_await http::co_read<Executor>(
+            stream, buffer, parser, ec);
+    if(ec)
+        BOOST_THROW_EXCEPTION(system_error{ec});
+    co_return bytes_transferred;
+}
+
+template<
+    class Executor,
+    class AsyncReadStream,
+    class DynamicBuffer,
+    bool isRequest, class Body, class Allocator>
+net::awaitable<std::size_t, Executor>
+co_read(
+    AsyncReadStream& stream,
+    DynamicBuffer& buffer,
+    message<isRequest, Body, basic_fields<Allocator>>& msg,
+    error_code& ec)
+{
+    static_assert(is_body<Body>::value,
+        "Body type requirements not met");
+    static_assert(is_body_reader<Body>::value,
+        "BodyReader type requirements not met");
+    parser<isRequest, Body, Allocator> p(std::move(msg));
+    auto const bytes_transferred =
+        co_await http::co_read<Executor>(
+            stream, buffer, p, ec);
+    if(! ec)
+        msg = p.release();
+    co_return bytes_transferred;
+}
+
+template<
+    class Executor,
+    class AsyncReadStream,
+    class DynamicBuffer,
+    bool isRequest, class Body, class Allocator>
+net::awaitable<std::size_t, Executor>
+co_read(
+    AsyncReadStream& stream,
+    DynamicBuffer& buffer,
+    message<isRequest, Body, basic_fields<Allocator>>& msg)
+{
+    error_code ec;
+    auto const bytes_transferred =
+        co_await http::co_read<Executor>(
+            stream, buffer, msg, ec);
+    if(ec)
+        BOOST_THROW_EXCEPTION(system_error{ec});
+    co_return bytes_transferred;
+}
+
+//------------------------------------------------------------------------------
+
+template<
+    class Executor,
+    class AsyncWriteStream,
+    bool isRequest, class Body, class Fields>
+net::awaitable<std::size_t, Executor>
+co_write(
+    AsyncWriteStream& stream,
+    serializer<isRequest, Body, Fields>& sr,
+    error_code& ec)
+{
+    static_assert(is_async_write_stream<
+            AsyncWriteStream>::value,
+        "AsyncWriteStream type requirements not met");
+    static_assert(is_body<Body>::value,
+        "Body type requirements not met");
+    static_assert(is_body_writer<Body>::value,
+        "BodyWriter type requirements not met");
+
+    // The serializer's buffer sequence cannot be held across a
+    // suspension point, so its elements are copied here. A longer
+    // sequence is sent in parts, as a short write would be.
+    std::array<net::const_buffer, 16> v;
+    std::size_t n;
+
+    sr.split(false);
+    ec = {};
+    std::size_t total = 0;
+    while(! sr.is_done())
+    {
+        n = 0;
+        sr.next(ec,
+            [&v, &n](error_code& ec_, auto const& buffers)
+            {
+                ec_ = {};
+                for(auto it = net::buffer_sequence_begin(buffers);
+                    n < v.size() &&
+                    it != net::buffer_sequence_end(buffers); ++it)
+                    v[n++] = *it;
+            });
+        if(ec)
+            break;
+        auto const bytes_transferred =
+            co_await stream.async_write_some(
+                span<net::const_buffer const>(v.data(), n),
+                net::redirect_error(
+                    net::use_awaitable_t<Executor>{}, ec));
+        total += bytes_transferred;
+        if(ec)
+            break;
+        sr.consume(bytes_transferred);
+    }
+    co_return total;
+}
+
+template<
+    class Executor,
+    class AsyncWriteStream,
+    bool isRequest, class Body, class Fields>
+net::awaitable<std::size_t, Executor>
+co_write(
+    AsyncWriteStream& stream,
+    serializer<isRequest, Body, Fields>& sr)
+{
+    error_code ec;
+    auto const bytes_transferred =
+        co_await http::co_write<Executor>(stream, sr, ec);
+    if(ec)
+        BOOST_THROW_EXCEPTION(system_error{ec});
+    co_return bytes_transferred;
+}
+
+template<
+    class Executor,
+    class AsyncWriteStream,
+    bool isRequest, class Body, class Fields>
+typename std::enable_if<
+    is_mutable_body_writer<Body>::value,
+    net::awaitable<std::size_t, Executor>>::type
+co_write(
+    AsyncWriteStream& stream,
+    message<isRequest, Body, Fields>& msg,
+    error_code& ec)
+{
+    serializer<isRequest, Body, Fields> sr(msg);
+    co_return co_await http::co_write<Executor>(stream, sr, ec);
+}
+
+template<
+    class Executor,
+    class AsyncWriteStream,
+    bool isRequest, class Body, class Fields>
+typename std::enable_if<
+    ! is_mutable_body_writer<Body>::value,
+    net::awaitable<std::size_t, Executor>>::type
+co_write(
+    AsyncWriteStream& stream,
+    message<isRequest, Body, Fields> const& msg,
+    error_code& ec)
+{
+    serializer<isRequest, Body, Fields> sr(msg);
+    co_return co_await http::co_write<Executor>(stream, sr, ec);
+}
+
+template<
+    class Executor,
+    class AsyncWriteStream,
+    bool isRequest, class Body, class Fields>
+typename std::enable_if<
+    is_mutable_body_writer<Body>::value,
+    net::awaitable<std::size_t, Executor>>::type
+co_write(
+    AsyncWriteStream& stream,
+    message<isRequest, Body, Fields>& msg)
+{
+    error_code ec;
+    auto const bytes_transferred =
+        co_await http::co_write<Executor>(stream, msg, ec);
+    if(ec)
+        BOOST_THROW_EXCEPTION(system_error{ec});
+    co_return bytes_transferred;
+}
+
+template<
+    class Executor,
+    class AsyncWriteStream,
+    bool isRequest, class Body, class Fields>
+typename std::enable_if<
+    ! is_mutable_body_writer<Body>::value,
+    net::awaitable<std::size_t, Executor>>::type
+co_write(
+    AsyncWriteStream& stream,
+    message<isRequest, Body, Fields> const& msg)
+{
+    error_code ec;
+    auto const bytes_transferred =
+        co_await http::co_write<Executor>(stream, msg, ec);
+    if(ec)
+        BOOST_THROW_EXCEPTION(system_error{ec});
+    co_return bytes_transferred;
+}
+
+} // http
+} // beast
+} // boost
+
+#endif
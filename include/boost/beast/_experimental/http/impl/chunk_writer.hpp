@@ -0,0 +1,221 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_IMPL_CHUNK_WRITER_HPP
+#define BOOST_BEAST_HTTP_IMPL_CHUNK_WRITER_HPP
+
+#include <boost/beast/core/async_base.hpp>
+#include <boost/beast/core/buffer_traits.hpp>
+#include <boost/beast/core/buffers_cat.hpp>
+#include <boost/beast/core/detail/is_invocable.hpp>
+#include <boost/beast/http/detail/chunk_encode.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/coroutine.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/throw_exception.hpp>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+template<class Stream, class DynamicBuffer>
+template<class Handler>
+class chunk_writer<Stream, DynamicBuffer>::flush_op
+    : public beast::async_base<
+        Handler, beast::executor_type<Stream>>
+    , public asio::coroutine
+{
+    chunk_writer& w_;
+    std::size_t bytes_written_ = 0;
+
+public:
+    template<class Handler_>
+    flush_op(
+        Handler_&& h,
+        chunk_writer& w)
+        : async_base<Handler,
+            beast::executor_type<Stream>>(
+                std::forward<Handler_>(h),
+                    w.stream_.get_executor())
+        , w_(w)
+    {
+        w_.flushing_ = true;
+        (*this)({}, 0, false);
+    }
+
+    void
+    operator()(
+        error_code ec,
+        std::size_t bytes_transferred,
+        bool cont = true)
+    {
+        BOOST_ASIO_CORO_REENTER(*this)
+        {
+            for(;;)
+            {
+                // Leftovers from a failed flush go first,
+                // then new chunks go to the other buffer.
+                if(w_.buf_[w_.in_ ^ 1].size() == 0)
+                {
+                    if(w_.buf_[w_.in_].size() == 0)
+                        break;
+                    w_.in_ ^= 1;
+                }
+                BOOST_ASIO_CORO_YIELD
+                net::async_write(w_.stream_,
+                    w_.buf_[w_.in_ ^ 1].data(),
+                        std::move(*this));
+                w_.buf_[w_.in_ ^ 1].consume(bytes_transferred);
+                bytes_written_ += bytes_transferred;
+                if(ec)
+                    break;
+            }
+            w_.flushing_ = false;
+            this->complete(cont, ec, bytes_written_);
+        }
+    }
+};
+
+template<class Stream, class DynamicBuffer>
+struct chunk_writer<Stream, DynamicBuffer>::
+    run_flush_op
+{
+    template<class WriteHandler>
+    void
+    operator()(
+        WriteHandler&& h,
+        chunk_writer* w)
+    {
+        // If you get an error on the following line it means
+        // that your handler does not meet the documented type
+        // requirements for the handler.
+
+        static_assert(
+            beast::detail::is_invocable<WriteHandler,
+                void(error_code, std::size_t)>::value,
+            "WriteHandler type requirements not met");
+
+        flush_op<
+            typename std::decay<WriteHandler>::type>(
+                std::forward<WriteHandler>(h), *w);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+template<class Stream, class DynamicBuffer>
+template<class... Args>
+chunk_writer<Stream, DynamicBuffer>::
+chunk_writer(Stream& stream, Args const&... args)
+    : stream_(stream)
+    , buf_{DynamicBuffer(args...), DynamicBuffer(args...)}
+{
+}
+
+template<class Stream, class DynamicBuffer>
+template<class ConstBufferSequence>
+void
+chunk_writer<Stream, DynamicBuffer>::
+append(ConstBufferSequence const& buffers)
+{
+    static_assert(
+        net::is_const_buffer_sequence<ConstBufferSequence>::value,
+        "ConstBufferSequence type requirements not met");
+    auto const n = buffer_bytes(buffers);
+    if(n == 0)
+        return;
+    // The chunk-size line is formatted on the stack and the
+    // whole chunk is copied into the buffer with one prepare.
+    char hex[2 * sizeof(std::size_t)];
+    char* const last = hex + sizeof(hex);
+    char* const first = detail::chunk_size::format(last, n);
+    auto const cb = buffers_cat(
+        net::const_buffer(first,
+            static_cast<std::size_t>(last - first)),
+        detail::chunk_crlf(),
+        buffers,
+        detail::chunk_crlf());
+    auto& b = buf_[in_];
+    auto const size = buffer_bytes(cb);
+    b.commit(net::buffer_copy(b.prepare(size), cb));
+}
+
+template<class Stream, class DynamicBuffer>
+void
+chunk_writer<Stream, DynamicBuffer>::
+append_last()
+{
+    auto& b = buf_[in_];
+    b.commit(net::buffer_copy(
+        b.prepare(5), net::buffer("0\r\n\r\n", 5)));
+}
+
+template<class Stream, class DynamicBuffer>
+std::size_t
+chunk_writer<Stream, DynamicBuffer>::
+flush()
+{
+    error_code ec;
+    auto const n = flush(ec);
+    if(ec)
+        BOOST_THROW_EXCEPTION(system_error{ec});
+    return n;
+}
+
+template<class Stream, class DynamicBuffer>
+std::size_t
+chunk_writer<Stream, DynamicBuffer>::
+flush(error_code& ec)
+{
+    static_assert(is_sync_write_stream<Stream>::value,
+        "SyncWriteStream type requirements not met");
+    BOOST_ASSERT(! flushing_);
+    ec = {};
+    std::size_t n = 0;
+    // Leftovers from a failed flush go first
+    for(auto const i : {in_ ^ 1, in_})
+    {
+        auto& b = buf_[i];
+        if(b.size() == 0)
+            continue;
+        auto const bytes_transferred =
+            net::write(stream_, b.data(), ec);
+        b.consume(bytes_transferred);
+        n += bytes_transferred;
+        if(ec)
+            break;
+    }
+    return n;
+}
+
+template<class Stream, class DynamicBuffer>
+template<BOOST_BEAST_ASYNC_TPARAM2 WriteHandler>
+BOOST_BEAST_ASYNC_RESULT2(WriteHandler)
+chunk_writer<Stream, DynamicBuffer>::
+async_flush(WriteHandler&& handler)
+{
+    static_assert(is_async_write_stream<Stream>::value,
+        "AsyncWriteStream type requirements not met");
+    BOOST_ASSERT(! flushing_);
+    return net::async_initiate<
+        WriteHandler,
+        void(error_code, std::size_t)>(
+            run_flush_op{},
+            handler,
+            this);
+}
+
+} // http
+} // beast
+} // boost
+
+#endif
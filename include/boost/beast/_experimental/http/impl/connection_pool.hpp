@@ -0,0 +1,584 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_IMPL_CONNECTION_POOL_HPP
+#define BOOST_BEAST_HTTP_IMPL_CONNECTION_POOL_HPP
+
+#include <boost/beast/core/async_base.hpp>
+#include <boost/beast/core/detail/is_invocable.hpp>
+#include <boost/asio/coroutine.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/assert.hpp>
+#include <boost/container_hash/hash.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/make_shared.hpp>
+#include <utility>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+namespace detail {
+
+struct pool_key_hash
+{
+    std::size_t
+    operator()(pool_key const& key) const noexcept
+    {
+        std::size_t seed = 0;
+        boost::hash_combine(seed, key.host);
+        boost::hash_combine(seed, key.port);
+        boost::hash_combine(seed, key.context);
+        return seed;
+    }
+};
+
+} // detail
+
+template<class Stream>
+struct connection_pool<Stream>::connection
+{
+    Stream stream;
+    pool_key key;
+    clock_type::time_point idle_since;
+    std::size_t uses = 1;
+
+    connection(Stream&& s, pool_key const& key_)
+        : stream(std::move(s))
+        , key(key_)
+    {
+    }
+};
+
+template<class Stream>
+struct connection_pool<Stream>::impl_type
+    : boost::enable_shared_from_this<impl_type>
+{
+    struct host_type
+    {
+        // Ordered by time of release, oldest first
+        std::vector<std::unique_ptr<connection>> idle;
+
+        // Idle and leased connections
+        std::size_t count = 0;
+
+        // Paused acquire operations
+        std::deque<saved_handler> waiters;
+
+        // A connection released to the front waiter
+        std::unique_ptr<connection> handoff;
+    };
+
+    using timer_type = net::basic_waitable_timer<
+        clock_type, net::wait_traits<clock_type>, executor_type>;
+
+    executor_type ex;
+    factory_type factory;
+    options opt;
+    timer_type timer;
+    std::unordered_map<pool_key,
+        host_type, detail::pool_key_hash> hosts;
+    std::size_t idle_total = 0;
+    bool timer_running = false;
+    bool closed = false;
+
+    class timeout_handler
+    {
+        boost::weak_ptr<impl_type> wp_;
+
+    public:
+        explicit
+        timeout_handler(boost::weak_ptr<impl_type> wp)
+            : wp_(std::move(wp))
+        {
+        }
+
+        void
+        operator()(error_code ec)
+        {
+            // timer canceled?
+            if(ec == net::error::operation_aborted)
+                return;
+
+            // pool destroyed?
+            auto sp = wp_.lock();
+            if(! sp)
+                return;
+            sp->timer_running = false;
+            sp->sweep();
+            sp->start_timer();
+        }
+    };
+
+    impl_type(
+        executor_type const& ex_,
+        factory_type&& factory_,
+        options const& opt_)
+        : ex(ex_)
+        , factory(std::move(factory_))
+        , opt(opt_)
+        , timer(ex_)
+    {
+    }
+
+    lease
+    make_lease(std::unique_ptr<connection> c)
+    {
+        return lease(this->weak_from_this(), std::move(c));
+    }
+
+    // Obtain a connection for the key, or
+    // return `false` if the caller must wait.
+    bool
+    try_acquire(
+        pool_key const& key,
+        std::unique_ptr<connection>& c)
+    {
+        auto& h = hosts[key];
+
+        // Queue behind earlier waiters
+        if(! h.waiters.empty())
+            return false;
+        auto const now = clock_type::now();
+        while(! h.idle.empty())
+        {
+            auto p = std::move(h.idle.back());
+            h.idle.pop_back();
+            on_idle_removed(1);
+            if(now - p->idle_since < opt.idle_timeout)
+            {
+                ++p->uses;
+                c = std::move(p);
+                return true;
+            }
+            // expired, close it
+            --h.count;
+        }
+        if( opt.max_per_host != 0 &&
+            h.count >= opt.max_per_host)
+            return false;
+        c.reset(new connection(factory(key), key));
+        ++h.count;
+        return true;
+    }
+
+    // Obtain the connection released to the front
+    // waiter, or a new one in the slot it freed.
+    void
+    take_handoff(
+        pool_key const& key,
+        std::unique_ptr<connection>& c)
+    {
+        auto& h = hosts[key];
+        if(h.handoff)
+        {
+            c = std::move(h.handoff);
+            ++c->uses;
+            return;
+        }
+        c.reset(new connection(factory(key), key));
+        ++h.count;
+    }
+
+    void
+    release(std::unique_ptr<connection> c, bool keep_alive)
+    {
+        auto const it = hosts.find(c->key);
+        BOOST_ASSERT(it != hosts.end());
+        auto& h = it->second;
+        bool const keep = keep_alive && ! closed && (
+            opt.max_requests == 0 ||
+            c->uses < opt.max_requests);
+        if(! h.waiters.empty())
+        {
+            // The connection, or its slot, goes to the oldest
+            // waiter before a later acquire can take it.
+            if(keep)
+            {
+                h.handoff = std::move(c);
+            }
+            else
+            {
+                c.reset();
+                --h.count;
+            }
+            auto w = std::move(h.waiters.front());
+            h.waiters.pop_front();
+            w.invoke();
+            return;
+        }
+        if(keep && h.idle.size() < opt.max_idle_per_host)
+        {
+            c->idle_since = clock_type::now();
+            h.idle.emplace_back(std::move(c));
+            ++idle_total;
+            start_timer();
+        }
+        else
+        {
+            c.reset();
+            --h.count;
+            if(h.count == 0)
+                hosts.erase(it);
+        }
+    }
+
+    // Close expired idle connections
+    void
+    sweep()
+    {
+        auto const now = clock_type::now();
+        for(auto it = hosts.begin(); it != hosts.end();)
+        {
+            auto& h = it->second;
+            auto n = std::size_t(0);
+            while(n < h.idle.size() &&
+                now - h.idle[n]->idle_since >= opt.idle_timeout)
+                ++n;
+            h.idle.erase(h.idle.begin(), h.idle.begin() + n);
+            h.count -= n;
+            on_idle_removed(n);
+            if(h.count == 0 && h.waiters.empty())
+                it = hosts.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    // Stop the timer when nothing is idle, so
+    // the pool does not keep the context running.
+    void
+    on_idle_removed(std::size_t n)
+    {
+        BOOST_ASSERT(idle_total >= n);
+        idle_total -= n;
+        if(idle_total == 0 && timer_running)
+        {
+            timer.cancel();
+            timer_running = false;
+        }
+    }
+
+    // Arm the timer for the oldest idle connection
+    void
+    start_timer()
+    {
+        if(timer_running || closed || idle_total == 0)
+            return;
+        bool found = false;
+        clock_type::time_point oldest;
+        for(auto const& v : hosts)
+        {
+            if(v.second.idle.empty())
+                continue;
+            auto const t = v.second.idle.front()->idle_since;
+            if(! found || t < oldest)
+                oldest = t;
+            found = true;
+        }
+        if(! found)
+            return;
+        timer_running = true;
+        timer.expires_at(oldest + opt.idle_timeout);
+        timer.async_wait(timeout_handler(this->weak_from_this()));
+    }
+
+    void
+    close()
+    {
+        if(closed)
+            return;
+        closed = true;
+        timer.cancel();
+        timer_running = false;
+        idle_total = 0;
+        std::vector<saved_handler> v;
+        for(auto it = hosts.begin(); it != hosts.end();)
+        {
+            auto& h = it->second;
+            h.count -= h.idle.size();
+            h.idle.clear();
+            for(auto& w : h.waiters)
+                v.emplace_back(std::move(w));
+            h.waiters.clear();
+            if(h.count == 0)
+                it = hosts.erase(it);
+            else
+                ++it;
+        }
+        for(auto& w : v)
+            w.invoke();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+template<class Stream>
+template<class Handler>
+class connection_pool<Stream>::acquire_op
+    : public beast::async_base<Handler, executor_type>
+    , public asio::coroutine
+{
+    boost::weak_ptr<impl_type> wp_;
+    pool_key key_;
+    std::unique_ptr<connection> c_;
+
+public:
+    template<class Handler_>
+    acquire_op(
+        Handler_&& h,
+        boost::shared_ptr<impl_type> const& sp,
+        pool_key const& key)
+        : async_base<Handler, executor_type>(
+            std::forward<Handler_>(h), sp->ex)
+        , wp_(sp)
+        , key_(key)
+    {
+        (*this)(false);
+    }
+
+    void
+    operator()(bool cont = true)
+    {
+        auto sp = wp_.lock();
+        BOOST_ASIO_CORO_REENTER(*this)
+        {
+            if( sp && ! sp->closed &&
+                ! sp->try_acquire(key_, c_))
+            {
+                // Wait for a lease to be released
+                BOOST_ASIO_CORO_YIELD
+                {
+                    auto& w = sp->hosts[key_].waiters;
+                    w.emplace_back();
+                    w.back().emplace(std::move(*this));
+                }
+                if(! sp->closed)
+                    sp->take_handoff(key_, c_);
+
+                // Woken from within release or close
+                BOOST_ASIO_CORO_YIELD
+                net::post(std::move(*this));
+
+                // Pool destroyed?
+                if(! sp)
+                    c_.reset();
+            }
+            if(! c_)
+                this->complete(cont,
+                    net::error::operation_aborted, lease{});
+            else
+                this->complete(cont, error_code{},
+                    sp->make_lease(std::move(c_)));
+        }
+    }
+};
+
+template<class Stream>
+struct connection_pool<Stream>::run_acquire_op
+{
+    template<class AcquireHandler>
+    void
+    operator()(
+        AcquireHandler&& h,
+        boost::shared_ptr<impl_type> const& sp,
+        pool_key const& key)
+    {
+        // If you get an error on the following line it means
+        // that your handler does not meet the documented type
+        // requirements for the handler.
+
+        static_assert(
+            beast::detail::is_invocable<AcquireHandler,
+                void(error_code, lease)>::value,
+            "AcquireHandler type requirements not met");
+
+        acquire_op<
+            typename std::decay<AcquireHandler>::type>(
+                std::forward<AcquireHandler>(h), sp, key);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+template<class Stream>
+connection_pool<Stream>::
+lease::
+lease(
+    boost::weak_ptr<impl_type> wp,
+    std::unique_ptr<connection> c)
+    : wp_(std::move(wp))
+    , c_(std::move(c))
+{
+}
+
+template<class Stream>
+auto
+connection_pool<Stream>::
+lease::
+operator=(lease&& other) ->
+    lease&
+{
+    if(this == &other)
+        return *this;
+    if(c_)
+        release(false);
+    wp_ = std::move(other.wp_);
+    c_ = std::move(other.c_);
+    return *this;
+}
+
+template<class Stream>
+connection_pool<Stream>::
+lease::
+~lease()
+{
+    if(c_)
+        release(false);
+}
+
+template<class Stream>
+auto
+connection_pool<Stream>::
+lease::
+stream() noexcept ->
+    stream_type&
+{
+    BOOST_ASSERT(c_);
+    return c_->stream;
+}
+
+template<class Stream>
+bool
+connection_pool<Stream>::
+lease::
+is_new() const noexcept
+{
+    BOOST_ASSERT(c_);
+    return c_->uses == 1;
+}
+
+template<class Stream>
+std::size_t
+connection_pool<Stream>::
+lease::
+use_count() const noexcept
+{
+    BOOST_ASSERT(c_);
+    return c_->uses;
+}
+
+template<class Stream>
+void
+connection_pool<Stream>::
+lease::
+release(bool keep_alive)
+{
+    BOOST_ASSERT(c_);
+    if(auto sp = wp_.lock())
+        sp->release(std::move(c_), keep_alive);
+    else
+        c_.reset();
+    wp_.reset();
+}
+
+//------------------------------------------------------------------------------
+
+template<class Stream>
+connection_pool<Stream>::
+~connection_pool()
+{
+    impl_->close();
+}
+
+template<class Stream>
+connection_pool<Stream>::
+connection_pool(
+    executor_type const& ex,
+    factory_type factory,
+    options const& opt)
+    : impl_(boost::make_shared<impl_type>(
+        ex, std::move(factory), opt))
+{
+}
+
+template<class Stream>
+auto
+connection_pool<Stream>::
+get_executor() const noexcept ->
+    executor_type
+{
+    return impl_->ex;
+}
+
+template<class Stream>
+auto
+connection_pool<Stream>::
+get_options() const noexcept ->
+    options const&
+{
+    return impl_->opt;
+}
+
+template<class Stream>
+std::size_t
+connection_pool<Stream>::
+size(pool_key const& key) const
+{
+    auto const it = impl_->hosts.find(key);
+    if(it == impl_->hosts.end())
+        return 0;
+    return it->second.count;
+}
+
+template<class Stream>
+std::size_t
+connection_pool<Stream>::
+idle(pool_key const& key) const
+{
+    auto const it = impl_->hosts.find(key);
+    if(it == impl_->hosts.end())
+        return 0;
+    return it->second.idle.size();
+}
+
+template<class Stream>
+template<
+    BOOST_ASIO_COMPLETION_TOKEN_FOR(void(error_code,
+        typename connection_pool<Stream>::lease)) AcquireHandler>
+BOOST_ASIO_INITFN_AUTO_RESULT_TYPE(
+    AcquireHandler, void(error_code,
+        typename connection_pool<Stream>::lease))
+connection_pool<Stream>::
+async_acquire(
+    pool_key const& key,
+    AcquireHandler&& handler)
+{
+    return net::async_initiate<
+        AcquireHandler,
+        void(error_code, lease)>(
+            run_acquire_op{},
+            handler,
+            impl_,
+            key);
+}
+
+template<class Stream>
+void
+connection_pool<Stream>::
+close()
+{
+    impl_->close();
+}
+
+} // http
+} // beast
+} // boost
+
+#endif
@@ -0,0 +1,239 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_IMPL_EVENT_STREAM_BODY_IPP
+#define BOOST_BEAST_HTTP_IMPL_EVENT_STREAM_BODY_IPP
+
+#include <boost/beast/_experimental/http/event_stream_body.hpp>
+#include <boost/beast/http/error.hpp>
+#include <boost/assert.hpp>
+#include <boost/make_shared.hpp>
+#include <cstring>
+#include <mutex>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+struct event_stream_body::value_type::state
+{
+    std::mutex m;
+    flat_buffer pending;
+    std::size_t limit;
+    bool closed = false;
+    bool waiting = false;
+    std::function<void()> ready;
+
+    explicit
+    state(std::size_t limit_)
+        : limit(limit_)
+    {
+    }
+
+    // Called with the lock held. Returns the
+    // function to invoke once the lock is released.
+    std::function<void()>
+    wake()
+    {
+        if(! waiting)
+            return {};
+        waiting = false;
+        return ready;
+    }
+};
+
+namespace detail {
+
+// Calls f(p, n) for each line of s, splitting on
+// CR, LF or CRLF as the event stream format does.
+template<class F>
+void
+for_each_event_line(string_view s, F const& f)
+{
+    auto p = s.data();
+    auto const end = p + s.size();
+    for(;;)
+    {
+        auto it = p;
+        while(it != end && *it != '\r' && *it != '\n')
+            ++it;
+        f(p, static_cast<std::size_t>(it - p));
+        if(it == end)
+            break;
+        if(*it == '\r' && it + 1 != end && it[1] == '\n')
+            ++it;
+        p = it + 1;
+    }
+}
+
+inline
+char*
+put_event_field(char* out,
+    char const* name, std::size_t name_len,
+    char const* p, std::size_t n)
+{
+    std::memcpy(out, name, name_len);
+    out += name_len;
+    if(n > 0)
+        std::memcpy(out, p, n);
+    out += n;
+    *out++ = '\n';
+    return out;
+}
+
+} // detail
+
+event_stream_body::value_type::
+value_type(std::size_t limit)
+    : sp_(boost::make_shared<state>(limit))
+{
+}
+
+std::size_t
+event_stream_body::value_type::
+limit() const
+{
+    std::lock_guard<std::mutex> lock(sp_->m);
+    return sp_->limit;
+}
+
+void
+event_stream_body::value_type::
+limit(std::size_t n)
+{
+    std::lock_guard<std::mutex> lock(sp_->m);
+    sp_->limit = n;
+}
+
+std::size_t
+event_stream_body::value_type::
+size() const
+{
+    std::lock_guard<std::mutex> lock(sp_->m);
+    return sp_->pending.size();
+}
+
+bool
+event_stream_body::value_type::
+is_open() const
+{
+    std::lock_guard<std::mutex> lock(sp_->m);
+    return ! sp_->closed;
+}
+
+bool
+event_stream_body::value_type::
+push(
+    string_view data,
+    string_view type,
+    string_view id)
+{
+    BOOST_ASSERT(type.find_first_of("\r\n") == string_view::npos);
+    BOOST_ASSERT(id.find_first_of("\r\n") == string_view::npos);
+
+    // Measure before taking the lock
+    std::size_t n = 1;
+    if(! type.empty())
+        n += 7 + type.size() + 1;
+    if(! id.empty())
+        n += 4 + id.size() + 1;
+    detail::for_each_event_line(data,
+        [&n](char const*, std::size_t len)
+        {
+            n += 6 + len + 1;
+        });
+
+    std::function<void()> f;
+    {
+        std::lock_guard<std::mutex> lock(sp_->m);
+        if(sp_->closed ||
+            n > sp_->limit - (std::min)(
+                sp_->limit, sp_->pending.size()))
+            return false;
+        auto const mb = sp_->pending.prepare(n);
+        auto out = static_cast<char*>(mb.data());
+        if(! type.empty())
+            out = detail::put_event_field(
+                out, "event: ", 7, type.data(), type.size());
+        if(! id.empty())
+            out = detail::put_event_field(
+                out, "id: ", 4, id.data(), id.size());
+        detail::for_each_event_line(data,
+            [&out](char const* p, std::size_t len)
+            {
+                out = detail::put_event_field(
+                    out, "data: ", 6, p, len);
+            });
+        *out++ = '\n';
+        BOOST_ASSERT(out == static_cast<char*>(mb.data()) + n);
+        sp_->pending.commit(n);
+        f = sp_->wake();
+    }
+    if(f)
+        f();
+    return true;
+}
+
+void
+event_stream_body::value_type::
+close()
+{
+    std::function<void()> f;
+    {
+        std::lock_guard<std::mutex> lock(sp_->m);
+        if(sp_->closed)
+            return;
+        sp_->closed = true;
+        f = sp_->wake();
+    }
+    if(f)
+        f();
+}
+
+void
+event_stream_body::value_type::
+on_ready(std::function<void()> f)
+{
+    std::lock_guard<std::mutex> lock(sp_->m);
+    sp_->ready = std::move(f);
+}
+
+//------------------------------------------------------------------------------
+
+auto
+event_stream_body::writer::
+get(error_code& ec) ->
+    boost::optional<std::pair<const_buffers_type, bool>>
+{
+    // The previous batch has been sent
+    buf_.clear();
+    std::lock_guard<std::mutex> lock(sp_->m);
+    if(sp_->pending.size() == 0)
+    {
+        if(sp_->closed)
+        {
+            ec = {};
+            return boost::none;
+        }
+        sp_->waiting = true;
+        ec = error::need_buffer;
+        return boost::none;
+    }
+    // Take everything queued, leaving the
+    // emptied buffer for the producers.
+    swap(buf_, sp_->pending);
+    ec = {};
+    return {{buf_.data(), ! sp_->closed}};
+}
+
+} // http
+} // beast
+} // boost
+
+#endif
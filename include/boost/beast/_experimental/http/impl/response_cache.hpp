@@ -0,0 +1,43 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_IMPL_RESPONSE_CACHE_HPP
+#define BOOST_BEAST_HTTP_IMPL_RESPONSE_CACHE_HPP
+
+#include <boost/beast/http/field.hpp>
+#include <boost/beast/http/verb.hpp>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+template<class Fields>
+cached_response
+response_cache::
+get(header<true, Fields> const& req,
+    string_view path,
+    string_view content_type,
+    error_code& ec)
+{
+    request_info info;
+    info.method = req.method();
+    info.target = req.target();
+    info.if_none_match = req[field::if_none_match];
+    info.head = req.method() == verb::head;
+    info.gzip = accepts_gzip(req[field::accept_encoding]);
+    info.keep_alive = keep_alive(req[field::connection], req.version());
+    info.version = req.version();
+    return get_impl(info, path, content_type, ec);
+}
+
+} // http
+} // beast
+} // boost
+
+#endif
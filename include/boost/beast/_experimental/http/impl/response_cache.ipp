@@ -0,0 +1,515 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_IMPL_RESPONSE_CACHE_IPP
+#define BOOST_BEAST_HTTP_IMPL_RESPONSE_CACHE_IPP
+
+#include <boost/beast/_experimental/http/response_cache.hpp>
+#include <boost/beast/core/file.hpp>
+#include <boost/beast/http/error.hpp>
+#include <boost/beast/http/rfc7230.hpp>
+#include <boost/asio/error.hpp>
+#include <cerrno>
+#include <cstdio>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+cached_response::
+cached_response(
+    status result,
+    shared_payload header,
+    string_view tail,
+    shared_payload body)
+    : header_(std::move(header))
+    , body_(std::move(body))
+    , n_(2)
+    , result_(result)
+{
+    b_[0] = net::const_buffer(header_.data(), header_.size());
+    b_[1] = net::const_buffer(tail.data(), tail.size());
+    if(! body_.empty())
+        b_[n_++] = net::const_buffer(body_.data(), body_.size());
+}
+
+std::size_t
+cached_response::
+size() const noexcept
+{
+    std::size_t n = 0;
+    for(auto const& b : *this)
+        n += b.size();
+    return n;
+}
+
+//------------------------------------------------------------------------------
+
+response_cache::
+~response_cache() = default;
+
+response_cache::
+response_cache()
+    : response_cache(options{})
+{
+}
+
+response_cache::
+response_cache(options const& opt)
+    : opt_(opt)
+{
+}
+
+void
+response_cache::
+invalidate(string_view target)
+{
+    std::lock_guard<std::mutex> lock(m_);
+    auto const it = map_.find(make_key(verb::get, target));
+    if(it == map_.end())
+        return;
+    bytes_ -= it->second->bytes;
+    lru_.erase(it->second);
+    map_.erase(it);
+}
+
+void
+response_cache::
+clear()
+{
+    std::lock_guard<std::mutex> lock(m_);
+    map_.clear();
+    lru_.clear();
+    bytes_ = 0;
+}
+
+std::size_t
+response_cache::
+size() const
+{
+    std::lock_guard<std::mutex> lock(m_);
+    return map_.size();
+}
+
+std::size_t
+response_cache::
+bytes() const
+{
+    std::lock_guard<std::mutex> lock(m_);
+    return bytes_;
+}
+
+std::size_t
+response_cache::
+hits() const
+{
+    std::lock_guard<std::mutex> lock(m_);
+    return hits_;
+}
+
+std::size_t
+response_cache::
+misses() const
+{
+    std::lock_guard<std::mutex> lock(m_);
+    return misses_;
+}
+
+std::string
+response_cache::
+make_key(verb method, string_view target)
+{
+    // HEAD is answered from the entry for GET
+    if(method == verb::head)
+        method = verb::get;
+    auto const m = to_string(method);
+    std::string s;
+    s.reserve(m.size() + 1 + target.size());
+    s.append(m.data(), m.size());
+    s.push_back(' ');
+    s.append(target.data(), target.size());
+    return s;
+}
+
+bool
+response_cache::
+accepts_gzip(string_view accept_encoding)
+{
+    for(auto const& e : ext_list{accept_encoding})
+    {
+        if(! beast::iequals(e.first, "gzip") &&
+            ! beast::iequals(e.first, "x-gzip"))
+            continue;
+        for(auto const& p : e.second)
+        {
+            if(! beast::iequals(p.first, "q"))
+                continue;
+            // q=0 means "not acceptable"
+            for(auto const c : p.second)
+                if(c != '0' && c != '.')
+                    return true;
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool
+response_cache::
+keep_alive(string_view connection, unsigned version)
+{
+    // Same rules as message::keep_alive
+    if(version < 11)
+        return token_list{connection}.exists("keep-alive");
+    return ! token_list{connection}.exists("close");
+}
+
+bool
+response_cache::
+etag_matches(string_view if_none_match, string_view etag)
+{
+    // The weak comparison function of rfc7232 section 2.3.2
+    auto const weak =
+        [](string_view s)
+        {
+            if(s.size() >= 2 && s[0] == 'W' && s[1] == '/')
+                s.remove_prefix(2);
+            return s;
+        };
+    auto it = if_none_match.begin();
+    auto const end = if_none_match.end();
+    for(;;)
+    {
+        while(it != end && (*it == ' ' || *it == '\t' || *it == ','))
+            ++it;
+        if(it == end)
+            return false;
+        auto const first = it;
+        while(it != end && *it != ',')
+            ++it;
+        auto last = it;
+        while(last != first && (last[-1] == ' ' || last[-1] == '\t'))
+            --last;
+        string_view const tag(&*first,
+            static_cast<std::size_t>(last - first));
+        if(tag == "*" || weak(tag) == weak(etag))
+            return true;
+    }
+}
+
+auto
+response_cache::
+stat_file(std::string const& path, error_code& ec) ->
+    file_stamp
+{
+    file_stamp st;
+#ifdef _WIN32
+    struct ::_stat64 sb;
+    if(::_stat64(path.c_str(), &sb) != 0)
+#else
+    struct ::stat sb;
+    if(::stat(path.c_str(), &sb) != 0)
+#endif
+    {
+        if(errno == ENOENT || errno == ENOTDIR)
+            ec = {};
+        else
+            ec.assign(errno, generic_category());
+        return st;
+    }
+    ec = {};
+    if((sb.st_mode & S_IFMT) != S_IFREG)
+        return st;
+    st.size = static_cast<std::uint64_t>(sb.st_size);
+    st.mtime = static_cast<std::uint64_t>(sb.st_mtime);
+    st.exists = true;
+    return st;
+}
+
+shared_payload
+response_cache::
+read_file(
+    std::string const& path,
+    std::uint64_t size,
+    error_code& ec)
+{
+    file f;
+    f.open(path.c_str(), file_mode::scan, ec);
+    if(ec)
+        return {};
+    shared_payload body(static_cast<std::size_t>(size),
+        [&](net::mutable_buffer b)
+        {
+            auto p = static_cast<char*>(b.data());
+            auto n = b.size();
+            while(n > 0)
+            {
+                auto const bytes = f.read(p, n, ec);
+                if(ec)
+                    return;
+                if(bytes == 0)
+                {
+                    // The file was truncated while reading
+                    ec = net::error::eof;
+                    return;
+                }
+                p += bytes;
+                n -= bytes;
+            }
+        });
+    if(ec)
+        return {};
+    return body;
+}
+
+auto
+response_cache::
+make_variant(
+    entry const& e,
+    string_view content_type,
+    string_view encoding,
+    std::string etag,
+    shared_payload body) const ->
+    variant
+{
+    std::string common;
+    if(! opt_.server.empty())
+    {
+        common += "Server: ";
+        common += opt_.server;
+        common += "\r\n";
+    }
+    common += "ETag: ";
+    common += etag;
+    common += "\r\n";
+    if(e.gz_stamp.exists)
+        common += "Vary: Accept-Encoding\r\n";
+
+    std::string ok = "HTTP/1.1 200 OK\r\n";
+    ok += common;
+    ok += "Content-Type: ";
+    ok.append(content_type.data(), content_type.size());
+    ok += "\r\n";
+    if(! encoding.empty())
+    {
+        ok += "Content-Encoding: ";
+        ok.append(encoding.data(), encoding.size());
+        ok += "\r\n";
+    }
+    ok += "Content-Length: ";
+    ok += std::to_string(body.size());
+    ok += "\r\n";
+
+    variant v;
+    v.etag = std::move(etag);
+    v.ok = shared_payload(string_view(ok));
+    v.not_modified = shared_payload(string_view(
+        "HTTP/1.1 304 Not Modified\r\n" + common));
+    v.body = std::move(body);
+    return v;
+}
+
+void
+response_cache::
+load(entry& e, string_view content_type, error_code& ec) const
+{
+    e.content_type = std::string(content_type);
+    e.stamp = stat_file(e.path, ec);
+    if(ec)
+        return;
+    if(! e.stamp.exists)
+    {
+        ec = make_error_code(errc::no_such_file_or_directory);
+        return;
+    }
+    if(e.stamp.size > opt_.max_entry_bytes)
+    {
+        ec = error::body_limit;
+        return;
+    }
+    auto const gz_path = e.path + ".gz";
+    e.gz_stamp = stat_file(gz_path, ec);
+    if(ec || e.gz_stamp.size > opt_.max_entry_bytes)
+        e.gz_stamp = {};
+
+    auto body = read_file(e.path, e.stamp.size, ec);
+    if(ec)
+        return;
+    shared_payload gz_body;
+    if(e.gz_stamp.exists)
+    {
+        gz_body = read_file(gz_path, e.gz_stamp.size, ec);
+        if(ec)
+        {
+            ec = {};
+            e.gz_stamp = {};
+        }
+    }
+
+    // The validator is derived from the size and modification
+    // time, so it survives restarts and is equal across servers
+    // sharing a document root.
+    char buf[48];
+    auto const n = std::snprintf(buf, sizeof(buf), "\"%llx-%llx",
+        static_cast<unsigned long long>(e.stamp.size),
+        static_cast<unsigned long long>(e.stamp.mtime));
+    std::string const etag(buf, static_cast<std::size_t>(n));
+
+    e.identity = make_variant(
+        e, content_type, {}, etag + "\"", std::move(body));
+    e.bytes = e.identity.ok.size() +
+        e.identity.not_modified.size() + e.identity.body.size();
+    if(e.gz_stamp.exists)
+    {
+        e.gzip = make_variant(
+            e, content_type, "gzip", etag + "-gz\"", std::move(gz_body));
+        e.bytes += e.gzip.ok.size() +
+            e.gzip.not_modified.size() + e.gzip.body.size();
+    }
+    e.checked = clock_type::now();
+}
+
+cached_response
+response_cache::
+make_response(entry const& e, request_info const& info)
+{
+    auto const& v = (info.gzip && e.gz_stamp.exists) ?
+        e.gzip : e.identity;
+
+    // The status line is always HTTP/1.1, so
+    // keep-alive is the default.
+    string_view tail;
+    if(! info.keep_alive)
+        tail = "Connection: close\r\n\r\n";
+    else if(info.version < 11)
+        tail = "Connection: keep-alive\r\n\r\n";
+    else
+        tail = "\r\n";
+
+    if(! info.if_none_match.empty() &&
+        etag_matches(info.if_none_match, v.etag))
+        return cached_response(
+            status::not_modified, v.not_modified, tail, {});
+    if(info.head)
+        return cached_response(status::ok, v.ok, tail, {});
+    return cached_response(status::ok, v.ok, tail, v.body);
+}
+
+void
+response_cache::
+insert(entry&& e)
+{
+    std::lock_guard<std::mutex> lock(m_);
+    auto it = map_.find(e.key);
+    if(it != map_.end())
+    {
+        bytes_ -= it->second->bytes;
+        lru_.erase(it->second);
+        map_.erase(it);
+    }
+    bytes_ += e.bytes;
+    lru_.push_front(std::move(e));
+    map_.emplace(lru_.front().key, lru_.begin());
+    while(bytes_ > opt_.max_bytes && lru_.size() > 1)
+    {
+        auto& back = lru_.back();
+        bytes_ -= back.bytes;
+        map_.erase(back.key);
+        lru_.pop_back();
+    }
+}
+
+cached_response
+response_cache::
+get_impl(
+    request_info const& info,
+    string_view path,
+    string_view content_type,
+    error_code& ec)
+{
+    if( info.method != verb::get &&
+        info.method != verb::head)
+    {
+        ec = make_error_code(errc::operation_not_supported);
+        return {};
+    }
+    auto key = make_key(info.method, info.target);
+    file_stamp stamp;
+    file_stamp gz_stamp;
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        auto const it = map_.find(key);
+        if( it != map_.end() &&
+            it->second->path == path &&
+            it->second->content_type == content_type)
+        {
+            auto& e = *it->second;
+            lru_.splice(lru_.begin(), lru_, it->second);
+            auto const now = clock_type::now();
+            if(now - e.checked < opt_.revalidate)
+            {
+                ++hits_;
+                ec = {};
+                return make_response(e, info);
+            }
+            // Other threads keep using the entry
+            // while this one checks the file.
+            e.checked = now;
+            stamp = e.stamp;
+            gz_stamp = e.gz_stamp;
+        }
+    }
+
+    if(stamp.exists)
+    {
+        std::string const p(path);
+        auto const st = stat_file(p, ec);
+        auto const gz_st = stat_file(p + ".gz", ec);
+        if(st == stamp && gz_st == gz_stamp)
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            auto const it = map_.find(key);
+            if( it != map_.end() &&
+                it->second->content_type == content_type)
+            {
+                ++hits_;
+                ec = {};
+                return make_response(*it->second, info);
+            }
+        }
+    }
+
+    entry e;
+    e.key = std::move(key);
+    e.path = std::string(path);
+    load(e, content_type, ec);
+    if(ec)
+    {
+        if(stamp.exists)
+            invalidate(info.target);
+        return {};
+    }
+    auto res = make_response(e, info);
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        ++misses_;
+    }
+    if(e.bytes <= opt_.max_bytes)
+        insert(std::move(e));
+    return res;
+}
+
+} // http
+} // beast
+} // boost
+
+#endif
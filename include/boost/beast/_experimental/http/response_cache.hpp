@@ -0,0 +1,394 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_RESPONSE_CACHE_HPP
+#define BOOST_BEAST_HTTP_RESPONSE_CACHE_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/beast/_experimental/core/shared_payload.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/status.hpp>
+#include <boost/beast/http/verb.hpp>
+#include <boost/asio/buffer.hpp>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+/** A serialized response held by a @ref response_cache.
+
+    This object refers to the complete bytes of an HTTP response:
+    the header, and the body unless the response has none. It meets
+    the requirements of <em>ConstBufferSequence</em>, so the whole
+    response is sent with one gathered write:
+
+    @code
+    net::async_write(stream, res, handler);
+    @endcode
+
+    The bytes are shared with the cache and with other copies, and
+    remain valid for the lifetime of the object even if the cache
+    entry is evicted or replaced.
+*/
+class cached_response
+{
+    friend class response_cache;
+
+    shared_payload header_;
+    shared_payload body_;
+    std::array<net::const_buffer, 3> b_;
+    std::size_t n_ = 0;
+    status result_ = status::unknown;
+
+    BOOST_BEAST_DECL
+    cached_response(
+        status result,
+        shared_payload header,
+        string_view tail,
+        shared_payload body);
+
+public:
+    /// The type of buffer in the sequence
+    using value_type = net::const_buffer;
+
+    /// The type of iterator used to represent the sequence
+    using const_iterator = net::const_buffer const*;
+
+    /// Constructor, for an empty response
+    cached_response() = default;
+
+    /// Returns `true` if the object refers to a response
+    bool
+    empty() const noexcept
+    {
+        return n_ == 0;
+    }
+
+    /// Return the status of the response
+    status
+    result() const noexcept
+    {
+        return result_;
+    }
+
+    /// Return the total size of the response in bytes
+    BOOST_BEAST_DECL
+    std::size_t
+    size() const noexcept;
+
+    /// Return an iterator to the beginning of the sequence
+    const_iterator
+    begin() const noexcept
+    {
+        return b_.data();
+    }
+
+    /// Return an iterator to the end of the sequence
+    const_iterator
+    end() const noexcept
+    {
+        return b_.data() + n_;
+    }
+};
+
+/** A cache of serialized responses for static files.
+
+    Serving a file with @ref file_body opens and reads the file,
+    and serializes the header, on every request. This object
+    instead keeps the complete response for frequently requested
+    files in memory, as @ref shared_payload buffers which are
+    shared by every connection sending them, so that a hit costs
+    a hash table lookup and one gathered write.
+
+    Only GET and HEAD requests are answered. Entries are keyed by
+    method and request target, and a HEAD request is answered from
+    the entry for GET, without the body. Each entry holds the
+    identity encoded file and, when a precompressed file with the
+    same name and the suffix ".gz" exists next to it, a gzip
+    encoded variant which is sent to clients whose Accept-Encoding
+    allows it. Every response carries an ETag derived from the
+    size and modification time of the file, and a request whose
+    If-None-Match matches it receives a 304 Not Modified.
+
+    An entry is checked against the file system at most once per
+    @ref options::revalidate interval; if the size or modification
+    time of the file changed, the file is read again. The least
+    recently used entries are evicted when the total size exceeds
+    @ref options::max_bytes.
+
+    @par Example
+    @code
+    error_code ec;
+    auto res = cache.get(req, path, mime_type(path), ec);
+    if(ec == http::error::body_limit)
+        ... // too large for the cache, send with file_body
+    else if(ec)
+        ... // the file could not be read
+    else
+        net::async_write(stream, res, handler);
+    @endcode
+
+    @par Thread Safety
+    @e Distinct @e objects: Safe.@n
+    @e Shared @e objects: Safe.
+*/
+class response_cache
+{
+    using clock_type = std::chrono::steady_clock;
+
+    // Identifies a version of a file
+    struct file_stamp
+    {
+        std::uint64_t size = 0;
+        std::uint64_t mtime = 0;
+        bool exists = false;
+
+        bool
+        operator==(file_stamp const& other) const noexcept
+        {
+            return
+                size == other.size &&
+                mtime == other.mtime &&
+                exists == other.exists;
+        }
+    };
+
+    // The responses for one content encoding. Header bytes
+    // stop before the Connection field and the final CRLF.
+    struct variant
+    {
+        std::string etag;
+        shared_payload ok;
+        shared_payload not_modified;
+        shared_payload body;
+    };
+
+    struct entry
+    {
+        std::string key;
+        std::string path;
+        std::string content_type;
+        file_stamp stamp;
+        file_stamp gz_stamp;
+        variant identity;
+        variant gzip;
+        std::size_t bytes = 0;
+        clock_type::time_point checked;
+    };
+
+    using list_type = std::list<entry>;
+
+    struct request_info
+    {
+        verb method;
+        string_view target;
+        string_view if_none_match;
+        bool head;
+        bool gzip;
+        bool keep_alive;
+        unsigned version;
+    };
+
+public:
+    /// Cache settings
+    struct options
+    {
+        /// Maximum number of bytes kept in the cache.
+        std::size_t max_bytes = 64 * 1024 * 1024;
+
+        /// Largest response kept in the cache.
+        std::size_t max_entry_bytes = 1024 * 1024;
+
+        /// How often a cached file is checked for changes.
+        std::chrono::steady_clock::duration revalidate =
+            std::chrono::seconds(1);
+
+        /// The value of the Server field, or empty for none.
+        std::string server;
+    };
+
+    response_cache(response_cache const&) = delete;
+    response_cache& operator=(response_cache const&) = delete;
+
+    /// Destructor
+    BOOST_BEAST_DECL
+    ~response_cache();
+
+    /// Constructor
+    BOOST_BEAST_DECL
+    response_cache();
+
+    /// Constructor
+    BOOST_BEAST_DECL
+    explicit
+    response_cache(options const& opt);
+
+    /// Return the cache settings.
+    options const&
+    get_options() const noexcept
+    {
+        return opt_;
+    }
+
+    /** Return the response for a request for a file.
+
+        If the cache holds a current response for the request method
+        and target, with the same path and content type, it is
+        returned. Otherwise the file is read, and the response is
+        built, stored, and returned.
+
+        The response depends on these fields of the request: the
+        method, which may be GET or HEAD; If-None-Match;
+        Accept-Encoding; and the version and keep-alive semantics,
+        which determine the Connection field of the response.
+
+        @param req The request header.
+
+        @param path The file to send, as mapped from the target by
+        the caller.
+
+        @param content_type The value of the Content-Type field.
+
+        @param ec Set to the error, if any occurred. If the file is
+        larger than @ref options::max_entry_bytes, the error is
+        @ref error::body_limit and the file should be sent another way.
+        If the method is neither GET nor HEAD, the error is
+        `errc::operation_not_supported` and the request should be
+        handled another way.
+
+        @return The response, which is empty on error.
+    */
+    template<class Fields>
+    cached_response
+    get(header<true, Fields> const& req,
+        string_view path,
+        string_view content_type,
+        error_code& ec);
+
+    /// Remove the entry for a target, for GET and HEAD, if any.
+    BOOST_BEAST_DECL
+    void
+    invalidate(string_view target);
+
+    /// Remove all entries.
+    BOOST_BEAST_DECL
+    void
+    clear();
+
+    /// Return the number of entries in the cache.
+    BOOST_BEAST_DECL
+    std::size_t
+    size() const;
+
+    /// Return the number of bytes held by the cache.
+    BOOST_BEAST_DECL
+    std::size_t
+    bytes() const;
+
+    /// Return the number of requests answered from the cache.
+    BOOST_BEAST_DECL
+    std::size_t
+    hits() const;
+
+    /// Return the number of requests which read the file.
+    BOOST_BEAST_DECL
+    std::size_t
+    misses() const;
+
+private:
+    BOOST_BEAST_DECL
+    static
+    std::string
+    make_key(verb method, string_view target);
+
+    BOOST_BEAST_DECL
+    static
+    bool
+    accepts_gzip(string_view accept_encoding);
+
+    BOOST_BEAST_DECL
+    static
+    bool
+    keep_alive(string_view connection, unsigned version);
+
+    BOOST_BEAST_DECL
+    static
+    bool
+    etag_matches(string_view if_none_match, string_view etag);
+
+    BOOST_BEAST_DECL
+    static
+    file_stamp
+    stat_file(std::string const& path, error_code& ec);
+
+    BOOST_BEAST_DECL
+    static
+    shared_payload
+    read_file(std::string const& path,
+        std::uint64_t size, error_code& ec);
+
+    BOOST_BEAST_DECL
+    cached_response
+    get_impl(
+        request_info const& info,
+        string_view path,
+        string_view content_type,
+        error_code& ec);
+
+    BOOST_BEAST_DECL
+    void
+    load(entry& e, string_view content_type, error_code& ec) const;
+
+    BOOST_BEAST_DECL
+    variant
+    make_variant(
+        entry const& e,
+        string_view content_type,
+        string_view encoding,
+        std::string etag,
+        shared_payload body) const;
+
+    BOOST_BEAST_DECL
+    static
+    cached_response
+    make_response(entry const& e, request_info const& info);
+
+    BOOST_BEAST_DECL
+    void
+    insert(entry&& e);
+
+    options opt_;
+    mutable std::mutex m_;
+    list_type lru_;
+    std::unordered_map<std::string, list_type::iterator> map_;
+    std::size_t bytes_ = 0;
+    std::size_t hits_ = 0;
+    std::size_t misses_ = 0;
+};
+
+} // http
+} // beast
+} // boost
+
+#include <boost/beast/_experimental/http/impl/response_cache.hpp>
+#ifdef BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/_experimental/http/impl/response_cache.ipp>
+#endif
+
+#endif
@@ -0,0 +1,167 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_SHARED_PAYLOAD_BODY_HPP
+#define BOOST_BEAST_HTTP_SHARED_PAYLOAD_BODY_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/buffer_traits.hpp>
+#include <boost/beast/core/detail/clamp.hpp>
+#include <boost/beast/_experimental/core/shared_payload.hpp>
+#include <boost/beast/http/error.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <string>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+/** A <em>Body</em> using @ref shared_payload
+
+    This body uses @ref shared_payload as the container for the
+    message payload. Copying a message with this body shares the
+    payload instead of copying it, so the same response may be
+    sent on many connections without allocating for each one.
+    Messages using this body type may be serialized and parsed.
+
+    When parsing, the body is accumulated in a temporary string
+    and copied into a new payload when the message is complete.
+*/
+struct shared_payload_body
+{
+    /** The type of container used for the body
+
+        This determines the type of @ref message::body
+        when this body type is used with a message container.
+    */
+    using value_type = shared_payload;
+
+    /** Returns the payload size of the body
+
+        When this body is used with @ref message::prepare_payload,
+        the Content-Length will be set to the payload size, and
+        any chunked Transfer-Encoding will be removed.
+    */
+    static
+    std::uint64_t
+    size(value_type const& body)
+    {
+        return body.size();
+    }
+
+    /** The algorithm for parsing the body
+
+        Meets the requirements of <em>BodyReader</em>.
+    */
+#if BOOST_BEAST_DOXYGEN
+    using reader = __implementation_defined__;
+#else
+    class reader
+    {
+        value_type& body_;
+        std::string s_;
+
+    public:
+        template<bool isRequest, class Fields>
+        explicit
+        reader(header<isRequest, Fields>&, value_type& b)
+            : body_(b)
+        {
+        }
+
+        void
+        init(boost::optional<
+            std::uint64_t> const& length, error_code& ec)
+        {
+            if(length)
+            {
+                if(*length > s_.max_size())
+                {
+                    ec = error::buffer_overflow;
+                    return;
+                }
+                s_.reserve(beast::detail::clamp(*length));
+            }
+            ec = {};
+        }
+
+        template<class ConstBufferSequence>
+        std::size_t
+        put(ConstBufferSequence const& buffers,
+            error_code& ec)
+        {
+            auto const extra = buffer_bytes(buffers);
+            auto const size = s_.size();
+            if(extra > s_.max_size() - size)
+            {
+                ec = error::buffer_overflow;
+                return 0;
+            }
+            s_.resize(size + extra);
+            ec = {};
+            return net::buffer_copy(net::buffer(
+                &s_[0] + size, extra), buffers);
+        }
+
+        void
+        finish(error_code& ec)
+        {
+            body_ = value_type(string_view(s_));
+            ec = {};
+        }
+    };
+#endif
+
+    /** The algorithm for serializing the body
+
+        Meets the requirements of <em>BodyWriter</em>.
+    */
+#if BOOST_BEAST_DOXYGEN
+    using writer = __implementation_defined__;
+#else
+    class writer
+    {
+        value_type const& body_;
+
+    public:
+        using const_buffers_type =
+            net::const_buffer;
+
+        template<bool isRequest, class Fields>
+        explicit
+        writer(header<isRequest, Fields> const&, value_type const& b)
+            : body_(b)
+        {
+        }
+
+        void
+        init(error_code& ec)
+        {
+            ec = {};
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>>
+        get(error_code& ec)
+        {
+            ec = {};
+            return {{
+                const_buffers_type{body_.data(), body_.size()},
+                false}};
+        }
+    };
+#endif
+};
+
+} // http
+} // beast
+} // boost
+
+#endif
@@ -0,0 +1,534 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_SSL_DETAIL_RECORD_ENGINE_HPP
+#define BOOST_BEAST_SSL_DETAIL_RECORD_ENGINE_HPP
+
+#include <boost/beast/_experimental/ssl/ssl_record_pool.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <boost/asio/ssl/error.hpp>
+#include <boost/asio/ssl/stream_base.hpp>
+#include <boost/asio/ssl/detail/openssl_types.hpp>
+#include <boost/throw_exception.hpp>
+#include <climits>
+#include <iterator>
+#include <new>
+#include <cstring>
+
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+# error "pooled_ssl_stream requires OpenSSL 1.1.0 or later"
+#endif
+
+namespace boost {
+namespace beast {
+namespace detail {
+
+/*  Drives an SSL object through a BIO which reads and writes
+    pooled record buffers, instead of the BIO pair and staging
+    vectors of net::ssl::stream.
+
+    Received bytes are read from the next layer straight into the
+    input buffer, where OpenSSL reads them, and records OpenSSL
+    writes are sent to the next layer straight from the output
+    buffer. Each buffer is taken from the pool when first needed
+    and given back by release_idle once it is empty.
+*/
+class record_engine
+{
+    SSL* ssl_;
+    ssl_record_pool& pool_;
+    char* in_ = nullptr;
+    std::size_t in_pos_ = 0;
+    std::size_t in_end_ = 0;
+    char* out_ = nullptr;
+    std::size_t out_pos_ = 0;
+    std::size_t out_end_ = 0;
+    char* stage_ = nullptr;
+    bool reading_ = false;  // input lent to a read of the next layer
+    bool writing_ = false;  // output being written to the next layer
+
+    static
+    record_engine&
+    get(BIO* b)
+    {
+        return *static_cast<record_engine*>(BIO_get_data(b));
+    }
+
+    static
+    int
+    bio_read(BIO* b, char* p, int len)
+    {
+        BIO_clear_retry_flags(b);
+        auto& e = get(b);
+        std::size_t n = e.in_end_ - e.in_pos_;
+        if(n == 0)
+        {
+            BIO_set_retry_read(b);
+            return -1;
+        }
+        if(n > static_cast<std::size_t>(len))
+            n = static_cast<std::size_t>(len);
+        std::memcpy(p, e.in_ + e.in_pos_, n);
+        e.in_pos_ += n;
+        if(e.in_pos_ == e.in_end_)
+            e.in_pos_ = e.in_end_ = 0;
+        return static_cast<int>(n);
+    }
+
+    static
+    int
+    bio_write(BIO* b, char const* p, int len)
+    {
+        BIO_clear_retry_flags(b);
+        auto& e = get(b);
+        if(! e.out_)
+        {
+            try
+            {
+                e.out_ = static_cast<char*>(e.pool_.acquire());
+            }
+            catch(std::bad_alloc const&)
+            {
+                return -1;
+            }
+        }
+        std::size_t n = ssl_record_pool::buffer_size - e.out_end_;
+        if(n == 0)
+        {
+            BIO_set_retry_write(b);
+            return -1;
+        }
+        if(n > static_cast<std::size_t>(len))
+            n = static_cast<std::size_t>(len);
+        std::memcpy(e.out_ + e.out_end_, p, n);
+        e.out_end_ += n;
+        return static_cast<int>(n);
+    }
+
+    static
+    long
+    bio_ctrl(BIO* b, int cmd, long, void*)
+    {
+        auto& e = get(b);
+        switch(cmd)
+        {
+        case BIO_CTRL_FLUSH:
+            return 1;
+        case BIO_CTRL_PENDING:
+            return static_cast<long>(e.in_end_ - e.in_pos_);
+        case BIO_CTRL_WPENDING:
+            return static_cast<long>(e.out_end_ - e.out_pos_);
+        default:
+            return 0;
+        }
+    }
+
+    static
+    BIO_METHOD*
+    method()
+    {
+        static BIO_METHOD* const m =
+            []
+            {
+                auto const m = BIO_meth_new(
+                    BIO_get_new_index() | BIO_TYPE_SOURCE_SINK,
+                    "beast record buffers");
+                if(! m)
+                    BOOST_THROW_EXCEPTION(std::bad_alloc{});
+                BIO_meth_set_read(m, &bio_read);
+                BIO_meth_set_write(m, &bio_write);
+                BIO_meth_set_ctrl(m, &bio_ctrl);
+                return m;
+            }();
+        return m;
+    }
+
+    static
+    error_code
+    last_error()
+    {
+        return error_code(
+            static_cast<int>(::ERR_get_error()),
+            net::error::get_ssl_category());
+    }
+
+public:
+    enum want
+    {
+        want_input_and_retry = -2,
+        want_output_and_retry = -1,
+        want_nothing = 0,
+        want_output = 1
+    };
+
+    record_engine(record_engine const&) = delete;
+    record_engine& operator=(record_engine const&) = delete;
+
+    ~record_engine()
+    {
+        ::SSL_free(ssl_);
+        pool_.release(in_);
+        pool_.release(out_);
+        pool_.release(stage_);
+    }
+
+    record_engine(
+        net::ssl::context& ctx,
+        ssl_record_pool& pool)
+        : ssl_(::SSL_new(ctx.native_handle()))
+        , pool_(pool)
+    {
+        if(! ssl_)
+            BOOST_THROW_EXCEPTION(system_error{last_error()});
+        BIO* b = ::BIO_new(method());
+        if(! b)
+        {
+            ::SSL_free(ssl_);
+            BOOST_THROW_EXCEPTION(system_error{last_error()});
+        }
+        BIO_set_data(b, this);
+        BIO_set_init(b, 1);
+        ::SSL_set_bio(ssl_, b, b);
+        ::SSL_set_mode(ssl_, SSL_MODE_ENABLE_PARTIAL_WRITE);
+        ::SSL_set_mode(ssl_, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+        ::SSL_set_mode(ssl_, SSL_MODE_RELEASE_BUFFERS);
+#ifdef SSL_OP_NO_RENEGOTIATION
+        // Only reads may read, and only writes may write
+        ::SSL_set_options(ssl_, SSL_OP_NO_RENEGOTIATION);
+#endif
+    }
+
+    SSL*
+    native_handle() noexcept
+    {
+        return ssl_;
+    }
+
+    ssl_record_pool&
+    pool() const noexcept
+    {
+        return pool_;
+    }
+
+    // Bytes of pooled buffers held now
+    std::size_t
+    buffer_bytes() const noexcept
+    {
+        return ssl_record_pool::buffer_size * (
+            (in_ ? 1 : 0) + (out_ ? 1 : 0) + (stage_ ? 1 : 0));
+    }
+
+    // Returns true if no received bytes are held
+    bool
+    input_released() const noexcept
+    {
+        return in_ == nullptr;
+    }
+
+    // Space to read received bytes into. It stays
+    // held until commit_input, even if empty.
+    net::mutable_buffer
+    prepare_input()
+    {
+        if(! in_)
+            in_ = static_cast<char*>(pool_.acquire());
+        reading_ = true;
+        return {in_ + in_end_,
+            ssl_record_pool::buffer_size - in_end_};
+    }
+
+    void
+    commit_input(std::size_t n) noexcept
+    {
+        reading_ = false;
+        in_end_ += n;
+    }
+
+    // Returns true if records are being written
+    bool
+    is_writing() const noexcept
+    {
+        return writing_;
+    }
+
+    // Records waiting to be sent. They stay
+    // held until consume_output.
+    net::const_buffer
+    prepare_output() noexcept
+    {
+        writing_ = true;
+        return {out_ + out_pos_, out_end_ - out_pos_};
+    }
+
+    void
+    consume_output(std::size_t n) noexcept
+    {
+        writing_ = false;
+        out_pos_ += n;
+        if(out_pos_ >= out_end_)
+            out_pos_ = out_end_ = 0;
+    }
+
+    // Bytes of records not yet sent
+    std::size_t
+    pending_output() const noexcept
+    {
+        return out_end_ - out_pos_;
+    }
+
+    // Give back the record buffers which hold nothing
+    void
+    release_idle() noexcept
+    {
+        if(in_ && ! reading_ && in_end_ == in_pos_)
+        {
+            pool_.release(in_);
+            in_ = nullptr;
+            in_pos_ = in_end_ = 0;
+        }
+        if(out_ && ! writing_ && out_end_ == out_pos_)
+        {
+            pool_.release(out_);
+            out_ = nullptr;
+            out_pos_ = out_end_ = 0;
+        }
+    }
+
+    // Give back the buffer used by stage
+    void
+    release_stage() noexcept
+    {
+        pool_.release(stage_);
+        stage_ = nullptr;
+    }
+
+    // Gather a short buffer sequence into one buffer, so
+    // that it is sent as one record instead of several.
+    template<class ConstBufferSequence>
+    net::const_buffer
+    stage(ConstBufferSequence const& buffers)
+    {
+        auto it = net::buffer_sequence_begin(buffers);
+        auto const end = net::buffer_sequence_end(buffers);
+        while(it != end && net::const_buffer(*it).size() == 0)
+            ++it;
+        if(it == end)
+            return {};
+        net::const_buffer const first = *it;
+        if( first.size() >= 16384 ||
+            std::next(it) == end)
+            return first;
+        if(! stage_)
+            stage_ = static_cast<char*>(pool_.acquire());
+        auto const n = net::buffer_copy(
+            net::buffer(stage_, 16384), buffers);
+        return {stage_, n};
+    }
+
+    want
+    perform(int (*op)(SSL*, void*, std::size_t),
+        void* data, std::size_t size,
+        error_code& ec, std::size_t* bytes_transferred)
+    {
+        std::size_t const before = pending_output();
+        ::ERR_clear_error();
+        int const result = op(ssl_, data, size);
+        int const ssl_error = ::SSL_get_error(ssl_, result);
+        int const sys_error = static_cast<int>(::ERR_get_error());
+        std::size_t const after = pending_output();
+
+        if(ssl_error == SSL_ERROR_SSL)
+        {
+            ec = error_code(sys_error,
+                net::error::get_ssl_category());
+            return after > before ? want_output : want_nothing;
+        }
+        if(ssl_error == SSL_ERROR_SYSCALL)
+        {
+            if(sys_error == 0)
+                ec = net::ssl::error::unspecified_system_error;
+            else
+                ec = error_code(sys_error,
+                    net::error::get_ssl_category());
+            return after > before ? want_output : want_nothing;
+        }
+        if(result > 0 && bytes_transferred)
+            *bytes_transferred = static_cast<std::size_t>(result);
+        ec = {};
+        if(ssl_error == SSL_ERROR_WANT_WRITE)
+            return want_output_and_retry;
+        if(after > before)
+            return result > 0 ? want_output : want_output_and_retry;
+        if(ssl_error == SSL_ERROR_WANT_READ)
+            return want_input_and_retry;
+        if(ssl_error == SSL_ERROR_ZERO_RETURN)
+        {
+            ec = net::error::eof;
+            return want_nothing;
+        }
+        if(ssl_error == SSL_ERROR_NONE)
+            return want_nothing;
+        ec = net::ssl::error::unexpected_result;
+        return want_nothing;
+    }
+
+    static
+    int
+    do_accept(SSL* ssl, void*, std::size_t)
+    {
+        return ::SSL_accept(ssl);
+    }
+
+    static
+    int
+    do_connect(SSL* ssl, void*, std::size_t)
+    {
+        return ::SSL_connect(ssl);
+    }
+
+    static
+    int
+    do_shutdown(SSL* ssl, void*, std::size_t)
+    {
+        int const result = ::SSL_shutdown(ssl);
+        if(result == 0)
+            return ::SSL_shutdown(ssl);
+        return result;
+    }
+
+    static
+    int
+    do_read(SSL* ssl, void* data, std::size_t size)
+    {
+        return ::SSL_read(ssl, data,
+            size < INT_MAX ? static_cast<int>(size) : INT_MAX);
+    }
+
+    static
+    int
+    do_write(SSL* ssl, void* data, std::size_t size)
+    {
+        return ::SSL_write(ssl, data,
+            size < INT_MAX ? static_cast<int>(size) : INT_MAX);
+    }
+
+    want
+    handshake(
+        net::ssl::stream_base::handshake_type type,
+        error_code& ec)
+    {
+        return perform(type == net::ssl::stream_base::client ?
+            &do_connect : &do_accept, nullptr, 0, ec, nullptr);
+    }
+
+    want
+    shutdown(error_code& ec)
+    {
+        return perform(&do_shutdown, nullptr, 0, ec, nullptr);
+    }
+
+    want
+    read(net::mutable_buffer b,
+        error_code& ec, std::size_t& n)
+    {
+        if(b.size() == 0)
+        {
+            ec = {};
+            return want_nothing;
+        }
+        return perform(&do_read, b.data(), b.size(), ec, &n);
+    }
+
+    want
+    write(net::const_buffer b,
+        error_code& ec, std::size_t& n)
+    {
+        if(b.size() == 0)
+        {
+            ec = {};
+            return want_nothing;
+        }
+        return perform(&do_write,
+            const_cast<void*>(b.data()), b.size(), ec, &n);
+    }
+
+    // Adjust the error from reading the next layer
+    error_code
+    map_error_code(error_code ec) const
+    {
+        if(ec != net::error::eof)
+            return ec;
+        // A clean end requires close_notify from the peer,
+        // and nothing of ours left unsent.
+        if( pending_output() == 0 &&
+            (::SSL_get_shutdown(ssl_) & SSL_RECEIVED_SHUTDOWN))
+            return ec;
+        return net::ssl::error::stream_truncated;
+    }
+};
+
+//------------------------------------------------------------------------------
+
+// The operations a pooled_ssl_stream performs,
+// each called until it wants nothing more.
+
+struct record_handshake
+{
+    net::ssl::stream_base::handshake_type type;
+
+    record_engine::want
+    operator()(record_engine& e,
+        error_code& ec, std::size_t&) const
+    {
+        return e.handshake(type, ec);
+    }
+};
+
+struct record_shutdown
+{
+    record_engine::want
+    operator()(record_engine& e,
+        error_code& ec, std::size_t&) const
+    {
+        return e.shutdown(ec);
+    }
+};
+
+struct record_read
+{
+    net::mutable_buffer b;
+
+    record_engine::want
+    operator()(record_engine& e,
+        error_code& ec, std::size_t& n) const
+    {
+        return e.read(b, ec, n);
+    }
+};
+
+struct record_write
+{
+    net::const_buffer b;
+
+    record_engine::want
+    operator()(record_engine& e,
+        error_code& ec, std::size_t& n) const
+    {
+        return e.write(b, ec, n);
+    }
+};
+
+} // detail
+} // beast
+} // boost
+
+#endif
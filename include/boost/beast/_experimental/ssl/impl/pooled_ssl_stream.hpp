@@ -0,0 +1,556 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_SSL_IMPL_POOLED_SSL_STREAM_HPP
+#define BOOST_BEAST_SSL_IMPL_POOLED_SSL_STREAM_HPP
+
+#include <boost/beast/core/async_base.hpp>
+#include <boost/beast/core/detail/is_invocable.hpp>
+#include <boost/beast/core/detail/type_traits.hpp>
+#include <boost/asio/coroutine.hpp>
+#include <boost/asio/socket_base.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/assert.hpp>
+#include <boost/throw_exception.hpp>
+
+namespace boost {
+namespace beast {
+namespace detail {
+
+// Detects a next layer which can wait for data to arrive,
+// such as a socket, without reading it into a buffer.
+template<class T, class = void>
+struct has_wait_read : std::false_type
+{
+};
+
+template<class T>
+struct has_wait_read<T, void_t<
+    decltype(std::declval<T&>().wait(
+        net::socket_base::wait_read,
+        std::declval<error_code&>())),
+    decltype(std::declval<T&>().async_wait(
+        net::socket_base::wait_read,
+        std::declval<void(*)(error_code)>()))>>
+    : std::true_type
+{
+};
+
+// Returns the object to wait on for data: the next layer
+// itself when it is a socket, or the socket of a basic_stream.
+// Layers in between could hold received data of their own,
+// so the search does not go further down.
+
+template<class Stream>
+auto
+record_waitable(Stream& s, int) ->
+    typename std::enable_if<
+        has_wait_read<Stream>::value, Stream&>::type
+{
+    return s;
+}
+
+template<class Stream>
+auto
+record_waitable(Stream& s, long) ->
+    typename std::enable_if<
+        has_wait_read<typename std::remove_reference<
+            decltype(s.socket())>::type>::value,
+        decltype(s.socket())>::type
+{
+    return s.socket();
+}
+
+template<class Stream>
+Stream&
+record_waitable(Stream& s, ...)
+{
+    return s;
+}
+
+template<class Stream>
+using record_waitable_type = typename std::remove_reference<
+    decltype(record_waitable(std::declval<Stream&>(), 0))>::type;
+
+template<class Stream>
+void
+record_wait_read(Stream& s, error_code& ec, std::true_type)
+{
+    s.wait(net::socket_base::wait_read, ec);
+}
+
+template<class Stream>
+void
+record_wait_read(Stream&, error_code&, std::false_type)
+{
+    BOOST_ASSERT(false);
+}
+
+template<class Stream, class Handler>
+void
+record_async_wait_read(Stream& s, Handler&& h, std::true_type)
+{
+    s.async_wait(net::socket_base::wait_read,
+        std::forward<Handler>(h));
+}
+
+template<class Stream, class Handler>
+void
+record_async_wait_read(Stream&, Handler&&, std::false_type)
+{
+    BOOST_ASSERT(false);
+}
+
+// Returns the first non-empty buffer of a sequence
+template<class MutableBufferSequence>
+net::mutable_buffer
+record_read_buffer(MutableBufferSequence const& buffers)
+{
+    auto it = net::buffer_sequence_begin(buffers);
+    auto const end = net::buffer_sequence_end(buffers);
+    for(; it != end; ++it)
+    {
+        net::mutable_buffer const b = *it;
+        if(b.size() > 0)
+            return b;
+    }
+    return {};
+}
+
+} // detail
+
+template<class NextLayer>
+template<class Operation, class Handler>
+class pooled_ssl_stream<NextLayer>::io_op
+    : public beast::async_base<Handler,
+        beast::executor_type<pooled_ssl_stream>>
+    , public asio::coroutine
+{
+    using want = detail::record_engine::want;
+    using has_wait = detail::has_wait_read<
+        detail::record_waitable_type<next_layer_type>>;
+
+    pooled_ssl_stream& s_;
+    Operation op_;
+    error_code ec_;
+    std::size_t bytes_ = 0;
+    want want_ = want::want_nothing;
+
+    void
+    upcall(bool cont, std::true_type)
+    {
+        this->complete(cont, ec_);
+    }
+
+    void
+    upcall(bool cont, std::false_type)
+    {
+        this->complete(cont, ec_, bytes_);
+    }
+
+public:
+    template<class Handler_>
+    io_op(
+        Handler_&& h,
+        pooled_ssl_stream& s,
+        Operation const& op)
+        : beast::async_base<Handler,
+            beast::executor_type<pooled_ssl_stream>>(
+                std::forward<Handler_>(h), s.get_executor())
+        , s_(s)
+        , op_(op)
+    {
+        (*this)({}, 0, false);
+    }
+
+    void
+    operator()(
+        error_code ec = {},
+        std::size_t bytes_transferred = 0,
+        bool cont = true)
+    {
+        auto& e = *s_.eng_;
+        BOOST_ASIO_CORO_REENTER(*this)
+        {
+            for(;;)
+            {
+                want_ = op_(e, ec_, bytes_);
+                if(want_ == want::want_input_and_retry)
+                {
+                    if(has_wait::value && e.input_released())
+                    {
+                        // Hold no buffer while the peer is quiet
+                        BOOST_ASIO_CORO_YIELD
+                        detail::record_async_wait_read(
+                            detail::record_waitable(s_.next_, 0),
+                                std::move(*this), has_wait{});
+                        if(ec)
+                        {
+                            ec_ = ec;
+                            break;
+                        }
+                    }
+                    BOOST_ASIO_CORO_YIELD
+                    s_.next_.async_read_some(
+                        e.prepare_input(), std::move(*this));
+                    e.commit_input(bytes_transferred);
+                    if(ec)
+                    {
+                        ec_ = e.map_error_code(ec);
+                        break;
+                    }
+                    continue;
+                }
+                if(want_ == want::want_nothing)
+                    break;
+                if(e.is_writing())
+                {
+                    // The operation sending records will send
+                    // ours too, but we need it to make room.
+                    if(want_ == want::want_output)
+                        break;
+                    // Resumed when the write completes
+                    BOOST_ASIO_CORO_YIELD
+                    s_.op_out_.emplace(std::move(*this));
+                    continue;
+                }
+                BOOST_ASIO_CORO_YIELD
+                net::async_write(s_.next_,
+                    e.prepare_output(), std::move(*this));
+                e.consume_output(bytes_transferred);
+                s_.op_out_.maybe_invoke();
+                if(ec)
+                {
+                    if(! ec_)
+                        ec_ = ec;
+                    break;
+                }
+                if(want_ == want::want_output)
+                    break;
+            }
+
+            // Send records another operation added
+            // while we were writing.
+            while(! ec && e.pending_output() > 0 && ! e.is_writing())
+            {
+                BOOST_ASIO_CORO_YIELD
+                net::async_write(s_.next_,
+                    e.prepare_output(), std::move(*this));
+                e.consume_output(bytes_transferred);
+                s_.op_out_.maybe_invoke();
+                if(ec && ! ec_)
+                    ec_ = ec;
+            }
+
+            if(std::is_same<Operation, detail::record_write>::value)
+                e.release_stage();
+            e.release_idle();
+            upcall(cont, std::integral_constant<bool,
+                std::is_same<Operation, detail::record_handshake>::value ||
+                std::is_same<Operation, detail::record_shutdown>::value>{});
+        }
+    }
+};
+
+template<class NextLayer>
+struct pooled_ssl_stream<NextLayer>::run_io_op
+{
+    template<class Handler, class Operation>
+    void
+    operator()(
+        Handler&& h,
+        pooled_ssl_stream* s,
+        Operation const& op)
+    {
+        io_op<Operation, typename std::decay<Handler>::type>(
+            std::forward<Handler>(h), *s, op);
+    }
+
+    template<class WriteHandler, class ConstBufferSequence>
+    void
+    operator()(
+        WriteHandler&& h,
+        pooled_ssl_stream* s,
+        ConstBufferSequence const* buffers)
+    {
+        // If you get an error on the following line it means
+        // that your handler does not meet the documented type
+        // requirements for the handler.
+
+        static_assert(
+            beast::detail::is_invocable<WriteHandler,
+            void(error_code, std::size_t)>::value,
+            "WriteHandler type requirements not met");
+
+        io_op<detail::record_write,
+            typename std::decay<WriteHandler>::type>(
+                std::forward<WriteHandler>(h), *s,
+                detail::record_write{s->eng_->stage(*buffers)});
+    }
+};
+
+//------------------------------------------------------------------------------
+
+template<class NextLayer>
+template<class Operation>
+void
+pooled_ssl_stream<NextLayer>::
+io(Operation const& op, error_code& ec, std::size_t& n)
+{
+    using want = detail::record_engine::want;
+    using has_wait = detail::has_wait_read<
+        detail::record_waitable_type<next_layer_type>>;
+    auto& e = *eng_;
+    error_code ec2;
+    for(;;)
+    {
+        auto const w = op(e, ec, n);
+        if(w == want::want_input_and_retry)
+        {
+            if(has_wait::value && e.input_released())
+                detail::record_wait_read(
+                    detail::record_waitable(next_, 0), ec2, has_wait{});
+            if(! ec2)
+            {
+                auto const b = e.prepare_input();
+                e.commit_input(next_.read_some(b, ec2));
+            }
+            if(ec2)
+            {
+                ec = e.map_error_code(ec2);
+                break;
+            }
+            continue;
+        }
+        if(w == want::want_nothing)
+            break;
+        e.consume_output(net::write(
+            next_, e.prepare_output(), ec2));
+        if(ec2)
+        {
+            if(! ec)
+                ec = ec2;
+            break;
+        }
+        if(w == want::want_output)
+            break;
+    }
+    e.release_idle();
+}
+
+template<class NextLayer>
+void
+pooled_ssl_stream<NextLayer>::
+handshake(handshake_type type)
+{
+    error_code ec;
+    handshake(type, ec);
+    if(ec)
+        BOOST_THROW_EXCEPTION(system_error{ec});
+}
+
+template<class NextLayer>
+void
+pooled_ssl_stream<NextLayer>::
+handshake(handshake_type type, error_code& ec)
+{
+    std::size_t n = 0;
+    io(detail::record_handshake{type}, ec, n);
+}
+
+template<class NextLayer>
+template<BOOST_BEAST_ASYNC_TPARAM1 HandshakeHandler>
+BOOST_BEAST_ASYNC_RESULT1(HandshakeHandler)
+pooled_ssl_stream<NextLayer>::
+async_handshake(
+    handshake_type type,
+    HandshakeHandler&& handler)
+{
+    static_assert(is_async_stream<next_layer_type>::value,
+        "AsyncStream type requirements not met");
+    return net::async_initiate<
+        HandshakeHandler,
+        void(error_code)>(
+            run_io_op{},
+            handler,
+            this,
+            detail::record_handshake{type});
+}
+
+template<class NextLayer>
+void
+pooled_ssl_stream<NextLayer>::
+shutdown()
+{
+    error_code ec;
+    shutdown(ec);
+    if(ec)
+        BOOST_THROW_EXCEPTION(system_error{ec});
+}
+
+template<class NextLayer>
+void
+pooled_ssl_stream<NextLayer>::
+shutdown(error_code& ec)
+{
+    std::size_t n = 0;
+    io(detail::record_shutdown{}, ec, n);
+}
+
+template<class NextLayer>
+template<BOOST_BEAST_ASYNC_TPARAM1 ShutdownHandler>
+BOOST_BEAST_ASYNC_RESULT1(ShutdownHandler)
+pooled_ssl_stream<NextLayer>::
+async_shutdown(ShutdownHandler&& handler)
+{
+    static_assert(is_async_stream<next_layer_type>::value,
+        "AsyncStream type requirements not met");
+    return net::async_initiate<
+        ShutdownHandler,
+        void(error_code)>(
+            run_io_op{},
+            handler,
+            this,
+            detail::record_shutdown{});
+}
+
+template<class NextLayer>
+template<class ConstBufferSequence>
+std::size_t
+pooled_ssl_stream<NextLayer>::
+write_some(ConstBufferSequence const& buffers)
+{
+    error_code ec;
+    auto const n = write_some(buffers, ec);
+    if(ec)
+        BOOST_THROW_EXCEPTION(system_error{ec});
+    return n;
+}
+
+template<class NextLayer>
+template<class ConstBufferSequence>
+std::size_t
+pooled_ssl_stream<NextLayer>::
+write_some(ConstBufferSequence const& buffers, error_code& ec)
+{
+    static_assert(is_sync_stream<next_layer_type>::value,
+        "SyncStream type requirements not met");
+    static_assert(net::is_const_buffer_sequence<
+        ConstBufferSequence>::value,
+        "ConstBufferSequence type requirements not met");
+    std::size_t n = 0;
+    io(detail::record_write{eng_->stage(buffers)}, ec, n);
+    eng_->release_stage();
+    return n;
+}
+
+template<class NextLayer>
+template<
+    class ConstBufferSequence,
+    BOOST_BEAST_ASYNC_TPARAM2 WriteHandler>
+BOOST_BEAST_ASYNC_RESULT2(WriteHandler)
+pooled_ssl_stream<NextLayer>::
+async_write_some(
+    ConstBufferSequence const& buffers,
+    WriteHandler&& handler)
+{
+    static_assert(is_async_stream<next_layer_type>::value,
+        "AsyncStream type requirements not met");
+    static_assert(net::is_const_buffer_sequence<
+        ConstBufferSequence>::value,
+        "ConstBufferSequence type requirements not met");
+    return net::async_initiate<
+        WriteHandler,
+        void(error_code, std::size_t)>(
+            run_io_op{},
+            handler,
+            this,
+            &buffers);
+}
+
+template<class NextLayer>
+template<class MutableBufferSequence>
+std::size_t
+pooled_ssl_stream<NextLayer>::
+read_some(MutableBufferSequence const& buffers)
+{
+    error_code ec;
+    auto const n = read_some(buffers, ec);
+    if(ec)
+        BOOST_THROW_EXCEPTION(system_error{ec});
+    return n;
+}
+
+template<class NextLayer>
+template<class MutableBufferSequence>
+std::size_t
+pooled_ssl_stream<NextLayer>::
+read_some(MutableBufferSequence const& buffers, error_code& ec)
+{
+    static_assert(is_sync_stream<next_layer_type>::value,
+        "SyncStream type requirements not met");
+    static_assert(net::is_mutable_buffer_sequence<
+        MutableBufferSequence>::value,
+        "MutableBufferSequence type requirements not met");
+    std::size_t n = 0;
+    io(detail::record_read{
+        detail::record_read_buffer(buffers)}, ec, n);
+    return n;
+}
+
+template<class NextLayer>
+template<
+    class MutableBufferSequence,
+    BOOST_BEAST_ASYNC_TPARAM2 ReadHandler>
+BOOST_BEAST_ASYNC_RESULT2(ReadHandler)
+pooled_ssl_stream<NextLayer>::
+async_read_some(
+    MutableBufferSequence const& buffers,
+    ReadHandler&& handler)
+{
+    static_assert(is_async_stream<next_layer_type>::value,
+        "AsyncStream type requirements not met");
+    static_assert(net::is_mutable_buffer_sequence<
+        MutableBufferSequence>::value,
+        "MutableBufferSequence type requirements not met");
+    return net::async_initiate<
+        ReadHandler,
+        void(error_code, std::size_t)>(
+            run_io_op{},
+            handler,
+            this,
+            detail::record_read{
+                detail::record_read_buffer(buffers)});
+}
+
+template<class NextLayer>
+void
+teardown(
+    role_type,
+    pooled_ssl_stream<NextLayer>& stream,
+    error_code& ec)
+{
+    stream.shutdown(ec);
+}
+
+template<class NextLayer, class TeardownHandler>
+void
+async_teardown(
+    role_type,
+    pooled_ssl_stream<NextLayer>& stream,
+    TeardownHandler&& handler)
+{
+    stream.async_shutdown(
+        std::forward<TeardownHandler>(handler));
+}
+
+} // beast
+} // boost
+
+#endif
@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_SSL_IMPL_SSL_RECORD_POOL_IPP
+#define BOOST_BEAST_SSL_IMPL_SSL_RECORD_POOL_IPP
+
+#include <boost/beast/_experimental/ssl/ssl_record_pool.hpp>
+#include <boost/assert.hpp>
+#include <new>
+
+namespace boost {
+namespace beast {
+
+ssl_record_pool::
+~ssl_record_pool()
+{
+    BOOST_ASSERT(in_use_ == 0);
+    while(free_)
+    {
+        auto const p = free_;
+        free_ = p->next;
+        ::operator delete(p);
+    }
+}
+
+ssl_record_pool::
+ssl_record_pool(
+    std::size_t max_free,
+    std::size_t reserve)
+    : max_free_(max_free)
+{
+    for(std::size_t i = 0; i < reserve; ++i)
+    {
+        auto const p = ::new(::operator new(buffer_size)) node;
+        p->next = free_;
+        free_ = p;
+        ++free_count_;
+    }
+}
+
+void*
+ssl_record_pool::
+acquire()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        if(++in_use_ > peak_)
+            peak_ = in_use_;
+        if(auto const p = free_)
+        {
+            free_ = p->next;
+            --free_count_;
+            return p;
+        }
+    }
+    try
+    {
+        return ::operator new(buffer_size);
+    }
+    catch(...)
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        --in_use_;
+        throw;
+    }
+}
+
+void
+ssl_record_pool::
+release(void* p) noexcept
+{
+    if(! p)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        BOOST_ASSERT(in_use_ > 0);
+        --in_use_;
+        if(free_count_ < max_free_)
+        {
+            auto const n = ::new(p) node;
+            n->next = free_;
+            free_ = n;
+            ++free_count_;
+            return;
+        }
+    }
+    ::operator delete(p);
+}
+
+std::size_t
+ssl_record_pool::
+in_use() const noexcept
+{
+    std::lock_guard<std::mutex> lock(m_);
+    return in_use_;
+}
+
+std::size_t
+ssl_record_pool::
+peak() const noexcept
+{
+    std::lock_guard<std::mutex> lock(m_);
+    return peak_;
+}
+
+std::size_t
+ssl_record_pool::
+available() const noexcept
+{
+    std::lock_guard<std::mutex> lock(m_);
+    return free_count_;
+}
+
+} // beast
+} // boost
+
+#endif
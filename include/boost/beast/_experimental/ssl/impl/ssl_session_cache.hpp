@@ -0,0 +1,591 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_SSL_IMPL_SSL_SESSION_CACHE_HPP
+#define BOOST_BEAST_SSL_IMPL_SSL_SESSION_CACHE_HPP
+
+#include <boost/beast/core/error.hpp>
+#include <boost/asio/ssl/error.hpp>
+#include <boost/throw_exception.hpp>
+#include <cstring>
+#include <ctime>
+#include <iterator>
+#include <new>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#endif
+
+// Since OpenSSL is not linked with the Beast library, these
+// are defined inline in the header instead of a .ipp file.
+
+namespace boost {
+namespace beast {
+
+inline
+ssl_session_cache::
+ssl_session_cache()
+    : ssl_session_cache(options{})
+{
+}
+
+inline
+ssl_session_cache::
+ssl_session_cache(options const& opt)
+    : opt_(opt)
+{
+    ticket_key k;
+    make_key(k);
+    add_key(k);
+}
+
+inline
+void
+ssl_session_cache::
+install(net::ssl::context& ctx)
+{
+    auto const h = ctx.native_handle();
+    ::SSL_CTX_set_ex_data(h, ex_index(), this);
+    if(opt_.session_ids)
+    {
+        ::SSL_CTX_set_session_cache_mode(h,
+            SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+        ::SSL_CTX_sess_set_new_cb(h, &on_new_session);
+        ::SSL_CTX_sess_set_get_cb(h, &on_get_session);
+        ::SSL_CTX_sess_set_remove_cb(h, &on_remove_session);
+    }
+    else
+    {
+        ::SSL_CTX_set_session_cache_mode(h, SSL_SESS_CACHE_OFF);
+    }
+    if(opt_.tickets)
+    {
+        ::SSL_CTX_clear_options(h, SSL_OP_NO_TICKET);
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        ::SSL_CTX_set_tlsext_ticket_key_evp_cb(h, &on_ticket_key);
+#else
+        ::SSL_CTX_set_tlsext_ticket_key_cb(h, &on_ticket_key);
+#endif
+    }
+    else
+    {
+        ::SSL_CTX_set_options(h, SSL_OP_NO_TICKET);
+    }
+}
+
+inline
+void
+ssl_session_cache::
+rotate_ticket_key()
+{
+    ticket_key k;
+    make_key(k);
+    std::lock_guard<std::mutex> lock(m_);
+    add_key(k);
+}
+
+inline
+void
+ssl_session_cache::
+set_ticket_key(unsigned char const (&key)[ticket_key_size])
+{
+    ticket_key k;
+    std::memcpy(k.name, key, 16);
+    std::memcpy(k.aes, key + 16, 32);
+    std::memcpy(k.hmac, key + 48, 32);
+    k.created = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(m_);
+    add_key(k);
+}
+
+inline
+void
+ssl_session_cache::
+clear()
+{
+    std::lock_guard<std::mutex> lock(m_);
+    map_.clear();
+    list_.clear();
+}
+
+inline
+std::size_t
+ssl_session_cache::
+size() const
+{
+    std::lock_guard<std::mutex> lock(m_);
+    return map_.size();
+}
+
+inline
+std::size_t
+ssl_session_cache::
+hits() const
+{
+    std::lock_guard<std::mutex> lock(m_);
+    return hits_;
+}
+
+inline
+std::size_t
+ssl_session_cache::
+misses() const
+{
+    std::lock_guard<std::mutex> lock(m_);
+    return misses_;
+}
+
+inline
+int
+ssl_session_cache::
+ex_index()
+{
+    static int const index = ::SSL_CTX_get_ex_new_index(
+        0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+inline
+ssl_session_cache*
+ssl_session_cache::
+get(SSL* ssl)
+{
+    return static_cast<ssl_session_cache*>(::SSL_CTX_get_ex_data(
+        ::SSL_get_SSL_CTX(ssl), ex_index()));
+}
+
+inline
+int
+ssl_session_cache::
+on_new_session(SSL* ssl, SSL_SESSION* sess)
+{
+    auto const self = get(ssl);
+    unsigned int len;
+    auto const id = ::SSL_SESSION_get_id(sess, &len);
+    int const n = ::i2d_SSL_SESSION(sess, nullptr);
+    if(! self || len == 0 || n <= 0)
+        return 0;
+    session s;
+    s.id.assign(reinterpret_cast<char const*>(id), len);
+    s.der.resize(static_cast<std::size_t>(n));
+    auto p = reinterpret_cast<unsigned char*>(&s.der[0]);
+    ::i2d_SSL_SESSION(sess, &p);
+
+    std::lock_guard<std::mutex> lock(self->m_);
+    auto const it = self->map_.find(s.id);
+    if(it != self->map_.end())
+    {
+        self->list_.erase(it->second);
+        self->map_.erase(it);
+    }
+    while(! self->list_.empty() &&
+        self->list_.size() >= self->opt_.max_sessions)
+    {
+        self->map_.erase(self->list_.back().id);
+        self->list_.pop_back();
+    }
+    if(self->opt_.max_sessions == 0)
+        return 0;
+    self->list_.push_front(std::move(s));
+    self->map_.emplace(self->list_.front().id, self->list_.begin());
+    // We keep our own copy, not the reference
+    return 0;
+}
+
+inline
+SSL_SESSION*
+ssl_session_cache::
+on_get_session(SSL* ssl,
+    unsigned char const* id, int len, int* copy)
+{
+    *copy = 0;
+    auto const self = get(ssl);
+    if(! self)
+        return nullptr;
+    std::string der;
+    {
+        std::lock_guard<std::mutex> lock(self->m_);
+        auto const it = self->map_.find(std::string(
+            reinterpret_cast<char const*>(id),
+            static_cast<std::size_t>(len)));
+        if(it == self->map_.end())
+        {
+            ++self->misses_;
+            return nullptr;
+        }
+        self->list_.splice(self->list_.begin(),
+            self->list_, it->second);
+        der = it->second->der;
+    }
+    auto p = reinterpret_cast<unsigned char const*>(der.data());
+    auto const sess = ::d2i_SSL_SESSION(
+        nullptr, &p, static_cast<long>(der.size()));
+    bool const expired = sess && std::time(nullptr) >
+        ::SSL_SESSION_get_time(sess) + ::SSL_SESSION_get_timeout(sess);
+    std::lock_guard<std::mutex> lock(self->m_);
+    if(! sess || expired)
+    {
+        ++self->misses_;
+        auto const it = self->map_.find(std::string(
+            reinterpret_cast<char const*>(id),
+            static_cast<std::size_t>(len)));
+        if(it != self->map_.end())
+        {
+            self->list_.erase(it->second);
+            self->map_.erase(it);
+        }
+        if(sess)
+            ::SSL_SESSION_free(sess);
+        return nullptr;
+    }
+    ++self->hits_;
+    return sess;
+}
+
+inline
+void
+ssl_session_cache::
+on_remove_session(SSL_CTX* ctx, SSL_SESSION* sess)
+{
+    auto const self = static_cast<ssl_session_cache*>(
+        ::SSL_CTX_get_ex_data(ctx, ex_index()));
+    if(! self)
+        return;
+    unsigned int len;
+    auto const id = ::SSL_SESSION_get_id(sess, &len);
+    std::lock_guard<std::mutex> lock(self->m_);
+    auto const it = self->map_.find(std::string(
+        reinterpret_cast<char const*>(id), len));
+    if(it == self->map_.end())
+        return;
+    self->list_.erase(it->second);
+    self->map_.erase(it);
+}
+
+inline
+int
+ssl_session_cache::
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+on_ticket_key(SSL* ssl,
+    unsigned char* name, unsigned char* iv,
+    EVP_CIPHER_CTX* cctx, EVP_MAC_CTX* hctx, int enc)
+#else
+on_ticket_key(SSL* ssl,
+    unsigned char* name, unsigned char* iv,
+    EVP_CIPHER_CTX* cctx, HMAC_CTX* hctx, int enc)
+#endif
+{
+    auto const self = get(ssl);
+    if(! self)
+        return -1;
+    ticket_key k;
+    int result = 1;
+    if(enc)
+    {
+        if(::RAND_bytes(iv, 16) <= 0)
+            return -1;
+        auto const now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(self->m_);
+        if(now - self->keys_.front().created >=
+            self->opt_.ticket_key_lifetime)
+        {
+            ticket_key nk;
+            make_key(nk);
+            self->add_key(nk);
+        }
+        k = self->keys_.front();
+        std::memcpy(name, k.name, 16);
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(self->m_);
+        auto it = self->keys_.begin();
+        for(; it != self->keys_.end(); ++it)
+            if(std::memcmp(name, it->name, 16) == 0)
+                break;
+        if(it == self->keys_.end())
+        {
+            // Unknown key, do a full handshake
+            ++self->misses_;
+            return 0;
+        }
+        ++self->hits_;
+        // Issue a ticket under the current key. TLS 1.3
+        // clients use each ticket once, so always renew.
+        if( it != self->keys_.begin() ||
+            ::SSL_version(ssl) >= TLS1_3_VERSION)
+            result = 2;
+        k = *it;
+    }
+    if(::EVP_CipherInit_ex(cctx, ::EVP_aes_256_cbc(),
+            nullptr, k.aes, iv, enc) <= 0)
+        return -1;
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    char digest[] = "SHA256";
+    OSSL_PARAM params[3];
+    params[0] = ::OSSL_PARAM_construct_octet_string(
+        OSSL_MAC_PARAM_KEY, k.hmac, sizeof(k.hmac));
+    params[1] = ::OSSL_PARAM_construct_utf8_string(
+        OSSL_MAC_PARAM_DIGEST, digest, 0);
+    params[2] = ::OSSL_PARAM_construct_end();
+    if(::EVP_MAC_CTX_set_params(hctx, params) <= 0)
+        return -1;
+#else
+    if(::HMAC_Init_ex(hctx, k.hmac, sizeof(k.hmac),
+            ::EVP_sha256(), nullptr) <= 0)
+        return -1;
+#endif
+    return result;
+}
+
+inline
+void
+ssl_session_cache::
+add_key(ticket_key const& k)
+{
+    keys_.insert(keys_.begin(), k);
+    if(keys_.size() > opt_.previous_ticket_keys + 1)
+        keys_.resize(opt_.previous_ticket_keys + 1);
+}
+
+inline
+void
+ssl_session_cache::
+make_key(ticket_key& k)
+{
+    if( ::RAND_bytes(k.name, sizeof(k.name)) <= 0 ||
+        ::RAND_bytes(k.aes, sizeof(k.aes)) <= 0 ||
+        ::RAND_bytes(k.hmac, sizeof(k.hmac)) <= 0)
+        BOOST_THROW_EXCEPTION(system_error{error_code(
+            static_cast<int>(::ERR_get_error()),
+            net::error::get_ssl_category())});
+    k.created = std::chrono::steady_clock::now();
+}
+
+//------------------------------------------------------------------------------
+
+inline
+ssl_client_session_store::
+~ssl_client_session_store()
+{
+    for(auto& e : list_)
+        ::SSL_SESSION_free(e.sess);
+}
+
+inline
+ssl_client_session_store::
+ssl_client_session_store(std::size_t max_servers)
+    : max_(max_servers)
+{
+}
+
+inline
+void
+ssl_client_session_store::
+install(net::ssl::context& ctx)
+{
+    auto const h = ctx.native_handle();
+    ::SSL_CTX_set_ex_data(h, ex_index(), this);
+    ::SSL_CTX_set_session_cache_mode(h,
+        SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    ::SSL_CTX_sess_set_new_cb(h, &on_new_session);
+    ::SSL_CTX_set_info_callback(h, &on_info);
+}
+
+inline
+bool
+ssl_client_session_store::
+prepare(SSL* ssl, string_view key)
+{
+    auto const p = new prepared;
+    p->key.assign(key.data(), key.size());
+    delete static_cast<prepared*>(
+        ::SSL_get_ex_data(ssl, key_index()));
+    ::SSL_set_ex_data(ssl, key_index(), p);
+
+    std::lock_guard<std::mutex> lock(m_);
+    auto const it = map_.find(p->key);
+    if(it != map_.end())
+    {
+        // OpenSSL invalidates the session of a connection
+        // which ends without a TLS shutdown.
+        auto const sess = it->second->sess;
+        if( std::time(nullptr) <= ::SSL_SESSION_get_time(sess) +
+                ::SSL_SESSION_get_timeout(sess)
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+            && ::SSL_SESSION_is_resumable(sess)
+#endif
+            )
+        {
+            list_.splice(list_.begin(), list_, it->second);
+            ::SSL_set_session(ssl, sess);
+            ++offered_;
+            return true;
+        }
+        erase(it->second);
+    }
+    ++misses_;
+    return false;
+}
+
+inline
+void
+ssl_client_session_store::
+erase(string_view key)
+{
+    std::lock_guard<std::mutex> lock(m_);
+    auto const it = map_.find(std::string(key.data(), key.size()));
+    if(it != map_.end())
+        erase(it->second);
+}
+
+inline
+std::size_t
+ssl_client_session_store::
+size() const
+{
+    std::lock_guard<std::mutex> lock(m_);
+    return map_.size();
+}
+
+inline
+std::size_t
+ssl_client_session_store::
+hits() const
+{
+    std::lock_guard<std::mutex> lock(m_);
+    return hits_;
+}
+
+inline
+std::size_t
+ssl_client_session_store::
+offered() const
+{
+    std::lock_guard<std::mutex> lock(m_);
+    return offered_;
+}
+
+inline
+std::size_t
+ssl_client_session_store::
+misses() const
+{
+    std::lock_guard<std::mutex> lock(m_);
+    return misses_;
+}
+
+inline
+int
+ssl_client_session_store::
+ex_index()
+{
+    static int const index = ::SSL_CTX_get_ex_new_index(
+        0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+inline
+int
+ssl_client_session_store::
+key_index()
+{
+    static int const index = ::SSL_get_ex_new_index(
+        0, nullptr, nullptr, nullptr, &free_key);
+    return index;
+}
+
+inline
+void
+ssl_client_session_store::
+free_key(void*, void* p, CRYPTO_EX_DATA*, int, long, void*)
+{
+    delete static_cast<prepared*>(p);
+}
+
+inline
+int
+ssl_client_session_store::
+on_new_session(SSL* ssl, SSL_SESSION* sess)
+{
+    auto const self = static_cast<ssl_client_session_store*>(
+        ::SSL_CTX_get_ex_data(::SSL_get_SSL_CTX(ssl), ex_index()));
+    auto const p = static_cast<prepared const*>(
+        ::SSL_get_ex_data(ssl, key_index()));
+    if(! self || ! p || self->max_ == 0)
+        return 0;
+    auto const& key = p->key;
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+    if(! ::SSL_SESSION_is_resumable(sess))
+        return 0;
+#endif
+    std::lock_guard<std::mutex> lock(self->m_);
+    auto const it = self->map_.find(key);
+    if(it != self->map_.end())
+    {
+        if(it->second->sess == sess)
+            return 0;
+        self->erase(it->second);
+    }
+    while(self->list_.size() >= self->max_)
+        self->erase(std::prev(self->list_.end()));
+    self->list_.push_front(entry{key, sess});
+    self->map_.emplace(key, self->list_.begin());
+    // We keep the reference
+    return 1;
+}
+
+inline
+void
+ssl_client_session_store::
+on_info(SSL const* ssl, int where, int)
+{
+    if(! (where & SSL_CB_HANDSHAKE_DONE))
+        return;
+    auto const h = const_cast<SSL*>(ssl);
+    auto const reused = ::SSL_session_reused(h) == 1;
+
+    // TLS 1.3 reports each ticket received after
+    // the handshake, so count each stream once.
+    auto const self = static_cast<ssl_client_session_store*>(
+        ::SSL_CTX_get_ex_data(::SSL_get_SSL_CTX(ssl), ex_index()));
+    auto const p = static_cast<prepared*>(
+        ::SSL_get_ex_data(h, key_index()));
+    if(self && p && ! p->counted)
+    {
+        p->counted = true;
+        if(reused)
+        {
+            std::lock_guard<std::mutex> lock(self->m_);
+            ++self->hits_;
+        }
+    }
+
+    // Before TLS 1.3, a ticket renewed in an abbreviated
+    // handshake is not given to the new session callback.
+    if(! reused || ::SSL_version(ssl) >= TLS1_3_VERSION)
+        return;
+    auto const sess = ::SSL_get1_session(h);
+    if(sess && on_new_session(h, sess) == 0)
+        ::SSL_SESSION_free(sess);
+}
+
+inline
+void
+ssl_client_session_store::
+erase(list_type::iterator it)
+{
+    ::SSL_SESSION_free(it->sess);
+    map_.erase(it->key);
+    list_.erase(it);
+}
+
+} // beast
+} // boost
+
+#endif
@@ -0,0 +1,413 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_SSL_POOLED_SSL_STREAM_HPP
+#define BOOST_BEAST_SSL_POOLED_SSL_STREAM_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/_experimental/ssl/ssl_record_pool.hpp>
+#include <boost/beast/_experimental/ssl/detail/record_engine.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/role.hpp>
+#include <boost/beast/core/saved_handler.hpp>
+#include <boost/beast/core/stream_traits.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <boost/asio/ssl/stream_base.hpp>
+#include <boost/asio/ssl/verify_mode.hpp>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace boost {
+namespace beast {
+
+/** A TLS stream which keeps its record buffers in a shared pool.
+
+    This stream provides the same operations as @ref ssl_stream,
+    using OpenSSL, but moves records between OpenSSL and the next
+    layer through buffers taken from a @ref ssl_record_pool:
+
+    @li Received bytes are read from the next layer directly into a
+        record buffer, and records are written to the next layer
+        directly from a record buffer, without the BIO pair and the
+        two staging vectors which `net::ssl::stream` allocates and
+        copies through for each connection.
+
+    @li A buffer is taken when an operation needs it and returned
+        when the operation completes with the buffer empty. When the
+        next layer is a socket, or a @ref basic_stream such as
+        @ref tcp_stream, a read waits for data to arrive on the socket
+        before taking a buffer, so a connection blocked in a read holds
+        no buffer at all. OpenSSL is also told to free its own buffers
+        when idle with `SSL_MODE_RELEASE_BUFFERS`.
+
+    @li The wait on the socket of a @ref basic_stream is not subject
+        to the stream's timeout, which applies again once data arrives
+        and the record is read. Cancelling or closing the stream ends
+        the wait. To time out quiet connections, use a timer of the
+        protocol above, such as the idle timeout of `websocket::stream`.
+
+    @li @ref buffer_bytes reports the pooled memory the stream
+        holds, and the pool reports the total.
+
+    Short buffer sequences given to a write are gathered, in a pooled
+    buffer, into a single record, as @ref ssl_stream does with
+    @ref flat_stream.
+
+    @par Example
+    @code
+    ssl_record_pool pool;
+    net::ssl::context ctx{net::ssl::context::tlsv12_client};
+    pooled_ssl_stream<net::ip::tcp::socket> stream{ioc, ctx, pool};
+    @endcode
+
+    @par Thread Safety
+    @e Distinct @e objects: Safe.@n
+    @e Shared @e objects: Unsafe. The application must also ensure
+    that all asynchronous operations are performed within the same
+    implicit or explicit strand.
+
+    @tparam NextLayer The type of the stream the TLS records are
+    sent over.
+*/
+template<class NextLayer>
+class pooled_ssl_stream
+    : public net::ssl::stream_base
+{
+    template<class Operation, class Handler>
+    class io_op;
+
+    struct run_io_op;
+
+    NextLayer next_;
+    std::unique_ptr<detail::record_engine> eng_;
+    saved_handler op_out_;  // waiting for the output buffer
+
+    template<class Operation>
+    void
+    io(Operation const& op,
+        error_code& ec, std::size_t& n);
+
+public:
+    /// The native handle type of the SSL stream.
+    using native_handle_type = SSL*;
+
+    /// The type of the next layer.
+    using next_layer_type =
+        typename std::remove_reference<NextLayer>::type;
+
+    /// The type of the executor associated with the object.
+    using executor_type =
+        beast::executor_type<next_layer_type>;
+
+    /** Constructor
+
+        @param arg The argument used to construct the next layer.
+
+        @param ctx The SSL context. The settings it holds when
+        the stream is constructed are used for the connection.
+
+        @param pool The pool of record buffers. It must outlive
+        the stream.
+    */
+    template<class Arg>
+    pooled_ssl_stream(
+        Arg&& arg,
+        net::ssl::context& ctx,
+        ssl_record_pool& pool)
+        : next_(std::forward<Arg>(arg))
+        , eng_(new detail::record_engine(ctx, pool))
+    {
+    }
+
+    /// Return the executor associated with the object.
+    executor_type
+    get_executor() noexcept
+    {
+        return next_.get_executor();
+    }
+
+    /** Return the underlying `SSL*`.
+
+        This may be used to set options before the handshake, such
+        as the host name to send with `SSL_set_tlsext_host_name`.
+    */
+    native_handle_type
+    native_handle() noexcept
+    {
+        return eng_->native_handle();
+    }
+
+    /// Return a reference to the next layer.
+    next_layer_type&
+    next_layer() noexcept
+    {
+        return next_;
+    }
+
+    /// Return a reference to the next layer.
+    next_layer_type const&
+    next_layer() const noexcept
+    {
+        return next_;
+    }
+
+    /// Return the pool which provides record buffers.
+    ssl_record_pool&
+    pool() const noexcept
+    {
+        return eng_->pool();
+    }
+
+    /** Return the number of bytes of pooled buffers held.
+
+        This is zero whenever the stream is idle, including while
+        a read waits for data on a socket.
+    */
+    std::size_t
+    buffer_bytes() const noexcept
+    {
+        return eng_->buffer_bytes();
+    }
+
+    /// Set the peer verification mode.
+    void
+    set_verify_mode(net::ssl::verify_mode v)
+    {
+        ::SSL_set_verify(eng_->native_handle(),
+            static_cast<int>(v), ::SSL_get_verify_callback(
+                eng_->native_handle()));
+    }
+
+    /** Perform the TLS handshake.
+
+        @param type The role of this end of the connection.
+
+        @throws system_error Thrown on failure.
+    */
+    void
+    handshake(handshake_type type);
+
+    /** Perform the TLS handshake.
+
+        @param type The role of this end of the connection.
+
+        @param ec Set to indicate what error occurred, if any.
+    */
+    void
+    handshake(handshake_type type, error_code& ec);
+
+    /** Perform the TLS handshake asynchronously.
+
+        @param type The role of this end of the connection.
+
+        @param handler The completion handler to invoke when the
+        operation completes. The implementation takes ownership of
+        the handler by performing a decay-copy. The equivalent
+        function signature of the handler must be:
+        @code
+        void handler(
+            error_code const& ec    // Result of operation
+        );
+        @endcode
+        Regardless of whether the asynchronous operation completes
+        immediately or not, the handler will not be invoked from within
+        this function. Invocation of the handler will be performed in a
+        manner equivalent to using `net::post`.
+    */
+    template<
+        BOOST_BEAST_ASYNC_TPARAM1 HandshakeHandler =
+            net::default_completion_token_t<executor_type>>
+    BOOST_BEAST_ASYNC_RESULT1(HandshakeHandler)
+    async_handshake(
+        handshake_type type,
+        HandshakeHandler&& handler =
+            net::default_completion_token_t<executor_type>{});
+
+    /** Shut down TLS on the stream.
+
+        This sends close_notify and waits for the peer's.
+
+        @throws system_error Thrown on failure.
+    */
+    void
+    shutdown();
+
+    /** Shut down TLS on the stream.
+
+        This sends close_notify and waits for the peer's.
+
+        @param ec Set to indicate what error occurred, if any.
+    */
+    void
+    shutdown(error_code& ec);
+
+    /** Shut down TLS on the stream asynchronously.
+
+        This sends close_notify and waits for the peer's.
+
+        @param handler The completion handler to invoke when the
+        operation completes. The implementation takes ownership of
+        the handler by performing a decay-copy. The equivalent
+        function signature of the handler must be:
+        @code
+        void handler(
+            error_code const& ec    // Result of operation
+        );
+        @endcode
+        Regardless of whether the asynchronous operation completes
+        immediately or not, the handler will not be invoked from within
+        this function. Invocation of the handler will be performed in a
+        manner equivalent to using `net::post`.
+    */
+    template<
+        BOOST_BEAST_ASYNC_TPARAM1 ShutdownHandler =
+            net::default_completion_token_t<executor_type>>
+    BOOST_BEAST_ASYNC_RESULT1(ShutdownHandler)
+    async_shutdown(
+        ShutdownHandler&& handler =
+            net::default_completion_token_t<executor_type>{});
+
+    /** Write some data to the stream.
+
+        @param buffers The data to write.
+
+        @return The number of bytes written.
+
+        @throws system_error Thrown on failure.
+    */
+    template<class ConstBufferSequence>
+    std::size_t
+    write_some(ConstBufferSequence const& buffers);
+
+    /** Write some data to the stream.
+
+        @param buffers The data to write.
+
+        @param ec Set to indicate what error occurred, if any.
+
+        @return The number of bytes written.
+    */
+    template<class ConstBufferSequence>
+    std::size_t
+    write_some(ConstBufferSequence const& buffers,
+        error_code& ec);
+
+    /** Write some data to the stream asynchronously.
+
+        @param buffers The data to write. The caller retains
+        ownership, and must keep the memory valid until the
+        handler is invoked.
+
+        @param handler The completion handler to invoke when the
+        operation completes. The implementation takes ownership of
+        the handler by performing a decay-copy. The equivalent
+        function signature of the handler must be:
+        @code
+        void handler(
+            error_code const& ec,       // Result of operation
+            std::size_t bytes_written   // Number of bytes written
+        );
+        @endcode
+        Regardless of whether the asynchronous operation completes
+        immediately or not, the handler will not be invoked from within
+        this function. Invocation of the handler will be performed in a
+        manner equivalent to using `net::post`.
+    */
+    template<
+        class ConstBufferSequence,
+        BOOST_BEAST_ASYNC_TPARAM2 WriteHandler =
+            net::default_completion_token_t<executor_type>>
+    BOOST_BEAST_ASYNC_RESULT2(WriteHandler)
+    async_write_some(
+        ConstBufferSequence const& buffers,
+        WriteHandler&& handler =
+            net::default_completion_token_t<executor_type>{});
+
+    /** Read some data from the stream.
+
+        @param buffers The buffers to read into.
+
+        @return The number of bytes read.
+
+        @throws system_error Thrown on failure.
+    */
+    template<class MutableBufferSequence>
+    std::size_t
+    read_some(MutableBufferSequence const& buffers);
+
+    /** Read some data from the stream.
+
+        @param buffers The buffers to read into.
+
+        @param ec Set to indicate what error occurred, if any.
+
+        @return The number of bytes read.
+    */
+    template<class MutableBufferSequence>
+    std::size_t
+    read_some(MutableBufferSequence const& buffers,
+        error_code& ec);
+
+    /** Read some data from the stream asynchronously.
+
+        @param buffers The buffers to read into. The caller retains
+        ownership, and must keep the memory valid until the handler
+        is invoked.
+
+        @param handler The completion handler to invoke when the
+        operation completes. The implementation takes ownership of
+        the handler by performing a decay-copy. The equivalent
+        function signature of the handler must be:
+        @code
+        void handler(
+            error_code const& ec,       // Result of operation
+            std::size_t bytes_read      // Number of bytes read
+        );
+        @endcode
+        Regardless of whether the asynchronous operation completes
+        immediately or not, the handler will not be invoked from within
+        this function. Invocation of the handler will be performed in a
+        manner equivalent to using `net::post`.
+    */
+    template<
+        class MutableBufferSequence,
+        BOOST_BEAST_ASYNC_TPARAM2 ReadHandler =
+            net::default_completion_token_t<executor_type>>
+    BOOST_BEAST_ASYNC_RESULT2(ReadHandler)
+    async_read_some(
+        MutableBufferSequence const& buffers,
+        ReadHandler&& handler =
+            net::default_completion_token_t<executor_type>{});
+};
+
+#if ! BOOST_BEAST_DOXYGEN
+template<class NextLayer>
+void
+teardown(
+    role_type role,
+    pooled_ssl_stream<NextLayer>& stream,
+    error_code& ec);
+
+template<class NextLayer, class TeardownHandler>
+void
+async_teardown(
+    role_type role,
+    pooled_ssl_stream<NextLayer>& stream,
+    TeardownHandler&& handler);
+#endif
+
+} // beast
+} // boost
+
+#include <boost/beast/_experimental/ssl/impl/pooled_ssl_stream.hpp>
+
+#endif
@@ -0,0 +1,117 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_SSL_SSL_RECORD_POOL_HPP
+#define BOOST_BEAST_SSL_SSL_RECORD_POOL_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <cstddef>
+#include <mutex>
+
+namespace boost {
+namespace beast {
+
+/** A pool of buffers for TLS records.
+
+    Each buffer holds one record as it appears on the wire.
+    Streams such as @ref pooled_ssl_stream take a buffer only
+    while they are moving data, and give it back as soon as they
+    are idle, so many mostly-idle connections can share a small
+    number of buffers.
+
+    Buffers returned to the pool are kept for reuse, up to a
+    limit, and may be allocated up front.
+
+    @par Thread Safety
+    @e Distinct @e objects: Safe.@n
+    @e Shared @e objects: Safe.
+*/
+class ssl_record_pool
+{
+    struct node
+    {
+        node* next;
+    };
+
+    mutable std::mutex m_;
+    node* free_ = nullptr;
+    std::size_t free_count_ = 0;
+    std::size_t in_use_ = 0;
+    std::size_t peak_ = 0;
+    std::size_t max_free_;
+
+public:
+    /** The size of each buffer.
+
+        This is the largest TLS record: 16KB of plaintext, 2KB
+        of expansion allowed by TLS 1.2, and the 5 byte header.
+    */
+    static std::size_t constexpr buffer_size = 16384 + 2048 + 5;
+
+    ssl_record_pool(ssl_record_pool const&) = delete;
+    ssl_record_pool& operator=(ssl_record_pool const&) = delete;
+
+    /** Destructor
+
+        All buffers must have been returned.
+    */
+    BOOST_BEAST_DECL
+    ~ssl_record_pool();
+
+    /** Constructor
+
+        @param max_free The largest number of unused buffers
+        kept for reuse. Buffers returned beyond this are freed.
+
+        @param reserve The number of buffers to allocate now.
+    */
+    BOOST_BEAST_DECL
+    explicit
+    ssl_record_pool(
+        std::size_t max_free = 1024,
+        std::size_t reserve = 0);
+
+    /** Take a buffer of @ref buffer_size bytes.
+
+        @throws std::bad_alloc if no buffer is free and
+        memory could not be obtained.
+    */
+    BOOST_BEAST_DECL
+    void*
+    acquire();
+
+    /// Return a buffer obtained from @ref acquire.
+    BOOST_BEAST_DECL
+    void
+    release(void* p) noexcept;
+
+    /// Returns the number of buffers currently taken.
+    BOOST_BEAST_DECL
+    std::size_t
+    in_use() const noexcept;
+
+    /// Returns the largest number of buffers taken at once.
+    BOOST_BEAST_DECL
+    std::size_t
+    peak() const noexcept;
+
+    /// Returns the number of unused buffers kept for reuse.
+    BOOST_BEAST_DECL
+    std::size_t
+    available() const noexcept;
+};
+
+} // beast
+} // boost
+
+#ifdef BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/_experimental/ssl/impl/ssl_record_pool.ipp>
+#endif
+
+#endif
@@ -0,0 +1,387 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_SSL_SSL_SESSION_CACHE_HPP
+#define BOOST_BEAST_SSL_SSL_SESSION_CACHE_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <boost/asio/ssl/detail/openssl_types.hpp>
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+# error "ssl_session_cache requires OpenSSL 1.1.0 or later"
+#endif
+
+namespace boost {
+namespace beast {
+
+/** A TLS session cache for servers.
+
+    Installed on a server's SSL context, this lets clients resume
+    earlier sessions with an abbreviated handshake, which skips
+    the key exchange and certificate signature:
+
+    @li Session tickets are encrypted with keys the cache holds.
+        The key used for new tickets is replaced periodically, and
+        a number of earlier keys are kept so that recent tickets
+        are still accepted. A ticket under an earlier key is
+        replaced with one under the current key.
+
+    @li Session IDs, used by clients without ticket support, are
+        looked up in a table of the most recently used sessions.
+
+    One cache may be installed on several contexts, for example
+    one per thread or per certificate, and may be used from any
+    thread. Servers which share the same ticket keys, by calling
+    @ref set_ticket_key, resume each other's sessions.
+
+    @par Example
+    @code
+    ssl_session_cache cache;
+    net::ssl::context ctx{net::ssl::context::tlsv12_server};
+    cache.install(ctx);
+    ssl_stream<tcp_stream> stream{ioc, ctx};
+    @endcode
+
+    @note The cache must outlive every context it is installed on.
+*/
+class ssl_session_cache
+{
+public:
+    /// Cache settings
+    struct options
+    {
+        /// Maximum number of sessions kept for session IDs.
+        std::size_t max_sessions = 20000;
+
+        /// How long the key used for new tickets is used.
+        std::chrono::steady_clock::duration ticket_key_lifetime =
+            std::chrono::hours(12);
+
+        /// Number of earlier ticket keys which are still accepted.
+        std::size_t previous_ticket_keys = 2;
+
+        /// Issue and accept session tickets.
+        bool tickets = true;
+
+        /// Keep sessions for resumption by session ID.
+        bool session_ids = true;
+    };
+
+    /// The size of a ticket key, in bytes.
+    static std::size_t constexpr ticket_key_size = 80;
+
+    ssl_session_cache(ssl_session_cache const&) = delete;
+    ssl_session_cache& operator=(ssl_session_cache const&) = delete;
+
+    /// Constructor
+    ssl_session_cache();
+
+    /// Constructor
+    explicit
+    ssl_session_cache(options const& opt);
+
+    /// Return the cache settings.
+    options const&
+    get_options() const noexcept
+    {
+        return opt_;
+    }
+
+    /** Install the cache on an SSL context.
+
+        Streams constructed from the context afterwards use the
+        cache. This replaces the context's session callbacks,
+        and its ticket key callback if tickets are enabled.
+    */
+    void
+    install(net::ssl::context& ctx);
+
+    /** Start using a new, random key for new tickets.
+
+        The previous key is still accepted, up to the number of
+        earlier keys in the settings.
+    */
+    void
+    rotate_ticket_key();
+
+    /** Start using the given key for new tickets.
+
+        This lets several servers resume each other's sessions.
+        The previous key is still accepted, up to the number of
+        earlier keys in the settings, and the key is replaced
+        after the key lifetime unless set again.
+
+        @param key The key: a 16 byte name, a 32 byte encryption
+        key, and a 32 byte authentication key.
+    */
+    void
+    set_ticket_key(unsigned char const (&key)[ticket_key_size]);
+
+    /// Remove all sessions kept for session IDs.
+    void
+    clear();
+
+    /// Return the number of sessions kept for session IDs.
+    std::size_t
+    size() const;
+
+    /** Return the number of offered sessions the cache knew.
+
+        A ticket is counted when the key it names is accepted,
+        before its integrity is checked. A corrupted or forged
+        ticket under such a key counts as a hit, although the
+        handshake is then a full one.
+    */
+    std::size_t
+    hits() const;
+
+    /** Return the number of offered sessions the cache did not know.
+
+        These are unknown or expired session IDs, and tickets under
+        a key which is no longer accepted.
+    */
+    std::size_t
+    misses() const;
+
+private:
+    struct ticket_key
+    {
+        unsigned char name[16];
+        unsigned char aes[32];
+        unsigned char hmac[32];
+        std::chrono::steady_clock::time_point created;
+    };
+
+    struct session
+    {
+        std::string id;
+        std::string der;
+    };
+
+    using list_type = std::list<session>;
+
+    static
+    ssl_session_cache*
+    get(SSL* ssl);
+
+    static
+    int
+    ex_index();
+
+    static
+    int
+    on_new_session(SSL* ssl, SSL_SESSION* sess);
+
+    static
+    SSL_SESSION*
+    on_get_session(SSL* ssl,
+        unsigned char const* id, int len, int* copy);
+
+    static
+    void
+    on_remove_session(SSL_CTX* ctx, SSL_SESSION* sess);
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    static
+    int
+    on_ticket_key(SSL* ssl,
+        unsigned char* name, unsigned char* iv,
+        EVP_CIPHER_CTX* cctx, EVP_MAC_CTX* hctx, int enc);
+#else
+    static
+    int
+    on_ticket_key(SSL* ssl,
+        unsigned char* name, unsigned char* iv,
+        EVP_CIPHER_CTX* cctx, HMAC_CTX* hctx, int enc);
+#endif
+
+    void
+    add_key(ticket_key const& k);
+
+    static
+    void
+    make_key(ticket_key& k);
+
+    options opt_;
+    mutable std::mutex m_;
+    std::vector<ticket_key> keys_;  // current key first
+    list_type list_;                // most recently used first
+    std::unordered_map<std::string, list_type::iterator> map_;
+    std::size_t hits_ = 0;
+    std::size_t misses_ = 0;
+};
+
+//------------------------------------------------------------------------------
+
+/** A TLS session store for clients.
+
+    Installed on a client's SSL context, this keeps the most
+    recent session, or ticket, received from each server, and
+    offers it the next time a stream connects to the same server,
+    so that the handshake can be abbreviated.
+
+    Streams are associated with a server by calling @ref prepare
+    before the handshake. The key is chosen by the caller and is
+    usually the host name and port.
+
+    @par Example
+    @code
+    ssl_client_session_store store;
+    net::ssl::context ctx{net::ssl::context::tlsv12_client};
+    store.install(ctx);
+
+    ssl_stream<tcp_stream> stream{ioc, ctx};
+    store.prepare(stream, "www.example.com:443");
+    stream.handshake(net::ssl::stream_base::client);
+    @endcode
+
+    @note The store must outlive every context it is installed on,
+    and every stream prepared with it.
+*/
+class ssl_client_session_store
+{
+public:
+    ssl_client_session_store(ssl_client_session_store const&) = delete;
+    ssl_client_session_store& operator=(ssl_client_session_store const&) = delete;
+
+    /// Destructor
+    ~ssl_client_session_store();
+
+    /** Constructor
+
+        @param max_servers The largest number of servers for which
+        a session is kept. The least recently used is removed first.
+    */
+    explicit
+    ssl_client_session_store(std::size_t max_servers = 1024);
+
+    /** Install the store on an SSL context.
+
+        This replaces the context's new session callback
+        and info callback.
+    */
+    void
+    install(net::ssl::context& ctx);
+
+    /** Associate a stream with a server, before the handshake.
+
+        Sessions the stream receives are kept for the server, and
+        the kept session, if any, is offered in the handshake.
+        Whether it was accepted may be checked afterwards with
+        `SSL_session_reused`.
+
+        @param stream The stream, whose `native_handle` returns
+        the `SSL*`.
+
+        @param key The name of the server.
+
+        @return `true` if a session was offered.
+    */
+    template<class Stream>
+    bool
+    prepare(Stream& stream, string_view key)
+    {
+        return prepare(stream.native_handle(), key);
+    }
+
+    /// Associate an `SSL*` with a server, before the handshake.
+    bool
+    prepare(SSL* ssl, string_view key);
+
+    /// Remove the session kept for a server, if any.
+    void
+    erase(string_view key);
+
+    /// Return the number of servers with a kept session.
+    std::size_t
+    size() const;
+
+    /** Return the number of handshakes which resumed a session.
+
+        This is counted when a prepared stream completes its
+        handshake, using `SSL_session_reused`.
+    */
+    std::size_t
+    hits() const;
+
+    /** Return the number of handshakes which offered a session.
+
+        The server may decline an offered session, so this is
+        at least @ref hits.
+    */
+    std::size_t
+    offered() const;
+
+    /// Return the number of handshakes with no session to offer.
+    std::size_t
+    misses() const;
+
+private:
+    struct entry
+    {
+        std::string key;
+        SSL_SESSION* sess;
+    };
+
+    // Attached to each prepared `SSL*`
+    struct prepared
+    {
+        std::string key;
+        bool counted = false;   // the handshake was counted
+    };
+
+    using list_type = std::list<entry>;
+
+    static
+    int
+    ex_index();
+
+    static
+    int
+    key_index();
+
+    static
+    int
+    on_new_session(SSL* ssl, SSL_SESSION* sess);
+
+    static
+    void
+    on_info(SSL const* ssl, int where, int ret);
+
+    static
+    void
+    free_key(void*, void* p, CRYPTO_EX_DATA*, int, long, void*);
+
+    void
+    erase(list_type::iterator it);
+
+    std::size_t max_;
+    mutable std::mutex m_;
+    list_type list_;    // most recently used first
+    std::unordered_map<std::string, list_type::iterator> map_;
+    std::size_t hits_ = 0;
+    std::size_t offered_ = 0;
+    std::size_t misses_ = 0;
+};
+
+} // beast
+} // boost
+
+#include <boost/beast/_experimental/ssl/impl/ssl_session_cache.hpp>
+
+#endif
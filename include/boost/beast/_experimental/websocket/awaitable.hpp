@@ -0,0 +1,125 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_WEBSOCKET_AWAITABLE_HPP
+#define BOOST_BEAST_WEBSOCKET_AWAITABLE_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/websocket/stream.hpp>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+
+#if BOOST_ASIO_HAS_CO_AWAIT
+
+#include <cstddef>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+
+/** Read a complete message from a websocket stream using a coroutine.
+
+    This function is the `co_await` counterpart of
+    `stream::async_read`, with the same error handling conventions
+    as the HTTP functions @ref http::co_read. When the stream's
+    read buffer already holds the whole message as a single
+    uncompressed frame, which is typical of small messages sent
+    back to back, the payload is copied out directly, without
+    starting the stream's read operation or suspending the calling
+    coroutine. Otherwise, including for control frames, compressed
+    or fragmented messages and text which is not valid UTF-8, the
+    message is read by `stream::async_read`.
+
+    @param ws The stream to read from.
+
+    @param buffer A dynamic buffer to append message data to.
+
+    @param ec Set to the error, if any occurred.
+
+    @return The number of message payload bytes appended to the
+    buffer.
+
+    @tparam Executor The executor type of the calling coroutine.
+*/
+template<
+    class Executor = net::any_io_executor,
+    class NextLayer, bool deflateSupported,
+    class DynamicBuffer>
+net::awaitable<std::size_t, Executor>
+co_read(
+    stream<NextLayer, deflateSupported>& ws,
+    DynamicBuffer& buffer,
+    error_code& ec);
+
+/** Read a complete message from a websocket stream using a coroutine.
+
+    This function behaves like the overload taking an
+    `error_code`, except that errors are reported by throwing
+    `system_error`.
+*/
+template<
+    class Executor = net::any_io_executor,
+    class NextLayer, bool deflateSupported,
+    class DynamicBuffer>
+net::awaitable<std::size_t, Executor>
+co_read(
+    stream<NextLayer, deflateSupported>& ws,
+    DynamicBuffer& buffer);
+
+/** Write a complete message to a websocket stream using a coroutine.
+
+    This function is the `co_await` counterpart of
+    `stream::async_write`. A write always performs I/O, so unlike
+    @ref co_read it has no path which avoids the stream's operation.
+
+    @param ws The stream to write to.
+
+    @param buffers The buffers containing the message to send.
+
+    @param ec Set to the error, if any occurred.
+
+    @return The number of payload bytes sent.
+
+    @tparam Executor The executor type of the calling coroutine.
+*/
+template<
+    class Executor = net::any_io_executor,
+    class NextLayer, bool deflateSupported,
+    class ConstBufferSequence>
+net::awaitable<std::size_t, Executor>
+co_write(
+    stream<NextLayer, deflateSupported>& ws,
+    ConstBufferSequence const& buffers,
+    error_code& ec);
+
+/** Write a complete message to a websocket stream using a coroutine.
+
+    This function behaves like the overload taking an
+    `error_code`, except that errors are reported by throwing
+    `system_error`.
+*/
+template<
+    class Executor = net::any_io_executor,
+    class NextLayer, bool deflateSupported,
+    class ConstBufferSequence>
+net::awaitable<std::size_t, Executor>
+co_write(
+    stream<NextLayer, deflateSupported>& ws,
+    ConstBufferSequence const& buffers);
+
+} // websocket
+} // beast
+} // boost
+
+#include <boost/beast/_experimental/websocket/impl/awaitable.hpp>
+
+#endif
+
+#endif
@@ -0,0 +1,121 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_WEBSOCKET_IMPL_AWAITABLE_HPP
+#define BOOST_BEAST_WEBSOCKET_IMPL_AWAITABLE_HPP
+
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/throw_exception.hpp>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+
+namespace detail {
+
+struct co_read_access
+{
+    template<
+        class NextLayer, bool deflateSupported,
+        class DynamicBuffer>
+    static
+    bool
+    read_buffered(
+        stream<NextLayer, deflateSupported>& ws,
+        DynamicBuffer& buffer,
+        std::size_t& bytes_transferred)
+    {
+        return ws.impl_->rd_take(buffer, bytes_transferred);
+    }
+};
+
+} // detail
+
+template<
+    class Executor,
+    class NextLayer, bool deflateSupported,
+    class DynamicBuffer>
+net::awaitable<std::size_t, Executor>
+co_read(
+    stream<NextLayer, deflateSupported>& ws,
+    DynamicBuffer& buffer,
+    error_code& ec)
+{
+    static_assert(
+        net::is_dynamic_buffer<DynamicBuffer>::value,
+        "DynamicBuffer type requirements not met");
+    ec = {};
+    std::size_t bytes_transferred;
+    if(detail::co_read_access::read_buffered(
+            ws, buffer, bytes_transferred))
+        co_return bytes_transferred;
+    co_return co_await ws.async_read(buffer,
+        net::redirect_error(
+            net::use_awaitable_t<Executor>{}, ec));
+}
+
+template<
+    class Executor,
+    class NextLayer, bool deflateSupported,
+    class DynamicBuffer>
+net::awaitable<std::size_t, Executor>
+co_read(
+    stream<NextLayer, deflateSupported>& ws,
+    DynamicBuffer& buffer)
+{
+    error_code ec;
+    auto const bytes_transferred =
+        co_await websocket::co_read<Executor>(ws, buffer, ec);
+    if(ec)
+        BOOST_THROW_EXCEPTION(system_error{ec});
+    co_return bytes_transferred;
+}
+
+template<
+    class Executor,
+    class NextLayer, bool deflateSupported,
+    class ConstBufferSequence>
+net::awaitable<std::size_t, Executor>
+co_write(
+    stream<NextLayer, deflateSupported>& ws,
+    ConstBufferSequence const& buffers,
+    error_code& ec)
+{
+    static_assert(net::is_const_buffer_sequence<
+        ConstBufferSequence>::value,
+            "ConstBufferSequence type requirements not met");
+    ec = {};
+    co_return co_await ws.async_write(buffers,
+        net::redirect_error(
+            net::use_awaitable_t<Executor>{}, ec));
+}
+
+template<
+    class Executor,
+    class NextLayer, bool deflateSupported,
+    class ConstBufferSequence>
+net::awaitable<std::size_t, Executor>
+co_write(
+    stream<NextLayer, deflateSupported>& ws,
+    ConstBufferSequence const& buffers)
+{
+    error_code ec;
+    auto const bytes_transferred =
+        co_await websocket::co_write<Executor>(ws, buffers, ec);
+    if(ec)
+        BOOST_THROW_EXCEPTION(system_error{ec});
+    co_return bytes_transferred;
+}
+
+} // websocket
+} // beast
+} // boost
+
+#endif
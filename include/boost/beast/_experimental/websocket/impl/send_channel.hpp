@@ -0,0 +1,170 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_WEBSOCKET_IMPL_SEND_CHANNEL_HPP
+#define BOOST_BEAST_WEBSOCKET_IMPL_SEND_CHANNEL_HPP
+
+#include <boost/beast/core/detail/buffers_ref.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/post.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+
+namespace detail {
+
+// A message which is itself a buffer sequence, such as
+// shared_payload, is referenced rather than copied into the
+// write operation; msg_ outlives the write. Otherwise the
+// message points to something accepted by net::buffer.
+
+template<class Message>
+beast::detail::buffers_ref<Message>
+channel_buffers(Message const& m, std::true_type)
+{
+    return beast::detail::make_buffers_ref(m);
+}
+
+template<class Message>
+auto
+channel_buffers(Message const& m, std::false_type) ->
+    decltype(net::buffer(*m))
+{
+    return net::buffer(*m);
+}
+
+template<class Message>
+auto
+channel_buffers(Message const& m) ->
+    decltype(detail::channel_buffers(m, std::integral_constant<bool,
+        net::is_const_buffer_sequence<Message>::value>{}))
+{
+    return detail::channel_buffers(m, std::integral_constant<bool,
+        net::is_const_buffer_sequence<Message>::value>{});
+}
+
+} // detail
+
+template<class Stream, class Message>
+struct send_channel<Stream, Message>::wake_op
+{
+    send_channel* self;
+    boost::weak_ptr<void> wp;
+
+    void
+    operator()()
+    {
+        // The channel is a member of the owner
+        if(auto sp = wp.lock())
+            self->do_write(std::move(sp));
+    }
+};
+
+template<class Stream, class Message>
+struct send_channel<Stream, Message>::write_op
+{
+    send_channel* self;
+    boost::shared_ptr<void> sp;
+
+    void
+    operator()(error_code ec, std::size_t)
+    {
+        self->on_write(ec, std::move(sp));
+    }
+};
+
+template<class Stream, class Message>
+send_channel<Stream, Message>::
+send_channel(Stream& ws, std::size_t capacity)
+    : ws_(ws)
+    , ring_(capacity)
+    , scheduled_(true) // until started
+    , closed_(false)
+{
+}
+
+template<class Stream, class Message>
+void
+send_channel<Stream, Message>::
+start(boost::weak_ptr<void> owner)
+{
+    owner_ = std::move(owner);
+    auto sp = owner_.lock();
+    BOOST_ASSERT(sp);
+    do_write(std::move(sp));
+}
+
+template<class Stream, class Message>
+bool
+send_channel<Stream, Message>::
+try_send(Message m)
+{
+    if(closed_.load(std::memory_order_relaxed))
+        return false;
+    if(! ring_.try_push(std::move(m)))
+        return false;
+
+    // Pairs with the fence in do_write, so that either we see
+    // the writer go idle, or the writer sees our message.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(! scheduled_.exchange(true, std::memory_order_acq_rel))
+        net::post(ws_.get_executor(), wake_op{this, owner_});
+    return true;
+}
+
+template<class Stream, class Message>
+void
+send_channel<Stream, Message>::
+do_write(boost::shared_ptr<void> sp)
+{
+    for(;;)
+    {
+        if(ring_.try_pop(msg_))
+        {
+            ws_.async_write(detail::channel_buffers(msg_),
+                write_op{this, std::move(sp)});
+            return;
+        }
+        scheduled_.store(false, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(ring_.empty())
+            return;
+
+        // A producer raced with us, take the
+        // messages unless it already posted.
+        if(scheduled_.exchange(true, std::memory_order_acq_rel))
+            return;
+    }
+}
+
+template<class Stream, class Message>
+void
+send_channel<Stream, Message>::
+on_write(error_code ec, boost::shared_ptr<void> sp)
+{
+    msg_ = Message();
+    if(ec)
+    {
+        // Leave scheduled_ set so producers stop posting
+        closed_.store(true, std::memory_order_relaxed);
+        while(ring_.try_pop(msg_))
+            msg_ = Message();
+        return;
+    }
+    do_write(std::move(sp));
+}
+
+} // websocket
+} // beast
+} // boost
+
+#endif
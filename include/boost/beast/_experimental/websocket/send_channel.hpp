@@ -0,0 +1,180 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_WEBSOCKET_SEND_CHANNEL_HPP
+#define BOOST_BEAST_WEBSOCKET_SEND_CHANNEL_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/_experimental/core/detail/mpsc_ring.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+
+/** A bounded queue of outgoing messages for a websocket stream.
+
+    This object lets any number of threads queue messages for one
+    websocket session without posting a function to the session's
+    executor for each message. Producers call @ref try_send, which
+    places the message in a fixed size ring buffer without locking.
+    Only the producer which finds the channel idle posts a function
+    to the executor of the stream; that function then writes every
+    queued message, one after the other, until the ring is empty.
+    A burst of messages therefore costs one wakeup.
+
+    The channel is normally a member of the session object which owns
+    the stream, and the session is managed by a shared pointer.
+    Call @ref start once the stream is open, passing a weak pointer
+    to the session. Pending writes hold a strong reference, so the
+    session stays alive until they complete.
+
+    @code
+    class session : public boost::enable_shared_from_this<session>
+    {
+        websocket::stream<beast::tcp_stream> ws_;
+        websocket::send_channel<
+            websocket::stream<beast::tcp_stream>> channel_;
+        ...
+        void on_accept(beast::error_code ec)
+        {
+            ...
+            channel_.start(weak_from_this());
+        }
+
+    public:
+        // May be called from any thread
+        bool send(boost::shared_ptr<std::string const> const& ss)
+        {
+            return channel_.try_send(ss);
+        }
+    };
+    @endcode
+
+    While the channel is started, the application must not start
+    other message writes on the stream. Control frames and reads
+    are not affected. The opcode of each message is determined by
+    the stream's @ref stream::binary setting.
+
+    If a write fails, the channel is closed and the remaining
+    messages are discarded.
+
+    @par Thread Safety
+    @e Distinct @e objects: Safe.@n
+    @e Shared @e objects: @ref try_send and @ref is_open are safe
+    to call concurrently. The other members must be called from the
+    stream's executor.
+
+    @tparam Stream The websocket stream type.
+
+    @tparam Message The type of a queued message. It must be default
+    constructible and movable. It must either meet the requirements
+    of <em>ConstBufferSequence</em>, such as @ref shared_payload, or
+    dereferencing it must produce an object accepted by `net::buffer`.
+    The bytes are not copied, so the object should be immutable and
+    shared.
+*/
+template<
+    class Stream,
+    class Message = boost::shared_ptr<std::string const>>
+class send_channel
+{
+    struct wake_op;
+    struct write_op;
+
+    Stream& ws_;
+    beast::detail::mpsc_ring<Message> ring_;
+    boost::weak_ptr<void> owner_;
+    std::atomic<bool> scheduled_;
+    std::atomic<bool> closed_;
+    Message msg_;
+
+    void do_write(boost::shared_ptr<void> sp);
+    void on_write(error_code ec, boost::shared_ptr<void> sp);
+
+public:
+    /// The type of the stream messages are written to.
+    using stream_type = Stream;
+
+    /// The type of a queued message.
+    using message_type = Message;
+
+    send_channel(send_channel const&) = delete;
+    send_channel& operator=(send_channel const&) = delete;
+
+    /** Constructor
+
+        Messages may be queued before the channel is started.
+
+        @param ws The stream to write to. It must outlive the channel.
+
+        @param capacity The maximum number of queued messages,
+        rounded up to a power of two.
+    */
+    explicit
+    send_channel(Stream& ws, std::size_t capacity = 1024);
+
+    /// Return the maximum number of queued messages.
+    std::size_t
+    capacity() const noexcept
+    {
+        return ring_.capacity();
+    }
+
+    /// Returns `true` if the channel accepts messages.
+    bool
+    is_open() const noexcept
+    {
+        return ! closed_.load(std::memory_order_relaxed);
+    }
+
+    /** Start writing queued messages.
+
+        This must be called at most once, after the stream is open.
+
+        @param owner A weak pointer to the object which owns the
+        stream and the channel.
+    */
+    void
+    start(boost::weak_ptr<void> owner);
+
+    /** Queue a message for sending.
+
+        This function may be called from any thread. It does not
+        block, and the message is not copied.
+
+        @return `true` if the message was queued, or `false` if the
+        channel is full or closed.
+    */
+    bool
+    try_send(Message m);
+
+    /** Stop accepting messages.
+
+        Messages already queued are still sent.
+    */
+    void
+    close() noexcept
+    {
+        closed_.store(true, std::memory_order_relaxed);
+    }
+};
+
+} // websocket
+} // beast
+} // boost
+
+#include <boost/beast/_experimental/websocket/impl/send_channel.hpp>
+
+#endif
@@ -36,61 +36,167 @@
 #include <cstdint>
 #include <limits>
 
+#ifndef BOOST_BEAST_CHACHA_SSE2
+# if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define BOOST_BEAST_CHACHA_SSE2 1
+# else
+#  define BOOST_BEAST_CHACHA_SSE2 0
+# endif
+#endif
+
+#if BOOST_BEAST_CHACHA_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace boost {
 namespace beast {
 namespace detail {
 
+/*  ChaCha generator producing four blocks per refill.
+
+    The four blocks use consecutive counters and are computed
+    side by side, one block per SIMD lane. Output is taken in
+    lane-interleaved order: word `i` of each of the four blocks,
+    then word `i+1`, and so on.
+*/
 template<std::size_t R>
 class chacha
 {
-    alignas(16) std::uint32_t block_[16];
+    static constexpr int lanes = 4;
+
+#if BOOST_BEAST_CHACHA_SSE2
+    using lane_type = __m128i;
+
+    static lane_type splat(std::uint32_t v)
+    {
+        return _mm_set1_epi32(static_cast<int>(v));
+    }
+
+    static lane_type load(std::uint32_t const* p)
+    {
+        return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+    }
+
+    static void store(std::uint32_t* p, lane_type v)
+    {
+        _mm_store_si128(reinterpret_cast<__m128i*>(p), v);
+    }
+
+    static lane_type add(lane_type a, lane_type b)
+    {
+        return _mm_add_epi32(a, b);
+    }
+
+    static lane_type xor_(lane_type a, lane_type b)
+    {
+        return _mm_xor_si128(a, b);
+    }
+
+    template<int N>
+    static lane_type rotl(lane_type v)
+    {
+        return _mm_or_si128(_mm_slli_epi32(v, N), _mm_srli_epi32(v, 32 - N));
+    }
+#else
+    struct lane_type
+    {
+        std::uint32_t v[lanes];
+    };
+
+    static lane_type splat(std::uint32_t v)
+    {
+        return {{v, v, v, v}};
+    }
+
+    static lane_type load(std::uint32_t const* p)
+    {
+        return {{p[0], p[1], p[2], p[3]}};
+    }
+
+    static void store(std::uint32_t* p, lane_type const& v)
+    {
+        for (int l = 0; l < lanes; ++l)
+            p[l] = v.v[l];
+    }
+
+    static lane_type add(lane_type a, lane_type const& b)
+    {
+        for (int l = 0; l < lanes; ++l)
+            a.v[l] += b.v[l];
+        return a;
+    }
+
+    static lane_type xor_(lane_type a, lane_type const& b)
+    {
+        for (int l = 0; l < lanes; ++l)
+            a.v[l] ^= b.v[l];
+        return a;
+    }
+
+    template<int N>
+    static lane_type rotl(lane_type a)
+    {
+        for (int l = 0; l < lanes; ++l)
+            a.v[l] = (a.v[l] << N) | (a.v[l] >> (32 - N));
+        return a;
+    }
+#endif
+
+    alignas(16) std::uint32_t block_[16 * lanes];
     std::uint32_t keysetup_[8];
     std::uint64_t ctr_ = 0;
-    int idx_ = 16;
+    int idx_ = 16 * lanes;
 
-    void generate_block()
+    static void quarterround(lane_type* x, int a, int b, int c, int d)
+    {
+        x[a] = add(x[a], x[b]); x[d] = rotl<16>(xor_(x[d], x[a]));
+        x[c] = add(x[c], x[d]); x[b] = rotl<12>(xor_(x[b], x[c]));
+        x[a] = add(x[a], x[b]); x[d] = rotl< 8>(xor_(x[d], x[a]));
+        x[c] = add(x[c], x[d]); x[b] = rotl< 7>(xor_(x[b], x[c]));
+    }
+
+    void generate_blocks()
     {
         std::uint32_t constexpr constants[4] = {
             0x61707865, 0x3320646e, 0x79622d32, 0x6b206574 };
-        std::uint32_t input[16];
+        std::uint32_t ctr_lo[lanes];
+        std::uint32_t ctr_hi[lanes];
+        for (int l = 0; l < lanes; ++l)
+        {
+            ctr_lo[l] = (ctr_ + l) & 0xffffffffu;
+            ctr_hi[l] = (ctr_ + l) >> 32;
+        }
+        ctr_ += lanes;
+        lane_type input[16];
         for (int i = 0; i < 4; ++i)
-            input[i] = constants[i];
+            input[i] = splat(constants[i]);
         for (int i = 0; i < 8; ++i)
-            input[4 + i] = keysetup_[i];
-        input[12] = (ctr_ / 16) & 0xffffffffu;
-        input[13] = (ctr_ / 16) >> 32;
-        input[14] = input[15] = 0xdeadbeef; // Could use 128-bit counter.
+            input[4 + i] = splat(keysetup_[i]);
+        input[12] = load(ctr_lo);
+        input[13] = load(ctr_hi);
+        input[14] = input[15] = splat(0xdeadbeef); // Could use 128-bit counter.
+        lane_type x[16];
         for (int i = 0; i < 16; ++i)
-            block_[i] = input[i];
-        chacha_core();
+            x[i] = input[i];
+        chacha_core(x);
         for (int i = 0; i < 16; ++i)
-            block_[i] += input[i];
+            store(block_ + lanes * i, add(x[i], input[i]));
     }
 
-    void chacha_core()
+    static void chacha_core(lane_type* x)
     {
-        #define BOOST_BEAST_CHACHA_ROTL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
-
-        #define BOOST_BEAST_CHACHA_QUARTERROUND(x, a, b, c, d) \
-            x[a] = x[a] + x[b]; x[d] ^= x[a]; x[d] = BOOST_BEAST_CHACHA_ROTL32(x[d], 16); \
-            x[c] = x[c] + x[d]; x[b] ^= x[c]; x[b] = BOOST_BEAST_CHACHA_ROTL32(x[b], 12); \
-            x[a] = x[a] + x[b]; x[d] ^= x[a]; x[d] = BOOST_BEAST_CHACHA_ROTL32(x[d],  8); \
-            x[c] = x[c] + x[d]; x[b] ^= x[c]; x[b] = BOOST_BEAST_CHACHA_ROTL32(x[b],  7)
-
         for (unsigned i = 0; i < R; i += 2)
         {
-            BOOST_BEAST_CHACHA_QUARTERROUND(block_, 0, 4,  8, 12);
-            BOOST_BEAST_CHACHA_QUARTERROUND(block_, 1, 5,  9, 13);
-            BOOST_BEAST_CHACHA_QUARTERROUND(block_, 2, 6, 10, 14);
-            BOOST_BEAST_CHACHA_QUARTERROUND(block_, 3, 7, 11, 15);
-            BOOST_BEAST_CHACHA_QUARTERROUND(block_, 0, 5, 10, 15);
-            BOOST_BEAST_CHACHA_QUARTERROUND(block_, 1, 6, 11, 12);
-            BOOST_BEAST_CHACHA_QUARTERROUND(block_, 2, 7,  8, 13);
-            BOOST_BEAST_CHACHA_QUARTERROUND(block_, 3, 4,  9, 14);
+            quarterround(x, 0, 4,  8, 12);
+            quarterround(x, 1, 5,  9, 13);
+            quarterround(x, 2, 6, 10, 14);
+            quarterround(x, 3, 7, 11, 15);
+            quarterround(x, 0, 5, 10, 15);
+            quarterround(x, 1, 6, 11, 12);
+            quarterround(x, 2, 7,  8, 13);
+            quarterround(x, 3, 4,  9, 14);
         }
-
-        #undef BOOST_BEAST_CHACHA_QUARTERROUND
-        #undef BOOST_BEAST_CHACHA_ROTL32
     }
 
 public:
@@ -109,11 +215,10 @@ public:
     std::uint32_t
     operator()()
     {
-        if(idx_ == 16)
+        if(idx_ == 16 * lanes)
         {
             idx_ = 0;
-            ++ctr_;
-            generate_block();
+            generate_blocks();
         }
         return block_[idx_++];
     }
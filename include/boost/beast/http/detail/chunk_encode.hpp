@@ -64,6 +64,10 @@ struct is_chunk_extensions<T, beast::detail::void_t<decltype(
 //------------------------------------------------------------------------------
 
 /** A buffer sequence containing a chunk-encoding header
+
+    The hex digits are stored inline, so constructing one
+    for each chunk does not allocate. Copies refer to their
+    own storage.
 */
 class chunk_size
 {
@@ -85,43 +89,60 @@ class chunk_size
         return last;
     }
 
-    struct sequence
-    {
-        net::const_buffer b;
-        char data[1 + 2 * sizeof(std::size_t)];
+    net::const_buffer b_;
+    char data_[1 + 2 * sizeof(std::size_t)];
 
-        explicit
-        sequence(std::size_t n)
-        {
-            char* it0 = data + sizeof(data);
-            auto it = to_hex(it0, n);
-            b = {it,
-                static_cast<std::size_t>(it0 - it)};
-        }
-    };
-
-    std::shared_ptr<sequence> sp_;
+    void
+    assign(chunk_size const& other)
+    {
+        auto const n = other.b_.size();
+        char* it = data_ + sizeof(data_) - n;
+        std::copy_n(static_cast<char const*>(
+            other.b_.data()), n, it);
+        b_ = {it, n};
+    }
 
 public:
     using value_type = net::const_buffer;
 
     using const_iterator = value_type const*;
 
-    chunk_size(chunk_size const& other) = default;
+    chunk_size(chunk_size const& other)
+    {
+        assign(other);
+    }
+
+    chunk_size&
+    operator=(chunk_size const& other)
+    {
+        assign(other);
+        return *this;
+    }
 
     /** Construct a chunk header
 
         @param n The number of octets in this chunk.
     */
     chunk_size(std::size_t n)
-        : sp_(std::make_shared<sequence>(n))
     {
+        char* it0 = data_ + sizeof(data_);
+        auto it = to_hex(it0, n);
+        b_ = {it,
+            static_cast<std::size_t>(it0 - it)};
+    }
+
+    /// Write the hex digits of `n` ending at `last`, returning the first
+    static
+    char*
+    format(char* last, std::size_t n)
+    {
+        return to_hex(last, n);
     }
 
     const_iterator
     begin() const
     {
-        return &sp_->b;
+        return &b_;
     }
 
     const_iterator
@@ -25,6 +25,18 @@ the program, with the macro BOOST_BEAST_SEPARATE_COMPILATION defined.
 # error Do not compile Beast library source with BOOST_BEAST_HEADER_ONLY defined
 #endif
 
+#include <boost/beast/_experimental/core/impl/detect_protocol.ipp>
+#include <boost/beast/_experimental/core/impl/proxy_protocol_stream.ipp>
+#include <boost/beast/_experimental/core/impl/shard_arena.ipp>
+#include <boost/beast/_experimental/core/impl/shared_payload.ipp>
+#include <boost/beast/_experimental/core/impl/sharded_server.ipp>
+#include <boost/beast/_experimental/core/impl/work_stealing_pool.ipp>
+
+#include <boost/beast/_experimental/http/impl/event_stream_body.ipp>
+#include <boost/beast/_experimental/http/impl/response_cache.ipp>
+
+#include <boost/beast/_experimental/ssl/impl/ssl_record_pool.ipp>
+
 #include <boost/beast/_experimental/test/impl/error.ipp>
 #include <boost/beast/_experimental/test/impl/fail_count.ipp>
 #include <boost/beast/_experimental/test/impl/stream.ipp>
@@ -52,6 +64,7 @@ the program, with the macro BOOST_BEAST_SEPARATE_COMPILATION defined.
 #include <boost/beast/http/impl/verb.ipp>
 
 #include <boost/beast/websocket/detail/hybi13.ipp>
+#include <boost/beast/websocket/detail/impl_cache.ipp>
 #include <boost/beast/websocket/detail/mask.ipp>
 #include <boost/beast/websocket/detail/pmd_extension.ipp>
 #include <boost/beast/websocket/detail/prng.ipp>
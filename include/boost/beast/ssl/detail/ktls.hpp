@@ -0,0 +1,719 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_SSL_DETAIL_KTLS_HPP
+#define BOOST_BEAST_SSL_DETAIL_KTLS_HPP
+
+#include <boost/beast/core/async_base.hpp>
+#include <boost/beast/core/bind_handler.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/stream_traits.hpp>
+#include <boost/asio/coroutine.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/socket_base.hpp>
+#include <boost/asio/ssl/detail/openssl_types.hpp>
+#include <boost/core/ignore_unused.hpp>
+#include <boost/system/error_code.hpp>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+#include <openssl/kdf.h>
+#endif
+
+// Kernel TLS is used when the Linux headers declare it.
+// Define BOOST_BEAST_NO_KTLS to leave it out.
+#ifndef BOOST_BEAST_HAS_KTLS
+# if ! defined(BOOST_BEAST_NO_KTLS) && defined(__linux__) && defined(__has_include)
+#  if __has_include(<linux/tls.h>)
+#   define BOOST_BEAST_HAS_KTLS 1
+#  endif
+# endif
+# ifndef BOOST_BEAST_HAS_KTLS
+#  define BOOST_BEAST_HAS_KTLS 0
+# endif
+#endif
+
+#if BOOST_BEAST_HAS_KTLS
+#include <linux/tls.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <cerrno>
+# ifndef SOL_TLS
+#  define SOL_TLS 282
+# endif
+# ifndef TCP_ULP
+#  define TCP_ULP 31
+# endif
+#endif
+
+namespace boost {
+namespace beast {
+namespace detail {
+
+// Record protection state for one direction
+// of a TLS 1.2 connection using an AEAD cipher.
+struct ktls_keys
+{
+    int nid = 0;                // NID_aes_128_gcm, ...
+    unsigned char key[32];
+    std::size_t key_size = 0;
+    unsigned char iv[12];       // salt for GCM, full IV for ChaCha
+    std::size_t iv_size = 0;
+    std::uint64_t seq = 0;      // next record sequence number
+};
+
+struct ktls_params
+{
+    ktls_keys tx;
+    ktls_keys rx;
+};
+
+// Returns the descriptor of the socket at the bottom of a
+// stack of layers, or -1 if the layer has none we can use.
+
+template<class Stream>
+auto
+ktls_native_handle(Stream& s, int) ->
+    typename std::enable_if<std::is_convertible<
+        decltype(s.socket().native_handle()), int>::value, int>::type
+{
+    return s.socket().is_open() ? s.socket().native_handle() : -1;
+}
+
+template<class Stream>
+auto
+ktls_native_handle(Stream& s, long) ->
+    typename std::enable_if<std::is_convertible<
+        decltype(s.native_handle()), int>::value, int>::type
+{
+    return s.is_open() ? s.native_handle() : -1;
+}
+
+template<class Stream>
+int
+ktls_native_handle(Stream&, ...)
+{
+    return -1;
+}
+
+inline
+error_code
+ktls_not_supported()
+{
+    return net::error::operation_not_supported;
+}
+
+/*  Derive the record keys of an established TLS 1.2 connection.
+
+    The key block is expanded from the master secret exactly as
+    the handshake did (RFC 5246 section 6.3). Both directions have
+    sent one protected record, the Finished message, so application
+    data starts at sequence number one.
+*/
+inline
+void
+ktls_derive(SSL* ssl, ktls_params& p, error_code& ec)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+    ec = {};
+    if(SSL_version(ssl) != TLS1_2_VERSION)
+    {
+        ec = ktls_not_supported();
+        return;
+    }
+
+    // Bytes OpenSSL has already received or produced would be
+    // lost, or sent with stale state, once the kernel takes over.
+    if( SSL_pending(ssl) > 0 ||
+        BIO_ctrl_pending(SSL_get_rbio(ssl)) > 0 ||
+        BIO_ctrl_wpending(SSL_get_wbio(ssl)) > 0)
+    {
+        ec = ktls_not_supported();
+        return;
+    }
+
+    SSL_CIPHER const* c = SSL_get_current_cipher(ssl);
+    SSL_SESSION const* sess = SSL_get_session(ssl);
+    if(! c || ! sess)
+    {
+        ec = ktls_not_supported();
+        return;
+    }
+    int const nid = SSL_CIPHER_get_cipher_nid(c);
+    std::size_t key_size;
+    std::size_t iv_size;
+    switch(nid)
+    {
+    case NID_aes_128_gcm:
+        key_size = 16;
+        iv_size = 4;
+        break;
+    case NID_aes_256_gcm:
+        key_size = 32;
+        iv_size = 4;
+        break;
+#ifdef NID_chacha20_poly1305
+    case NID_chacha20_poly1305:
+        key_size = 32;
+        iv_size = 12;
+        break;
+#endif
+    default:
+        ec = ktls_not_supported();
+        return;
+    }
+
+    unsigned char master[SSL_MAX_MASTER_KEY_LENGTH];
+    std::size_t const master_size =
+        SSL_SESSION_get_master_key(sess, master, sizeof(master));
+    unsigned char seed[2 * SSL3_RANDOM_SIZE];
+    SSL_get_server_random(ssl, seed, SSL3_RANDOM_SIZE);
+    SSL_get_client_random(ssl, seed + SSL3_RANDOM_SIZE, SSL3_RANDOM_SIZE);
+
+    // client key, server key, client IV, server IV
+    unsigned char block[2 * (32 + 12)];
+    std::size_t block_size = 2 * (key_size + iv_size);
+    EVP_PKEY_CTX* pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_TLS1_PRF, nullptr);
+    bool const ok =
+        pctx &&
+        EVP_PKEY_derive_init(pctx) > 0 &&
+        EVP_PKEY_CTX_set_tls1_prf_md(pctx,
+            SSL_CIPHER_get_handshake_digest(c)) > 0 &&
+        EVP_PKEY_CTX_set1_tls1_prf_secret(pctx,
+            master, static_cast<int>(master_size)) > 0 &&
+        EVP_PKEY_CTX_add1_tls1_prf_seed(pctx,
+            reinterpret_cast<unsigned char const*>(
+                "key expansion"), 13) > 0 &&
+        EVP_PKEY_CTX_add1_tls1_prf_seed(pctx,
+            seed, static_cast<int>(sizeof(seed))) > 0 &&
+        EVP_PKEY_derive(pctx, block, &block_size) > 0;
+    EVP_PKEY_CTX_free(pctx);
+    OPENSSL_cleanse(master, sizeof(master));
+    if(! ok)
+    {
+        ec = ktls_not_supported();
+        return;
+    }
+
+    bool const server = SSL_is_server(ssl) != 0;
+    auto& client = server ? p.rx : p.tx;
+    auto& srv = server ? p.tx : p.rx;
+    auto it = block;
+    std::memcpy(client.key, it, key_size);
+    it += key_size;
+    std::memcpy(srv.key, it, key_size);
+    it += key_size;
+    std::memcpy(client.iv, it, iv_size);
+    it += iv_size;
+    std::memcpy(srv.iv, it, iv_size);
+    OPENSSL_cleanse(block, sizeof(block));
+    ktls_keys* const keys[] = { &p.tx, &p.rx };
+    for(auto k : keys)
+    {
+        k->nid = nid;
+        k->key_size = key_size;
+        k->iv_size = iv_size;
+        k->seq = 1;
+    }
+#else
+    boost::ignore_unused(ssl, p);
+    ec = ktls_not_supported();
+#endif
+}
+
+#if BOOST_BEAST_HAS_KTLS
+
+inline
+error_code
+ktls_last_error()
+{
+    return error_code(errno, system::system_category());
+}
+
+template<class CryptoInfo>
+void
+ktls_fill(CryptoInfo& ci, ktls_keys const& k,
+    unsigned char* iv, std::size_t iv_size)
+{
+    unsigned char seq[8];
+    for(int i = 0; i < 8; ++i)
+        seq[i] = static_cast<unsigned char>(k.seq >> (56 - 8 * i));
+    ci.info.version = TLS_1_2_VERSION;
+    std::memcpy(ci.key, k.key, k.key_size);
+    std::memcpy(ci.rec_seq, seq, sizeof(seq));
+    if(iv_size == 8)
+    {
+        // GCM: implicit salt, explicit nonce
+        // starting from the sequence number
+        std::memcpy(iv, seq, 8);
+    }
+    else
+    {
+        std::memcpy(iv, k.iv, iv_size);
+    }
+}
+
+// Attach the TLS upper layer protocol to a TCP socket
+inline
+void
+ktls_attach(int fd, error_code& ec)
+{
+    ec = {};
+    if(::setsockopt(fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) != 0)
+        ec = ktls_last_error();
+}
+
+// Install the keys for one direction, TLS_TX or TLS_RX
+inline
+void
+ktls_install(int fd, int dir,
+    ktls_keys const& k, error_code& ec)
+{
+    ec = {};
+    int rv;
+    switch(k.nid)
+    {
+    case NID_aes_128_gcm:
+    {
+        tls12_crypto_info_aes_gcm_128 ci{};
+        ci.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+        ktls_fill(ci, k, ci.iv, sizeof(ci.iv));
+        std::memcpy(ci.salt, k.iv, sizeof(ci.salt));
+        rv = ::setsockopt(fd, SOL_TLS, dir, &ci, sizeof(ci));
+        OPENSSL_cleanse(&ci, sizeof(ci));
+        break;
+    }
+#ifdef TLS_CIPHER_AES_GCM_256
+    case NID_aes_256_gcm:
+    {
+        tls12_crypto_info_aes_gcm_256 ci{};
+        ci.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+        ktls_fill(ci, k, ci.iv, sizeof(ci.iv));
+        std::memcpy(ci.salt, k.iv, sizeof(ci.salt));
+        rv = ::setsockopt(fd, SOL_TLS, dir, &ci, sizeof(ci));
+        OPENSSL_cleanse(&ci, sizeof(ci));
+        break;
+    }
+#endif
+#if defined(TLS_CIPHER_CHACHA20_POLY1305) && defined(NID_chacha20_poly1305)
+    case NID_chacha20_poly1305:
+    {
+        tls12_crypto_info_chacha20_poly1305 ci{};
+        ci.info.cipher_type = TLS_CIPHER_CHACHA20_POLY1305;
+        ktls_fill(ci, k, ci.iv, sizeof(ci.iv));
+        rv = ::setsockopt(fd, SOL_TLS, dir, &ci, sizeof(ci));
+        OPENSSL_cleanse(&ci, sizeof(ci));
+        break;
+    }
+#endif
+    default:
+        ec = ktls_not_supported();
+        return;
+    }
+    if(rv != 0)
+        ec = ktls_last_error();
+}
+
+/*  Consume a record which is not application data.
+
+    A plain read fails with EIO when the next record received by
+    the kernel has another content type. The record is taken here
+    with its type. Post-handshake handshake messages are skipped,
+    close_notify becomes end of stream, and anything else ends the
+    connection with an error. On success the read may be retried.
+*/
+inline
+void
+ktls_read_control(int fd, error_code& ec)
+{
+    ec = {};
+    std::unique_ptr<unsigned char[]> buf(
+        new unsigned char[16 * 1024]);
+    char cbuf[CMSG_SPACE(sizeof(unsigned char))];
+    iovec iov;
+    iov.iov_base = buf.get();
+    iov.iov_len = 16 * 1024;
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+    auto const n = ::recvmsg(fd, &msg, MSG_DONTWAIT);
+    if(n < 0)
+    {
+        ec = ktls_last_error();
+        return;
+    }
+    if(n == 0)
+    {
+        ec = net::error::eof;
+        return;
+    }
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if( ! cmsg ||
+        cmsg->cmsg_level != SOL_TLS ||
+        cmsg->cmsg_type != TLS_GET_RECORD_TYPE)
+    {
+        // Application data can't be returned
+        // from here, so this must not happen.
+        ec = system::errc::make_error_code(
+            system::errc::io_error);
+        return;
+    }
+    switch(*CMSG_DATA(cmsg))
+    {
+    case 21: // alert
+        if(n >= 2 && buf[1] == 0)
+            ec = net::error::eof;
+        else
+            ec = net::error::connection_aborted;
+        break;
+
+    case 22: // handshake
+        break;
+
+    default:
+        ec = system::errc::make_error_code(
+            system::errc::protocol_error);
+        break;
+    }
+}
+
+// Make one attempt to send close_notify through the
+// kernel. When the send buffer is full the error is
+// net::error::would_block, and nothing was sent.
+inline
+void
+ktls_try_close_notify(int fd, error_code& ec)
+{
+    ec = {};
+    unsigned char alert[2] = { 1, 0 };
+    char cbuf[CMSG_SPACE(sizeof(unsigned char))];
+    iovec iov;
+    iov.iov_base = alert;
+    iov.iov_len = sizeof(alert);
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_TLS;
+    cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(unsigned char));
+    *CMSG_DATA(cmsg) = 21;
+    msg.msg_controllen = cmsg->cmsg_len;
+    if(::sendmsg(fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT) >= 0)
+        return;
+    if(errno == EAGAIN || errno == EWOULDBLOCK)
+        ec = net::error::would_block;
+    else
+        ec = ktls_last_error();
+}
+
+// Send close_notify through the kernel, blocking
+// until the send buffer has room for it.
+inline
+void
+ktls_send_close_notify(int fd, error_code& ec)
+{
+    for(;;)
+    {
+        ktls_try_close_notify(fd, ec);
+        if(ec != net::error::would_block)
+            return;
+        pollfd pfd{};
+        pfd.fd = fd;
+        pfd.events = POLLOUT;
+        if(::poll(&pfd, 1, -1) < 0 && errno != EINTR)
+        {
+            ec = ktls_last_error();
+            return;
+        }
+    }
+}
+
+#else
+
+inline
+void
+ktls_attach(int, error_code& ec)
+{
+    ec = ktls_not_supported();
+}
+
+inline
+void
+ktls_install(int, int, ktls_keys const&, error_code& ec)
+{
+    ec = ktls_not_supported();
+}
+
+inline
+void
+ktls_read_control(int, error_code& ec)
+{
+    ec = ktls_not_supported();
+}
+
+inline
+void
+ktls_try_close_notify(int, error_code& ec)
+{
+    ec = ktls_not_supported();
+}
+
+inline
+void
+ktls_send_close_notify(int, error_code& ec)
+{
+    ec = ktls_not_supported();
+}
+
+#endif
+
+// The socket whose keys ktls_enable installs
+struct ktls_socket
+{
+    int fd;
+
+    void
+    attach(error_code& ec)
+    {
+        ktls_attach(fd, ec);
+    }
+
+    void
+    install(bool send, ktls_keys const& k, error_code& ec)
+    {
+    #if BOOST_BEAST_HAS_KTLS
+        ktls_install(fd, send ? TLS_TX : TLS_RX, k, ec);
+    #else
+        ktls_install(fd, 0, k, ec);
+    #endif
+    }
+};
+
+/*  Hand record protection of a connection to the kernel.
+
+    The keys for receiving are installed first, so that when the
+    kernel cannot decrypt, nothing is installed and OpenSSL keeps
+    both directions. Were the keys for sending installed alone,
+    OpenSSL would go on reading with a write state the kernel has
+    moved past, and records it sends while reading, such as alerts,
+    would corrupt the connection.
+
+    If the keys for sending then fail, OpenSSL keeps sending with
+    its own, still current, state but no longer reads. Its shutdown
+    is told that the peer's close_notify was received, so that it
+    sends its own without waiting for one it cannot read.
+*/
+template<class Socket>
+void
+ktls_enable(
+    SSL* ssl, Socket& sock,
+    bool& tx, bool& rx, error_code& ec)
+{
+    ktls_params params;
+    ktls_derive(ssl, params, ec);
+    if(! ec)
+        sock.attach(ec);
+    if(! ec)
+        sock.install(false, params.rx, ec);
+    if(! ec)
+    {
+        rx = true;
+        sock.install(true, params.tx, ec);
+        tx = ! ec;
+        if(ec)
+            SSL_set_shutdown(ssl,
+                SSL_get_shutdown(ssl) | SSL_RECEIVED_SHUTDOWN);
+    }
+    OPENSSL_cleanse(&params, sizeof(params));
+}
+
+inline
+bool
+ktls_is_control(error_code const& ec)
+{
+    return ec == system::errc::io_error;
+}
+
+//------------------------------------------------------------------------------
+
+// Reads application data from a socket with kernel TLS
+// receive installed, handling other records in between.
+template<
+    class Stream, class MutableBufferSequence,
+    class Handler>
+class ktls_read_op
+    : public async_base<Handler, beast::executor_type<Stream>>
+    , public asio::coroutine
+{
+    Stream& s_;
+    MutableBufferSequence b_;
+    int fd_;
+
+public:
+    template<class Handler_>
+    ktls_read_op(
+        Handler_&& h,
+        Stream& s,
+        MutableBufferSequence const& b,
+        int fd)
+        : async_base<Handler, beast::executor_type<Stream>>(
+            std::forward<Handler_>(h), s.get_executor())
+        , s_(s)
+        , b_(b)
+        , fd_(fd)
+    {
+        (*this)({}, 0);
+    }
+
+    void
+    operator()(error_code ec, std::size_t bytes_transferred)
+    {
+        BOOST_ASIO_CORO_REENTER(*this)
+        {
+            for(;;)
+            {
+                BOOST_ASIO_CORO_YIELD
+                s_.async_read_some(b_, std::move(*this));
+                if(! ktls_is_control(ec))
+                    break;
+                ktls_read_control(fd_, ec);
+                if(ec)
+                    break;
+            }
+            this->complete_now(ec, bytes_transferred);
+        }
+    }
+};
+
+struct run_ktls_read_op
+{
+    template<
+        class ReadHandler,
+        class Stream,
+        class MutableBufferSequence>
+    void
+    operator()(
+        ReadHandler&& h,
+        Stream* s,
+        MutableBufferSequence const& b,
+        int fd)
+    {
+        ktls_read_op<
+            Stream,
+            MutableBufferSequence,
+            typename std::decay<ReadHandler>::type>(
+                std::forward<ReadHandler>(h), *s, b, fd);
+    }
+};
+
+// Waits until the socket at the bottom of a stack of
+// layers can be written. The wait goes to the socket
+// itself, so the timeout of a tcp_stream does not apply.
+
+template<class Stream, class Handler>
+auto
+ktls_async_wait_write(Stream& s, Handler&& h, int) ->
+    decltype(void(s.socket().async_wait(
+        net::socket_base::wait_write, std::move(h))))
+{
+    s.socket().async_wait(
+        net::socket_base::wait_write, std::move(h));
+}
+
+template<class Stream, class Handler>
+auto
+ktls_async_wait_write(Stream& s, Handler&& h, long) ->
+    decltype(void(s.async_wait(
+        net::socket_base::wait_write, std::move(h))))
+{
+    s.async_wait(
+        net::socket_base::wait_write, std::move(h));
+}
+
+template<class Stream, class Handler>
+void
+ktls_async_wait_write(Stream& s, Handler&& h, ...)
+{
+    net::post(s.get_executor(), beast::bind_front_handler(
+        std::move(h), ktls_not_supported()));
+}
+
+// Sends close_notify through the kernel, waiting on
+// the socket while its send buffer is full.
+template<class Stream, class Handler>
+class ktls_shutdown_op
+    : public async_base<Handler, beast::executor_type<Stream>>
+    , public asio::coroutine
+{
+    Stream& s_;
+
+public:
+    template<class Handler_>
+    ktls_shutdown_op(
+        Handler_&& h,
+        Stream& s)
+        : async_base<Handler, beast::executor_type<Stream>>(
+            std::forward<Handler_>(h), s.get_executor())
+        , s_(s)
+    {
+        (*this)({}, false);
+    }
+
+    void
+    operator()(error_code ec, bool cont = true)
+    {
+        BOOST_ASIO_CORO_REENTER(*this)
+        {
+            for(;;)
+            {
+                ktls_try_close_notify(
+                    ktls_native_handle(s_, 0), ec);
+                if(ec != net::error::would_block)
+                    break;
+                BOOST_ASIO_CORO_YIELD
+                ktls_async_wait_write(s_, std::move(*this), 0);
+                if(ec)
+                    break;
+            }
+            this->complete(cont, ec);
+        }
+    }
+};
+
+struct run_ktls_shutdown_op
+{
+    template<class ShutdownHandler, class Stream>
+    void
+    operator()(
+        ShutdownHandler&& h,
+        Stream* s)
+    {
+        ktls_shutdown_op<
+            Stream,
+            typename std::decay<ShutdownHandler>::type>(
+                std::forward<ShutdownHandler>(h), *s);
+    }
+};
+
+} // detail
+} // beast
+} // boost
+
+#endif
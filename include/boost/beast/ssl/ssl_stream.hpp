@@ -16,12 +16,15 @@
 #include <boost/beast/websocket/ssl.hpp>
 
 #include <boost/beast/core/flat_stream.hpp>
+#include <boost/beast/core/stream_traits.hpp>
+#include <boost/beast/ssl/detail/ktls.hpp>
 
 // VFALCO We include this because anyone who uses ssl will
 //        very likely need to check for ssl::error::stream_truncated
 #include <boost/asio/ssl/error.hpp>
 
 #include <boost/asio/ssl/stream.hpp>
+#include <boost/throw_exception.hpp>
 #include <cstddef>
 #include <memory>
 #include <type_traits>
@@ -62,6 +65,9 @@ namespace beast {
         limitation of `net::ssl::stream` when writing buffer sequences
         having length greater than one.
 
+    @li Can hand record protection to the Linux kernel after the
+        handshake; see @ref enable_ktls.
+
     @par Concepts:
         @li AsyncReadStream
         @li AsyncWriteStream
@@ -77,6 +83,15 @@ class ssl_stream
     using stream_type = boost::beast::flat_stream<ssl_stream_type>;
 
     std::unique_ptr<stream_type> p_;
+    bool ktls_tx_ = false;
+    bool ktls_rx_ = false;
+
+    int
+    ktls_fd()
+    {
+        return detail::ktls_native_handle(
+            beast::get_lowest_layer(next_layer()), 0);
+    }
 
 public:
     /// The native handle type of the SSL stream.
@@ -439,6 +454,101 @@ public:
             BOOST_ASIO_MOVE_CAST(BufferedHandshakeHandler)(handler));
     }
 
+    /** Hand record protection to the kernel.
+
+        This function installs the keys negotiated by the handshake into
+        Linux kernel TLS, so that the kernel encrypts and decrypts
+        records and the stream reads and writes the socket directly.
+        Data then no longer passes through OpenSSL, and the application
+        may send files over the connection with `sendfile` on the
+        native socket handle. The HTTP serializer does not do this
+        itself: a `file_body` is still read into memory and written
+        through the stream.
+
+        It must be called after the handshake completes and before any
+        data is read or written. When the connection cannot be offloaded,
+        the stream is left unchanged and continues to use OpenSSL, so
+        calling this function is always safe. Offload requires:
+
+        @li A Linux kernel with the `tls` module loaded,
+
+        @li A lowest layer which is a TCP socket, such as
+            `net::ip::tcp::socket` or @ref tcp_stream,
+
+        @li TLS 1.2 with AES-128-GCM, AES-256-GCM or ChaCha20-Poly1305.
+            TLS 1.3 is not offloaded, because OpenSSL does not make its
+            traffic secrets available when used through memory BIOs.
+
+        The keys for receiving are installed first, and when they
+        cannot be, nothing is offloaded. In the unlikely case that
+        the keys for sending then cannot be installed, the kernel
+        decrypts received records while OpenSSL goes on protecting
+        sent ones; @ref is_ktls_rx reports this, and @ref shutdown
+        then sends close_notify through OpenSSL without waiting for
+        the peer's.
+
+        Once offloaded, @ref shutdown sends close_notify through the
+        kernel without waiting for the peer's, and a close_notify
+        received from the peer is reported as `net::error::eof`.
+        If the socket's send buffer is full, @ref async_shutdown waits
+        on the socket of the lowest layer for room; this wait is not
+        subject to the timeout of a @ref tcp_stream, so close the
+        stream to abandon it.
+        Once the kernel decrypts received records, renegotiation and
+        other handshake messages from the peer are ignored, and OpenSSL
+        no longer reads or answers them.
+
+        @param ec Set to indicate why the stream was not offloaded.
+
+        @return `true` if the kernel now protects sent records.
+    */
+    bool
+    enable_ktls(boost::system::error_code& ec)
+    {
+        if(ktls_rx_)
+        {
+            ec = {};
+            return ktls_tx_;
+        }
+        detail::ktls_socket sock{ktls_fd()};
+        if(sock.fd < 0)
+        {
+            ec = net::error::operation_not_supported;
+            return false;
+        }
+        detail::ktls_enable(native_handle(),
+            sock, ktls_tx_, ktls_rx_, ec);
+        return ktls_tx_;
+    }
+
+    /** Hand record protection to the kernel.
+
+        This function behaves like the overload taking an error code,
+        for callers which do not need the reason for a fallback.
+
+        @return `true` if the kernel now protects sent records.
+    */
+    bool
+    enable_ktls()
+    {
+        boost::system::error_code ec;
+        return enable_ktls(ec);
+    }
+
+    /// Returns `true` if the kernel protects sent records.
+    bool
+    is_ktls_tx() const noexcept
+    {
+        return ktls_tx_;
+    }
+
+    /// Returns `true` if the kernel protects received records.
+    bool
+    is_ktls_rx() const noexcept
+    {
+        return ktls_rx_;
+    }
+
     /** Shut down SSL on the stream.
 
         This function is used to shut down SSL on the stream. The function call
@@ -449,6 +559,14 @@ public:
     void
     shutdown()
     {
+        if(ktls_tx_)
+        {
+            boost::system::error_code ec;
+            detail::ktls_send_close_notify(ktls_fd(), ec);
+            if(ec)
+                BOOST_THROW_EXCEPTION(system_error{ec});
+            return;
+        }
         p_->next_layer().shutdown();
     }
 
@@ -462,6 +580,11 @@ public:
     void
     shutdown(boost::system::error_code& ec)
     {
+        if(ktls_tx_)
+        {
+            detail::ktls_send_close_notify(ktls_fd(), ec);
+            return;
+        }
         p_->next_layer().shutdown(ec);
     }
 
@@ -481,6 +604,13 @@ public:
     BOOST_ASIO_INITFN_RESULT_TYPE(ShutdownHandler, void(boost::system::error_code))
     async_shutdown(BOOST_ASIO_MOVE_ARG(ShutdownHandler) handler)
     {
+        if(ktls_tx_)
+            return net::async_initiate<
+                ShutdownHandler,
+                void(boost::system::error_code)>(
+                    detail::run_ktls_shutdown_op{},
+                    handler,
+                    &beast::get_lowest_layer(next_layer()));
         return p_->next_layer().async_shutdown(
             BOOST_ASIO_MOVE_CAST(ShutdownHandler)(handler));
     }
@@ -505,6 +635,8 @@ public:
     std::size_t
     write_some(ConstBufferSequence const& buffers)
     {
+        if(ktls_tx_)
+            return next_layer().write_some(buffers);
         return p_->write_some(buffers);
     }
 
@@ -529,6 +661,8 @@ public:
     write_some(ConstBufferSequence const& buffers,
         boost::system::error_code& ec)
     {
+        if(ktls_tx_)
+            return next_layer().write_some(buffers, ec);
         return p_->write_some(buffers, ec);
     }
 
@@ -560,6 +694,9 @@ public:
     async_write_some(ConstBufferSequence const& buffers,
         BOOST_ASIO_MOVE_ARG(WriteHandler) handler)
     {
+        if(ktls_tx_)
+            return next_layer().async_write_some(buffers,
+                BOOST_ASIO_MOVE_CAST(WriteHandler)(handler));
         return p_->async_write_some(buffers,
             BOOST_ASIO_MOVE_CAST(WriteHandler)(handler));
     }
@@ -585,7 +722,13 @@ public:
     std::size_t
     read_some(MutableBufferSequence const& buffers)
     {
-        return p_->read_some(buffers);
+        if(! ktls_rx_)
+            return p_->read_some(buffers);
+        boost::system::error_code ec;
+        auto const n = read_some(buffers, ec);
+        if(ec)
+            BOOST_THROW_EXCEPTION(system_error{ec});
+        return n;
     }
 
     /** Read some data from the stream.
@@ -610,7 +753,17 @@ public:
     read_some(MutableBufferSequence const& buffers,
         boost::system::error_code& ec)
     {
-        return p_->read_some(buffers, ec);
+        if(! ktls_rx_)
+            return p_->read_some(buffers, ec);
+        for(;;)
+        {
+            auto const n = next_layer().read_some(buffers, ec);
+            if(! detail::ktls_is_control(ec))
+                return n;
+            detail::ktls_read_control(ktls_fd(), ec);
+            if(ec)
+                return 0;
+        }
     }
 
     /** Start an asynchronous read.
@@ -641,6 +794,15 @@ public:
     async_read_some(MutableBufferSequence const& buffers,
         BOOST_ASIO_MOVE_ARG(ReadHandler) handler)
     {
+        if(ktls_rx_)
+            return net::async_initiate<
+                ReadHandler,
+                void(boost::system::error_code, std::size_t)>(
+                    detail::run_ktls_read_op{},
+                    handler,
+                    &next_layer(),
+                    buffers,
+                    ktls_fd());
         return p_->async_read_some(buffers,
             BOOST_ASIO_MOVE_CAST(ReadHandler)(handler));
     }
@@ -675,6 +837,11 @@ teardown(
     ssl_stream<SyncStream>& stream,
     boost::system::error_code& ec)
 {
+    if(stream.ktls_tx_)
+    {
+        stream.shutdown(ec);
+        return;
+    }
     // Just forward it to the underlying ssl::stream
     using boost::beast::websocket::teardown;
     teardown(role, *stream.p_, ec);
@@ -687,6 +854,12 @@ async_teardown(
     ssl_stream<AsyncStream>& stream,
     TeardownHandler&& handler)
 {
+    if(stream.ktls_tx_)
+    {
+        stream.async_shutdown(
+            std::forward<TeardownHandler>(handler));
+        return;
+    }
     // Just forward it to the underlying ssl::stream
     using boost::beast::websocket::async_teardown;
     async_teardown(role, *stream.p_,
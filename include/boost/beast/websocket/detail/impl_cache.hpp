@@ -0,0 +1,103 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_WEBSOCKET_DETAIL_IMPL_CACHE_HPP
+#define BOOST_BEAST_WEBSOCKET_DETAIL_IMPL_CACHE_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <cstddef>
+#include <type_traits>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+namespace detail {
+
+// Memory for stream implementations can be recycled through a
+// small per-thread cache, so that short lived connections do
+// not return the large impl object to the global heap each time.
+// The cache holds at most impl_cache_max() bytes per thread, and
+// is off unless the application sets a limit.
+
+BOOST_BEAST_DECL
+void*
+impl_cache_allocate(std::size_t n);
+
+BOOST_BEAST_DECL
+void
+impl_cache_deallocate(void* p, std::size_t n) noexcept;
+
+BOOST_BEAST_DECL
+void
+impl_cache_max(std::size_t n) noexcept;
+
+BOOST_BEAST_DECL
+std::size_t
+impl_cache_max() noexcept;
+
+// Allocator used to allocate_shared stream implementations
+template<class T>
+struct impl_allocator
+{
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    template<class U>
+    struct rebind
+    {
+        using other = impl_allocator<U>;
+    };
+
+    impl_allocator() = default;
+
+    template<class U>
+    impl_allocator(impl_allocator<U> const&) noexcept
+    {
+    }
+
+    T*
+    allocate(std::size_t n)
+    {
+        return static_cast<T*>(
+            impl_cache_allocate(n * sizeof(T)));
+    }
+
+    void
+    deallocate(T* p, std::size_t n) noexcept
+    {
+        impl_cache_deallocate(p, n * sizeof(T));
+    }
+
+    template<class U>
+    friend
+    bool
+    operator==(impl_allocator const&, impl_allocator<U> const&) noexcept
+    {
+        return true;
+    }
+
+    template<class U>
+    friend
+    bool
+    operator!=(impl_allocator const&, impl_allocator<U> const&) noexcept
+    {
+        return false;
+    }
+};
+
+} // detail
+} // websocket
+} // beast
+} // boost
+
+#ifdef BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/websocket/detail/impl_cache.ipp>
+#endif
+
+#endif
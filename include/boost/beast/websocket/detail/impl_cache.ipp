@@ -0,0 +1,169 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_WEBSOCKET_DETAIL_IMPL_CACHE_IPP
+#define BOOST_BEAST_WEBSOCKET_DETAIL_IMPL_CACHE_IPP
+
+#include <boost/beast/websocket/detail/impl_cache.hpp>
+#include <boost/config.hpp>
+#include <boost/core/ignore_unused.hpp>
+#include <atomic>
+#include <new>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+namespace detail {
+
+inline
+std::atomic<std::size_t>&
+impl_cache_limit() noexcept
+{
+    static std::atomic<std::size_t> n(0);
+    return n;
+}
+
+void
+impl_cache_max(std::size_t n) noexcept
+{
+    impl_cache_limit().store(n, std::memory_order_relaxed);
+}
+
+std::size_t
+impl_cache_max() noexcept
+{
+    return impl_cache_limit().load(std::memory_order_relaxed);
+}
+
+#ifdef BOOST_NO_CXX11_THREAD_LOCAL
+
+void*
+impl_cache_allocate(std::size_t n)
+{
+    return ::operator new(n);
+}
+
+void
+impl_cache_deallocate(void* p, std::size_t n) noexcept
+{
+    boost::ignore_unused(n);
+    ::operator delete(p);
+}
+
+#else
+
+// Freed blocks, one list per block size. Each stream type has
+// a single size, so a few lists cover the types a thread uses;
+// blocks of any other size go back to the heap.
+//
+// The list is trivially destructible, so it can still be read
+// while other thread_local and static objects are destroyed.
+// Its blocks are freed by impl_cache_reaper at thread exit,
+// after which `dead` sends every block back to the heap.
+struct impl_cache_list
+{
+    struct node
+    {
+        node* next;
+    };
+
+    static std::size_t constexpr slots = 4;
+
+    node* head[slots];
+    std::size_t size[slots];
+    std::size_t bytes;
+    bool dead;
+};
+
+inline
+impl_cache_list&
+impl_cache_get() noexcept
+{
+    thread_local impl_cache_list list{};
+    return list;
+}
+
+struct impl_cache_reaper
+{
+    ~impl_cache_reaper()
+    {
+        auto& list = impl_cache_get();
+        for(auto& head : list.head)
+        {
+            while(head)
+            {
+                auto const p = head;
+                head = p->next;
+                ::operator delete(p);
+            }
+        }
+        list.bytes = 0;
+        list.dead = true;
+    }
+};
+
+// Registers the reaper for this thread. This is
+// only called while the list is still alive.
+inline
+void
+impl_cache_reap_at_exit() noexcept
+{
+    thread_local impl_cache_reaper reaper;
+    boost::ignore_unused(reaper);
+}
+
+void*
+impl_cache_allocate(std::size_t n)
+{
+    auto& list = impl_cache_get();
+    for(std::size_t i = 0; i < impl_cache_list::slots; ++i)
+    {
+        auto const p = list.head[i];
+        if(! p || list.size[i] != n)
+            continue;
+        list.head[i] = p->next;
+        list.bytes -= n;
+        p->~node();
+        return p;
+    }
+    return ::operator new(n);
+}
+
+void
+impl_cache_deallocate(void* p, std::size_t n) noexcept
+{
+    auto& list = impl_cache_get();
+    if( list.dead ||
+        n < sizeof(impl_cache_list::node) ||
+        list.bytes + n > impl_cache_max())
+    {
+        ::operator delete(p);
+        return;
+    }
+    for(std::size_t i = 0; i < impl_cache_list::slots; ++i)
+    {
+        if(list.head[i] && list.size[i] != n)
+            continue;
+        impl_cache_reap_at_exit();
+        list.size[i] = n;
+        list.head[i] = ::new(p) impl_cache_list::node{list.head[i]};
+        list.bytes += n;
+        return;
+    }
+    ::operator delete(p);
+}
+
+#endif
+
+} // detail
+} // websocket
+} // beast
+} // boost
+
+#endif
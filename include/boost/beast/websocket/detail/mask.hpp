@@ -13,6 +13,7 @@
 #include <boost/beast/core/detail/config.hpp>
 #include <boost/beast/core/buffers_range.hpp>
 #include <boost/asio/buffer.hpp>
+#include <algorithm>
 #include <array>
 #include <climits>
 #include <cstdint>
@@ -36,6 +37,17 @@ BOOST_BEAST_DECL
 void
 mask_inplace(net::mutable_buffer const& b, prepared_key& key);
 
+// Copy bytes, applying the mask in the same pass.
+// The ranges may be the same but must not otherwise overlap.
+//
+BOOST_BEAST_DECL
+void
+mask_copy(
+    void* dest,
+    void const* src,
+    std::size_t n,
+    prepared_key& key);
+
 // Apply mask in place
 //
 template<class MutableBufferSequence>
@@ -49,6 +61,57 @@ mask_inplace(
         detail::mask_inplace(b, key);
 }
 
+// Copy up to `n` bytes from one buffer sequence to another,
+// applying the mask in the same pass. Returns the number of
+// bytes copied, as with `net::buffer_copy`.
+//
+template<
+    class MutableBufferSequence,
+    class ConstBufferSequence>
+std::size_t
+mask_copy(
+    MutableBufferSequence const& dest,
+    ConstBufferSequence const& src,
+    std::size_t n,
+    prepared_key& key)
+{
+    std::size_t total = 0;
+    auto dit = net::buffer_sequence_begin(dest);
+    auto const dend = net::buffer_sequence_end(dest);
+    auto sit = net::buffer_sequence_begin(src);
+    auto const send = net::buffer_sequence_end(src);
+    std::size_t doff = 0;
+    std::size_t soff = 0;
+    while(total < n && dit != dend && sit != send)
+    {
+        auto const d = net::mutable_buffer(*dit) + doff;
+        auto const s = net::const_buffer(*sit) + soff;
+        auto const amount = (std::min)(n - total,
+            (std::min)(d.size(), s.size()));
+        detail::mask_copy(d.data(), s.data(), amount, key);
+        total += amount;
+        if(amount == d.size())
+        {
+            ++dit;
+            doff = 0;
+        }
+        else
+        {
+            doff += amount;
+        }
+        if(amount == s.size())
+        {
+            ++sit;
+            soff = 0;
+        }
+        else
+        {
+            soff += amount;
+        }
+    }
+    return total;
+}
+
 } // detail
 } // websocket
 } // beast
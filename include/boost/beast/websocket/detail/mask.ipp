@@ -11,6 +11,7 @@
 #define BOOST_BEAST_WEBSOCKET_DETAIL_MASK_IPP
 
 #include <boost/beast/websocket/detail/mask.hpp>
+#include <cstring>
 
 namespace boost {
 namespace beast {
@@ -40,20 +41,51 @@ rol(prepared_key& v, std::size_t n)
 void
 mask_inplace(net::mutable_buffer const& b, prepared_key& key)
 {
-    auto n = b.size();
+    detail::mask_copy(b.data(),
+        static_cast<void const*>(b.data()), b.size(), key);
+}
+
+// Copy bytes, applying the mask in the same pass
+//
+void
+mask_copy(
+    void* dest,
+    void const* src,
+    std::size_t n,
+    prepared_key& key)
+{
     auto const mask = key; // avoid aliasing
-    auto p = static_cast<unsigned char*>(b.data());
-    while(n >= 4)
+    auto d = static_cast<unsigned char*>(dest);
+    auto s = static_cast<unsigned char const*>(src);
+    // The key repeats every 4 bytes, so a word holding it
+    // twice in memory order masks 8 bytes at a time on any
+    // endianness. memcpy keeps the unaligned access legal.
+    std::uint64_t m;
+    std::memcpy(&m, mask.data(), 4);
+    std::memcpy(reinterpret_cast<unsigned char*>(&m) + 4,
+        mask.data(), 4);
+    while(n >= 8)
+    {
+        std::uint64_t v;
+        std::memcpy(&v, s, 8);
+        v ^= m;
+        std::memcpy(d, &v, 8);
+        d += 8;
+        s += 8;
+        n -= 8;
+    }
+    if(n >= 4)
     {
         for(int i = 0; i < 4; ++i)
-            p[i] ^= mask[i];
-        p += 4;
+            d[i] = s[i] ^ mask[i];
+        d += 4;
+        s += 4;
         n -= 4;
     }
     if(n > 0)
     {
         for(std::size_t i = 0; i < n; ++i)
-            p[i] ^= mask[i];
+            d[i] = s[i] ^ mask[i];
         rol(key, n);
     }
 }
@@ -29,6 +29,7 @@ public:
         : public boost::enable_shared_from_this<impl_type>
     {
         service& svc_;
+        std::size_t shard_;
         std::size_t index_;
 
         friend class service;
@@ -50,8 +51,24 @@ public:
     };
 
 private:
-    std::mutex m_;
-    std::vector<impl_type*> v_;
+    // Streams register in one of several lists, chosen by the
+    // constructing thread, so that threads creating and destroying
+    // streams at the same time do not contend on one mutex.
+    struct shard
+    {
+        char pad[64]; // keep the mutexes on separate cache lines
+        std::mutex m;
+        std::vector<impl_type*> v;
+    };
+
+    static std::size_t constexpr shard_count = 16;
+
+    shard shards_[shard_count];
+
+    BOOST_BEAST_DECL
+    static
+    std::size_t
+    select_shard(void const* p) noexcept;
 
     BOOST_BEAST_DECL
     void
@@ -11,6 +11,9 @@
 #define BOOST_BEAST_WEBSOCKET_DETAIL_SERVICE_IPP
 
 #include <boost/beast/websocket/detail/service.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 
 namespace boost {
 namespace beast {
@@ -21,10 +24,12 @@ service::
 impl_type::
 impl_type(net::execution_context& ctx)
     : svc_(net::use_service<service>(ctx))
+    , shard_(select_shard(this))
 {
-    std::lock_guard<std::mutex> g(svc_.m_);
-    index_ = svc_.v_.size();
-    svc_.v_.push_back(this);
+    auto& sh = svc_.shards_[shard_];
+    std::lock_guard<std::mutex> g(sh.m);
+    index_ = sh.v.size();
+    sh.v.push_back(this);
 }
 
 void
@@ -32,24 +37,51 @@ service::
 impl_type::
 remove()
 {
-    std::lock_guard<std::mutex> g(svc_.m_);
-    auto& other = *svc_.v_.back();
+    auto& sh = svc_.shards_[shard_];
+    std::lock_guard<std::mutex> g(sh.m);
+    auto& other = *sh.v.back();
     other.index_ = index_;
-    svc_.v_[index_] = &other;
-    svc_.v_.pop_back();
+    sh.v[index_] = &other;
+    sh.v.pop_back();
 }
 
 //---
 
+#ifdef BOOST_NO_CXX11_THREAD_LOCAL
+
+std::size_t
+service::
+select_shard(void const* p) noexcept
+{
+    auto const n = reinterpret_cast<std::uintptr_t>(p);
+    return ((n >> 4) ^ (n >> 12)) % shard_count;
+}
+
+#else
+
+std::size_t
+service::
+select_shard(void const*) noexcept
+{
+    // Threads are assigned shards in turn on first use
+    static std::atomic<std::size_t> next(0);
+    thread_local static std::size_t const n =
+        next.fetch_add(1, std::memory_order_relaxed) % shard_count;
+    return n;
+}
+
+#endif
+
 void
 service::
 shutdown()
 {
     std::vector<boost::weak_ptr<impl_type>> v;
+    for(auto& sh : shards_)
     {
-        std::lock_guard<std::mutex> g(m_);
-        v.reserve(v_.size());
-        for(auto p : v_)
+        std::lock_guard<std::mutex> g(sh.m);
+        v.reserve(v.size() + sh.v.size());
+        for(auto p : sh.v)
             v.emplace_back(p->weak_from_this());
     }
     for(auto wp : v)
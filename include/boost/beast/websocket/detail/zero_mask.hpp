@@ -0,0 +1,68 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_WEBSOCKET_DETAIL_ZERO_MASK_HPP
+#define BOOST_BEAST_WEBSOCKET_DETAIL_ZERO_MASK_HPP
+
+#include <boost/beast/core/string.hpp>
+#include <boost/beast/http/fields.hpp>
+#include <boost/beast/http/rfc7230.hpp>
+#include <string>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+namespace detail {
+
+// Extension token for the zero mask extension
+inline
+string_view
+zero_mask_token() noexcept
+{
+    return "x-beast-zero-mask";
+}
+
+// Returns `true` if the fields offer or accept the extension
+//
+template<class Allocator>
+bool
+zero_mask_read(http::basic_fields<Allocator> const& fields)
+{
+    http::ext_list list{
+        fields[http::field::sec_websocket_extensions]};
+    return list.exists(zero_mask_token());
+}
+
+// Add the extension to the fields, after any others
+//
+template<class Allocator>
+void
+zero_mask_write(http::basic_fields<Allocator>& fields)
+{
+    auto const it = fields.find(
+        http::field::sec_websocket_extensions);
+    if(it == fields.end())
+    {
+        fields.set(http::field::sec_websocket_extensions,
+            zero_mask_token());
+        return;
+    }
+    std::string s(it->value());
+    s.append(", ");
+    s.append(zero_mask_token().data(),
+        zero_mask_token().size());
+    fields.set(http::field::sec_websocket_extensions, s);
+}
+
+} // detail
+} // websocket
+} // beast
+} // boost
+
+#endif
@@ -152,6 +152,8 @@ build_response(
         res.set(http::field::sec_websocket_accept, acc);
     }
     this->build_response_pmd(res, req);
+    if(zm_opt.server_enable && detail::zero_mask_read(req))
+        detail::zero_mask_write(res);
     decorate(res);
     result = {};
     return res;
@@ -168,7 +168,7 @@ public:
                     auto const mb = buffers_prefix(
                         clamp(impl.rd_fh.len),
                         impl.rd_buf.data());
-                    if(impl.rd_fh.len > 0 && impl.rd_fh.mask)
+                    if(impl.rd_fh.len > 0 && impl.rd_masked())
                         detail::mask_inplace(mb, impl.rd_key);
                     detail::read_close(impl.cr, mb, ev_);
                     if(ev_)
@@ -342,7 +342,7 @@ close(close_reason const& cr, error_code& ec)
             auto const mb = buffers_prefix(
                 clamp(impl.rd_fh.len),
                 impl.rd_buf.data());
-            if(impl.rd_fh.len > 0 && impl.rd_fh.mask)
+            if(impl.rd_fh.len > 0 && impl.rd_masked())
                 detail::mask_inplace(mb, impl.rd_key);
             detail::read_close(impl.cr, mb, ev);
             if(ev)
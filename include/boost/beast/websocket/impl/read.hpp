@@ -185,8 +185,12 @@ public:
                     impl.rd_block.lock(this);
                 }
                 // Immediately apply the mask to the portion
-                // of the buffer holding payload data.
-                if(impl.rd_fh.len > 0 && impl.rd_fh.mask)
+                // of the buffer holding control or compressed
+                // payload data. Other payload data is unmasked
+                // as it is copied out.
+                if(impl.rd_fh.len > 0 && impl.rd_masked() && (
+                    detail::is_control(impl.rd_fh.op) ||
+                        impl.rd_deflated()))
                     detail::mask_inplace(buffers_prefix(
                         clamp(impl.rd_fh.len),
                             impl.rd_buf.data()),
@@ -366,17 +370,18 @@ public:
                         if(impl.check_stop_now(ec))
                             goto upcall;
                         impl.reset_idle();
-                        if(impl.rd_fh.mask)
-                            detail::mask_inplace(buffers_prefix(clamp(
-                                impl.rd_remain), impl.rd_buf.data()),
-                                    impl.rd_key);
                     }
                     if(impl.rd_buf.size() > 0)
                     {
-                        // Copy from the read buffer.
-                        // The mask was already applied.
-                        bytes_transferred = net::buffer_copy(cb_,
-                            impl.rd_buf.data(), clamp(impl.rd_remain));
+                        // Copy from the read buffer,
+                        // removing the mask in the same pass.
+                        if(impl.rd_masked())
+                            bytes_transferred = detail::mask_copy(cb_,
+                                impl.rd_buf.data(), clamp(impl.rd_remain),
+                                    impl.rd_key);
+                        else
+                            bytes_transferred = net::buffer_copy(cb_,
+                                impl.rd_buf.data(), clamp(impl.rd_remain));
                         auto const mb = buffers_prefix(
                             bytes_transferred, cb_);
                         impl.rd_remain -= bytes_transferred;
@@ -395,6 +400,7 @@ public:
                         bytes_written_ += bytes_transferred;
                         impl.rd_size += bytes_transferred;
                         impl.rd_buf.consume(bytes_transferred);
+                        cb_.consume(bytes_transferred);
                     }
                     else
                     {
@@ -413,7 +419,7 @@ public:
                         auto const mb = buffers_prefix(
                             bytes_transferred, cb_);
                         impl.rd_remain -= bytes_transferred;
-                        if(impl.rd_fh.mask)
+                        if(impl.rd_masked())
                             detail::mask_inplace(mb, impl.rd_key);
                         if(impl.rd_op == detail::opcode::text)
                         {
@@ -429,11 +435,20 @@ public:
                         }
                         bytes_written_ += bytes_transferred;
                         impl.rd_size += bytes_transferred;
+                        cb_.consume(bytes_transferred);
                     }
                 }
                 BOOST_ASSERT( ! impl.rd_done );
                 if( impl.rd_remain == 0 && impl.rd_fh.fin )
                     impl.rd_done = true;
+                else if(impl.rd_remain == 0 &&
+                    buffer_bytes(cb_) > 0 && impl.rd_burst())
+                {
+                    // Small frames often arrive together,
+                    // go on to the next one already in the
+                    // read buffer instead of completing.
+                    goto loop;
+                }
             }
             else
             {
@@ -457,7 +472,7 @@ public:
                         impl.reset_idle();
                         BOOST_ASSERT(bytes_transferred > 0);
                         impl.rd_buf.commit(bytes_transferred);
-                        if(impl.rd_fh.mask)
+                        if(impl.rd_masked())
                             detail::mask_inplace(
                                 buffers_prefix(clamp(impl.rd_remain),
                                     impl.rd_buf.data()), impl.rd_key);
@@ -608,6 +623,19 @@ public:
                     || impl.op_idle_ping.maybe_invoke()
                     || impl.op_ping.maybe_invoke()
                     || impl.op_wr.maybe_invoke();
+            // A read satisfied from rd_buf may skip the
+            // post, within the budget set by the caller.
+            // Errors found before any I/O are still posted.
+            if(! cont && ! ec &&
+                impl.rd_immediate < impl.rd_immediate_max)
+            {
+                ++impl.rd_immediate;
+                cont = true;
+            }
+            else
+            {
+                impl.rd_immediate = 0;
+            }
             this->complete(cont, ec, bytes_written_);
         }
     }
@@ -694,6 +722,96 @@ public:
     }
 };
 
+template<class NextLayer, bool deflateSupported>
+template<class Handler, class MutableBufferSequence>
+class stream<NextLayer, deflateSupported>::read_into_op
+    : public beast::stable_async_base<
+        Handler, beast::executor_type<stream>>
+    , public asio::coroutine
+{
+    boost::weak_ptr<impl_type> wp_;
+    buffers_suffix<MutableBufferSequence> cb_;
+    std::size_t bytes_written_ = 0;
+    char* scratch_ = nullptr;
+
+public:
+    template<class Handler_>
+    read_into_op(
+        Handler_&& h,
+        boost::shared_ptr<impl_type> const& sp,
+        MutableBufferSequence const& bs)
+        : stable_async_base<Handler,
+            beast::executor_type<stream>>(
+                std::forward<Handler_>(h),
+                    sp->stream().get_executor())
+        , wp_(sp)
+        , cb_(bs)
+    {
+        (*this)({}, 0, false);
+    }
+
+    void operator()(
+        error_code ec = {},
+        std::size_t bytes_transferred = 0,
+        bool cont = true)
+    {
+        auto sp = wp_.lock();
+        if(! sp)
+        {
+            ec = net::error::operation_aborted;
+            bytes_written_ = 0;
+            return this->complete(cont, ec, bytes_written_);
+        }
+        auto& impl = *sp;
+        BOOST_ASIO_CORO_REENTER(*this)
+        {
+            do
+            {
+                if(buffer_bytes(cb_) > 0)
+                {
+                    // Large payloads are read by read_some_op
+                    // straight into the caller's buffers.
+                    BOOST_ASIO_CORO_YIELD
+                    read_some_op<read_into_op, buffers_suffix<
+                        MutableBufferSequence>>(
+                            std::move(*this), sp, cb_);
+
+                    cb_.consume(bytes_transferred);
+                    bytes_written_ += bytes_transferred;
+                }
+                else
+                {
+                    // The buffers are full, so the rest of the
+                    // message must not produce any payload, as
+                    // with an empty final frame. One byte of
+                    // room lets a compressed message finish.
+                    if(! scratch_)
+                        scratch_ = &beast::allocate_stable<
+                            char>(*this, '\0');
+                    BOOST_ASIO_CORO_YIELD
+                    read_some_op<read_into_op, net::mutable_buffer>(
+                        std::move(*this), sp,
+                            net::mutable_buffer(scratch_, 1));
+
+                    if(! ec && bytes_transferred > 0)
+                    {
+                        // The message does not fit
+                        ec = error::buffer_overflow;
+                        impl.check_stop_now(ec);
+                        goto upcall;
+                    }
+                }
+                if(ec)
+                    goto upcall;
+            }
+            while(! impl.rd_done);
+
+        upcall:
+            this->complete(cont, ec, bytes_written_);
+        }
+    }
+};
+
 template<class NextLayer, bool deflateSupported>
 struct stream<NextLayer, deflateSupported>::
     run_read_some_op
@@ -760,6 +878,37 @@ struct stream<NextLayer, deflateSupported>::
     }
 };
 
+template<class NextLayer, bool deflateSupported>
+struct stream<NextLayer, deflateSupported>::
+    run_read_into_op
+{
+    template<
+        class ReadHandler,
+        class MutableBufferSequence>
+    void
+    operator()(
+        ReadHandler&& h,
+        boost::shared_ptr<impl_type> const& sp,
+        MutableBufferSequence const& b)
+    {
+        // If you get an error on the following line it means
+        // that your handler does not meet the documented type
+        // requirements for the handler.
+
+        static_assert(
+            beast::detail::is_invocable<ReadHandler,
+                void(error_code, std::size_t)>::value,
+            "ReadHandler type requirements not met");
+
+        read_into_op<
+            typename std::decay<ReadHandler>::type,
+            MutableBufferSequence>(
+                std::forward<ReadHandler>(h),
+                sp,
+                b);
+    }
+};
+
 //------------------------------------------------------------------------------
 
 template<class NextLayer, bool deflateSupported>
@@ -826,6 +975,89 @@ async_read(DynamicBuffer& buffer, ReadHandler&& handler)
 
 //------------------------------------------------------------------------------
 
+template<class NextLayer, bool deflateSupported>
+template<class MutableBufferSequence>
+std::size_t
+stream<NextLayer, deflateSupported>::
+read_into(MutableBufferSequence const& buffers)
+{
+    static_assert(is_sync_stream<next_layer_type>::value,
+        "SyncStream type requirements not met");
+    static_assert(net::is_mutable_buffer_sequence<
+            MutableBufferSequence>::value,
+        "MutableBufferSequence type requirements not met");
+    error_code ec;
+    auto const bytes_written = read_into(buffers, ec);
+    if(ec)
+        BOOST_THROW_EXCEPTION(system_error{ec});
+    return bytes_written;
+}
+
+template<class NextLayer, bool deflateSupported>
+template<class MutableBufferSequence>
+std::size_t
+stream<NextLayer, deflateSupported>::
+read_into(MutableBufferSequence const& buffers, error_code& ec)
+{
+    static_assert(is_sync_stream<next_layer_type>::value,
+        "SyncStream type requirements not met");
+    static_assert(net::is_mutable_buffer_sequence<
+            MutableBufferSequence>::value,
+        "MutableBufferSequence type requirements not met");
+    buffers_suffix<MutableBufferSequence> cb(buffers);
+    std::size_t bytes_written = 0;
+    do
+    {
+        if(buffer_bytes(cb) == 0)
+        {
+            // The buffers are full, so the rest of the
+            // message must not produce any payload.
+            char c;
+            auto const n = read_some(net::mutable_buffer(&c, 1), ec);
+            if(! ec && n > 0)
+            {
+                // The message does not fit
+                ec = error::buffer_overflow;
+                impl_->check_stop_now(ec);
+            }
+            if(ec)
+                return bytes_written;
+            continue;
+        }
+        auto const n = read_some(cb, ec);
+        cb.consume(n);
+        bytes_written += n;
+        if(ec)
+            return bytes_written;
+    }
+    while(! is_message_done());
+    return bytes_written;
+}
+
+template<class NextLayer, bool deflateSupported>
+template<class MutableBufferSequence, BOOST_BEAST_ASYNC_TPARAM2 ReadHandler>
+BOOST_BEAST_ASYNC_RESULT2(ReadHandler)
+stream<NextLayer, deflateSupported>::
+async_read_into(
+    MutableBufferSequence const& buffers,
+    ReadHandler&& handler)
+{
+    static_assert(is_async_stream<next_layer_type>::value,
+        "AsyncStream type requirements not met");
+    static_assert(net::is_mutable_buffer_sequence<
+            MutableBufferSequence>::value,
+        "MutableBufferSequence type requirements not met");
+    return net::async_initiate<
+        ReadHandler,
+        void(error_code, std::size_t)>(
+            run_read_into_op{},
+            handler,
+            impl_,
+            buffers);
+}
+
+//------------------------------------------------------------------------------
+
 template<class NextLayer, bool deflateSupported>
 template<class DynamicBuffer>
 std::size_t
@@ -940,6 +1172,7 @@ read_some(
     close_code code{};
     std::size_t bytes_written = 0;
     ec = {};
+    buffers_suffix<MutableBufferSequence> cb(buffers);
     // Make sure the stream is open
     if(impl.check_stop_now(ec))
         return bytes_written;
@@ -975,8 +1208,12 @@ loop:
                 return bytes_written;
         }
         // Immediately apply the mask to the portion
-        // of the buffer holding payload data.
-        if(impl.rd_fh.len > 0 && impl.rd_fh.mask)
+        // of the buffer holding control or compressed
+        // payload data. Other payload data is unmasked
+        // as it is copied out.
+        if(impl.rd_fh.len > 0 && impl.rd_masked() && (
+            detail::is_control(impl.rd_fh.op) ||
+                impl.rd_deflated()))
             detail::mask_inplace(buffers_prefix(
                 clamp(impl.rd_fh.len), impl.rd_buf.data()),
                     impl.rd_key);
@@ -1068,7 +1305,7 @@ loop:
         {
             if(impl.rd_buf.size() == 0 && impl.rd_buf.max_size() >
                 (std::min)(clamp(impl.rd_remain),
-                    buffer_bytes(buffers)))
+                    buffer_bytes(cb)))
             {
                 // Fill the read buffer first, otherwise we
                 // get fewer bytes at the cost of one I/O.
@@ -1077,20 +1314,18 @@ loop:
                         impl.rd_buf.max_size())), ec));
                 if(impl.check_stop_now(ec))
                     return bytes_written;
-                if(impl.rd_fh.mask)
-                    detail::mask_inplace(
-                        buffers_prefix(clamp(impl.rd_remain),
-                            impl.rd_buf.data()), impl.rd_key);
             }
             if(impl.rd_buf.size() > 0)
             {
-                // Copy from the read buffer.
-                // The mask was already applied.
-                auto const bytes_transferred = net::buffer_copy(
-                    buffers, impl.rd_buf.data(),
+                // Copy from the read buffer,
+                // removing the mask in the same pass.
+                auto const bytes_transferred = impl.rd_masked() ?
+                    detail::mask_copy(cb, impl.rd_buf.data(),
+                        clamp(impl.rd_remain), impl.rd_key) :
+                    net::buffer_copy(cb, impl.rd_buf.data(),
                         clamp(impl.rd_remain));
                 auto const mb = buffers_prefix(
-                    bytes_transferred, buffers);
+                    bytes_transferred, cb);
                 impl.rd_remain -= bytes_transferred;
                 if(impl.rd_op == detail::opcode::text)
                 {
@@ -1107,25 +1342,26 @@ loop:
                 bytes_written += bytes_transferred;
                 impl.rd_size += bytes_transferred;
                 impl.rd_buf.consume(bytes_transferred);
+                cb.consume(bytes_transferred);
             }
             else
             {
                 // Read into caller's buffer
                 BOOST_ASSERT(impl.rd_remain > 0);
-                BOOST_ASSERT(buffer_bytes(buffers) > 0);
+                BOOST_ASSERT(buffer_bytes(cb) > 0);
                 BOOST_ASSERT(buffer_bytes(buffers_prefix(
-                    clamp(impl.rd_remain), buffers)) > 0);
+                    clamp(impl.rd_remain), cb)) > 0);
                 auto const bytes_transferred =
                     impl.stream().read_some(buffers_prefix(
-                        clamp(impl.rd_remain), buffers), ec);
+                        clamp(impl.rd_remain), cb), ec);
                 // VFALCO What if some bytes were written?
                 if(impl.check_stop_now(ec))
                     return bytes_written;
                 BOOST_ASSERT(bytes_transferred > 0);
                 auto const mb = buffers_prefix(
-                    bytes_transferred, buffers);
+                    bytes_transferred, cb);
                 impl.rd_remain -= bytes_transferred;
-                if(impl.rd_fh.mask)
+                if(impl.rd_masked())
                     detail::mask_inplace(mb, impl.rd_key);
                 if(impl.rd_op == detail::opcode::text)
                 {
@@ -1141,11 +1377,20 @@ loop:
                 }
                 bytes_written += bytes_transferred;
                 impl.rd_size += bytes_transferred;
+                cb.consume(bytes_transferred);
             }
         }
         BOOST_ASSERT( ! impl.rd_done );
         if( impl.rd_remain == 0 && impl.rd_fh.fin )
             impl.rd_done = true;
+        else if(impl.rd_remain == 0 &&
+            buffer_bytes(cb) > 0 && impl.rd_burst())
+        {
+            // Small frames often arrive together,
+            // go on to the next one already in the
+            // read buffer instead of returning.
+            goto loop;
+        }
     }
     else
     {
@@ -1154,7 +1399,6 @@ loop:
         // never emit the end-of-stream deflate block.
         //
         bool did_read = false;
-        buffers_suffix<MutableBufferSequence> cb(buffers);
         while(buffer_bytes(cb) > 0)
         {
             zlib::z_params zs;
@@ -1187,7 +1431,7 @@ loop:
                         return bytes_written;
                     BOOST_ASSERT(bytes_transferred > 0);
                     impl.rd_buf.commit(bytes_transferred);
-                    if(impl.rd_fh.mask)
+                    if(impl.rd_masked())
                         detail::mask_inplace(
                             buffers_prefix(clamp(impl.rd_remain),
                                 impl.rd_buf.data()), impl.rd_key);
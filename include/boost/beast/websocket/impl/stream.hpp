@@ -14,6 +14,7 @@
 #include <boost/beast/websocket/rfc6455.hpp>
 #include <boost/beast/websocket/teardown.hpp>
 #include <boost/beast/websocket/detail/hybi13.hpp>
+#include <boost/beast/websocket/detail/impl_cache.hpp>
 #include <boost/beast/websocket/detail/mask.hpp>
 #include <boost/beast/websocket/impl/stream_impl.hpp>
 #include <boost/beast/version.hpp>
@@ -51,7 +52,8 @@ template<class NextLayer, bool deflateSupported>
 template<class... Args>
 stream<NextLayer, deflateSupported>::
 stream(Args&&... args)
-    : impl_(boost::make_shared<impl_type>(
+    : impl_(boost::allocate_shared<impl_type>(
+        detail::impl_allocator<impl_type>{},
         std::forward<Args>(args)...))
 {
     BOOST_ASSERT(impl_->rd_buf.max_size() >=
@@ -192,6 +194,22 @@ get_option(permessage_deflate& o)
     impl_->get_option_pmd(o);
 }
 
+template<class NextLayer, bool deflateSupported>
+void
+stream<NextLayer, deflateSupported>::
+set_option(zero_mask const& o)
+{
+    impl_->zm_opt = o;
+}
+
+template<class NextLayer, bool deflateSupported>
+void
+stream<NextLayer, deflateSupported>::
+get_option(zero_mask& o)
+{
+    o = impl_->zm_opt;
+}
+
 template<class NextLayer, bool deflateSupported>
 void
 stream<NextLayer, deflateSupported>::
@@ -259,6 +277,22 @@ read_message_max() const
     return impl_->rd_msg_max;
 }
 
+template<class NextLayer, bool deflateSupported>
+void
+stream<NextLayer, deflateSupported>::
+read_immediate_max(std::size_t amount)
+{
+    impl_->rd_immediate_max = amount;
+}
+
+template<class NextLayer, bool deflateSupported>
+std::size_t
+stream<NextLayer, deflateSupported>::
+read_immediate_max() const
+{
+    return impl_->rd_immediate_max;
+}
+
 template<class NextLayer, bool deflateSupported>
 void
 stream<NextLayer, deflateSupported>::
@@ -286,6 +320,22 @@ write_buffer_bytes() const
     return impl_->wr_buf_opt;
 }
 
+template<class NextLayer, bool deflateSupported>
+void
+stream<NextLayer, deflateSupported>::
+mask_buffer_bytes(std::size_t amount)
+{
+    impl_->wr_mask_opt = amount;
+}
+
+template<class NextLayer, bool deflateSupported>
+std::size_t
+stream<NextLayer, deflateSupported>::
+mask_buffer_bytes() const
+{
+    return impl_->wr_mask_opt;
+}
+
 template<class NextLayer, bool deflateSupported>
 void
 stream<NextLayer, deflateSupported>::
@@ -19,6 +19,7 @@
 #include <boost/beast/websocket/detail/service.hpp>
 #include <boost/beast/websocket/detail/soft_mutex.hpp>
 #include <boost/beast/websocket/detail/utf8_checker.hpp>
+#include <boost/beast/websocket/detail/zero_mask.hpp>
 #include <boost/beast/http/read.hpp>
 #include <boost/beast/http/write.hpp>
 #include <boost/beast/http/rfc7230.hpp>
@@ -35,6 +36,7 @@
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/optional.hpp>
+#include <algorithm>
 
 namespace boost {
 namespace beast {
@@ -74,6 +76,8 @@ struct stream<NextLayer, deflateSupported>::impl_type
     control_cb_type         ctrl_cb;        // control callback
 
     std::size_t             rd_msg_max      /* max message size */ = 16 * 1024 * 1024;
+    std::size_t             rd_immediate_max /* max consecutive immediate completions */ = 0;
+    std::size_t             rd_immediate    /* consecutive immediate completions so far */ = 0;
     std::uint64_t           rd_size         /* total size of current message so far */ = 0;
     std::uint64_t           rd_remain       /* message frame bytes left in current frame */ = 0;
     detail::frame_header    rd_fh;          // current frame header
@@ -103,6 +107,10 @@ struct stream<NextLayer, deflateSupported>::impl_type
         std::uint8_t[]>     wr_buf;         // write buffer
     std::size_t             wr_buf_size     /* write buffer size (current message) */ = 0;
     std::size_t             wr_buf_opt      /* write buffer size option setting */ = 4096;
+    std::size_t             wr_mask_size    /* mask staging size (current message) */ = 0;
+    std::size_t             wr_mask_opt     /* mask staging size option setting */ = 0;
+    bool                    wr_zero_mask    /* send zero mask keys (negotiated) */ = false;
+    zero_mask               zm_opt;         // zero mask extension options
     detail::fh_buffer       wr_fb;          // header buffer used for writes
 
     saved_handler           op_rd;          // paused read op
@@ -159,6 +167,7 @@ struct stream<NextLayer, deflateSupported>::impl_type
         role = role_;
         status_ = status::open;
         rd_remain = 0;
+        rd_immediate = 0;
         rd_cont = false;
         rd_done = true;
         // Can't clear this because accept uses it
@@ -174,6 +183,8 @@ struct stream<NextLayer, deflateSupported>::impl_type
 
         wr_cont = false;
         wr_buf_size = 0;
+        wr_mask_size = 0;
+        wr_zero_mask = false;
 
         this->open_pmd(role);
     }
@@ -193,6 +204,7 @@ struct stream<NextLayer, deflateSupported>::impl_type
         timer.expires_at(never());
         cr.code = close_code::none;
         rd_remain = 0;
+        rd_immediate = 0;
         rd_cont = false;
         rd_done = true;
         rd_buf.consume(rd_buf.size());
@@ -227,21 +239,30 @@ struct stream<NextLayer, deflateSupported>::impl_type
         wr_compress =
             this->pmd_enabled() && wr_compress_opt;
 
-        // Maintain the write buffer
+        // Maintain the write buffer. In the client role it
+        // also stages masked payload, which may use more of
+        // it than one fragment.
         if( this->pmd_enabled() ||
             role == role_type::client)
         {
+            auto const mask_size =
+                role == role_type::client ?
+                    (std::max)(wr_buf_opt, wr_mask_opt) :
+                    wr_buf_opt;
             if(! wr_buf ||
-                wr_buf_size != wr_buf_opt)
+                wr_buf_size != wr_buf_opt ||
+                wr_mask_size != mask_size)
             {
                 wr_buf_size = wr_buf_opt;
+                wr_mask_size = mask_size;
                 wr_buf = boost::make_unique_noinit<
-                    std::uint8_t[]>(wr_buf_size);
+                    std::uint8_t[]>(wr_mask_size);
             }
         }
         else
         {
             wr_buf_size = wr_buf_opt;
+            wr_mask_size = 0;
             wr_buf.reset();
         }
 
@@ -278,9 +299,45 @@ struct stream<NextLayer, deflateSupported>::impl_type
     parse_fh(detail::frame_header& fh,
         DynamicBuffer& b, error_code& ec);
 
+    // Returns `true` if rd_buf holds the complete header and
+    // payload of a continuation frame which carries data or ends
+    // the message, after any empty ones, so a read can go on to
+    // it without performing I/O. Frames which parse_fh would
+    // reject end the burst, the next read reports the error.
+    bool
+    rd_burst() const;
+
+    // Decode the header of a frame at the front of `cb`
+    // which parse_fh would accept, as part of a message
+    // of `size` bytes so far. Returns the size of the
+    // header, or zero if it is incomplete or rejected.
+    template<class ConstBufferSequence>
+    std::size_t
+    rd_peek(ConstBufferSequence const& cb,
+        std::uint64_t size, detail::frame_header& fh) const;
+
+    // Read a message held in full by rd_buf as one
+    // uncompressed frame, without an operation. Returns
+    // `false`, changing nothing, when one is needed.
+    template<class DynamicBuffer>
+    bool
+    rd_take(DynamicBuffer& buffer,
+        std::size_t& bytes_transferred);
+
+    // `true` if the current frame payload must be unmasked.
+    // A zero key leaves the payload unchanged.
+    bool
+    rd_masked() const
+    {
+        return rd_fh.mask && rd_fh.key != 0;
+    }
+
     std::uint32_t
     create_mask()
     {
+        // Negotiated with the zero mask extension
+        if(wr_zero_mask)
+            return 0;
         auto g = detail::make_prng(secure_prng_);
         for(;;)
             if(auto key = g())
@@ -602,6 +659,8 @@ build_request(
     req.set(http::field::sec_websocket_key, key);
     req.set(http::field::sec_websocket_version, "13");
     this->build_request_pmd(req);
+    if(zm_opt.client_enable)
+        detail::zero_mask_write(req);
     decorator_opt(req);
     decorator(req);
     return req;
@@ -653,6 +712,8 @@ on_response(
     ec = {};
     this->on_response_pmd(res);
     this->open(role_type::client);
+    wr_zero_mask = zm_opt.client_enable &&
+        detail::zero_mask_read(res);
 }
 
 //------------------------------------------------------------------------------
@@ -869,6 +930,144 @@ parse_fh(
     return true;
 }
 
+template<class NextLayer, bool deflateSupported>
+bool
+stream<NextLayer, deflateSupported>::impl_type::
+rd_burst() const
+{
+    buffers_suffix<decltype(rd_buf.data())> cb(rd_buf.data());
+    for(;;)
+    {
+        detail::frame_header fh;
+        auto const need = rd_peek(cb, rd_size, fh);
+        if(need == 0 || fh.op != detail::opcode::cont)
+            return false;
+        if(fh.len > 0 || fh.fin)
+            return buffer_bytes(cb) - need >= fh.len;
+        // Skip an empty non-final frame
+        cb.consume(need);
+    }
+}
+
+template<class NextLayer, bool deflateSupported>
+template<class ConstBufferSequence>
+std::size_t
+stream<NextLayer, deflateSupported>::impl_type::
+rd_peek(
+    ConstBufferSequence const& cb,
+    std::uint64_t size,
+    detail::frame_header& fh) const
+{
+    // The largest frame header is 14 bytes
+    std::uint8_t tmp[14];
+    auto const n = net::buffer_copy(net::buffer(tmp), cb);
+    if(n < 2)
+        return 0;
+    // reserved bits
+    if(tmp[0] & 0x70)
+        return 0;
+    fh.op = static_cast<detail::opcode>(tmp[0] & 0x0f);
+    fh.fin = (tmp[0] & 0x80) != 0;
+    fh.rsv1 = false;
+    fh.rsv2 = false;
+    fh.rsv3 = false;
+    fh.mask = (tmp[1] & 0x80) != 0;
+    if(fh.mask != (role == role_type::server))
+        return 0;
+    std::size_t need = 2;
+    fh.len = tmp[1] & 0x7f;
+    if(fh.len == 126)
+        need += 2;
+    else if(fh.len == 127)
+        need += 8;
+    if(fh.mask)
+        need += 4;
+    if(n < need)
+        return 0;
+    if(fh.len == 126)
+    {
+        fh.len = (std::uint64_t(tmp[2]) << 8) | tmp[3];
+        if(fh.len < 126)
+            return 0;
+    }
+    else if(fh.len == 127)
+    {
+        fh.len = 0;
+        for(std::size_t i = 2; i < 10; ++i)
+            fh.len = (fh.len << 8) | tmp[i];
+        if(fh.len < 65536)
+            return 0;
+    }
+    fh.key = 0;
+    if(fh.mask)
+        for(std::size_t i = need; i-- > need - 4;)
+            fh.key = (fh.key << 8) | tmp[i];
+    // message size limit
+    if(size > (std::numeric_limits<
+        std::uint64_t>::max)() - fh.len)
+        return 0;
+    if(rd_msg_max && beast::detail::sum_exceeds(
+        size, fh.len, rd_msg_max))
+        return 0;
+    return need;
+}
+
+template<class NextLayer, bool deflateSupported>
+template<class DynamicBuffer>
+bool
+stream<NextLayer, deflateSupported>::impl_type::
+rd_take(
+    DynamicBuffer& buffer,
+    std::size_t& bytes_transferred)
+{
+    // Only between messages, with no read pending
+    if( status_ != status::open || timed_out ||
+        rd_block.is_locked() || ! rd_done ||
+        rd_cont || rd_remain != 0)
+        return false;
+    detail::frame_header fh;
+    buffers_suffix<decltype(rd_buf.data())> cb(rd_buf.data());
+    auto const need = rd_peek(cb, 0, fh);
+    if( need == 0 || ! fh.fin || (
+            fh.op != detail::opcode::text &&
+            fh.op != detail::opcode::binary))
+        return false;
+    cb.consume(need);
+    if(buffer_bytes(cb) < fh.len)
+        return false;
+    auto const len = static_cast<std::size_t>(fh.len);
+    if(buffer.max_size() - buffer.size() < len)
+        return false;
+    auto const mb = buffer.prepare(len);
+    if(fh.mask && fh.key != 0)
+    {
+        detail::prepared_key key;
+        detail::prepare_key(key, fh.key);
+        detail::mask_copy(mb, cb, len, key);
+    }
+    else
+    {
+        net::buffer_copy(mb, cb, len);
+    }
+    // Invalid text is left to the read
+    // operation, which fails the connection.
+    if(fh.op == detail::opcode::text)
+    {
+        detail::utf8_checker utf8;
+        if(! utf8.write(mb) || ! utf8.finish())
+            return false;
+    }
+    error_code ec;
+    BOOST_VERIFY(parse_fh(rd_fh, rd_buf, ec));
+    BOOST_ASSERT(rd_fh.len == fh.len && rd_fh.key == fh.key);
+    rd_buf.consume(len);
+    rd_remain = 0;
+    rd_size = len;
+    buffer.commit(len);
+    bytes_transferred = len;
+    return true;
+}
+
 template<class NextLayer, bool deflateSupported>
 template<class DynamicBuffer>
 void
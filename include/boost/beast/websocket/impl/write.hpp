@@ -99,13 +99,16 @@ public:
             detail::opcode::cont : impl.wr_opcode;
         fh_.mask =
             impl.role == role_type::client;
+        fh_.key = 0;
 
-        // Choose a write algorithm
+        // Choose a write algorithm. With the zero mask
+        // extension, masked frames carry a zero key and
+        // the payload is sent as-is.
         if(impl.wr_compress)
         {
             how_ = do_deflate;
         }
-        else if(! fh_.mask)
+        else if(! fh_.mask || impl.wr_zero_mask)
         {
             if(! impl.wr_frag)
             {
@@ -263,11 +266,9 @@ operator()(
             impl.wr_fb.clear();
             detail::write<flat_static_buffer_base>(
                 impl.wr_fb, fh_);
-            n = clamp(remain_, impl.wr_buf_size);
-            net::buffer_copy(net::buffer(
-                impl.wr_buf.get(), n), cb_);
-            detail::mask_inplace(net::buffer(
-                impl.wr_buf.get(), n), key_);
+            n = clamp(remain_, impl.wr_mask_size);
+            detail::mask_copy(net::buffer(
+                impl.wr_buf.get(), n), cb_, n, key_);
             remain_ -= n;
             impl.wr_cont = ! fin_;
             // write frame header and some payload
@@ -283,12 +284,10 @@ operator()(
                 goto upcall;
             while(remain_ > 0)
             {
-                cb_.consume(impl.wr_buf_size);
-                n = clamp(remain_, impl.wr_buf_size);
-                net::buffer_copy(net::buffer(
-                    impl.wr_buf.get(), n), cb_);
-                detail::mask_inplace(net::buffer(
-                    impl.wr_buf.get(), n), key_);
+                cb_.consume(impl.wr_mask_size);
+                n = clamp(remain_, impl.wr_mask_size);
+                detail::mask_copy(net::buffer(
+                    impl.wr_buf.get(), n), cb_, n, key_);
                 remain_ -= n;
                 // write more payload
                 BOOST_ASIO_CORO_YIELD
@@ -315,10 +314,8 @@ operator()(
                 fh_.key = impl.create_mask();
                 fh_.fin = fin_ ? remain_ == 0 : false;
                 detail::prepare_key(key_, fh_.key);
-                net::buffer_copy(net::buffer(
-                    impl.wr_buf.get(), n), cb_);
-                detail::mask_inplace(net::buffer(
-                    impl.wr_buf.get(), n), key_);
+                detail::mask_copy(net::buffer(
+                    impl.wr_buf.get(), n), cb_, n, key_);
                 impl.wr_fb.clear();
                 detail::write<flat_static_buffer_base>(
                     impl.wr_fb, fh_);
@@ -374,7 +371,7 @@ operator()(
                     BOOST_ASSERT(buffer_bytes(cb_) == 0);
                     goto upcall;
                 }
-                if(fh_.mask)
+                if(fh_.mask && ! impl.wr_zero_mask)
                 {
                     fh_.key = impl.create_mask();
                     detail::prepared_key key;
@@ -520,6 +517,7 @@ write_some(bool fin,
     fh.op = impl.wr_cont ?
         detail::opcode::cont : impl.wr_opcode;
     fh.mask = impl.role == role_type::client;
+    fh.key = 0;
     auto remain = buffer_bytes(buffers);
     if(impl.wr_compress)
     {
@@ -545,7 +543,7 @@ write_some(bool fin,
                 fh.fin = false;
                 break;
             }
-            if(fh.mask)
+            if(fh.mask && ! impl.wr_zero_mask)
             {
                 fh.key = this->impl_->create_mask();
                 detail::prepared_key key;
@@ -570,7 +568,7 @@ write_some(bool fin,
         if(fh.fin)
             impl.do_context_takeover_write(impl.role);
     }
-    else if(! fh.mask)
+    else if(! fh.mask || impl.wr_zero_mask)
     {
         if(! impl.wr_frag)
         {
@@ -631,13 +629,12 @@ write_some(bool fin,
             ConstBufferSequence> cb{buffers};
         {
             auto const n =
-                clamp(remain, impl.wr_buf_size);
+                clamp(remain, impl.wr_mask_size);
             auto const b =
                 net::buffer(impl.wr_buf.get(), n);
-            net::buffer_copy(b, cb);
+            detail::mask_copy(b, cb, n, key);
             cb.consume(n);
             remain -= n;
-            detail::mask_inplace(b, key);
             impl.wr_cont = ! fin;
             net::write(impl.stream(),
                 buffers_cat(fh_buf.data(), b), ec);
@@ -648,13 +645,12 @@ write_some(bool fin,
         while(remain > 0)
         {
             auto const n =
-                clamp(remain, impl.wr_buf_size);
+                clamp(remain, impl.wr_mask_size);
             auto const b =
                 net::buffer(impl.wr_buf.get(), n);
-            net::buffer_copy(b, cb);
+            detail::mask_copy(b, cb, n, key);
             cb.consume(n);
             remain -= n;
-            detail::mask_inplace(b, key);
             net::write(impl.stream(), b, ec);
             bytes_transferred += n;
             if(impl.check_stop_now(ec))
@@ -676,8 +672,7 @@ write_some(bool fin,
                 clamp(remain, impl.wr_buf_size);
             auto const b =
                 net::buffer(impl.wr_buf.get(), n);
-            net::buffer_copy(b, cb);
-            detail::mask_inplace(b, key);
+            detail::mask_copy(b, cb, n, key);
             fh.len = n;
             remain -= n;
             fh.fin = fin ? remain == 0 : false;
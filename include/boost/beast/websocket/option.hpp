@@ -57,6 +57,32 @@ struct permessage_deflate
     int memLevel = 4;
 };
 
+/** Zero mask extension options.
+
+    These settings control a private extension, negotiated with the
+    token `x-beast-zero-mask` in the Sec-WebSocket-Extensions field,
+    which lets a client send every frame with a mask key of zero.
+    The frames are still valid WebSocket frames, but neither end
+    generates keys or applies the mask to payload data.
+
+    The extension is used only when the client offers it and the
+    server accepts it, so both ends must enable it. Masking protects
+    intermediaries from attacker chosen bytes on the wire; enable this
+    only for links between trusted endpoints, such as services talking
+    over loopback or a private network, and never through proxies.
+
+    @note Objects of this type are used with
+          @ref beast::websocket::stream::set_option.
+*/
+struct zero_mask
+{
+    /// `true` to accept the extension in the server role
+    bool server_enable = false;
+
+    /// `true` to offer the extension in the client role
+    bool client_enable = false;
+};
+
 } // websocket
 } // beast
 } // boost
@@ -18,6 +18,7 @@
 #include <boost/beast/websocket/stream_fwd.hpp>
 #include <boost/beast/websocket/detail/hybi13.hpp>
 #include <boost/beast/websocket/detail/impl_base.hpp>
+#include <boost/beast/websocket/detail/impl_cache.hpp>
 #include <boost/beast/websocket/detail/pmd_extension.hpp>
 #include <boost/beast/websocket/detail/prng.hpp>
 #include <boost/beast/core/role.hpp>
@@ -58,6 +59,7 @@ enum class frame_type
 
 namespace detail {
 class frame_test;
+struct co_read_access;
 } // detail
 
 //--------------------------------------------------------------------
@@ -139,6 +141,8 @@ class stream
     using control_cb_type =
         std::function<void(frame_type, string_view)>;
 
+    friend struct detail::co_read_access;
+
     friend class close_test;
     friend class frame_test;
     friend class ping_test;
@@ -369,6 +373,17 @@ public:
     void
     get_option(permessage_deflate& o);
 
+    /** Set the zero mask extension options
+
+        The options take effect on the next handshake.
+    */
+    void
+    set_option(zero_mask const& o);
+
+    /// Get the zero mask extension options
+    void
+    get_option(zero_mask& o);
+
     /** Set the automatic fragmentation option.
 
         Determines if outgoing message payloads are broken up into
@@ -499,6 +514,51 @@ public:
     std::size_t
     read_message_max() const;
 
+    /** Set the limit on consecutive immediate read completions.
+
+        An asynchronous read which finds everything it needs in the
+        stream's read buffer completes without performing I/O. By
+        default its completion handler is then submitted to the
+        executor with `net::post`, which costs a round trip through
+        the scheduler for every such message. This option allows up
+        to `amount` of these reads in a row to invoke the completion
+        handler directly instead, before the initiating function
+        returns. The next one is posted as usual, so that a peer
+        sending many small messages cannot starve other work or grow
+        the call stack without bound. Reads which perform I/O, and
+        reads which fail, reset the count. A read which fails before
+        performing I/O, for example because the stream is closed,
+        is always posted.
+
+        When this option is set, the completion handler of
+        @ref async_read_some may be invoked from within the initiating
+        function. So may those of @ref async_read and
+        @ref async_read_into, which receive each frame through the
+        same algorithm, when the whole message is already in the
+        read buffer. The caller must therefore already
+        be running in a context where the handler may be invoked, such
+        as the strand used by the stream, and must not hold locks which
+        the handler acquires.
+
+        The default setting is zero, which never completes a read
+        immediately.
+
+        @par Example
+        Allowing up to 16 immediate completions in a row:
+        @code
+            ws.read_immediate_max(16);
+        @endcode
+
+        @param amount The maximum number of consecutive reads which
+        may complete immediately.
+    */
+    void
+    read_immediate_max(std::size_t amount);
+
+    /// Returns the limit on consecutive immediate read completions.
+    std::size_t
+    read_immediate_max() const;
+
     /** Set whether the PRNG is cryptographically secure
 
         This controls whether or not the source of pseudo-random
@@ -559,6 +619,39 @@ public:
     std::size_t
     write_buffer_bytes() const;
 
+    /** Set the mask buffer size option.
+
+        Sets the size of the buffer used to mask outgoing payload data
+        when the stream operates in the client role. Payload is copied
+        and masked into this buffer in one pass, then written to the
+        next layer, so a larger buffer means fewer writes for large
+        messages. Unlike @ref write_buffer_bytes, this setting does not
+        change the size of auto-fragmented frames.
+
+        The buffer used is the larger of this setting and
+        @ref write_buffer_bytes. The default setting is zero, which
+        uses @ref write_buffer_bytes alone. For streams operating in
+        the server mode, this setting has no effect.
+
+        The mask buffer size can only be changed when the stream is not
+        open. Undefined behavior results if the option is modified after
+        a successful WebSocket handshake.
+
+        @par Example
+        Setting the mask buffer size.
+        @code
+            ws.mask_buffer_bytes(64 * 1024);
+        @endcode
+
+        @param amount The size of the mask buffer in bytes.
+    */
+    void
+    mask_buffer_bytes(std::size_t amount);
+
+    /// Returns the size of the mask buffer option.
+    std::size_t
+    mask_buffer_bytes() const;
+
     /** Set the text message write option.
 
         This controls whether or not outgoing message opcodes
@@ -1919,10 +2012,11 @@ public:
             std::size_t bytes_written   // Number of bytes appended to buffer
         );
         @endcode
-        Regardless of whether the asynchronous operation completes
-        immediately or not, the handler will not be invoked from within
-        this function. Invocation of the handler will be performed in a
-        manner equivalent to using `net::post`.
+        Unless @ref read_immediate_max is set, the handler will not be
+        invoked from within this function, regardless of whether the
+        asynchronous operation completes immediately or not, and its
+        invocation will be performed in a manner equivalent to using
+        `net::post`.
     */
     template<
         class DynamicBuffer,
@@ -1936,6 +2030,194 @@ public:
             net::default_completion_token_t<
                 executor_type>{});
 
+    /** Read a complete message into a buffer sequence.
+
+        This function is used to read a complete message into a
+        caller-provided buffer sequence, such as a pre-sized vector
+        or a memory-mapped file region.
+
+        The call blocks until one of the following is true:
+
+        @li A complete message is received.
+
+        @li A close frame is received. In this case the error indicated by
+            the function will be @ref error::closed.
+
+        @li An error occurs.
+
+        The algorithm, known as a <em>composed operation</em>, is implemented
+        in terms of calls to the next layer's `read_some` and `write_some`
+        functions.
+
+        Message data is written to the buffers starting from the
+        beginning. When no data is waiting in the stream's read buffer,
+        frame payloads are read from the next layer directly into the
+        caller's memory without an intermediate copy. If the message
+        does not fit, the error @ref error::buffer_overflow is indicated
+        and the stream fails. A message which fills the buffers exactly
+        is received without error, even when it ends with an empty frame.
+        The functions @ref got_binary and @ref got_text may be used
+        to query the stream and determine the type of the last received message.
+
+        Until the call returns, the implementation will read incoming control
+        frames and handle them automatically as follows:
+
+        @li The @ref control_callback will be invoked for each control frame.
+
+        @li For each received ping frame, a pong frame will be
+            automatically sent.
+
+        @li If a close frame is received, the WebSocket closing handshake is
+            performed. In this case, when the function returns, the error
+            @ref error::closed will be indicated.
+
+        @return The number of message payload bytes written to the buffers.
+
+        @param buffers A buffer sequence to write the message into.
+
+        @throws system_error Thrown on failure.
+    */
+    template<class MutableBufferSequence>
+    std::size_t
+    read_into(MutableBufferSequence const& buffers);
+
+    /** Read a complete message into a buffer sequence.
+
+        This function is used to read a complete message into a
+        caller-provided buffer sequence, such as a pre-sized vector
+        or a memory-mapped file region.
+
+        The call blocks until one of the following is true:
+
+        @li A complete message is received.
+
+        @li A close frame is received. In this case the error indicated by
+            the function will be @ref error::closed.
+
+        @li An error occurs.
+
+        The algorithm, known as a <em>composed operation</em>, is implemented
+        in terms of calls to the next layer's `read_some` and `write_some`
+        functions.
+
+        Message data is written to the buffers starting from the
+        beginning. When no data is waiting in the stream's read buffer,
+        frame payloads are read from the next layer directly into the
+        caller's memory without an intermediate copy. If the message
+        does not fit, the error @ref error::buffer_overflow is indicated
+        and the stream fails. A message which fills the buffers exactly
+        is received without error, even when it ends with an empty frame.
+        The functions @ref got_binary and @ref got_text may be used
+        to query the stream and determine the type of the last received message.
+
+        Until the call returns, the implementation will read incoming control
+        frames and handle them automatically as follows:
+
+        @li The @ref control_callback will be invoked for each control frame.
+
+        @li For each received ping frame, a pong frame will be
+            automatically sent.
+
+        @li If a close frame is received, the WebSocket closing handshake is
+            performed. In this case, when the function returns, the error
+            @ref error::closed will be indicated.
+
+        @return The number of message payload bytes written to the buffers.
+
+        @param buffers A buffer sequence to write the message into.
+
+        @param ec Set to indicate what error occurred, if any.
+    */
+    template<class MutableBufferSequence>
+    std::size_t
+    read_into(
+        MutableBufferSequence const& buffers,
+        error_code& ec);
+
+    /** Read a complete message into a buffer sequence asynchronously.
+
+        This function is used to asynchronously read a complete message
+        into a caller-provided buffer sequence, such as a pre-sized vector
+        or a memory-mapped file region.
+
+        This call always returns immediately. The asynchronous operation
+        will continue until one of the following conditions is true:
+
+        @li A complete message is received.
+
+        @li A close frame is received. In this case the error indicated by
+            the function will be @ref error::closed.
+
+        @li An error occurs.
+
+        The algorithm, known as a <em>composed asynchronous operation</em>,
+        is implemented in terms of calls to the next layer's `async_read_some`
+        and `async_write_some` functions. The program must ensure that no other
+        calls to @ref read, @ref read_some, @ref async_read, or @ref async_read_some
+        are performed until this operation completes.
+
+        Message data is written to the buffers starting from the
+        beginning. When no data is waiting in the stream's read buffer,
+        frame payloads are read from the next layer directly into the
+        caller's memory without an intermediate copy. If the message
+        does not fit, the error @ref error::buffer_overflow is indicated
+        and the stream fails. A message which fills the buffers exactly
+        is received without error, even when it ends with an empty frame.
+        The functions @ref got_binary and @ref got_text may be used
+        to query the stream and determine the type of the last received message.
+
+        Until the operation completes, the implementation will read incoming
+        control frames and handle them automatically as follows:
+
+        @li The @ref control_callback will be invoked for each control frame.
+
+        @li For each received ping frame, a pong frame will be
+            automatically sent.
+
+        @li If a close frame is received, the WebSocket close procedure is
+            performed. In this case, when the function returns, the error
+            @ref error::closed will be indicated.
+
+        Pong frames and close frames sent by the implementation while the
+        read operation is outstanding do not prevent the application from
+        also writing message data, sending pings, sending pongs, or sending
+        close frames.
+
+        @param buffers A buffer sequence to write the message into.
+        The implementation will make copies of this object as needed, but
+        ownership of the underlying memory is not transferred. The
+        caller is responsible for ensuring that the memory locations
+        pointed to by the buffer sequence remain valid until the
+        completion handler is called.
+
+        @param handler The completion handler to invoke when the operation
+        completes. The implementation takes ownership of the handler by
+        performing a decay-copy. The equivalent function signature of
+        the handler must be:
+        @code
+        void handler(
+            error_code const& ec,       // Result of operation
+            std::size_t bytes_written   // Number of bytes written to the buffers
+        );
+        @endcode
+        Unless @ref read_immediate_max is set, the handler will not be
+        invoked from within this function, regardless of whether the
+        asynchronous operation completes immediately or not, and its
+        invocation will be performed in a manner equivalent to using
+        `net::post`.
+    */
+    template<
+        class MutableBufferSequence,
+        BOOST_BEAST_ASYNC_TPARAM2 ReadHandler =
+            net::default_completion_token_t<
+                executor_type>>
+    BOOST_BEAST_ASYNC_RESULT2(ReadHandler)
+    async_read_into(
+        MutableBufferSequence const& buffers,
+        ReadHandler&& handler =
+            net::default_completion_token_t<
+                executor_type>{});
+
     //--------------------------------------------------------------------------
 
     /** Read some message data.
@@ -2098,10 +2380,11 @@ public:
             std::size_t bytes_written   // Number of bytes appended to buffer
         );
         @endcode
-        Regardless of whether the asynchronous operation completes
-        immediately or not, the handler will not be invoked from within
-        this function. Invocation of the handler will be performed in a
-        manner equivalent to using `net::post`.
+        Unless @ref read_immediate_max is set, the handler will not be
+        invoked from within this function, regardless of whether the
+        asynchronous operation completes immediately or not, and its
+        invocation will be performed in a manner equivalent to using
+        `net::post`.
     */
     template<
         class DynamicBuffer,
@@ -2273,10 +2556,11 @@ public:
             std::size_t bytes_written   // Number of bytes written to the buffers
         );
         @endcode
-        Regardless of whether the asynchronous operation completes
-        immediately or not, the handler will not be invoked from within
-        this function. Invocation of the handler will be performed in a
-        manner equivalent to using `net::post`.
+        Unless @ref read_immediate_max is set, the handler will not be
+        invoked from within this function, regardless of whether the
+        asynchronous operation completes immediately or not, and its
+        invocation will be performed in a manner equivalent to using
+        `net::post`.
     */
     template<
         class MutableBufferSequence,
@@ -2545,6 +2829,7 @@ private:
     template<class>         class idle_ping_op;
     template<class, class>  class read_some_op;
     template<class, class>  class read_op;
+    template<class, class>  class read_into_op;
     template<class>         class response_op;
     template<class, class>  class write_some_op;
     template<class, class>  class write_op;
@@ -2556,6 +2841,7 @@ private:
     struct run_idle_ping_op;
     struct run_read_some_op;
     struct run_read_op;
+    struct run_read_into_op;
     struct run_response_op;
     struct run_write_some_op;
     struct run_write_op;
@@ -2632,6 +2918,32 @@ seed_prng(std::seed_seq& ss)
     detail::prng_seed(&ss);
 }
 
+/** Set the size of the per-thread cache of stream memory
+
+    Each websocket @ref stream allocates its implementation object on
+    construction and frees it when the last reference goes away. To keep
+    servers which accept and drop many short lived connections away from
+    the global heap, freed implementation memory is kept in a cache
+    local to the freeing thread and handed out again to the next stream
+    of the same type constructed on that thread.
+
+    This function sets the maximum number of bytes held by the cache of
+    each thread. Memory freed while the cache is full is returned to the
+    heap. A value of zero disables the cache, which is the default.
+
+    Cached memory is returned to the heap when its thread exits. Only
+    the memory is reused: each stream is constructed afresh, since its
+    next layer is bound to the executor and arguments it was given.
+
+    @param bytes The maximum number of bytes cached per thread.
+*/
+inline
+void
+stream_cache_max(std::size_t bytes) noexcept
+{
+    detail::impl_cache_max(bytes);
+}
+
 } // websocket
 } // beast
 } // boost
@@ -0,0 +1,312 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header files are self-contained.
+#include <boost/beast/_experimental/http/awaitable.hpp>
+#include <boost/beast/_experimental/websocket/awaitable.hpp>
+
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/_experimental/test/stream.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/core/ostream.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/asio/io_context.hpp>
+#include <cstring>
+
+#if BOOST_ASIO_HAS_CO_AWAIT
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#endif
+
+namespace boost {
+namespace beast {
+
+class awaitable_test
+    : public unit_test::suite
+{
+public:
+#if BOOST_ASIO_HAS_CO_AWAIT
+    static constexpr char const* req_text =
+        "GET / HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Content-Length: 5\r\n"
+        "\r\n"
+        "Hello";
+
+    void
+    testReadBuffered()
+    {
+        // A message already in the buffer is parsed
+        // without suspending and without reading.
+        net::io_context ioc;
+        test::stream ts(ioc);
+        flat_buffer b;
+        ostream(b) << req_text << req_text;
+        bool done = false;
+        net::co_spawn(ioc,
+            [&]() -> net::awaitable<void>
+            {
+                http::request<http::string_body> req;
+                error_code ec;
+                co_await http::co_read(ts, b, req, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(req.body() == "Hello");
+                http::request<http::string_body> req2;
+                co_await http::co_read(ts, b, req2, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(req2[http::field::host] == "localhost");
+                BEAST_EXPECT(b.size() == 0);
+                done = true;
+            }, net::detached);
+        ioc.run_one();
+        BEAST_EXPECT(done);
+    }
+
+    void
+    testRead()
+    {
+        net::io_context ioc;
+        test::stream ts(ioc);
+        ts.read_size(3);
+        ts.append(req_text);
+        ts.close_remote();
+        bool done = false;
+        net::co_spawn(ioc,
+            [&]() -> net::awaitable<void>
+            {
+                flat_buffer b;
+                http::request_parser<http::string_body> p;
+                error_code ec;
+                auto const n = co_await http::co_read(ts, b, p, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(n == std::strlen(req_text));
+                BEAST_EXPECT(p.get().body() == "Hello");
+
+                // The next read sees the end of the stream
+                http::request<http::string_body> req;
+                co_await http::co_read(ts, b, req, ec);
+                BEAST_EXPECTS(ec == http::error::end_of_stream,
+                    ec.message());
+                try
+                {
+                    co_await http::co_read(ts, b, req);
+                    fail("", __FILE__, __LINE__);
+                }
+                catch(system_error const& e)
+                {
+                    BEAST_EXPECT(e.code() == http::error::end_of_stream);
+                }
+                done = true;
+            }, net::detached);
+        ioc.run();
+        BEAST_EXPECT(done);
+    }
+
+    void
+    testReadEof()
+    {
+        // A message delimited by the end of the stream
+        net::io_context ioc;
+        test::stream ts(ioc);
+        ts.append(
+            "HTTP/1.1 200 OK\r\n"
+            "\r\n"
+            "Hello");
+        ts.close_remote();
+        bool done = false;
+        net::co_spawn(ioc,
+            [&]() -> net::awaitable<void>
+            {
+                flat_buffer b;
+                http::response<http::string_body> res;
+                co_await http::co_read(ts, b, res);
+                BEAST_EXPECT(res.body() == "Hello");
+                done = true;
+            }, net::detached);
+        ioc.run();
+        BEAST_EXPECT(done);
+    }
+
+    void
+    testWrite()
+    {
+        net::io_context ioc;
+        test::stream ts(ioc), tr(ioc);
+        ts.connect(tr);
+        ts.write_size(7);
+        bool done = false;
+        net::co_spawn(ioc,
+            [&]() -> net::awaitable<void>
+            {
+                http::request<http::string_body> req;
+                req.method(http::verb::get);
+                req.target("/");
+                req.set(http::field::host, "localhost");
+                req.body() = "Hello";
+                req.prepare_payload();
+                auto const n = co_await http::co_write(ts, req);
+                BEAST_EXPECT(n == std::strlen(req_text));
+
+                http::response<http::string_body> const res{
+                    http::status::ok, 11};
+                error_code ec;
+                co_await http::co_write(ts, res, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                done = true;
+            }, net::detached);
+        ioc.run();
+        BEAST_EXPECT(done);
+        BEAST_EXPECT(tr.str() ==
+            std::string(req_text) + "HTTP/1.1 200 OK\r\n\r\n");
+
+        // write errors are reported
+        ts.close();
+        done = false;
+        net::co_spawn(ioc,
+            [&]() -> net::awaitable<void>
+            {
+                http::response<http::string_body> res{
+                    http::status::ok, 11};
+                error_code ec;
+                co_await http::co_write(ts, res, ec);
+                BEAST_EXPECT(ec);
+                done = true;
+            }, net::detached);
+        ioc.restart();
+        ioc.run();
+        BEAST_EXPECT(done);
+    }
+
+    void
+    testWebsocket()
+    {
+        net::io_context ioc;
+        websocket::stream<test::stream> ws1(ioc), ws2(ioc);
+        ws1.next_layer().connect(ws2.next_layer());
+        bool done = false;
+        net::co_spawn(ioc,
+            [&]() -> net::awaitable<void>
+            {
+                co_await ws2.async_accept(net::use_awaitable);
+                flat_buffer b;
+                co_await websocket::co_read(ws2, b);
+                co_await websocket::co_write(ws2, b.data());
+            }, net::detached);
+        net::co_spawn(ioc,
+            [&]() -> net::awaitable<void>
+            {
+                co_await ws1.async_handshake(
+                    "localhost", "/", net::use_awaitable);
+                co_await websocket::co_write(
+                    ws1, net::buffer("Hello", 5));
+                flat_buffer b;
+                error_code ec;
+                auto const n = co_await websocket::co_read(ws1, b, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(n == 5);
+                BEAST_EXPECT(buffers_to_string(b.data()) == "Hello");
+                done = true;
+            }, net::detached);
+        ioc.run();
+        BEAST_EXPECT(done);
+    }
+
+    void
+    testWebsocketBuffered()
+    {
+        net::io_context ioc;
+        websocket::stream<test::stream> ws1(ioc), ws2(ioc);
+        ws1.next_layer().connect(ws2.next_layer());
+        net::co_spawn(ioc,
+            [&]() -> net::awaitable<void>
+            {
+                co_await ws2.async_accept(net::use_awaitable);
+            }, net::detached);
+        net::co_spawn(ioc,
+            [&]() -> net::awaitable<void>
+            {
+                co_await ws1.async_handshake(
+                    "localhost", "/", net::use_awaitable);
+                co_await websocket::co_write(
+                    ws1, net::buffer("Hello", 5));
+                ws1.binary(true);
+                co_await websocket::co_write(
+                    ws1, net::buffer("World", 5));
+                ws1.text(true);
+                co_await ws1.async_write_some(false,
+                    net::buffer("frag", 4), net::use_awaitable);
+                co_await ws1.async_write_some(true,
+                    net::buffer("mented", 6), net::use_awaitable);
+            }, net::detached);
+        ioc.run();
+        ioc.restart();
+
+        // After the first read fills the read buffer, a message
+        // held in full is copied out without suspending, and a
+        // fragmented one is left to the read operation.
+        bool first = false;
+        bool buffered = false;
+        bool done = false;
+        net::co_spawn(ioc,
+            [&]() -> net::awaitable<void>
+            {
+                flat_buffer b;
+                error_code ec;
+                auto n = co_await websocket::co_read(ws2, b, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(ws2.got_text());
+                BEAST_EXPECT(buffers_to_string(b.data()) == "Hello");
+                b.consume(n);
+                first = true;
+                n = co_await websocket::co_read(ws2, b, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(n == 5);
+                BEAST_EXPECT(ws2.got_binary());
+                BEAST_EXPECT(buffers_to_string(b.data()) == "World");
+                b.consume(n);
+                buffered = true;
+                n = co_await websocket::co_read(ws2, b, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(n == 10);
+                BEAST_EXPECT(ws2.got_text());
+                BEAST_EXPECT(
+                    buffers_to_string(b.data()) == "fragmented");
+                done = true;
+            }, net::detached);
+        while(! first && ioc.run_one())
+        {
+        }
+        BEAST_EXPECT(buffered);
+        BEAST_EXPECT(! done);
+        ioc.run();
+        BEAST_EXPECT(done);
+    }
+#endif
+
+    void
+    run() override
+    {
+#if BOOST_ASIO_HAS_CO_AWAIT
+        testReadBuffered();
+        testRead();
+        testReadEof();
+        testWrite();
+        testWebsocket();
+        testWebsocketBuffered();
+#else
+        pass();
+#endif
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,core,awaitable);
+
+} // beast
+} // boost
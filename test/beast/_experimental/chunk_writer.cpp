@@ -0,0 +1,295 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/_experimental/http/chunk_writer.hpp>
+
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/_experimental/test/stream.hpp>
+#include <boost/beast/core/bind_handler.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/multi_buffer.hpp>
+#include <boost/beast/http/empty_body.hpp>
+#include <boost/beast/http/read.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/beast/http/write.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+class chunk_writer_test
+    : public unit_test::suite
+{
+public:
+    static
+    net::const_buffer
+    cbuf(string_view s)
+    {
+        return {s.data(), s.size()};
+    }
+
+    void
+    testAppend()
+    {
+        net::io_context ioc;
+        test::stream ts{ioc};
+        test::stream tr{ioc};
+        ts.connect(tr);
+
+        chunk_writer<test::stream> cw{ts};
+        BEAST_EXPECT(cw.pending() == 0);
+        cw.append(cbuf("Hello"));
+        cw.append(cbuf(""));
+        std::array<net::const_buffer, 2> const bs{{
+            cbuf("0123456789"), cbuf("abcdef") }};
+        cw.append(bs);
+        BEAST_EXPECT(cw.pending() == 10 + 22);
+        BEAST_EXPECT(tr.str().empty());
+        auto const n = cw.flush();
+        BEAST_EXPECT(n == 32);
+        BEAST_EXPECT(cw.pending() == 0);
+        BEAST_EXPECT(ts.nwrite() == 1);
+        BEAST_EXPECT(tr.str() ==
+            "5\r\nHello\r\n"
+            "10\r\n0123456789abcdef\r\n");
+        tr.clear();
+
+        cw.append_last();
+        cw.flush();
+        BEAST_EXPECT(tr.str() == "0\r\n\r\n");
+        BEAST_EXPECT(cw.flush() == 0);
+    }
+
+    void
+    testMultiBuffer()
+    {
+        net::io_context ioc;
+        test::stream ts{ioc};
+        test::stream tr{ioc};
+        ts.connect(tr);
+
+        {
+            chunk_writer<test::stream, multi_buffer> cw{ts};
+            std::string const s(100, '*');
+            cw.append(net::buffer(s));
+            cw.append_last();
+            cw.flush();
+            BEAST_EXPECT(tr.str() ==
+                "64\r\n" + s + "\r\n0\r\n\r\n");
+        }
+
+        // Buffer arguments are forwarded
+        {
+            chunk_writer<test::stream, flat_buffer> cw{ts, 16};
+            cw.append(cbuf("Hello"));
+            try
+            {
+                cw.append(cbuf("0123456789"));
+                fail("", __FILE__, __LINE__);
+            }
+            catch(std::length_error const&)
+            {
+                pass();
+            }
+            BEAST_EXPECT(cw.pending() == 10);
+        }
+    }
+
+    void
+    testAsync()
+    {
+        net::io_context ioc;
+        test::stream ts{ioc};
+        test::stream tr{ioc};
+        ts.connect(tr);
+
+        // Send a chunked response, appending
+        // while the first flush is in progress.
+        response<empty_body> res{status::ok, 11};
+        res.chunked(true);
+        response_serializer<empty_body> sr{res};
+        write_header(ts, sr);
+
+        chunk_writer<test::stream> cw{ts};
+        cw.append(cbuf("one,"));
+        std::size_t n = 0;
+        int count = 0;
+        cw.async_flush(
+            [&](error_code ec, std::size_t bytes_written)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                n = bytes_written;
+                ++count;
+            });
+        BEAST_EXPECT(cw.is_flushing());
+        cw.append(cbuf("two,"));
+        cw.append(cbuf("three"));
+        cw.append_last();
+        ioc.run();
+        BEAST_EXPECT(count == 1);
+        BEAST_EXPECT(! cw.is_flushing());
+        BEAST_EXPECT(cw.pending() == 0);
+        BEAST_EXPECT(n == 9 + 9 + 10 + 5);
+
+        flat_buffer b;
+        response<string_body> m;
+        read(tr, b, m);
+        BEAST_EXPECT(m.body() == "one,two,three");
+
+        // Nothing to write
+        ioc.restart();
+        count = 0;
+        cw.async_flush(
+            [&](error_code ec, std::size_t bytes_written)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(bytes_written == 0);
+                ++count;
+            });
+        BEAST_EXPECT(count == 0);
+        ioc.run();
+        BEAST_EXPECT(count == 1);
+    }
+
+    void
+    testFailure()
+    {
+        net::io_context ioc;
+        test::fail_count fc{0};
+        test::stream ts{ioc, fc};
+        test::stream tr{ioc};
+        ts.connect(tr);
+
+        chunk_writer<test::stream> cw{ts};
+        cw.append(cbuf("Hello"));
+        error_code ec;
+        BEAST_EXPECT(cw.flush(ec) == 0);
+        BEAST_EXPECTS(ec == test::error::test_failure, ec.message());
+        BEAST_EXPECT(cw.pending() == 10);
+
+        int count = 0;
+        cw.async_flush(
+            [&](error_code ec, std::size_t)
+            {
+                BEAST_EXPECTS(ec == test::error::test_failure,
+                    ec.message());
+                ++count;
+            });
+        ioc.run();
+        BEAST_EXPECT(count == 1);
+        BEAST_EXPECT(! cw.is_flushing());
+        BEAST_EXPECT(cw.pending() == 10);
+    }
+
+    // Fails one write, then passes writes to the stream
+    class fail_once_stream
+    {
+        test::stream& s_;
+        int n_;
+
+    public:
+        using executor_type = test::stream::executor_type;
+
+        fail_once_stream(test::stream& s, int n)
+            : s_(s)
+            , n_(n)
+        {
+        }
+
+        executor_type
+        get_executor() noexcept
+        {
+            return s_.get_executor();
+        }
+
+        template<class ConstBufferSequence, class WriteHandler>
+        void
+        async_write_some(
+            ConstBufferSequence const& buffers,
+            WriteHandler&& handler)
+        {
+            if(n_-- == 0)
+            {
+                net::post(get_executor(), beast::bind_front_handler(
+                    std::forward<WriteHandler>(handler),
+                    error_code(test::error::test_failure),
+                    std::size_t{0}));
+                return;
+            }
+            s_.async_write_some(buffers,
+                std::forward<WriteHandler>(handler));
+        }
+    };
+
+    void
+    testPartialFailure()
+    {
+        // A flush fails partway through a chunk while more are
+        // appended; the next flush sends everything in order.
+        net::io_context ioc;
+        test::stream ts{ioc};
+        test::stream tr{ioc};
+        ts.connect(tr);
+        ts.write_size(4);
+        fail_once_stream fs{ts, 1};
+
+        chunk_writer<fail_once_stream> cw{fs};
+        cw.append(cbuf("Hello"));
+        int count = 0;
+        cw.async_flush(
+            [&](error_code ec, std::size_t bytes_written)
+            {
+                BEAST_EXPECTS(ec == test::error::test_failure,
+                    ec.message());
+                BEAST_EXPECT(bytes_written == 4);
+                ++count;
+            });
+        cw.append(cbuf("World"));
+        ioc.run();
+        BEAST_EXPECT(count == 1);
+        BEAST_EXPECT(cw.pending() == 6 + 10);
+
+        ioc.restart();
+        cw.append_last();
+        cw.async_flush(
+            [&](error_code ec, std::size_t bytes_written)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(bytes_written == 6 + 10 + 5);
+                ++count;
+            });
+        ioc.run();
+        BEAST_EXPECT(count == 2);
+        BEAST_EXPECT(cw.pending() == 0);
+        BEAST_EXPECT(tr.str() ==
+            "5\r\nHello\r\n5\r\nWorld\r\n0\r\n\r\n");
+    }
+
+    void
+    run() override
+    {
+        testAppend();
+        testMultiBuffer();
+        testAsync();
+        testFailure();
+        testPartialFailure();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,http,chunk_writer);
+
+} // http
+} // beast
+} // boost
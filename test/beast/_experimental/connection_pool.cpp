@@ -0,0 +1,354 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/_experimental/http/connection_pool.hpp>
+
+#include <boost/beast/_experimental/test/stream.hpp>
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/asio/io_context.hpp>
+#include <chrono>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+class connection_pool_test
+    : public unit_test::suite
+{
+public:
+    using pool_type = connection_pool<test::stream>;
+    using lease = pool_type::lease;
+
+    static
+    pool_type::factory_type
+    make_factory(net::io_context& ioc, std::size_t& created)
+    {
+        return
+            [&ioc, &created](pool_key const&)
+            {
+                ++created;
+                return test::stream(ioc);
+            };
+    }
+
+    void
+    testReuse()
+    {
+        net::io_context ioc;
+        std::size_t created = 0;
+        pool_type pool(ioc.get_executor(),
+            make_factory(ioc, created));
+        pool_key const key{"localhost", "80"};
+
+        test::stream* first = nullptr;
+        bool invoked = false;
+        pool.async_acquire(key,
+            [&](error_code ec, lease l)
+            {
+                invoked = true;
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(l);
+                BEAST_EXPECT(l.is_new());
+                first = &l.stream();
+                l.release(true);
+            });
+        BEAST_EXPECT(! invoked);
+        ioc.poll();
+        ioc.restart();
+        BEAST_EXPECT(invoked);
+        BEAST_EXPECT(pool.size(key) == 1);
+        BEAST_EXPECT(pool.idle(key) == 1);
+
+        invoked = false;
+        pool.async_acquire(key,
+            [&](error_code ec, lease l)
+            {
+                invoked = true;
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(! l.is_new());
+                BEAST_EXPECT(l.use_count() == 2);
+                BEAST_EXPECT(&l.stream() == first);
+                // destroyed without release, not kept alive
+            });
+        ioc.poll();
+        ioc.restart();
+        BEAST_EXPECT(invoked);
+        BEAST_EXPECT(created == 1);
+        BEAST_EXPECT(pool.size(key) == 0);
+        BEAST_EXPECT(pool.idle(key) == 0);
+
+        // different origins do not share connections
+        pool_key const key2{"localhost", "8080"};
+        std::vector<lease> v;
+        pool.async_acquire(key,
+            [&](error_code, lease l)
+            {
+                v.emplace_back(std::move(l));
+            });
+        pool.async_acquire(key2,
+            [&](error_code, lease l)
+            {
+                v.emplace_back(std::move(l));
+            });
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(v.size() == 2);
+        BEAST_EXPECT(created == 3);
+        BEAST_EXPECT(pool.size(key) == 1);
+        BEAST_EXPECT(pool.size(key2) == 1);
+        for(auto& l : v)
+            l.release(true);
+        BEAST_EXPECT(pool.idle(key) == 1);
+        BEAST_EXPECT(pool.idle(key2) == 1);
+    }
+
+    void
+    testLimits()
+    {
+        net::io_context ioc;
+        std::size_t created = 0;
+        pool_type::options opt;
+        opt.max_per_host = 1;
+        opt.max_requests = 2;
+        pool_type pool(ioc.get_executor(),
+            make_factory(ioc, created), opt);
+        pool_key const key{"localhost", "80"};
+
+        lease held;
+        int order = 0;
+        int first = 0;
+        int second = 0;
+        pool.async_acquire(key,
+            [&](error_code ec, lease l)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                first = ++order;
+                held = std::move(l);
+            });
+        pool.async_acquire(key,
+            [&](error_code ec, lease l)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                second = ++order;
+                BEAST_EXPECT(! l.is_new());
+                // max_requests reached, not kept
+                l.release(true);
+            });
+        ioc.poll();
+        ioc.restart();
+        BEAST_EXPECT(first == 1);
+        BEAST_EXPECT(second == 0);
+        BEAST_EXPECT(pool.size(key) == 1);
+
+        // releasing wakes the waiter
+        held.release(true);
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(second == 2);
+        BEAST_EXPECT(created == 1);
+        BEAST_EXPECT(pool.size(key) == 0);
+    }
+
+    void
+    testFairness()
+    {
+        net::io_context ioc;
+        std::size_t created = 0;
+        pool_type::options opt;
+        opt.max_per_host = 1;
+        pool_type pool(ioc.get_executor(),
+            make_factory(ioc, created), opt);
+        pool_key const key{"localhost", "80"};
+
+        lease held;
+        pool.async_acquire(key,
+            [&](error_code ec, lease l)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                held = std::move(l);
+            });
+        ioc.poll();
+        ioc.restart();
+        BEAST_EXPECT(held);
+
+        std::vector<int> order;
+        auto const acquire =
+            [&](int id, bool keep_alive)
+            {
+                pool.async_acquire(key,
+                    [&order, id, keep_alive](error_code ec, lease l)
+                    {
+                        BEAST_EXPECTS(! ec, ec.message());
+                        BEAST_EXPECT(l);
+                        order.push_back(id);
+                        l.release(keep_alive);
+                    });
+            };
+        acquire(1, true);
+        acquire(2, false);
+        acquire(3, true);
+
+        // Neither an acquire made right after a release,
+        // nor one made after the waiters were woken, may
+        // take the connection ahead of them.
+        held.release(true);
+        acquire(4, true);
+        ioc.poll_one();
+        acquire(5, true);
+        ioc.poll();
+        ioc.restart();
+        BEAST_EXPECT((order == std::vector<int>{1, 2, 3, 4, 5}));
+
+        // The second waiter closed its connection, so
+        // the third one was given a new stream.
+        BEAST_EXPECT(created == 2);
+        BEAST_EXPECT(pool.size(key) == 1);
+        BEAST_EXPECT(pool.idle(key) == 1);
+    }
+
+    void
+    testIdleTimeout()
+    {
+        net::io_context ioc;
+        std::size_t created = 0;
+        pool_type::options opt;
+        opt.idle_timeout = std::chrono::milliseconds(10);
+        pool_type pool(ioc.get_executor(),
+            make_factory(ioc, created), opt);
+        pool_key const key{"localhost", "80"};
+
+        pool.async_acquire(key,
+            [&](error_code, lease l)
+            {
+                l.release(true);
+            });
+        ioc.run_one();
+        BEAST_EXPECT(pool.idle(key) == 1);
+
+        // the idle timer closes the connection
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(pool.size(key) == 0);
+        BEAST_EXPECT(pool.idle(key) == 0);
+    }
+
+    void
+    testClose()
+    {
+        net::io_context ioc;
+        std::size_t created = 0;
+        pool_type::options opt;
+        opt.max_per_host = 1;
+        pool_type pool(ioc.get_executor(),
+            make_factory(ioc, created), opt);
+        pool_key const key{"localhost", "80"};
+
+        lease held;
+        error_code ec2;
+        pool.async_acquire(key,
+            [&](error_code, lease l)
+            {
+                held = std::move(l);
+            });
+        pool.async_acquire(key,
+            [&](error_code ec, lease l)
+            {
+                ec2 = ec;
+                BEAST_EXPECT(! l);
+            });
+        ioc.poll();
+        ioc.restart();
+        BEAST_EXPECT(held);
+        pool.close();
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(ec2 == net::error::operation_aborted);
+
+        // leases outstanding at close are not kept
+        held.release(true);
+        BEAST_EXPECT(pool.size(key) == 0);
+
+        bool invoked = false;
+        pool.async_acquire(key,
+            [&](error_code ec, lease)
+            {
+                invoked = true;
+                BEAST_EXPECT(ec == net::error::operation_aborted);
+            });
+        ioc.run();
+        BEAST_EXPECT(invoked);
+    }
+
+    void
+    testDestroy()
+    {
+        // leases may outlive the pool
+        net::io_context ioc;
+        std::size_t created = 0;
+        lease held;
+        {
+            pool_type pool(ioc.get_executor(),
+                make_factory(ioc, created));
+            pool.async_acquire({"localhost", "80"},
+                [&](error_code, lease l)
+                {
+                    held = std::move(l);
+                });
+            ioc.run();
+            ioc.restart();
+        }
+        BEAST_EXPECT(held);
+        held.release(true);
+        BEAST_EXPECT(! held);
+    }
+
+    void
+    testSelfMove()
+    {
+        net::io_context ioc;
+        std::size_t created = 0;
+        pool_type pool(ioc.get_executor(),
+            make_factory(ioc, created));
+        pool_key const key{"localhost", "80"};
+        lease held;
+        pool.async_acquire(key,
+            [&](error_code, lease l)
+            {
+                held = std::move(l);
+            });
+        ioc.run();
+        BEAST_EXPECT(held);
+        auto& same = held;
+        held = std::move(same);
+        BEAST_EXPECT(held);
+        BEAST_EXPECT(pool.size(key) == 1);
+        held.release(true);
+        BEAST_EXPECT(pool.idle(key) == 1);
+    }
+
+    void
+    run() override
+    {
+        testReuse();
+        testLimits();
+        testFairness();
+        testIdleTimeout();
+        testClose();
+        testDestroy();
+        testSelfMove();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,http,connection_pool);
+
+} // http
+} // beast
+} // boost
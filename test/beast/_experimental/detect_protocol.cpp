@@ -0,0 +1,338 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/_experimental/core/detect_protocol.hpp>
+
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/_experimental/test/stream.hpp>
+#include <boost/beast/_experimental/test/handler.hpp>
+#include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/string.hpp>
+#include <array>
+#include <string>
+
+namespace boost {
+namespace beast {
+
+class detect_protocol_test : public unit_test::suite
+{
+public:
+    static
+    string_view
+    client_hello()
+    {
+        return {"\x16\x03\x01\x02\x00\x01\x00\x01\xfc\x03\x03", 11};
+    }
+
+    static
+    string_view
+    proxy_v2()
+    {
+        return {"\r\n\r\n\0\r\nQUIT\n\x21\x11\x00\x0c", 16};
+    }
+
+    static
+    string_view
+    upgrade()
+    {
+        return
+            "GET /chat HTTP/1.1\r\n"
+            "Host: server.example.com\r\n"
+            "Upgrade: h2c, WebSocket\r\n"
+            "Connection: upgrade\r\n"
+            "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+            "Sec-WebSocket-Version: 13\r\n"
+            "\r\n";
+    }
+
+    // Every proper prefix is indeterminate, and
+    // the whole string is classified as `what`.
+    void
+    grow(string_view s, detected_protocol what)
+    {
+        for(std::size_t i = 0; i < s.size(); ++i)
+            BEAST_EXPECTS(classify_protocol(net::const_buffer(
+                s.data(), i)) == detected_protocol::indeterminate,
+                    std::to_string(i));
+        BEAST_EXPECT(classify_protocol(net::const_buffer(
+            s.data(), s.size())) == what);
+    }
+
+    void
+    check(string_view s, detected_protocol what)
+    {
+        BEAST_EXPECT(classify_protocol(net::const_buffer(
+            s.data(), s.size())) == what);
+    }
+
+    void
+    testClassify()
+    {
+        using p = detected_protocol;
+
+        grow(client_hello().substr(0, 9), p::tls);
+        grow(proxy_v2().substr(0, 12), p::proxy_v2);
+        grow("PROXY ", p::proxy_v1);
+        grow("PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n", p::http2);
+        grow("GET / HTTP/1.1\r\nHost: x\r\n\r\n", p::http);
+        grow(upgrade().substr(0, 71), p::websocket);
+        check(upgrade(), p::websocket);
+
+        check(client_hello(), p::tls);
+        check(proxy_v2(), p::proxy_v2);
+        check("PROXY TCP4 192.0.2.1 192.0.2.2 56324 443\r\n", p::proxy_v1);
+        check("POST /upload HTTP/1.0\r\n\r\nbody", p::http);
+        check("OPTIONS * HTTP/1.1\r\n\r\n", p::http);
+        check("PUT / HTTP/1.1\r\n\r\n", p::http);
+        check("PATCH / HTTP/1.1\r\n\r\n", p::http);
+        check(
+            "GET / HTTP/1.1\r\n"
+            "Upgrade: h2c\r\n"
+            "X-Upgrade: websocket\r\n"
+            "\r\n", p::http);
+        check(
+            "GET / HTTP/1.1\r\n"
+            "upgrade:websocket\r\n"
+            "\r\n", p::websocket);
+
+        check({"\x16\x03\x01\x02\x00\x02", 6}, p::unknown);
+        check({"\r\n\r\n\0\r\nQUIX", 12}, p::unknown);
+        check("\r\n", p::indeterminate);
+        check("\x01", p::unknown);
+        check("SSH-2.0-OpenSSH_9.6\r\n", p::unknown);
+        check(" GET / HTTP/1.1\r\n", p::unknown);
+        check("G(T / HTTP/1.1\r\n", p::unknown);
+        check("GET / HTTP/2.0\r\n\r\n", p::unknown);
+        check("GET /\r\n\r\n", p::unknown);
+        check("PRI * HTTP/1.1\r\n\r\n", p::http);
+        check("PROXY", p::indeterminate);
+        check("PROX", p::indeterminate);
+        check("", p::indeterminate);
+    }
+
+    void
+    testBuffers()
+    {
+        // A header split across buffers is classified
+        // the same as the contiguous bytes.
+        auto const s = upgrade();
+        for(std::size_t i = 0; i <= s.size(); ++i)
+        {
+            std::array<net::const_buffer, 3> const bs{{
+                net::const_buffer(s.data(), i),
+                net::const_buffer(s.data() + i, s.size() - i),
+                net::const_buffer(s.data(), 0)}};
+            BEAST_EXPECTS(classify_protocol(bs) ==
+                detected_protocol::websocket, std::to_string(i));
+        }
+        std::array<net::const_buffer, 0> const none{};
+        BEAST_EXPECT(classify_protocol(none) ==
+            detected_protocol::indeterminate);
+    }
+
+    void
+    testLimit()
+    {
+        using p = detected_protocol;
+
+        // A large request header is http once the limit is reached
+        std::string s = "GET / HTTP/1.1\r\nCookie: ";
+        s.append(detect_protocol_limit, 'x');
+        check(s, p::http);
+        BEAST_EXPECT(classify_protocol(
+            net::buffer(s), s.size() + 1) == p::indeterminate);
+        BEAST_EXPECT(classify_protocol(
+            net::buffer(s.data(), 10), 10) == p::http);
+
+        // A long method is not a request
+        std::string m(detect_protocol_limit, 'A');
+        check(m, p::unknown);
+        BEAST_EXPECT(classify_protocol(
+            net::buffer(m), m.size() + 1) == p::indeterminate);
+
+        // A truncated signature is not recognized
+        BEAST_EXPECT(classify_protocol(
+            net::buffer("PROXY ", 6), 3) == p::unknown);
+        BEAST_EXPECT(classify_protocol(
+            net::const_buffer(client_hello().data(), 9), 4) == p::unknown);
+    }
+
+    void
+    testRead()
+    {
+        net::io_context ioc;
+
+        // The request is received with one read, and left in the buffer
+        {
+            error_code ec;
+            flat_buffer b;
+            test::stream s1(ioc);
+            s1.append(upgrade());
+            auto const result = detect_protocol(s1, b, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(result == detected_protocol::websocket);
+            BEAST_EXPECT(s1.nread() == 1);
+            BEAST_EXPECT(buffers_to_string(b.data()) == upgrade());
+        }
+
+        // Bytes already in the buffer are examined first
+        {
+            error_code ec;
+            flat_buffer b;
+            test::stream s1(ioc);
+            auto const n = net::buffer_copy(b.prepare(16),
+                net::const_buffer(proxy_v2().data(), proxy_v2().size()));
+            b.commit(n);
+            auto const result = detect_protocol(s1, b, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(result == detected_protocol::proxy_v2);
+            BEAST_EXPECT(s1.nread() == 0);
+        }
+
+        // Several reads
+        {
+            error_code ec;
+            flat_buffer b;
+            test::stream s1(ioc);
+            s1.read_size(3);
+            s1.append("GET / HTTP/1.1\r\n\r\n");
+            auto const result = detect_protocol(s1, b, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(result == detected_protocol::http);
+            BEAST_EXPECT(s1.nread() == 6);
+        }
+
+        // A buffer smaller than the limit
+        {
+            error_code ec;
+            flat_buffer b(8);
+            test::stream s1(ioc);
+            s1.append("GET / HTTP/1.1\r\n\r\n");
+            auto const result = detect_protocol(s1, b, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(result == detected_protocol::http);
+            BEAST_EXPECT(b.size() == 8);
+        }
+
+        // eof
+        {
+            error_code ec;
+            flat_buffer b;
+            test::stream s1(ioc);
+            auto s2 = test::connect(s1);
+            s1.append("PRI * HTTP");
+            s2.close();
+            auto const result = detect_protocol(s1, b, ec);
+            BEAST_EXPECT(ec == net::error::eof);
+            BEAST_EXPECT(result == detected_protocol::unknown);
+            BEAST_EXPECT(b.size() == 10);
+        }
+    }
+
+    void
+    testAsyncRead()
+    {
+        net::io_context ioc;
+
+        // The request is received with one read, and left in the buffer
+        {
+            flat_buffer b;
+            test::stream s1(ioc);
+            s1.append(client_hello());
+            async_detect_protocol(s1, b,
+                [&](error_code ec, detected_protocol result)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    BEAST_EXPECT(result == detected_protocol::tls);
+                });
+            test::run(ioc);
+            BEAST_EXPECT(s1.nread() == 1);
+            BEAST_EXPECT(buffers_to_string(b.data()) == client_hello());
+        }
+
+        // Immediate completion
+        {
+            flat_buffer b;
+            test::stream s1(ioc);
+            auto const n = net::buffer_copy(b.prepare(6),
+                net::buffer("PROXY ", 6));
+            b.commit(n);
+            bool invoked = false;
+            async_detect_protocol(s1, b,
+                [&](error_code ec, detected_protocol result)
+                {
+                    invoked = true;
+                    BEAST_EXPECTS(! ec, ec.message());
+                    BEAST_EXPECT(result == detected_protocol::proxy_v1);
+                });
+            BEAST_EXPECT(! invoked);
+            test::run(ioc);
+            BEAST_EXPECT(invoked);
+        }
+
+        // Several reads
+        {
+            flat_buffer b;
+            test::stream s1(ioc);
+            s1.read_size(5);
+            s1.append(upgrade());
+            async_detect_protocol(s1, b,
+                [&](error_code ec, detected_protocol result)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    BEAST_EXPECT(result == detected_protocol::websocket);
+                });
+            test::run(ioc);
+        }
+
+        // A smaller limit
+        {
+            flat_buffer b;
+            test::stream s1(ioc);
+            s1.append("GET / HTTP/1.1\r\n\r\n");
+            async_detect_protocol(s1, b, 10,
+                [&](error_code ec, detected_protocol result)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    BEAST_EXPECT(result == detected_protocol::http);
+                });
+            test::run(ioc);
+            BEAST_EXPECT(b.size() == 10);
+        }
+
+        // eof
+        {
+            flat_buffer b;
+            test::stream s1(ioc);
+            auto s2 = test::connect(s1);
+            s1.append("GET");
+            s2.close();
+            async_detect_protocol(s1, b,
+                test::fail_handler(net::error::eof));
+            test::run(ioc);
+        }
+    }
+
+    void
+    run() override
+    {
+        testClassify();
+        testBuffers();
+        testLimit();
+        testRead();
+        testAsyncRead();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,core,detect_protocol);
+
+} // beast
+} // boost
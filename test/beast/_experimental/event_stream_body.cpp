@@ -0,0 +1,299 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/_experimental/http/event_stream_body.hpp>
+
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/_experimental/test/stream.hpp>
+#include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/http/read.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/beast/http/write.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+class event_stream_body_test
+    : public unit_test::suite
+{
+public:
+    using value_type = event_stream_body::value_type;
+
+    // Returns everything queued in v, as the writer sends it
+    static
+    std::string
+    drain(value_type const& v)
+    {
+        response_header<> h;
+        event_stream_body::writer w{h, v};
+        error_code ec;
+        w.init(ec);
+        auto const result = w.get(ec);
+        if(! result)
+            return {};
+        return buffers_to_string(result->first);
+    }
+
+    void
+    testPush()
+    {
+        value_type v;
+        BEAST_EXPECT(v.is_open());
+        BEAST_EXPECT(v.size() == 0);
+        BEAST_EXPECT(v.push("Hello"));
+        BEAST_EXPECT(v.size() == 13);
+        BEAST_EXPECT(drain(v) == "data: Hello\n\n");
+        BEAST_EXPECT(v.size() == 0);
+
+        BEAST_EXPECT(v.push("1", "tick", "7"));
+        BEAST_EXPECT(drain(v) ==
+            "event: tick\n"
+            "id: 7\n"
+            "data: 1\n\n");
+
+        // Line breaks in the data
+        BEAST_EXPECT(v.push("a\nb\r\nc\rd"));
+        BEAST_EXPECT(v.push(""));
+        BEAST_EXPECT(v.push("x\n"));
+        BEAST_EXPECT(drain(v) ==
+            "data: a\n"
+            "data: b\n"
+            "data: c\n"
+            "data: d\n\n"
+            "data: \n\n"
+            "data: x\n"
+            "data: \n\n");
+
+        // Copies share the queue
+        value_type v2 = v;
+        BEAST_EXPECT(v2.push("shared"));
+        BEAST_EXPECT(v.size() == 14);
+        v.close();
+        BEAST_EXPECT(! v2.is_open());
+        BEAST_EXPECT(! v2.push("late"));
+        BEAST_EXPECT(v.size() == 14);
+    }
+
+    void
+    testLimit()
+    {
+        value_type v{26};
+        BEAST_EXPECT(v.limit() == 26);
+        BEAST_EXPECT(v.push("Hello"));
+        BEAST_EXPECT(v.push("World"));
+        BEAST_EXPECT(v.size() == 26);
+        BEAST_EXPECT(! v.push("!"));
+        BEAST_EXPECT(v.size() == 26);
+
+        // Sent bytes no longer count
+        BEAST_EXPECT(drain(v).size() == 26);
+        BEAST_EXPECT(v.push("!"));
+
+        // A lower limit rejects further events
+        v.limit(4);
+        BEAST_EXPECT(! v.push("?"));
+        v.limit(100);
+        BEAST_EXPECT(v.push("?"));
+    }
+
+    void
+    testWrite()
+    {
+        net::io_context ioc;
+        test::stream ts{ioc};
+        test::stream tr{ioc};
+        ts.connect(tr);
+
+        response<event_stream_body> res{status::ok, 11};
+        res.chunked(true);
+        int ready = 0;
+        res.body().on_ready([&ready]{ ++ready; });
+        response_serializer<event_stream_body> sr{res};
+        write_header(ts, sr);
+        tr.clear();
+
+        // Everything queued goes in one chunk
+        auto events = res.body();
+        BEAST_EXPECT(events.push("one"));
+        BEAST_EXPECT(events.push("two"));
+        BEAST_EXPECT(ready == 0);
+        auto const nwrite = ts.nwrite();
+        error_code ec;
+        write(ts, sr, ec);
+        BEAST_EXPECTS(ec == error::need_buffer, ec.message());
+        BEAST_EXPECT(ts.nwrite() == nwrite + 1);
+        BEAST_EXPECT(tr.str() ==
+            "16\r\n"
+            "data: one\n\n"
+            "data: two\n\n"
+            "\r\n");
+        tr.clear();
+
+        // The callback runs once, for the first event
+        // queued after the serializer found none.
+        BEAST_EXPECT(ready == 0);
+        BEAST_EXPECT(events.push("three"));
+        BEAST_EXPECT(ready == 1);
+        BEAST_EXPECT(events.push("four"));
+        BEAST_EXPECT(ready == 1);
+        write(ts, sr, ec);
+        BEAST_EXPECTS(ec == error::need_buffer, ec.message());
+        BEAST_EXPECT(tr.str() ==
+            "19\r\n"
+            "data: three\n\n"
+            "data: four\n\n"
+            "\r\n");
+        tr.clear();
+
+        // Closing wakes the writer and ends the body
+        events.close();
+        BEAST_EXPECT(ready == 2);
+        write(ts, sr, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(sr.is_done());
+        BEAST_EXPECT(tr.str() == "0\r\n\r\n");
+    }
+
+    void
+    testClose()
+    {
+        // Events queued before close are sent with the last chunk
+        net::io_context ioc;
+        test::stream ts{ioc};
+        test::stream tr{ioc};
+        ts.connect(tr);
+
+        response<event_stream_body> res{status::ok, 11};
+        res.chunked(true);
+        response_serializer<event_stream_body> sr{res};
+        write_header(ts, sr);
+        res.body().push("bye");
+        res.body().close();
+        error_code ec;
+        write(ts, sr, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(sr.is_done());
+
+        flat_buffer b;
+        response<string_body> m;
+        read(tr, b, m, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(m.body() == "data: bye\n\n");
+    }
+
+    void
+    testAsync()
+    {
+        // A session writing on an io_context while
+        // producers on other threads queue events.
+        struct session
+        {
+            net::io_context ioc;
+            test::stream ts{ioc};
+            test::stream tr{ioc};
+            response<event_stream_body> res{status::ok, 11};
+            response_serializer<event_stream_body> sr{res};
+            bool writing = false;
+            error_code result;
+
+            session()
+            {
+                ts.connect(tr);
+                res.chunked(true);
+                res.body().on_ready(
+                    [this]
+                    {
+                        net::post(ioc, [this]{ do_write(); });
+                    });
+            }
+
+            void
+            do_write()
+            {
+                if(writing || sr.is_done())
+                    return;
+                writing = true;
+                async_write(ts, sr,
+                    [this](error_code ec, std::size_t)
+                    {
+                        writing = false;
+                        if(ec == error::need_buffer)
+                        {
+                            if(res.body().size() > 0 ||
+                                ! res.body().is_open())
+                                do_write();
+                            return;
+                        }
+                        result = ec;
+                    });
+            }
+        };
+
+        int const threads = 4;
+        int const count = 1000;
+        session s;
+        write_header(s.ts, s.sr);
+        auto const nwrite = s.ts.nwrite();
+        s.do_write();
+        auto work = net::make_work_guard(s.ioc);
+        std::thread t([&]{ s.ioc.run(); });
+        {
+            std::vector<std::thread> v;
+            auto events = s.res.body();
+            for(int i = 0; i < threads; ++i)
+                v.emplace_back(
+                    [events, count]() mutable
+                    {
+                        for(int j = 0; j < count; ++j)
+                            while(! events.push("x"))
+                                std::this_thread::yield();
+                    });
+            for(auto& th : v)
+                th.join();
+            events.close();
+        }
+        work.reset();
+        t.join();
+        BEAST_EXPECTS(! s.result, s.result.message());
+        BEAST_EXPECT(s.sr.is_done());
+        BEAST_EXPECT(s.ts.nwrite() - nwrite <=
+            static_cast<std::size_t>(threads * count) + 1);
+
+        flat_buffer b;
+        response<string_body> m;
+        error_code ec;
+        read(s.tr, b, m, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(m.body().size() ==
+            static_cast<std::size_t>(threads * count) * 9);
+    }
+
+    void
+    run() override
+    {
+        testPush();
+        testLimit();
+        testWrite();
+        testClose();
+        testAsync();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,http,event_stream_body);
+
+} // http
+} // beast
+} // boost
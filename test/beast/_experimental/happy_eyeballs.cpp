@@ -0,0 +1,239 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/_experimental/core/happy_eyeballs.hpp>
+
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <chrono>
+#include <vector>
+
+namespace boost {
+namespace beast {
+
+class happy_eyeballs_test
+    : public unit_test::suite
+{
+public:
+    using tcp = net::ip::tcp;
+
+    static
+    tcp::endpoint
+    refused_endpoint(net::io_context& ioc)
+    {
+        // bind and close, so nothing is listening on the port
+        tcp::acceptor a(ioc, tcp::endpoint(
+            net::ip::make_address_v4("127.0.0.1"), 0));
+        auto const ep = a.local_endpoint();
+        a.close();
+        return ep;
+    }
+
+    void
+    testConnect()
+    {
+        net::io_context ioc;
+        tcp::acceptor a(ioc, tcp::endpoint(
+            net::ip::make_address_v4("127.0.0.1"), 0));
+        auto const good = a.local_endpoint();
+
+        // The IPv6 loopback is tried first and is either
+        // refused or unsupported; IPv4 is tried next.
+        std::vector<tcp::endpoint> eps;
+        eps.emplace_back(net::ip::make_address_v6("::1"), good.port());
+        eps.emplace_back(good);
+
+        tcp_stream s(ioc);
+        bool invoked = false;
+        async_connect_happy_eyeballs(s, eps,
+            std::chrono::milliseconds(250),
+            std::chrono::seconds(30),
+            [&](error_code ec, tcp::endpoint ep)
+            {
+                invoked = true;
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(ep == good);
+            });
+        BEAST_EXPECT(! invoked);
+        ioc.run();
+        BEAST_EXPECT(invoked);
+        BEAST_EXPECT(s.socket().is_open());
+        BEAST_EXPECT(s.socket().remote_endpoint() == good);
+    }
+
+    void
+    testStagger()
+    {
+        net::io_context ioc;
+        tcp::acceptor a(ioc, tcp::endpoint(
+            net::ip::make_address_v4("127.0.0.1"), 0));
+        auto const good = a.local_endpoint();
+
+        // A non-routable address which either stalls
+        // or fails; the second endpoint must win.
+        std::vector<tcp::endpoint> eps;
+        eps.emplace_back(
+            net::ip::make_address_v4("192.0.2.1"), good.port());
+        eps.emplace_back(good);
+
+        tcp_stream s(ioc);
+        bool invoked = false;
+        auto const start = std::chrono::steady_clock::now();
+        async_connect_happy_eyeballs(s, eps,
+            std::chrono::milliseconds(10),
+            std::chrono::seconds(30),
+            [&](error_code ec, tcp::endpoint ep)
+            {
+                invoked = true;
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(ep == good);
+            });
+        ioc.run();
+        BEAST_EXPECT(invoked);
+        BEAST_EXPECT(std::chrono::steady_clock::now() - start <
+            std::chrono::seconds(5));
+    }
+
+    void
+    testPreferV6()
+    {
+        net::io_context ioc;
+        tcp::acceptor a6(ioc);
+        error_code ec;
+        a6.open(tcp::v6(), ec);
+        if(! ec)
+            a6.bind(tcp::endpoint(
+                net::ip::make_address_v6("::1"), 0), ec);
+        if(! ec)
+            a6.listen(net::socket_base::max_listen_connections, ec);
+        if(ec)
+            return; // IPv6 is unavailable
+        tcp::acceptor a4(ioc, tcp::endpoint(
+            net::ip::make_address_v4("127.0.0.1"), 0));
+
+        // IPv6 is tried first, wherever it is in the sequence
+        std::vector<tcp::endpoint> eps;
+        eps.push_back(a4.local_endpoint());
+        eps.push_back(a6.local_endpoint());
+
+        tcp_stream s(ioc);
+        bool invoked = false;
+        async_connect_happy_eyeballs(s, eps,
+            std::chrono::seconds(10),
+            std::chrono::seconds(30),
+            [&](error_code ec, tcp::endpoint ep)
+            {
+                invoked = true;
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(ep == a6.local_endpoint());
+            });
+        ioc.run();
+        BEAST_EXPECT(invoked);
+    }
+
+    void
+    testTimeout()
+    {
+        net::io_context ioc;
+
+        // A full backlog makes further connects stall
+        tcp::acceptor a(ioc, tcp::endpoint(
+            net::ip::make_address_v4("127.0.0.1"), 0));
+        a.listen(0);
+        std::vector<tcp::socket> v;
+        for(int i = 0; i < 8; ++i)
+        {
+            v.emplace_back(ioc);
+            v.back().async_connect(
+                a.local_endpoint(), [](error_code){});
+        }
+
+        std::vector<tcp::endpoint> eps;
+        eps.push_back(a.local_endpoint());
+        eps.push_back(a.local_endpoint());
+
+        tcp_stream s(ioc);
+        bool invoked = false;
+        auto const start = std::chrono::steady_clock::now();
+        async_connect_happy_eyeballs(s, eps,
+            std::chrono::milliseconds(10),
+            std::chrono::milliseconds(100),
+            [&](error_code ec, tcp::endpoint ep)
+            {
+                invoked = true;
+                BEAST_EXPECTS(ec == error::timeout, ec.message());
+                BEAST_EXPECT(ep == tcp::endpoint{});
+                for(auto& sock : v)
+                    sock.close();
+            });
+        ioc.run();
+        BEAST_EXPECT(invoked);
+        BEAST_EXPECT(! s.socket().is_open());
+        BEAST_EXPECT(std::chrono::steady_clock::now() - start <
+            std::chrono::seconds(5));
+    }
+
+    void
+    testFail()
+    {
+        net::io_context ioc;
+        std::vector<tcp::endpoint> eps;
+        eps.push_back(refused_endpoint(ioc));
+        eps.push_back(refused_endpoint(ioc));
+
+        tcp_stream s(ioc);
+        bool invoked = false;
+        async_connect_happy_eyeballs(s, eps,
+            std::chrono::seconds(10),
+            std::chrono::seconds(30),
+            [&](error_code ec, tcp::endpoint ep)
+            {
+                invoked = true;
+                BEAST_EXPECT(ec);
+                BEAST_EXPECT(ep == tcp::endpoint{});
+            });
+        ioc.run();
+        BEAST_EXPECT(invoked);
+        BEAST_EXPECT(! s.socket().is_open());
+
+        // empty sequence
+        invoked = false;
+        async_connect_happy_eyeballs(s,
+            std::vector<tcp::endpoint>{},
+            std::chrono::milliseconds(250),
+            std::chrono::seconds(30),
+            [&](error_code ec, tcp::endpoint)
+            {
+                invoked = true;
+                BEAST_EXPECT(ec == net::error::not_found);
+            });
+        BEAST_EXPECT(! invoked);
+        ioc.restart();
+        ioc.run();
+        BEAST_EXPECT(invoked);
+    }
+
+    void
+    run() override
+    {
+        testConnect();
+        testStagger();
+        testPreferV6();
+        testTimeout();
+        testFail();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,core,happy_eyeballs);
+
+} // beast
+} // boost
@@ -0,0 +1,458 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/_experimental/ssl/pooled_ssl_stream.hpp>
+
+#include <boost/beast/_experimental/test/stream.hpp>
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+#include <boost/beast/ssl/ssl_stream.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include "example/common/server_certificate.hpp"
+#include <array>
+#include <chrono>
+#include <string>
+
+namespace boost {
+namespace beast {
+
+class pooled_ssl_stream_test : public unit_test::suite
+{
+public:
+    using socket_type = net::ip::tcp::socket;
+
+    static
+    net::ssl::context
+    make_context(bool server)
+    {
+        net::ssl::context ctx(net::ssl::context::tlsv12);
+        if(server)
+            load_server_certificate(ctx);
+        return ctx;
+    }
+
+    template<class Stream>
+    static
+    void
+    async_handshake(Stream& s, net::ssl::stream_base::handshake_type type)
+    {
+        s.async_handshake(type,
+            [](error_code ec)
+            {
+                if(ec)
+                    throw system_error{ec};
+            });
+    }
+
+    static
+    std::string
+    make_payload(std::size_t n)
+    {
+        std::string s(n, '\0');
+        for(std::size_t i = 0; i < n; ++i)
+            s[i] = static_cast<char>('a' + i % 26);
+        return s;
+    }
+
+    void
+    testPool()
+    {
+        ssl_record_pool pool(1, 2);
+        BEAST_EXPECT(pool.available() == 2);
+        auto const p1 = pool.acquire();
+        auto const p2 = pool.acquire();
+        auto const p3 = pool.acquire();
+        BEAST_EXPECT(pool.available() == 0);
+        BEAST_EXPECT(pool.in_use() == 3);
+        BEAST_EXPECT(pool.peak() == 3);
+        pool.release(p1);
+        pool.release(p2);
+        pool.release(p3);
+        pool.release(nullptr);
+        BEAST_EXPECT(pool.in_use() == 0);
+        BEAST_EXPECT(pool.available() == 1);
+        BEAST_EXPECT(pool.peak() == 3);
+    }
+
+    void
+    testTestStream()
+    {
+        net::io_context ioc;
+        ssl_record_pool pool;
+        auto server_ctx = make_context(true);
+        auto client_ctx = make_context(false);
+        pooled_ssl_stream<test::stream> server(ioc, server_ctx, pool);
+        pooled_ssl_stream<test::stream> client(ioc, client_ctx, pool);
+        server.next_layer().connect(client.next_layer());
+
+        async_handshake(server, net::ssl::stream_base::server);
+        async_handshake(client, net::ssl::stream_base::client);
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(server.buffer_bytes() == 0);
+        BEAST_EXPECT(client.buffer_bytes() == 0);
+        BEAST_EXPECT(pool.in_use() == 0);
+        BEAST_EXPECT(pool.peak() > 0);
+
+        // Larger than a record
+        auto const payload = make_payload(100000);
+        std::string s(payload.size(), '\0');
+        net::async_write(client, net::buffer(payload),
+            [&](error_code ec, std::size_t n)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(n == payload.size());
+            });
+        net::async_read(server, net::buffer(&s[0], s.size()),
+            [&](error_code ec, std::size_t n)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(n == payload.size());
+            });
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(s == payload);
+        BEAST_EXPECT(pool.in_use() == 0);
+
+        // A buffer sequence is sent as one record
+        std::array<net::const_buffer, 3> const cb{{
+            net::buffer("Hello", 5),
+            net::buffer(", ", 2),
+            net::buffer("World", 5)}};
+        std::size_t const before = client.next_layer().nwrite_bytes();
+        BEAST_EXPECT(client.write_some(cb) == 12);
+        BEAST_EXPECT(client.next_layer().nwrite_bytes() - before <
+            2 * (12 + 5 + 8 + 16));
+        BEAST_EXPECT(client.buffer_bytes() == 0);
+        s.assign(12, '\0');
+        net::read(server, net::buffer(&s[0], s.size()));
+        BEAST_EXPECT(s == "Hello, World");
+        BEAST_EXPECT(pool.in_use() == 0);
+
+        // Empty buffers transfer nothing
+        BEAST_EXPECT(client.write_some(net::const_buffer{}) == 0);
+        BEAST_EXPECT(server.read_some(net::mutable_buffer{}) == 0);
+
+        // Shut down, both ways
+        error_code ec1;
+        error_code ec2;
+        client.async_shutdown(
+            [&](error_code ec)
+            {
+                ec1 = ec;
+            });
+        server.async_read_some(net::buffer(&s[0], s.size()),
+            [&](error_code ec, std::size_t)
+            {
+                ec2 = ec;
+                server.async_shutdown(
+                    [&](error_code ec)
+                    {
+                        BEAST_EXPECTS(! ec, ec.message());
+                    });
+            });
+        ioc.run();
+        BEAST_EXPECTS(! ec1, ec1.message());
+        BEAST_EXPECTS(ec2 == net::error::eof, ec2.message());
+        BEAST_EXPECT(pool.in_use() == 0);
+    }
+
+    void
+    testTruncated()
+    {
+        net::io_context ioc;
+        ssl_record_pool pool;
+        auto server_ctx = make_context(true);
+        auto client_ctx = make_context(false);
+        pooled_ssl_stream<test::stream> server(ioc, server_ctx, pool);
+        pooled_ssl_stream<test::stream> client(ioc, client_ctx, pool);
+        server.next_layer().connect(client.next_layer());
+        async_handshake(server, net::ssl::stream_base::server);
+        async_handshake(client, net::ssl::stream_base::client);
+        ioc.run();
+
+        // Closing the transport without close_notify
+        client.next_layer().close();
+        char buf[8];
+        error_code ec;
+        server.read_some(net::buffer(buf), ec);
+        BEAST_EXPECTS(ec == net::ssl::error::stream_truncated,
+            ec.message());
+        BEAST_EXPECT(pool.in_use() == 0);
+    }
+
+    void
+    testSocket()
+    {
+        // Against net::ssl::stream, over a socket
+        net::io_context ioc;
+        ssl_record_pool pool;
+        auto server_ctx = make_context(true);
+        auto client_ctx = make_context(false);
+        pooled_ssl_stream<socket_type> server(ioc, server_ctx, pool);
+        ssl_stream<socket_type> client(ioc, client_ctx);
+
+        net::ip::tcp::acceptor a(ioc,
+            {net::ip::make_address("127.0.0.1"), 0});
+        a.async_accept(server.next_layer(),
+            [](error_code){});
+        client.next_layer().async_connect(
+            a.local_endpoint(),
+            [](error_code){});
+        ioc.run();
+        ioc.restart();
+
+        async_handshake(server, net::ssl::stream_base::server);
+        async_handshake(client, net::ssl::stream_base::client);
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(pool.in_use() == 0);
+
+        // A pending read holds no buffer
+        std::string s(5, '\0');
+        bool done = false;
+        net::async_read(server, net::buffer(&s[0], s.size()),
+            [&](error_code ec, std::size_t)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                done = true;
+            });
+        ioc.poll();
+        BEAST_EXPECT(! done);
+        BEAST_EXPECT(server.buffer_bytes() == 0);
+        BEAST_EXPECT(pool.in_use() == 0);
+
+        net::write(client, net::buffer("Hello", 5));
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(done);
+        BEAST_EXPECT(s == "Hello");
+        BEAST_EXPECT(pool.in_use() == 0);
+
+        // Synchronous, in the other direction
+        net::write(server, net::buffer("World", 5));
+        net::read(client, net::buffer(&s[0], s.size()));
+        BEAST_EXPECT(s == "World");
+
+        // A read and a write at the same time
+        auto const payload = make_payload(50000);
+        std::string r(payload.size(), '\0');
+        std::string t(payload.size(), '\0');
+        net::async_read(server, net::buffer(&r[0], r.size()),
+            [](error_code ec, std::size_t)
+            {
+                if(ec)
+                    throw system_error{ec};
+            });
+        net::async_write(server, net::buffer(payload),
+            [](error_code ec, std::size_t)
+            {
+                if(ec)
+                    throw system_error{ec};
+            });
+        net::async_write(client, net::buffer(payload),
+            [](error_code ec, std::size_t)
+            {
+                if(ec)
+                    throw system_error{ec};
+            });
+        net::async_read(client, net::buffer(&t[0], t.size()),
+            [](error_code ec, std::size_t)
+            {
+                if(ec)
+                    throw system_error{ec};
+            });
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(r == payload);
+        BEAST_EXPECT(t == payload);
+        BEAST_EXPECT(pool.in_use() == 0);
+
+        // The peer answers close_notify
+        error_code ec1;
+        server.async_shutdown(
+            [&](error_code ec)
+            {
+                ec1 = ec;
+            });
+        client.async_read_some(net::buffer(&s[0], s.size()),
+            [&](error_code ec, std::size_t)
+            {
+                BEAST_EXPECTS(ec == net::error::eof, ec.message());
+                client.async_shutdown([](error_code){});
+            });
+        ioc.run();
+        BEAST_EXPECTS(! ec1, ec1.message());
+        BEAST_EXPECT(pool.in_use() == 0);
+    }
+
+    void
+    testTcpStream()
+    {
+        // A tcp_stream next layer waits on its socket
+        net::io_context ioc;
+        ssl_record_pool pool;
+        auto server_ctx = make_context(true);
+        auto client_ctx = make_context(false);
+        pooled_ssl_stream<tcp_stream> server(ioc, server_ctx, pool);
+        ssl_stream<socket_type> client(ioc, client_ctx);
+
+        net::ip::tcp::acceptor a(ioc,
+            {net::ip::make_address("127.0.0.1"), 0});
+        a.async_accept(server.next_layer().socket(),
+            [](error_code){});
+        client.next_layer().async_connect(
+            a.local_endpoint(),
+            [](error_code){});
+        ioc.run();
+        ioc.restart();
+
+        async_handshake(server, net::ssl::stream_base::server);
+        async_handshake(client, net::ssl::stream_base::client);
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(pool.in_use() == 0);
+
+        std::string s(5, '\0');
+        bool done = false;
+        server.next_layer().expires_after(std::chrono::seconds(30));
+        net::async_read(server, net::buffer(&s[0], s.size()),
+            [&](error_code ec, std::size_t)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                done = true;
+            });
+        ioc.poll();
+        BEAST_EXPECT(! done);
+        BEAST_EXPECT(server.buffer_bytes() == 0);
+        BEAST_EXPECT(pool.in_use() == 0);
+
+        net::write(client, net::buffer("Hello", 5));
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(done);
+        BEAST_EXPECT(s == "Hello");
+        BEAST_EXPECT(pool.in_use() == 0);
+
+        // Synchronous
+        net::write(client, net::buffer("World", 5));
+        net::read(server, net::buffer(&s[0], s.size()));
+        BEAST_EXPECT(s == "World");
+        BEAST_EXPECT(pool.in_use() == 0);
+
+        // Cancelling the stream ends the wait
+        error_code ec1;
+        net::async_read(server, net::buffer(&s[0], s.size()),
+            [&](error_code ec, std::size_t)
+            {
+                ec1 = ec;
+            });
+        ioc.poll();
+        BEAST_EXPECT(server.buffer_bytes() == 0);
+        server.next_layer().cancel();
+        ioc.run();
+        BEAST_EXPECTS(ec1 == net::error::operation_aborted,
+            ec1.message());
+        BEAST_EXPECT(pool.in_use() == 0);
+    }
+
+    void
+    testWaitOutput()
+    {
+        // A shutdown started while a write is stalled
+        // waits for the write, instead of polling.
+        net::io_context ioc;
+        ssl_record_pool pool;
+        auto server_ctx = make_context(true);
+        auto client_ctx = make_context(false);
+        pooled_ssl_stream<socket_type> server(ioc, server_ctx, pool);
+        ssl_stream<socket_type> client(ioc, client_ctx);
+
+        net::ip::tcp::acceptor a(ioc,
+            {net::ip::make_address("127.0.0.1"), 0});
+        a.async_accept(server.next_layer(),
+            [](error_code){});
+        client.next_layer().async_connect(
+            a.local_endpoint(),
+            [](error_code){});
+        ioc.run();
+        ioc.restart();
+        server.next_layer().set_option(
+            net::socket_base::send_buffer_size(4096));
+        client.next_layer().set_option(
+            net::socket_base::receive_buffer_size(4096));
+
+        async_handshake(server, net::ssl::stream_base::server);
+        async_handshake(client, net::ssl::stream_base::client);
+        ioc.run();
+        ioc.restart();
+
+        // The client does not read, so the write stalls
+        auto const payload = make_payload(200000);
+        bool wrote = false;
+        net::async_write(server, net::buffer(payload),
+            [&](error_code, std::size_t)
+            {
+                wrote = true;
+            });
+        while(ioc.run_for(std::chrono::milliseconds(200)) > 0)
+        {
+        }
+        BEAST_EXPECT(! wrote);
+
+        bool shut = false;
+        error_code ec1;
+        server.async_shutdown(
+            [&](error_code ec)
+            {
+                shut = true;
+                ec1 = ec;
+            });
+
+        // The shutdown waits without being scheduled again
+        auto const n = ioc.run_for(std::chrono::milliseconds(100));
+        BEAST_EXPECTS(n < 20, std::to_string(n));
+        BEAST_EXPECT(! wrote);
+        BEAST_EXPECT(! shut);
+
+        // Reading lets both finish
+        std::string r(payload.size(), '\0');
+        net::async_read(client, net::buffer(&r[0], r.size()),
+            [&](error_code ec, std::size_t)
+            {
+                BEAST_EXPECTS(ec == net::error::eof, ec.message());
+                client.async_shutdown([](error_code){});
+            });
+        ioc.run();
+        BEAST_EXPECT(wrote);
+        BEAST_EXPECT(shut);
+        BEAST_EXPECTS(! ec1, ec1.message());
+        BEAST_EXPECT(pool.in_use() == 0);
+    }
+
+    void
+    run() override
+    {
+        testPool();
+        testTestStream();
+        testTruncated();
+        testSocket();
+        testTcpStream();
+        testWaitOutput();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,ssl,pooled_ssl_stream);
+
+} // beast
+} // boost
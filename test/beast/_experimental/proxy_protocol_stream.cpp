@@ -0,0 +1,419 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/_experimental/core/proxy_protocol_stream.hpp>
+
+#include <boost/beast/_experimental/test/stream.hpp>
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <functional>
+#include <string>
+
+namespace boost {
+namespace beast {
+
+class proxy_protocol_stream_test
+    : public unit_test::suite
+{
+public:
+    using stream_type = proxy_protocol_stream<test::stream>;
+
+    static
+    string_view
+    payload()
+    {
+        return "GET / HTTP/1.1\r\nHost: example.com\r\n\r\n";
+    }
+
+    // Builds a version 2 header
+    static
+    std::string
+    v2(
+        unsigned char ver_cmd,
+        unsigned char family,
+        string_view addresses,
+        std::size_t tlv_size = 0)
+    {
+        std::string s("\r\n\r\n\0\r\nQUIT\n", 12);
+        auto const len = addresses.size() + tlv_size;
+        s.push_back(static_cast<char>(ver_cmd));
+        s.push_back(static_cast<char>(family));
+        s.push_back(static_cast<char>(len >> 8));
+        s.push_back(static_cast<char>(len & 0xff));
+        s.append(addresses.data(), addresses.size());
+        s.append(tlv_size, '\x04');
+        return s;
+    }
+
+    static
+    std::string
+    v2_inet(std::size_t tlv_size = 0)
+    {
+        // 192.0.2.1:56324 -> 192.0.2.2:443
+        return v2(0x21, 0x11, {
+            "\xc0\x00\x02\x01" "\xc0\x00\x02\x02"
+            "\xdc\x04" "\x01\xbb", 12}, tlv_size);
+    }
+
+    static
+    std::string
+    v2_inet6(std::size_t tlv_size = 0)
+    {
+        // [2001:db8::1]:56324 -> [2001:db8::2]:443
+        return v2(0x21, 0x21, {
+            "\x20\x01\x0d\xb8\0\0\0\0\0\0\0\0\0\0\0\x01"
+            "\x20\x01\x0d\xb8\0\0\0\0\0\0\0\0\0\0\0\x02"
+            "\xdc\x04" "\x01\xbb", 36}, tlv_size);
+    }
+
+    static
+    net::ip::tcp::endpoint
+    endpoint(char const* addr, unsigned short port)
+    {
+        return {net::ip::make_address(addr), port};
+    }
+
+    void
+    expectHeader(
+        proxy_header const& h,
+        int version,
+        net::ip::tcp::endpoint const& source,
+        net::ip::tcp::endpoint const& destination)
+    {
+        BEAST_EXPECT(h.version == version);
+        BEAST_EXPECT(h.proxied);
+        BEAST_EXPECTS(h.source == source, h.source.address().to_string());
+        BEAST_EXPECT(h.destination == destination);
+    }
+
+    // Reads everything with every combination of
+    // next layer read size and caller buffer size.
+    template<class Check>
+    void
+    doMatrix(string_view header, Check const& check)
+    {
+        net::io_context ioc;
+        std::string const in =
+            std::string(header) + std::string(payload());
+        for(std::size_t j = 1; j <= in.size(); j += j < 20 ? 1 : 7)
+        {
+            for(std::size_t k = 1; k <= 64; k += k < 4 ? 1 : 20)
+            {
+                // sync
+                {
+                    stream_type s(ioc);
+                    s.next_layer().read_size(j);
+                    s.next_layer().append(in);
+                    test::connect(s.next_layer()).close();
+
+                    flat_buffer b;
+                    error_code ec;
+                    for(;;)
+                    {
+                        b.commit(s.read_some(b.prepare(k), ec));
+                        if(ec)
+                            break;
+                    }
+                    BEAST_EXPECTS(ec == net::error::eof, ec.message());
+                    BEAST_EXPECT(buffers_to_string(b.data()) == payload());
+                    check(s.header());
+                }
+
+                // async
+                {
+                    stream_type s(ioc);
+                    s.next_layer().read_size(j);
+                    s.next_layer().append(in);
+                    test::connect(s.next_layer()).close();
+
+                    flat_buffer b;
+                    error_code ec;
+                    std::function<void(error_code, std::size_t)> on_read;
+                    on_read =
+                        [&](error_code ec_, std::size_t n)
+                        {
+                            b.commit(n);
+                            ec = ec_;
+                            if(! ec)
+                                s.async_read_some(
+                                    b.prepare(k), decltype(on_read)(on_read));
+                        };
+                    s.async_read_some(
+                        b.prepare(k), decltype(on_read)(on_read));
+                    ioc.run();
+                    ioc.restart();
+                    BEAST_EXPECTS(ec == net::error::eof, ec.message());
+                    BEAST_EXPECT(buffers_to_string(b.data()) == payload());
+                    check(s.header());
+                }
+            }
+        }
+    }
+
+    void
+    testHeaders()
+    {
+        doMatrix("PROXY TCP4 192.0.2.1 192.0.2.2 56324 443\r\n",
+            [&](proxy_header const& h)
+            {
+                expectHeader(h, 1,
+                    endpoint("192.0.2.1", 56324),
+                    endpoint("192.0.2.2", 443));
+            });
+
+        doMatrix("PROXY TCP6 2001:db8::1 2001:db8::2 56324 443\r\n",
+            [&](proxy_header const& h)
+            {
+                expectHeader(h, 1,
+                    endpoint("2001:db8::1", 56324),
+                    endpoint("2001:db8::2", 443));
+            });
+
+        doMatrix("PROXY UNKNOWN ffff::1 ffff::2 1 2\r\n",
+            [&](proxy_header const& h)
+            {
+                BEAST_EXPECT(h.version == 1);
+                BEAST_EXPECT(! h.proxied);
+            });
+
+        doMatrix(v2_inet(),
+            [&](proxy_header const& h)
+            {
+                expectHeader(h, 2,
+                    endpoint("192.0.2.1", 56324),
+                    endpoint("192.0.2.2", 443));
+            });
+
+        doMatrix(v2_inet6(20),
+            [&](proxy_header const& h)
+            {
+                expectHeader(h, 2,
+                    endpoint("2001:db8::1", 56324),
+                    endpoint("2001:db8::2", 443));
+            });
+
+        // TLVs larger than the inline buffer are skipped
+        doMatrix(v2_inet(1000),
+            [&](proxy_header const& h)
+            {
+                expectHeader(h, 2,
+                    endpoint("192.0.2.1", 56324),
+                    endpoint("192.0.2.2", 443));
+            });
+
+        // LOCAL, such as a health check from the proxy
+        doMatrix(v2(0x20, 0x00, {}),
+            [&](proxy_header const& h)
+            {
+                BEAST_EXPECT(h.version == 2);
+                BEAST_EXPECT(! h.proxied);
+            });
+
+        // UDP over IPv4 is accepted without addresses
+        doMatrix(v2(0x21, 0x12, {"\0\0\0\0\0\0\0\0\0\0\0\0", 12}),
+            [&](proxy_header const& h)
+            {
+                BEAST_EXPECT(h.version == 2);
+                BEAST_EXPECT(! h.proxied);
+            });
+    }
+
+    void
+    doError(string_view in, error_code const& expected)
+    {
+        net::io_context ioc;
+        for(std::size_t j = 1; j <= in.size(); ++j)
+        {
+            {
+                stream_type s(ioc);
+                s.next_layer().read_size(j);
+                s.next_layer().append(in);
+                test::connect(s.next_layer()).close();
+                error_code ec;
+                s.handshake(ec);
+                BEAST_EXPECTS(ec == expected, ec.message());
+                BEAST_EXPECT(! s.is_header_done());
+            }
+            {
+                stream_type s(ioc);
+                s.next_layer().read_size(j);
+                s.next_layer().append(in);
+                test::connect(s.next_layer()).close();
+                error_code ec;
+                s.async_handshake(
+                    [&](error_code ec_)
+                    {
+                        ec = ec_;
+                    });
+                ioc.run();
+                ioc.restart();
+                BEAST_EXPECTS(ec == expected, ec.message());
+            }
+        }
+    }
+
+    void
+    testErrors()
+    {
+        error_code const bad_signature = proxy_error::bad_signature;
+        error_code const bad_header = proxy_error::bad_header;
+
+        doError(payload(), bad_signature);
+        doError("PROXX TCP4", bad_signature);
+        doError({"\r\n\r\n\0\r\nQUIX\n\x21\x11\x00\x0c", 16}, bad_signature);
+        doError(std::string(1, '\0'), bad_signature);
+
+        doError("PROXY TCP4 192.0.2.1 192.0.2.2 56324 443\n", bad_header);
+        doError("PROXY TCP5 192.0.2.1 192.0.2.2 56324 443\r\n", bad_header);
+        doError("PROXY TCP4 2001:db8::1 192.0.2.2 56324 443\r\n", bad_header);
+        doError("PROXY TCP6 192.0.2.1 192.0.2.2 56324 443\r\n", bad_header);
+        doError("PROXY TCP4 192.0.2.1 192.0.2.2 65536 443\r\n", bad_header);
+        doError("PROXY TCP4 192.0.2.1 192.0.2.2 5x 443\r\n", bad_header);
+        doError("PROXY TCP4 192.0.2.1 192.0.2.2 56324\r\n", bad_header);
+        doError("PROXY TCP4 192.0.2.1 192.0.2.2 56324 443 1\r\n", bad_header);
+        doError("PROXY TCP4  192.0.2.1 192.0.2.2 56324 443\r\n", bad_header);
+        doError("PROXY \r\n", bad_header);
+        doError("PROXY " + std::string(120, 'x'), bad_header);
+        doError(v2(0x11, 0x11, {"\0\0\0\0\0\0\0\0\0\0\0\0", 12}), bad_header);
+        doError(v2(0x22, 0x11, {"\0\0\0\0\0\0\0\0\0\0\0\0", 12}), bad_header);
+        doError(v2(0x21, 0x11, {"\0\0\0\0", 4}), bad_header);
+        doError(v2(0x21, 0x21, {"\0\0\0\0\0\0\0\0\0\0\0\0", 12}), bad_header);
+
+        // The stream ends inside the header
+        doError("PROXY TCP4 192.0.2.1", net::error::eof);
+        doError(v2_inet(100).substr(0, 60), net::error::eof);
+
+        BEAST_EXPECT(! make_error_code(
+            proxy_error::bad_signature).message().empty());
+        BEAST_EXPECT(! make_error_code(
+            proxy_error::bad_header).message().empty());
+        BEAST_EXPECT(std::string(make_error_code(
+            proxy_error::bad_header).category().name()) ==
+                "boost.beast.proxy");
+    }
+
+    void
+    testHandshake()
+    {
+        net::io_context ioc;
+
+        // The header and the request arrive together
+        {
+            stream_type s(ioc);
+            auto s2 = test::connect(s.next_layer());
+            s.next_layer().append(v2_inet() + std::string(payload()));
+            s.handshake();
+            BEAST_EXPECT(s.is_header_done());
+            BEAST_EXPECT(s.header().proxied);
+            BEAST_EXPECT(s.next_layer().nread() == 1);
+
+            // The bytes received with the header are returned
+            std::string buf(payload().size(), 0);
+            net::read(s, net::buffer(&buf[0], buf.size()));
+            BEAST_EXPECT(buf == payload());
+            BEAST_EXPECT(s.next_layer().nread() == 1);
+
+            // Then reads go to the next layer
+            s.next_layer().append("xy");
+            char c[2];
+            BEAST_EXPECT(s.read_some(net::buffer(c)) == 2);
+            BEAST_EXPECT(s.next_layer().nread() == 2);
+
+            // A second handshake does nothing
+            s.handshake();
+            BEAST_EXPECT(s.next_layer().nread() == 2);
+
+            // Writes go to the next layer
+            net::write(s, net::buffer("hello", 5));
+            BEAST_EXPECT(buffers_to_string(
+                s2.buffer().data()) == "hello");
+
+            error_code ec;
+            teardown(role_type::server, s, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+        }
+
+        // The handler is not invoked from within the initiating function
+        {
+            stream_type s(ioc);
+            s.next_layer().append(v2_inet());
+            bool invoked = false;
+            s.async_handshake(
+                [&](error_code ec)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    invoked = true;
+                });
+            BEAST_EXPECT(! invoked);
+            ioc.run();
+            ioc.restart();
+            BEAST_EXPECT(invoked);
+
+            invoked = false;
+            s.async_handshake(
+                [&](error_code ec)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    invoked = true;
+                });
+            BEAST_EXPECT(! invoked);
+            ioc.run();
+            ioc.restart();
+            BEAST_EXPECT(invoked);
+        }
+
+        // Asynchronous reads after the header
+        {
+            stream_type s(ioc);
+            s.next_layer().append(
+                "PROXY TCP4 192.0.2.1 192.0.2.2 56324 443\r\nab");
+            char c[8];
+            std::size_t n = 0;
+            s.async_read_some(net::buffer(c),
+                [&](error_code ec, std::size_t bytes_transferred)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    n = bytes_transferred;
+                });
+            ioc.run();
+            ioc.restart();
+            BEAST_EXPECT(n == 2);
+            BEAST_EXPECT(s.next_layer().nread() == 1);
+
+            s.next_layer().append("cde");
+            s.async_read_some(net::buffer(c),
+                [&](error_code ec, std::size_t bytes_transferred)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    n = bytes_transferred;
+                });
+            ioc.run();
+            ioc.restart();
+            BEAST_EXPECT(n == 3);
+            BEAST_EXPECT(s.next_layer().nread() == 2);
+        }
+    }
+
+    void
+    run() override
+    {
+        testHeaders();
+        testErrors();
+        testHandshake();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,core,proxy_protocol_stream);
+
+} // beast
+} // boost
@@ -0,0 +1,291 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/_experimental/core/resolver_cache.hpp>
+
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/core/bind_handler.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace boost {
+namespace beast {
+
+class resolver_cache_test
+    : public unit_test::suite
+{
+public:
+    // Answers every name with 127.0.0.1 and the service as the port
+    struct mock_resolver
+    {
+        using executor_type = net::io_context::executor_type;
+        using results_type = net::ip::tcp::resolver::results_type;
+
+        executor_type ex;
+        std::size_t calls = 0;
+        error_code fail;
+
+        explicit
+        mock_resolver(executor_type ex_)
+            : ex(ex_)
+        {
+        }
+
+        executor_type
+        get_executor() noexcept
+        {
+            return ex;
+        }
+
+        void
+        cancel()
+        {
+        }
+
+        template<class Handler>
+        void
+        async_resolve(
+            std::string const& host,
+            std::string const& service,
+            Handler&& h)
+        {
+            ++calls;
+            results_type results;
+            if(! fail)
+                results = results_type::create(
+                    net::ip::tcp::endpoint(
+                        net::ip::make_address_v4("127.0.0.1"),
+                        static_cast<unsigned short>(
+                            std::stoi(service))),
+                    host, service);
+            net::post(ex, beast::bind_front_handler(
+                std::forward<Handler>(h), fail, results));
+        }
+    };
+
+    using cache_type = basic_resolver_cache<mock_resolver>;
+    using results_type = cache_type::results_type;
+
+    void
+    testHit()
+    {
+        net::io_context ioc;
+        cache_type cache(ioc.get_executor());
+        int n = 0;
+        auto const check =
+            [&](error_code ec, results_type r)
+            {
+                ++n;
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(r.size() == 1);
+                BEAST_EXPECT(r.begin()->endpoint().port() == 80);
+            };
+        cache.async_resolve("localhost", "80", check);
+        BEAST_EXPECT(n == 0);
+        ioc.run();
+        ioc.restart();
+        cache.async_resolve("localhost", "80", check);
+        BEAST_EXPECT(n == 1);
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(n == 2);
+        BEAST_EXPECT(cache.resolver().calls == 1);
+        BEAST_EXPECT(cache.hits() == 1);
+        BEAST_EXPECT(cache.misses() == 1);
+        BEAST_EXPECT(cache.size() == 1);
+
+        // different services are different names
+        cache.async_resolve("localhost", "8080",
+            [&](error_code, results_type r)
+            {
+                ++n;
+                BEAST_EXPECT(r.begin()->endpoint().port() == 8080);
+            });
+        ioc.run();
+        BEAST_EXPECT(n == 3);
+        BEAST_EXPECT(cache.resolver().calls == 2);
+        BEAST_EXPECT(cache.size() == 2);
+    }
+
+    void
+    testCoalesce()
+    {
+        net::io_context ioc;
+        cache_type cache(ioc.get_executor());
+        int n = 0;
+        for(int i = 0; i < 3; ++i)
+            cache.async_resolve("localhost", "80",
+                [&](error_code ec, results_type r)
+                {
+                    ++n;
+                    BEAST_EXPECTS(! ec, ec.message());
+                    BEAST_EXPECT(r.size() == 1);
+                });
+        ioc.run();
+        BEAST_EXPECT(n == 3);
+        BEAST_EXPECT(cache.resolver().calls == 1);
+        BEAST_EXPECT(cache.misses() == 1);
+        BEAST_EXPECT(cache.hits() == 2);
+    }
+
+    void
+    testExpire()
+    {
+        net::io_context ioc;
+        cache_type cache(ioc.get_executor());
+        cache_type::options opt;
+        opt.ttl = std::chrono::seconds(0);
+        cache.set_options(opt);
+        auto const f = [](error_code, results_type){};
+        cache.async_resolve("localhost", "80", f);
+        ioc.run();
+        ioc.restart();
+        cache.async_resolve("localhost", "80", f);
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(cache.resolver().calls == 2);
+        BEAST_EXPECT(cache.size() == 1);
+    }
+
+    void
+    testNegative()
+    {
+        net::io_context ioc;
+        cache_type cache(ioc.get_executor());
+        cache.resolver().fail = net::error::host_not_found;
+        int n = 0;
+        auto const check =
+            [&](error_code ec, results_type r)
+            {
+                ++n;
+                BEAST_EXPECT(ec == net::error::host_not_found);
+                BEAST_EXPECT(r.empty());
+            };
+        cache.async_resolve("nowhere", "80", check);
+        ioc.run();
+        ioc.restart();
+        cache.async_resolve("nowhere", "80", check);
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(n == 2);
+        BEAST_EXPECT(cache.resolver().calls == 1);
+
+        // failures use their own lifetime
+        cache_type::options opt;
+        opt.negative_ttl = std::chrono::seconds(0);
+        cache.set_options(opt);
+        cache.erase("nowhere", "80");
+        cache.async_resolve("nowhere", "80", check);
+        ioc.run();
+        ioc.restart();
+        cache.async_resolve("nowhere", "80", check);
+        ioc.run();
+        BEAST_EXPECT(n == 4);
+        BEAST_EXPECT(cache.resolver().calls == 3);
+    }
+
+    void
+    testEvict()
+    {
+        net::io_context ioc;
+        cache_type cache(ioc.get_executor());
+        cache_type::options opt;
+        opt.max_entries = 2;
+        cache.set_options(opt);
+        auto const f = [](error_code, results_type){};
+        cache.async_resolve("a", "1", f);
+        ioc.run();
+        ioc.restart();
+        cache.async_resolve("b", "2", f);
+        ioc.run();
+        ioc.restart();
+        cache.async_resolve("c", "3", f);
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(cache.size() == 2);
+
+        // the entry closest to expiring was discarded
+        cache.async_resolve("a", "1", f);
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(cache.resolver().calls == 4);
+
+        cache.clear();
+        BEAST_EXPECT(cache.size() == 0);
+
+        // pending lookups are not evicted, and the
+        // limit holds while they are outstanding
+        int n = 0;
+        auto const check =
+            [&](error_code ec, results_type r)
+            {
+                ++n;
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(r.size() == 1);
+            };
+        cache.async_resolve("a", "1", check);
+        cache.async_resolve("b", "2", check);
+        cache.async_resolve("c", "3", check);
+        BEAST_EXPECT(cache.size() == 2);
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(n == 3);
+        BEAST_EXPECT(cache.size() == 2);
+        BEAST_EXPECT(cache.resolver().calls == 7);
+    }
+
+    void
+    testDestroy()
+    {
+        net::io_context ioc;
+        int n = 0;
+        {
+            cache_type cache(ioc.get_executor());
+            for(int i = 0; i < 2; ++i)
+                cache.async_resolve("localhost", "80",
+                    [&](error_code ec, results_type)
+                    {
+                        ++n;
+                        BEAST_EXPECT(
+                            ec == net::error::operation_aborted);
+                    });
+        }
+        ioc.run();
+        BEAST_EXPECT(n == 2);
+    }
+
+    void
+    testJavadocs()
+    {
+        BEAST_EXPECT((std::is_same<
+            resolver_cache::results_type,
+            net::ip::tcp::resolver::results_type>::value));
+    }
+
+    void
+    run() override
+    {
+        testHit();
+        testCoalesce();
+        testExpire();
+        testNegative();
+        testEvict();
+        testDestroy();
+        testJavadocs();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,core,resolver_cache);
+
+} // beast
+} // boost
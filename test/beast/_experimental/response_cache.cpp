@@ -0,0 +1,310 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/_experimental/http/response_cache.hpp>
+
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/_experimental/test/stream.hpp>
+#include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/core/file.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/http/empty_body.hpp>
+#include <boost/beast/http/read.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/write.hpp>
+#include <cstdio>
+#include <string>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+class response_cache_test
+    : public unit_test::suite
+{
+public:
+    BOOST_STATIC_ASSERT(
+        net::is_const_buffer_sequence<cached_response>::value);
+
+    // A file which is removed when the object is destroyed
+    class temp_file
+    {
+        std::string path_;
+
+    public:
+        explicit
+        temp_file(std::string path)
+            : path_(std::move(path))
+        {
+        }
+
+        ~temp_file()
+        {
+            std::remove(path_.c_str());
+        }
+
+        std::string const&
+        path() const
+        {
+            return path_;
+        }
+
+        void
+        write(string_view s)
+        {
+            error_code ec;
+            file f;
+            f.open(path_.c_str(), file_mode::write, ec);
+            if(! ec)
+                f.write(s.data(), s.size(), ec);
+            if(ec)
+                throw system_error{ec};
+        }
+    };
+
+    static
+    request<empty_body>
+    make_request(verb method = verb::get)
+    {
+        request<empty_body> req{method, "/index.html", 11};
+        req.set(field::host, "localhost");
+        return req;
+    }
+
+    // Send a cached response and parse it
+    static
+    response<string_body>
+    parse(cached_response const& r, bool head = false)
+    {
+        net::io_context ioc;
+        test::stream ts(ioc), tr(ioc);
+        ts.connect(tr);
+        net::write(ts, r);
+        flat_buffer b;
+        response_parser<string_body> p;
+        p.skip(head);
+        read(tr, b, p);
+        BOOST_ASSERT(b.size() == 0);
+        return p.release();
+    }
+
+    void
+    testGet()
+    {
+        temp_file tf("response_cache_test_1.txt");
+        tf.write("Hello, world!");
+
+        response_cache::options opt;
+        opt.server = "test";
+        response_cache cache(opt);
+        error_code ec;
+        auto const req = make_request();
+
+        auto r = cache.get(req, tf.path(), "text/plain", ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(r.result() == status::ok);
+        BEAST_EXPECT(cache.misses() == 1);
+        BEAST_EXPECT(cache.size() == 1);
+        BEAST_EXPECT(cache.bytes() > 13);
+        BEAST_EXPECT(std::distance(r.begin(), r.end()) == 3);
+
+        auto res = parse(r);
+        BEAST_EXPECT(res.result() == status::ok);
+        BEAST_EXPECT(res.body() == "Hello, world!");
+        BEAST_EXPECT(res[field::content_type] == "text/plain");
+        BEAST_EXPECT(res[field::server] == "test");
+        BEAST_EXPECT(res.keep_alive());
+        BEAST_EXPECT(res.count(field::vary) == 0);
+        auto const etag = std::string(res[field::etag]);
+        BEAST_EXPECT(etag.size() > 2 && etag.front() == '"');
+
+        // A hit shares the bytes with the first response
+        auto r2 = cache.get(req, tf.path(), "text/plain", ec);
+        BEAST_EXPECT(! ec);
+        BEAST_EXPECT(cache.hits() == 1);
+        BEAST_EXPECT(r2.begin()->data() == r.begin()->data());
+        BEAST_EXPECT(r2.size() == r.size());
+
+        // HEAD
+        auto req2 = make_request(verb::head);
+        r2 = cache.get(req2, tf.path(), "text/plain", ec);
+        BEAST_EXPECT(std::distance(r2.begin(), r2.end()) == 2);
+        res = parse(r2, true);
+        BEAST_EXPECT(res[field::content_length] == "13");
+
+        // Connection semantics follow the request
+        req2 = make_request();
+        req2.keep_alive(false);
+        res = parse(cache.get(req2, tf.path(), "text/plain", ec));
+        BEAST_EXPECT(! res.keep_alive());
+        req2.version(10);
+        req2.keep_alive(true);
+        res = parse(cache.get(req2, tf.path(), "text/plain", ec));
+        BEAST_EXPECT(res[field::connection] == "keep-alive");
+
+        // Conditional requests
+        req2 = make_request();
+        for(auto const& s : {
+            etag,
+            "W/" + etag,
+            "\"x\", " + etag,
+            std::string("*")})
+        {
+            req2.set(field::if_none_match, s);
+            r2 = cache.get(req2, tf.path(), "text/plain", ec);
+            BEAST_EXPECTS(r2.result() == status::not_modified, s);
+            res = parse(r2, true);
+            BEAST_EXPECT(res[field::etag] == etag);
+            BEAST_EXPECT(res.count(field::content_length) == 0);
+        }
+        req2.set(field::if_none_match, "\"x\"");
+        r2 = cache.get(req2, tf.path(), "text/plain", ec);
+        BEAST_EXPECT(r2.result() == status::ok);
+
+        // Only GET and HEAD are answered
+        r2 = cache.get(make_request(verb::post),
+            tf.path(), "text/plain", ec);
+        BEAST_EXPECT(ec == errc::operation_not_supported);
+        BEAST_EXPECT(r2.empty());
+        BEAST_EXPECT(cache.size() == 1);
+
+        // A different content type is not a hit
+        auto const hits = cache.hits();
+        res = parse(cache.get(req, tf.path(), "text/html", ec));
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(res[field::content_type] == "text/html");
+        BEAST_EXPECT(cache.hits() == hits);
+        BEAST_EXPECT(cache.misses() == 2);
+        BEAST_EXPECT(cache.size() == 1);
+        res = parse(cache.get(req, tf.path(), "text/html", ec));
+        BEAST_EXPECT(res[field::content_type] == "text/html");
+        BEAST_EXPECT(cache.hits() == hits + 1);
+
+        cache.invalidate(req.target());
+        BEAST_EXPECT(cache.size() == 0);
+        BEAST_EXPECT(cache.bytes() == 0);
+        // Responses remain valid after the entry is gone
+        BEAST_EXPECT(parse(r).body() == "Hello, world!");
+    }
+
+    void
+    testRevalidate()
+    {
+        temp_file tf("response_cache_test_2.txt");
+        tf.write("one");
+
+        response_cache::options opt;
+        opt.revalidate = std::chrono::seconds(0);
+        response_cache cache(opt);
+        error_code ec;
+        auto const req = make_request();
+        auto r = cache.get(req, tf.path(), "text/plain", ec);
+        BEAST_EXPECT(parse(r).body() == "one");
+        r = cache.get(req, tf.path(), "text/plain", ec);
+        BEAST_EXPECT(cache.hits() == 1);
+
+        tf.write("three");
+        r = cache.get(req, tf.path(), "text/plain", ec);
+        BEAST_EXPECT(parse(r).body() == "three");
+        BEAST_EXPECT(cache.misses() == 2);
+        BEAST_EXPECT(cache.size() == 1);
+
+        // Removing the file removes the entry
+        std::remove(tf.path().c_str());
+        r = cache.get(req, tf.path(), "text/plain", ec);
+        BEAST_EXPECT(ec == errc::no_such_file_or_directory);
+        BEAST_EXPECT(r.empty());
+        BEAST_EXPECT(cache.size() == 0);
+    }
+
+    void
+    testGzip()
+    {
+        temp_file tf("response_cache_test_3.txt");
+        temp_file gz("response_cache_test_3.txt.gz");
+        tf.write("plain");
+        gz.write("compressed");
+
+        response_cache cache;
+        error_code ec;
+        auto req = make_request();
+        auto res = parse(cache.get(req, tf.path(), "text/plain", ec));
+        BEAST_EXPECT(res.body() == "plain");
+        BEAST_EXPECT(res[field::vary] == "Accept-Encoding");
+        auto const etag = std::string(res[field::etag]);
+
+        req.set(field::accept_encoding, "deflate, gzip;q=0.5");
+        res = parse(cache.get(req, tf.path(), "text/plain", ec));
+        BEAST_EXPECT(res.body() == "compressed");
+        BEAST_EXPECT(res[field::content_encoding] == "gzip");
+        BEAST_EXPECT(res[field::vary] == "Accept-Encoding");
+        BEAST_EXPECT(res[field::etag] != etag);
+        BEAST_EXPECT(cache.misses() == 1);
+
+        req.set(field::accept_encoding, "gzip;q=0");
+        res = parse(cache.get(req, tf.path(), "text/plain", ec));
+        BEAST_EXPECT(res.body() == "plain");
+    }
+
+    void
+    testLimits()
+    {
+        temp_file t1("response_cache_test_4.txt");
+        temp_file t2("response_cache_test_5.txt");
+        t1.write(std::string(1000, '1'));
+        t2.write(std::string(1000, '2'));
+
+        response_cache::options opt;
+        opt.max_entry_bytes = 500;
+        {
+            response_cache cache(opt);
+            error_code ec;
+            auto r = cache.get(
+                make_request(), t1.path(), "text/plain", ec);
+            BEAST_EXPECT(ec == error::body_limit);
+            BEAST_EXPECT(r.empty());
+            BEAST_EXPECT(cache.size() == 0);
+        }
+
+        // The least recently used entry is evicted
+        opt.max_entry_bytes = 2000;
+        opt.max_bytes = 2000;
+        response_cache cache(opt);
+        error_code ec;
+        auto req = make_request();
+        req.target("/1");
+        cache.get(req, t1.path(), "text/plain", ec);
+        req.target("/2");
+        cache.get(req, t2.path(), "text/plain", ec);
+        BEAST_EXPECT(cache.size() == 1);
+        BEAST_EXPECT(cache.bytes() <= opt.max_bytes);
+        cache.get(req, t2.path(), "text/plain", ec);
+        BEAST_EXPECT(cache.hits() == 1);
+        cache.clear();
+        BEAST_EXPECT(cache.size() == 0);
+        BEAST_EXPECT(cache.bytes() == 0);
+    }
+
+    void
+    run() override
+    {
+        testGet();
+        testRevalidate();
+        testGzip();
+        testLimits();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,http,response_cache);
+
+} // http
+} // beast
+} // boost
@@ -0,0 +1,233 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/_experimental/websocket/send_channel.hpp>
+
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/_experimental/test/stream.hpp>
+#include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/websocket/stream.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/make_shared.hpp>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+
+class send_channel_test
+    : public unit_test::suite
+{
+public:
+    using ws_type = stream<test::stream>;
+    using channel_type = send_channel<ws_type>;
+
+    // Owns the server side stream and its channel
+    struct session
+    {
+        ws_type ws;
+        channel_type channel;
+
+        session(net::io_context& ioc, std::size_t capacity)
+            : ws(ioc)
+            , channel(ws, capacity)
+        {
+        }
+    };
+
+    static
+    boost::shared_ptr<std::string const>
+    make_message(std::string s)
+    {
+        return boost::make_shared<std::string const>(std::move(s));
+    }
+
+    // Connect the session to a client and complete the handshake
+    static
+    void
+    open(net::io_context& ioc, session& s, ws_type& wsc)
+    {
+        wsc.next_layer().connect(s.ws.next_layer());
+        wsc.async_handshake("localhost", "/", [](error_code){});
+        s.ws.async_accept([](error_code){});
+        ioc.run();
+        ioc.restart();
+    }
+
+    void
+    testSend()
+    {
+        net::io_context ioc;
+        auto sp = boost::make_shared<session>(ioc, 3);
+        BEAST_EXPECT(sp->channel.capacity() == 4);
+        ws_type wsc(ioc);
+        open(ioc, *sp, wsc);
+
+        // Messages queue up until the channel is started
+        for(int i = 0; i < 4; ++i)
+            BEAST_EXPECT(sp->channel.try_send(
+                make_message(std::to_string(i))));
+        BEAST_EXPECT(! sp->channel.try_send(make_message("x")));
+        ioc.poll();
+        ioc.restart();
+        BEAST_EXPECT(wsc.next_layer().str().empty());
+
+        sp->channel.start(sp);
+        BEAST_EXPECT(sp->channel.try_send(make_message("4")));
+        std::string result;
+        flat_buffer b;
+        for(int i = 0; i < 5; ++i)
+        {
+            wsc.async_read(b,
+                [&](error_code ec, std::size_t)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    result += buffers_to_string(b.data());
+                    b.consume(b.size());
+                });
+            ioc.run();
+            ioc.restart();
+        }
+        BEAST_EXPECT(result == "01234");
+
+        // A message sent while idle wakes the channel
+        BEAST_EXPECT(sp->channel.try_send(make_message("5")));
+        wsc.async_read(b,
+            [&](error_code ec, std::size_t)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(buffers_to_string(b.data()) == "5");
+            });
+        ioc.run();
+        ioc.restart();
+
+        // Closing stops new messages
+        sp->channel.close();
+        BEAST_EXPECT(! sp->channel.is_open());
+        BEAST_EXPECT(! sp->channel.try_send(make_message("6")));
+    }
+
+    void
+    testProducers()
+    {
+        std::size_t const producers = 4;
+        std::size_t const messages = 2000;
+
+        net::io_context ioc;
+        auto sp = boost::make_shared<session>(ioc, 16);
+        ws_type wsc(ioc);
+        open(ioc, *sp, wsc);
+        sp->channel.start(sp);
+
+        std::vector<std::size_t> next(producers, 0);
+        std::size_t received = 0;
+        flat_buffer b;
+        std::function<void()> do_read =
+            [&]
+            {
+                wsc.async_read(b,
+                    [&](error_code ec, std::size_t)
+                    {
+                        BEAST_EXPECTS(! ec, ec.message());
+                        auto const s = buffers_to_string(b.data());
+                        b.consume(b.size());
+                        auto const pos = s.find(':');
+                        auto const id = std::stoul(s.substr(0, pos));
+                        auto const n = std::stoul(s.substr(pos + 1));
+                        // Each producer's messages arrive in order
+                        BEAST_EXPECT(n == next[id]);
+                        next[id] = n + 1;
+                        if(++received < producers * messages)
+                            do_read();
+                    });
+            };
+        do_read();
+
+        // The work guard keeps run() from returning while
+        // the ring is briefly empty.
+        auto work = net::make_work_guard(ioc);
+        std::vector<std::thread> v;
+        for(std::size_t id = 0; id < producers; ++id)
+            v.emplace_back(
+                [&, id]
+                {
+                    for(std::size_t n = 0; n < messages;)
+                    {
+                        if(sp->channel.try_send(make_message(
+                                std::to_string(id) + ":" +
+                                std::to_string(n))))
+                            ++n;
+                        else
+                            std::this_thread::yield();
+                    }
+                });
+        std::thread t(
+            [&]
+            {
+                for(auto& th : v)
+                    th.join();
+                work.reset();
+            });
+        ioc.run();
+        t.join();
+        BEAST_EXPECT(received == producers * messages);
+    }
+
+    void
+    testWriteError()
+    {
+        net::io_context ioc;
+        auto sp = boost::make_shared<session>(ioc, 8);
+        {
+            // Destroying the peer makes writes fail
+            ws_type wsc(ioc);
+            open(ioc, *sp, wsc);
+        }
+        sp->channel.start(sp);
+        BEAST_EXPECT(sp->channel.try_send(make_message("*")));
+        ioc.run();
+        BEAST_EXPECT(! sp->channel.is_open());
+        BEAST_EXPECT(! sp->channel.try_send(make_message("*")));
+    }
+
+    void
+    testOwnerGone()
+    {
+        // A wakeup for a destroyed session does nothing
+        net::io_context ioc;
+        auto sp = boost::make_shared<session>(ioc, 8);
+        ws_type wsc(ioc);
+        open(ioc, *sp, wsc);
+        sp->channel.start(sp);
+        BEAST_EXPECT(sp->channel.try_send(make_message("*")));
+        sp.reset();
+        ioc.run();
+        pass();
+    }
+
+    void
+    run() override
+    {
+        testSend();
+        testProducers();
+        testWriteError();
+        testOwnerGone();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,websocket,send_channel);
+
+} // websocket
+} // beast
+} // boost
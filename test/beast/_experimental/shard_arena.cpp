@@ -0,0 +1,101 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/_experimental/core/shard_arena.hpp>
+
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/http/fields.hpp>
+#include <string>
+#include <vector>
+
+namespace boost {
+namespace beast {
+
+class shard_arena_test
+    : public unit_test::suite
+{
+public:
+    void
+    testArena()
+    {
+        shard_arena a(2);
+        auto p0 = a.allocate(10);
+        auto p1 = a.allocate(16);
+        BEAST_EXPECT(a.misses() == 2);
+        a.deallocate(p0, 10);
+        BEAST_EXPECT(a.cached_bytes() == 16);
+
+        // same size class, reused
+        auto p2 = a.allocate(3);
+        BEAST_EXPECT(p2 == p0);
+        BEAST_EXPECT(a.hits() == 1);
+        a.deallocate(p2, 3);
+        a.deallocate(p1, 16);
+        BEAST_EXPECT(a.cached_bytes() == 32);
+
+        // over the cache limit
+        auto p3 = a.allocate(12);
+        auto p4 = a.allocate(12);
+        auto p5 = a.allocate(12);
+        a.deallocate(p3, 12);
+        a.deallocate(p4, 12);
+        a.deallocate(p5, 12);
+        BEAST_EXPECT(a.cached_bytes() == 32);
+
+        // larger than any size class
+        auto p6 = a.allocate(shard_arena::max_size + 1);
+        a.deallocate(p6, shard_arena::max_size + 1);
+        BEAST_EXPECT(a.cached_bytes() == 32);
+
+        a.deallocate(nullptr, 0);
+    }
+
+    void
+    testAllocator()
+    {
+        shard_arena a;
+        shard_arena b;
+        arena_allocator<char> ca(a);
+        arena_allocator<int> ia(ca);
+        BEAST_EXPECT(ca == ia);
+        BEAST_EXPECT(ca != arena_allocator<char>(b));
+        BEAST_EXPECT(&ia.arena() == &a);
+
+        {
+            std::vector<int, arena_allocator<int>> v(ia);
+            for(int i = 0; i < 100; ++i)
+                v.push_back(i);
+            BEAST_EXPECT(v[99] == 99);
+        }
+        BEAST_EXPECT(a.cached_bytes() > 0);
+
+        // fields allocate from the arena
+        for(int i = 0; i < 2; ++i)
+        {
+            http::basic_fields<arena_allocator<char>> f(ca);
+            f.set(http::field::server, "Beast");
+            f.set(http::field::content_type, "text/plain");
+            BEAST_EXPECT(f[http::field::server] == "Beast");
+        }
+        BEAST_EXPECT(a.hits() > 0);
+    }
+
+    void
+    run() override
+    {
+        testArena();
+        testAllocator();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,core,shard_arena);
+
+} // beast
+} // boost
@@ -0,0 +1,128 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/_experimental/core/sharded_server.hpp>
+
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace boost {
+namespace beast {
+
+class sharded_server_test
+    : public unit_test::suite
+{
+public:
+    using tcp = net::ip::tcp;
+
+    void
+    doServer(bool reuse_port)
+    {
+        std::atomic<std::size_t> count(0);
+        std::atomic<bool> affine(true);
+        sharded_server::options opt;
+        opt.shards = 2;
+        opt.pin_threads = false;
+        opt.reuse_port = reuse_port;
+        sharded_server server(
+            tcp::endpoint(net::ip::make_address_v4("127.0.0.1"), 0),
+            [&](sharded_server::shard& s, tcp::socket sock)
+            {
+                if(! s.get_executor().running_in_this_thread() ||
+                    &sock.get_executor().context() != &s.context())
+                    affine = false;
+                ++count;
+                std::string const reply =
+                    std::to_string(s.index());
+                net::write(sock, net::buffer(reply));
+            },
+            opt);
+        BEAST_EXPECT(server.size() == 2);
+        if(! reuse_port)
+            BEAST_EXPECT(! server.reuse_port());
+        auto const ep = server.local_endpoint();
+        BEAST_EXPECT(ep.port() != 0);
+
+        std::thread t([&]{ server.run(); });
+        net::io_context ioc;
+        std::size_t const n = 8;
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            tcp::socket sock(ioc);
+            sock.connect(ep);
+            std::string s;
+            error_code ec;
+            net::read(sock, net::dynamic_buffer(s), ec);
+            BEAST_EXPECT(ec == net::error::eof);
+            BEAST_EXPECT(s == "0" || s == "1");
+        }
+        server.stop();
+        t.join();
+        BEAST_EXPECT(count == n);
+        BEAST_EXPECT(affine);
+        BEAST_EXPECT(
+            server.get_shard(0).accepted() +
+            server.get_shard(1).accepted() == n);
+        if(! reuse_port)
+        {
+            // round-robin across shards
+            BEAST_EXPECT(server.get_shard(0).accepted() == n / 2);
+            BEAST_EXPECT(server.get_shard(1).accepted() == n / 2);
+        }
+    }
+
+    void
+    testServer()
+    {
+        doServer(true);
+        doServer(false);
+    }
+
+    void
+    testStop()
+    {
+        // stop from within a shard, then run again
+        sharded_server::options opt;
+        opt.shards = 1;
+        opt.pin_threads = false;
+        sharded_server server(
+            tcp::endpoint(net::ip::make_address_v4("127.0.0.1"), 0),
+            [&](sharded_server::shard&, tcp::socket)
+            {
+                server.stop();
+            },
+            opt);
+        for(int i = 0; i < 2; ++i)
+        {
+            std::thread t([&]{ server.run(); });
+            net::io_context ioc;
+            tcp::socket sock(ioc);
+            sock.connect(server.local_endpoint());
+            t.join();
+        }
+        BEAST_EXPECT(server.get_shard(0).accepted() == 2);
+    }
+
+    void
+    run() override
+    {
+        testServer();
+        testStop();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,core,sharded_server);
+
+} // beast
+} // boost
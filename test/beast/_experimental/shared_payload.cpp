@@ -0,0 +1,231 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/_experimental/core/shared_payload.hpp>
+#include <boost/beast/_experimental/http/shared_payload_body.hpp>
+
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/_experimental/test/stream.hpp>
+#include <boost/beast/_experimental/websocket/send_channel.hpp>
+#include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/http/read.hpp>
+#include <boost/beast/http/write.hpp>
+#include <boost/beast/websocket/stream.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/make_shared.hpp>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace boost {
+namespace beast {
+
+class shared_payload_test
+    : public unit_test::suite
+{
+public:
+    BOOST_STATIC_ASSERT(
+        net::is_const_buffer_sequence<shared_payload>::value);
+    BOOST_STATIC_ASSERT(
+        http::is_body<http::shared_payload_body>::value);
+    BOOST_STATIC_ASSERT(
+        http::is_body_writer<http::shared_payload_body>::value);
+    BOOST_STATIC_ASSERT(
+        http::is_body_reader<http::shared_payload_body>::value);
+
+    void
+    testMembers()
+    {
+        {
+            shared_payload p;
+            BEAST_EXPECT(p.empty());
+            BEAST_EXPECT(p.size() == 0);
+            BEAST_EXPECT(p.use_count() == 0);
+            BEAST_EXPECT(buffer_bytes(p) == 0);
+            BEAST_EXPECT(p.begin() == p.end());
+        }
+        {
+            shared_payload p(string_view("Hello"));
+            BEAST_EXPECT(! p.empty());
+            BEAST_EXPECT(p.size() == 5);
+            BEAST_EXPECT(p.str() == "Hello");
+            BEAST_EXPECT(buffers_to_string(p) == "Hello");
+            BEAST_EXPECT(p.use_count() == 1);
+
+            shared_payload p2(p);
+            BEAST_EXPECT(p2.data() == p.data());
+            BEAST_EXPECT(p.use_count() == 2);
+
+            shared_payload p3(std::move(p2));
+            BEAST_EXPECT(p2.empty());
+            BEAST_EXPECT(p3.use_count() == 2);
+
+            p2 = p3;
+            BEAST_EXPECT(p.use_count() == 3);
+            p3 = shared_payload();
+            BEAST_EXPECT(p.use_count() == 2);
+            swap(p2, p3);
+            BEAST_EXPECT(p2.empty());
+            BEAST_EXPECT(p3.str() == "Hello");
+        }
+        {
+            std::array<net::const_buffer, 3> const b = {{
+                net::buffer("ab", 2),
+                net::buffer("", 0),
+                net::buffer("cde", 3)}};
+            shared_payload p(b);
+            BEAST_EXPECT(p.str() == "abcde");
+            shared_payload p2(net::const_buffer{});
+            BEAST_EXPECT(p2.empty());
+        }
+        {
+            shared_payload p(3,
+                [](net::mutable_buffer b)
+                {
+                    std::memcpy(b.data(), "xyz", b.size());
+                });
+            BEAST_EXPECT(p.str() == "xyz");
+        }
+        try
+        {
+            shared_payload p(3,
+                [](net::mutable_buffer)
+                {
+                    throw std::runtime_error("fill");
+                });
+            fail("", __FILE__, __LINE__);
+        }
+        catch(std::runtime_error const&)
+        {
+            pass();
+        }
+    }
+
+    void
+    testPool()
+    {
+        // Storage of the same size class is reused
+        void const* p0;
+        {
+            shared_payload p(std::string(100, '*'));
+            p0 = p.data();
+        }
+        {
+            shared_payload p(std::string(120, '*'));
+            BEAST_EXPECT(p.data() == p0);
+        }
+
+        // Payloads above the limit are not pooled
+        {
+            shared_payload p(std::string(
+                shared_payload::max_pooled + 1, '*'));
+            BEAST_EXPECT(p.size() == shared_payload::max_pooled + 1);
+        }
+
+        // Copies may be released on any thread
+        shared_payload const p(string_view("*"));
+        std::vector<std::thread> v;
+        for(int i = 0; i < 4; ++i)
+            v.emplace_back(
+                [&p]
+                {
+                    std::vector<shared_payload> copies;
+                    for(int j = 0; j < 10000; ++j)
+                        copies.push_back(p);
+                });
+        for(auto& t : v)
+            t.join();
+        BEAST_EXPECT(p.use_count() == 1);
+    }
+
+    void
+    testHttp()
+    {
+        net::io_context ioc;
+        test::stream ts(ioc), tr(ioc);
+        ts.connect(tr);
+
+        http::response<http::shared_payload_body> res;
+        res.result(http::status::ok);
+        res.body() = shared_payload(string_view("Hello, world!"));
+        res.prepare_payload();
+
+        // Copies of the message share the body
+        auto res2 = res;
+        BEAST_EXPECT(res2.body().data() == res.body().data());
+        http::write(ts, res2);
+
+        flat_buffer b;
+        http::response<http::shared_payload_body> res3;
+        http::read(tr, b, res3);
+        BEAST_EXPECT(res3.body().str() == "Hello, world!");
+        BEAST_EXPECT(res3.body().use_count() == 1);
+    }
+
+    void
+    testWebsocket()
+    {
+        using ws_type = websocket::stream<test::stream>;
+
+        struct session
+        {
+            ws_type ws;
+            websocket::send_channel<ws_type, shared_payload> channel;
+
+            explicit
+            session(net::io_context& ioc)
+                : ws(ioc)
+                , channel(ws)
+            {
+            }
+        };
+
+        net::io_context ioc;
+        auto sp = boost::make_shared<session>(ioc);
+        ws_type wsc(ioc);
+        wsc.next_layer().connect(sp->ws.next_layer());
+        wsc.async_handshake("localhost", "/", [](error_code){});
+        sp->ws.async_accept([](error_code){});
+        ioc.run();
+        ioc.restart();
+
+        shared_payload const p(string_view("Hello"));
+        sp->ws.write(p);
+        sp->channel.start(sp);
+        BEAST_EXPECT(sp->channel.try_send(p));
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(p.use_count() == 1);
+
+        flat_buffer b;
+        wsc.read(b);
+        BEAST_EXPECT(buffers_to_string(b.data()) == "Hello");
+        b.consume(b.size());
+        wsc.read(b);
+        BEAST_EXPECT(buffers_to_string(b.data()) == "Hello");
+    }
+
+    void
+    run() override
+    {
+        testMembers();
+        testPool();
+        testHttp();
+        testWebsocket();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,core,shared_payload);
+
+} // beast
+} // boost
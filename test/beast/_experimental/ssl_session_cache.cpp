@@ -0,0 +1,223 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/_experimental/ssl/ssl_session_cache.hpp>
+
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/ssl/ssl_stream.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include "example/common/server_certificate.hpp"
+
+namespace boost {
+namespace beast {
+
+class ssl_session_cache_test : public unit_test::suite
+{
+public:
+    using socket_type = net::ip::tcp::socket;
+
+    net::io_context ioc_;
+    net::ip::tcp::acceptor acceptor_{ioc_,
+        {net::ip::make_address("127.0.0.1"), 0}};
+
+    // Connects a new client and server over loopback, exchanges
+    // a byte so that TLS 1.3 tickets are received, and returns
+    // true if the session was resumed.
+    bool
+    connect(
+        net::ssl::context& server_ctx,
+        net::ssl::context& client_ctx,
+        ssl_client_session_store* store)
+    {
+        ssl_stream<socket_type> server(ioc_, server_ctx);
+        ssl_stream<socket_type> client(ioc_, client_ctx);
+        acceptor_.async_accept(server.next_layer(),
+            [](error_code){});
+        client.next_layer().async_connect(
+            acceptor_.local_endpoint(),
+            [](error_code){});
+        ioc_.run();
+        ioc_.restart();
+        if(store)
+            store->prepare(client, "server");
+        server.async_handshake(net::ssl::stream_base::server,
+            [&](error_code ec)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+            });
+        client.async_handshake(net::ssl::stream_base::client,
+            [&](error_code ec)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+            });
+        ioc_.run();
+        ioc_.restart();
+
+        char c = 0;
+        net::async_write(server, net::buffer("x", 1),
+            [](error_code, std::size_t){});
+        net::async_read(client, net::buffer(&c, 1),
+            [](error_code, std::size_t){});
+        ioc_.run();
+        ioc_.restart();
+        BEAST_EXPECT(c == 'x');
+
+        // Without a TLS shutdown, the session is not resumable
+        server.async_shutdown([](error_code){});
+        client.async_shutdown([](error_code){});
+        ioc_.run();
+        ioc_.restart();
+        return ::SSL_session_reused(client.native_handle()) == 1;
+    }
+
+    static
+    net::ssl::context
+    make_context(net::ssl::context::method method, bool server)
+    {
+        net::ssl::context ctx(method);
+        if(server)
+            load_server_certificate(ctx);
+        return ctx;
+    }
+
+    void
+    testTickets(net::ssl::context::method method)
+    {
+        ssl_session_cache::options opt;
+        opt.previous_ticket_keys = 1;
+        ssl_session_cache cache(opt);
+        ssl_client_session_store store;
+        auto server_ctx = make_context(method, true);
+        auto client_ctx = make_context(method, false);
+        cache.install(server_ctx);
+        store.install(client_ctx);
+
+        BEAST_EXPECT(! connect(server_ctx, client_ctx, &store));
+        BEAST_EXPECT(store.misses() == 1);
+        BEAST_EXPECT(store.size() == 1);
+        BEAST_EXPECT(connect(server_ctx, client_ctx, &store));
+        BEAST_EXPECT(store.hits() == 1);
+        BEAST_EXPECT(store.offered() == 1);
+        BEAST_EXPECT(cache.hits() == 1);
+
+        // The previous key is still accepted, and the
+        // ticket is replaced with one under the new key.
+        cache.rotate_ticket_key();
+        BEAST_EXPECT(connect(server_ctx, client_ctx, &store));
+        BEAST_EXPECT(cache.hits() == 2);
+        cache.rotate_ticket_key();
+        BEAST_EXPECT(connect(server_ctx, client_ctx, &store));
+        BEAST_EXPECT(cache.hits() == 3);
+
+        // Older keys are not
+        cache.rotate_ticket_key();
+        cache.rotate_ticket_key();
+        BEAST_EXPECT(! connect(server_ctx, client_ctx, &store));
+        BEAST_EXPECT(cache.misses() == 1);
+        BEAST_EXPECT(store.offered() == 4);
+        BEAST_EXPECT(store.hits() == 3);
+        BEAST_EXPECT(connect(server_ctx, client_ctx, &store));
+        BEAST_EXPECT(store.hits() == 4);
+
+        // Without a kept session there is nothing to offer
+        store.erase("server");
+        BEAST_EXPECT(store.size() == 0);
+        BEAST_EXPECT(! connect(server_ctx, client_ctx, &store));
+    }
+
+    void
+    testSharedKey()
+    {
+        // Two servers with the same ticket key
+        unsigned char key[ssl_session_cache::ticket_key_size];
+        for(std::size_t i = 0; i < sizeof(key); ++i)
+            key[i] = static_cast<unsigned char>(i);
+        ssl_session_cache cache1;
+        ssl_session_cache cache2;
+        cache1.set_ticket_key(key);
+        cache2.set_ticket_key(key);
+        ssl_client_session_store store;
+        auto ctx1 = make_context(net::ssl::context::tlsv12, true);
+        auto ctx2 = make_context(net::ssl::context::tlsv12, true);
+        auto client_ctx = make_context(net::ssl::context::tlsv12, false);
+        cache1.install(ctx1);
+        cache2.install(ctx2);
+        store.install(client_ctx);
+        BEAST_EXPECT(! connect(ctx1, client_ctx, &store));
+        BEAST_EXPECT(connect(ctx2, client_ctx, &store));
+        BEAST_EXPECT(cache2.hits() == 1);
+    }
+
+    void
+    testSessionIds()
+    {
+        ssl_session_cache::options opt;
+        opt.tickets = false;
+        opt.max_sessions = 2;
+        ssl_session_cache cache(opt);
+        ssl_client_session_store store;
+        auto server_ctx = make_context(net::ssl::context::tlsv12, true);
+        auto client_ctx = make_context(net::ssl::context::tlsv12, false);
+        cache.install(server_ctx);
+        store.install(client_ctx);
+
+        BEAST_EXPECT(! connect(server_ctx, client_ctx, &store));
+        BEAST_EXPECT(cache.size() == 1);
+        BEAST_EXPECT(connect(server_ctx, client_ctx, &store));
+        BEAST_EXPECT(cache.hits() == 1);
+
+        // Evicted sessions are not resumed
+        BEAST_EXPECT(! connect(server_ctx, client_ctx, nullptr));
+        BEAST_EXPECT(! connect(server_ctx, client_ctx, nullptr));
+        BEAST_EXPECT(cache.size() == 2);
+        BEAST_EXPECT(! connect(server_ctx, client_ctx, &store));
+        BEAST_EXPECT(cache.misses() == 1);
+
+        cache.clear();
+        BEAST_EXPECT(cache.size() == 0);
+        BEAST_EXPECT(! connect(server_ctx, client_ctx, &store));
+        BEAST_EXPECT(cache.misses() == 2);
+    }
+
+    void
+    testNoResumption()
+    {
+        // A context without the cache does not resume
+        auto server_ctx = make_context(net::ssl::context::tlsv12, true);
+        auto client_ctx = make_context(net::ssl::context::tlsv12, false);
+        ::SSL_CTX_set_options(server_ctx.native_handle(), SSL_OP_NO_TICKET);
+        ::SSL_CTX_set_session_cache_mode(
+            server_ctx.native_handle(), SSL_SESS_CACHE_OFF);
+        ssl_client_session_store store(1);
+        store.install(client_ctx);
+        BEAST_EXPECT(! connect(server_ctx, client_ctx, &store));
+        BEAST_EXPECT(! connect(server_ctx, client_ctx, &store));
+        BEAST_EXPECT(store.hits() == 0);
+        BEAST_EXPECT(store.offered() + store.misses() == 2);
+    }
+
+    void
+    run() override
+    {
+        testTickets(net::ssl::context::tlsv12);
+        testTickets(net::ssl::context::tlsv13);
+        testSharedKey();
+        testSessionIds();
+        testNoResumption();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,ssl,ssl_session_cache);
+
+} // beast
+} // boost
@@ -0,0 +1,357 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/_experimental/core/work_stealing_pool.hpp>
+
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/core/basic_stream.hpp>
+#include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/websocket/stream.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+
+namespace boost {
+namespace beast {
+
+class work_stealing_pool_test
+    : public unit_test::suite
+{
+public:
+    using executor_type = work_stealing_pool::executor_type;
+
+    BOOST_STATIC_ASSERT(net::execution::is_executor<executor_type>::value);
+
+    void
+    testOrdering()
+    {
+        work_stealing_pool pool(4);
+        BEAST_EXPECT(pool.size() == 4);
+        auto const ex = pool.make_executor();
+        int const n = 10000;
+        std::atomic<int> running(0);
+        int next = 0;
+        bool ordered = true;
+        bool exclusive = true;
+        std::promise<void> done;
+        for(int i = 0; i < n; ++i)
+            net::post(ex,
+                [&, i]
+                {
+                    if(++running != 1)
+                        exclusive = false;
+                    if(! ex.running_in_this_thread())
+                        exclusive = false;
+                    if(next++ != i)
+                        ordered = false;
+                    --running;
+                    if(i == n - 1)
+                        done.set_value();
+                });
+        done.get_future().wait();
+        BEAST_EXPECT(next == n);
+        BEAST_EXPECT(ordered);
+        BEAST_EXPECT(exclusive);
+        BEAST_EXPECT(! ex.running_in_this_thread());
+    }
+
+    void
+    testDispatch()
+    {
+        work_stealing_pool pool(2);
+        auto const ex = pool.make_executor();
+        auto const other = pool.make_executor();
+        BEAST_EXPECT(ex == ex);
+        BEAST_EXPECT(ex != other);
+        std::promise<void> done;
+        net::post(ex,
+            [&]
+            {
+                // inline within the session
+                bool invoked = false;
+                net::dispatch(ex, [&]{ invoked = true; });
+                BEAST_EXPECT(invoked);
+
+                // never inline through post
+                invoked = false;
+                net::post(ex, [&]{ done.set_value(); });
+                BEAST_EXPECT(! invoked);
+
+                // other sessions are not inline
+                bool other_invoked = false;
+                net::dispatch(other, [&]{ other_invoked = true; });
+                BEAST_EXPECT(! other_invoked);
+            });
+        done.get_future().wait();
+    }
+
+    void
+    testStealing()
+    {
+        work_stealing_pool pool(2, 1);
+        auto const ex0 = pool.make_executor();  // worker 0
+        auto const ex1 = pool.make_executor();  // worker 1
+        auto const ex2 = pool.make_executor();  // worker 0
+        (void)ex1;
+
+        // Occupy worker 0, then queue a second session on it
+        std::promise<void> release;
+        auto released = release.get_future().share();
+        std::promise<std::thread::id> blocked;
+        std::promise<std::thread::id> stolen;
+        net::post(ex0,
+            [&]
+            {
+                blocked.set_value(std::this_thread::get_id());
+                released.wait();
+            });
+        auto const t0 = blocked.get_future().get();
+        net::post(ex2,
+            [&]
+            {
+                stolen.set_value(std::this_thread::get_id());
+            });
+        auto f = stolen.get_future();
+        BEAST_EXPECT(f.wait_for(std::chrono::seconds(10)) ==
+            std::future_status::ready);
+        BEAST_EXPECT(f.get() != t0);
+        BEAST_EXPECT(pool.steals() >= 1);
+        release.set_value();
+    }
+
+    void
+    testPendingStolen()
+    {
+        work_stealing_pool pool(2, 1);
+        auto const ex0 = pool.make_executor();  // worker 0
+        auto const ex1 = pool.make_executor();  // worker 1
+        auto const ex2 = pool.make_executor();  // worker 0
+        (void)ex1;
+
+        // A session waiting on its timer may still be taken,
+        // the shared reactor delivers the wait wherever it runs.
+        net::basic_waitable_timer<
+            std::chrono::steady_clock,
+            net::wait_traits<std::chrono::steady_clock>,
+            executor_type> timer(ex2);
+        timer.expires_after(std::chrono::hours(1));
+        std::promise<std::thread::id> waited;
+        timer.async_wait(
+            [&](error_code ec)
+            {
+                BEAST_EXPECT(ec == net::error::operation_aborted);
+                waited.set_value(std::this_thread::get_id());
+            });
+
+        std::promise<void> release;
+        auto released = release.get_future().share();
+        std::promise<std::thread::id> blocked;
+        std::promise<std::thread::id> ran;
+        net::post(ex0,
+            [&]
+            {
+                blocked.set_value(std::this_thread::get_id());
+                released.wait();
+            });
+        auto const t0 = blocked.get_future().get();
+        net::post(ex2,
+            [&]
+            {
+                ran.set_value(std::this_thread::get_id());
+                timer.cancel();
+            });
+        auto f = ran.get_future();
+        BEAST_EXPECT(f.wait_for(std::chrono::seconds(10)) ==
+            std::future_status::ready);
+        auto const t1 = f.get();
+        BEAST_EXPECT(t1 != t0);
+        BEAST_EXPECT(pool.steals() >= 1);
+
+        // The completion follows the session to its new worker
+        auto g = waited.get_future();
+        BEAST_EXPECT(g.wait_for(std::chrono::seconds(10)) ==
+            std::future_status::ready);
+        BEAST_EXPECT(g.get() == t1);
+        release.set_value();
+    }
+
+    template<class T>
+    struct counted_allocator
+    {
+        using value_type = T;
+
+        std::atomic<int>* n;
+
+        explicit
+        counted_allocator(std::atomic<int>& n_) noexcept
+            : n(&n_)
+        {
+        }
+
+        template<class U>
+        counted_allocator(counted_allocator<U> const& other) noexcept
+            : n(other.n)
+        {
+        }
+
+        T*
+        allocate(std::size_t size)
+        {
+            ++*n;
+            return std::allocator<T>{}.allocate(size);
+        }
+
+        void
+        deallocate(T* p, std::size_t size) noexcept
+        {
+            std::allocator<T>{}.deallocate(p, size);
+        }
+
+        template<class U>
+        friend
+        bool
+        operator==(
+            counted_allocator const& lhs,
+            counted_allocator<U> const& rhs) noexcept
+        {
+            return lhs.n == rhs.n;
+        }
+
+        template<class U>
+        friend
+        bool
+        operator!=(
+            counted_allocator const& lhs,
+            counted_allocator<U> const& rhs) noexcept
+        {
+            return lhs.n != rhs.n;
+        }
+    };
+
+    struct allocating_handler
+    {
+        using allocator_type = counted_allocator<char>;
+
+        std::atomic<int>* n;
+        std::promise<void>* done;
+
+        allocator_type
+        get_allocator() const noexcept
+        {
+            return allocator_type(*n);
+        }
+
+        void
+        operator()() const
+        {
+            done->set_value();
+        }
+    };
+
+    void
+    testAllocator()
+    {
+        // Queued functions use the handler's allocator
+        work_stealing_pool pool(1);
+        auto const ex = pool.make_executor();
+        std::atomic<int> n(0);
+        std::promise<void> done;
+        net::post(ex, allocating_handler{&n, &done});
+        done.get_future().wait();
+        BEAST_EXPECT(n == 1);
+    }
+
+    void
+    testWebsocket()
+    {
+        using tcp = net::ip::tcp;
+        using stream_type = websocket::stream<
+            basic_stream<tcp, executor_type>>;
+
+        work_stealing_pool pool(2);
+        net::io_context ioc;
+        tcp::acceptor acceptor(ioc, tcp::endpoint(
+            net::ip::make_address_v4("127.0.0.1"), 0));
+
+        stream_type client(pool.make_executor());
+        std::promise<std::string> reply;
+        flat_buffer cb;
+        client.next_layer().async_connect(acceptor.local_endpoint(),
+            [&](error_code ec)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                client.async_handshake("localhost", "/",
+                [&](error_code ec)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    client.async_write(net::buffer("Hello", 5),
+                    [&](error_code ec, std::size_t)
+                    {
+                        BEAST_EXPECTS(! ec, ec.message());
+                        client.async_read(cb,
+                        [&](error_code ec, std::size_t)
+                        {
+                            BEAST_EXPECTS(! ec, ec.message());
+                            reply.set_value(buffers_to_string(cb.data()));
+                        });
+                    });
+                });
+            });
+
+        stream_type server(acceptor.accept(pool.make_executor()));
+        flat_buffer sb;
+        server.async_accept(
+            [&](error_code ec)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                server.async_read(sb,
+                [&](error_code ec, std::size_t)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    server.async_write(sb.data(),
+                    [&](error_code ec, std::size_t)
+                    {
+                        BEAST_EXPECTS(! ec, ec.message());
+                    });
+                });
+            });
+
+        auto f = reply.get_future();
+        BEAST_EXPECT(f.wait_for(std::chrono::seconds(10)) ==
+            std::future_status::ready);
+        BEAST_EXPECT(f.get() == "Hello");
+        pool.stop();
+        pool.join();
+    }
+
+    void
+    run() override
+    {
+        testOrdering();
+        testDispatch();
+        testStealing();
+        testPendingStolen();
+        testAllocator();
+        testWebsocket();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,core,work_stealing_pool);
+
+} // beast
+} // boost
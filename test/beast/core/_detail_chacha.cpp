@@ -0,0 +1,121 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/core/detail/chacha.hpp>
+
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace detail {
+
+class chacha_test : public beast::unit_test::suite
+{
+public:
+    static
+    std::uint32_t
+    rotl(std::uint32_t x, int n)
+    {
+        return (x << n) | (x >> (32 - n));
+    }
+
+    static
+    void
+    quarterround(std::uint32_t* x, int a, int b, int c, int d)
+    {
+        x[a] += x[b]; x[d] = rotl(x[d] ^ x[a], 16);
+        x[c] += x[d]; x[b] = rotl(x[b] ^ x[c], 12);
+        x[a] += x[b]; x[d] = rotl(x[d] ^ x[a],  8);
+        x[c] += x[d]; x[b] = rotl(x[b] ^ x[c],  7);
+    }
+
+    // One block computed the straightforward way
+    static
+    void
+    reference(
+        std::uint32_t* out,
+        std::uint32_t const* key,
+        std::uint64_t counter)
+    {
+        std::uint32_t input[16] = {
+            0x61707865, 0x3320646e, 0x79622d32, 0x6b206574 };
+        for(int i = 0; i < 8; ++i)
+            input[4 + i] = key[i];
+        input[12] = counter & 0xffffffffu;
+        input[13] = counter >> 32;
+        input[14] = input[15] = 0xdeadbeef;
+        std::copy(input, input + 16, out);
+        for(int i = 0; i < 20; i += 2)
+        {
+            quarterround(out, 0, 4,  8, 12);
+            quarterround(out, 1, 5,  9, 13);
+            quarterround(out, 2, 6, 10, 14);
+            quarterround(out, 3, 7, 11, 15);
+            quarterround(out, 0, 5, 10, 15);
+            quarterround(out, 1, 6, 11, 12);
+            quarterround(out, 2, 7,  8, 13);
+            quarterround(out, 3, 4,  9, 14);
+        }
+        for(int i = 0; i < 16; ++i)
+            out[i] += input[i];
+    }
+
+    void
+    testReference()
+    {
+        std::uint32_t const seed[8] = {
+            1, 2, 3, 4, 5, 6, 7, 8 };
+        std::uint64_t const stream = 0x0000000900000010;
+        std::uint32_t key[8];
+        std::copy(seed, seed + 8, key);
+        key[6] += 0x10;
+        key[7] += 0x09;
+
+        chacha<20> g{seed, stream};
+        // Four refills of four interleaved blocks
+        for(std::uint64_t batch = 0; batch < 4; ++batch)
+        {
+            std::uint32_t blocks[4][16];
+            for(int l = 0; l < 4; ++l)
+                reference(blocks[l], key, batch * 4 + l);
+            for(int i = 0; i < 16; ++i)
+                for(int l = 0; l < 4; ++l)
+                    BEAST_EXPECT(g() == blocks[l][i]);
+        }
+    }
+
+    void
+    testDistinct()
+    {
+        std::uint32_t const seed[8] = {};
+        chacha<20> g{seed, 0};
+        std::vector<std::uint32_t> v(1024);
+        for(auto& x : v)
+            x = g();
+        std::sort(v.begin(), v.end());
+        BEAST_EXPECT(std::adjacent_find(
+            v.begin(), v.end()) == v.end());
+    }
+
+    void
+    run() override
+    {
+        testReference();
+        testDistinct();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,core,chacha);
+
+} // detail
+} // beast
+} // boost
@@ -9,3 +9,493 @@
 
 // Test that header file is self-contained.
 #include <boost/beast/ssl/ssl_stream.hpp>
+
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include "example/common/server_certificate.hpp"
+#include <openssl/evp.h>
+#include <string>
+#include <vector>
+
+namespace boost {
+namespace beast {
+
+class ssl_stream_test : public unit_test::suite
+{
+public:
+    using socket_type = net::ip::tcp::socket;
+
+    // A connected pair over loopback, after the handshake
+    struct connection
+    {
+        net::io_context ioc;
+        net::ssl::context server_ctx;
+        net::ssl::context client_ctx;
+        ssl_stream<socket_type> server;
+        ssl_stream<tcp_stream> client;
+
+        // Streams take their settings from the
+        // context when they are constructed.
+        static
+        net::ssl::context
+        make_context(
+            net::ssl::context::method method,
+            char const* ciphers,
+            bool server)
+        {
+            net::ssl::context ctx(method);
+            if(server)
+                load_server_certificate(ctx);
+            if(ciphers)
+                SSL_CTX_set_cipher_list(ctx.native_handle(), ciphers);
+            return ctx;
+        }
+
+        connection(
+            net::ssl::context::method method,
+            char const* ciphers)
+            : server_ctx(make_context(method, nullptr, true))
+            , client_ctx(make_context(method, ciphers, false))
+            , server(ioc, server_ctx)
+            , client(ioc, client_ctx)
+        {
+
+            net::ip::tcp::acceptor a(ioc,
+                {net::ip::make_address("127.0.0.1"), 0});
+            a.async_accept(server.next_layer(),
+                [](error_code){});
+            client.next_layer().async_connect(
+                a.local_endpoint(),
+                [](error_code){});
+            ioc.run();
+            ioc.restart();
+
+            server.async_handshake(
+                net::ssl::stream_base::server,
+                [](error_code ec)
+                {
+                    if(ec)
+                        throw system_error{ec};
+                });
+            client.async_handshake(
+                net::ssl::stream_base::client,
+                [](error_code ec)
+                {
+                    if(ec)
+                        throw system_error{ec};
+                });
+            ioc.run();
+            ioc.restart();
+        }
+    };
+
+    static
+    EVP_CIPHER const*
+    evp_cipher(int nid)
+    {
+        switch(nid)
+        {
+        case NID_aes_128_gcm: return EVP_aes_128_gcm();
+        case NID_aes_256_gcm: return EVP_aes_256_gcm();
+        default:              return EVP_chacha20_poly1305();
+        }
+    }
+
+    // Protects one TLS 1.2 application data record, or opens
+    // one when `seal` is false, as the kernel would.
+    static
+    std::string
+    transform(
+        detail::ktls_keys const& k,
+        std::string const& in,
+        bool seal)
+    {
+        unsigned char seq[8];
+        for(int i = 0; i < 8; ++i)
+            seq[i] = static_cast<unsigned char>(k.seq >> (56 - 8 * i));
+        bool const gcm = k.iv_size == 4;
+        std::size_t const overhead = gcm ? 8 : 0;
+        unsigned char nonce[12];
+        std::string body;
+        unsigned char tag[16];
+        if(seal)
+        {
+            body = in;
+        }
+        else
+        {
+            std::size_t const n = in.size() - 5 - overhead - 16;
+            body = in.substr(5 + overhead, n);
+            std::memcpy(tag, in.data() + in.size() - 16, 16);
+        }
+        if(gcm)
+        {
+            std::memcpy(nonce, k.iv, 4);
+            std::memcpy(nonce + 4, seal ? seq :
+                reinterpret_cast<unsigned char const*>(
+                    in.data() + 5), 8);
+        }
+        else
+        {
+            std::memcpy(nonce, k.iv, 12);
+            for(int i = 0; i < 8; ++i)
+                nonce[4 + i] ^= seq[i];
+        }
+        unsigned char aad[13];
+        std::memcpy(aad, seq, 8);
+        aad[8] = 23;
+        aad[9] = 3;
+        aad[10] = 3;
+        aad[11] = static_cast<unsigned char>(body.size() >> 8);
+        aad[12] = static_cast<unsigned char>(body.size());
+
+        EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+        int len;
+        std::string out(body.size(), '\0');
+        auto const p = reinterpret_cast<unsigned char*>(&out[0]);
+        EVP_CipherInit_ex(ctx, evp_cipher(k.nid),
+            nullptr, nullptr, nullptr, seal ? 1 : 0);
+        EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_IVLEN, 12, nullptr);
+        EVP_CipherInit_ex(ctx, nullptr, nullptr, k.key, nonce, -1);
+        EVP_CipherUpdate(ctx, nullptr, &len, aad, sizeof(aad));
+        EVP_CipherUpdate(ctx, p, &len,
+            reinterpret_cast<unsigned char const*>(body.data()),
+            static_cast<int>(body.size()));
+        if(! seal)
+            EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, 16, tag);
+        bool const ok = EVP_CipherFinal_ex(ctx, p + len, &len) > 0;
+        if(seal)
+            EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, 16, tag);
+        EVP_CIPHER_CTX_free(ctx);
+        if(! seal)
+            return ok ? out : "<bad record>";
+
+        std::size_t const size = overhead + out.size() + 16;
+        std::string rec;
+        rec += '\x17';
+        rec += '\x03';
+        rec += '\x03';
+        rec += static_cast<char>(size >> 8);
+        rec += static_cast<char>(size);
+        if(gcm)
+            rec.append(reinterpret_cast<char const*>(seq), 8);
+        rec += out;
+        rec.append(reinterpret_cast<char const*>(tag), 16);
+        return rec;
+    }
+
+    void
+    testKtlsKeys(char const* ciphers, int nid)
+    {
+        connection c(net::ssl::context::tlsv12, ciphers);
+        detail::ktls_params cp;
+        detail::ktls_params sp;
+        error_code ec;
+        detail::ktls_derive(c.client.native_handle(), cp, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        detail::ktls_derive(c.server.native_handle(), sp, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(cp.tx.nid == nid);
+        BEAST_EXPECT(cp.tx.seq == 1 && cp.rx.seq == 1);
+        BEAST_EXPECT(std::memcmp(
+            cp.tx.key, sp.rx.key, cp.tx.key_size) == 0);
+        BEAST_EXPECT(std::memcmp(
+            cp.rx.iv, sp.tx.iv, cp.rx.iv_size) == 0);
+
+        // A record protected with the client's keys,
+        // written to the socket, is read by OpenSSL.
+        net::write(c.client.next_layer(), net::buffer(
+            transform(cp.tx, "Hello", true)));
+        std::string s(5, '\0');
+        net::read(c.server, net::buffer(&s[0], s.size()));
+        BEAST_EXPECT(s == "Hello");
+
+        // A record from OpenSSL opens with the client's keys
+        net::write(c.server, net::buffer("World", 5));
+        std::string rec(5 + (cp.rx.iv_size == 4 ? 8 : 0) + 5 + 16, '\0');
+        net::read(c.client.next_layer(), net::buffer(&rec[0], rec.size()));
+        BEAST_EXPECT(transform(cp.rx, rec, false) == "World");
+    }
+
+    void
+    testKtlsKeys()
+    {
+        testKtlsKeys("ECDHE-RSA-AES128-GCM-SHA256", NID_aes_128_gcm);
+        testKtlsKeys("ECDHE-RSA-AES256-GCM-SHA384", NID_aes_256_gcm);
+        testKtlsKeys("ECDHE-RSA-CHACHA20-POLY1305", NID_chacha20_poly1305);
+    }
+
+    void
+    testEnableKtls()
+    {
+        connection c(net::ssl::context::tlsv12,
+            "ECDHE-RSA-AES128-GCM-SHA256");
+        BEAST_EXPECT(! c.client.is_ktls_tx());
+        error_code ec1;
+        error_code ec2;
+        bool const offloaded =
+            c.client.enable_ktls(ec1) && c.server.enable_ktls(ec2);
+        if(offloaded)
+        {
+            log << "kernel TLS offload is available" << std::endl;
+            BEAST_EXPECT(c.client.is_ktls_tx());
+            BEAST_EXPECT(c.server.is_ktls_tx());
+        }
+        else
+        {
+            // The stream falls back to OpenSSL
+            log << "kernel TLS offload is unavailable: " <<
+                (ec1 ? ec1 : ec2).message() << std::endl;
+            BEAST_EXPECT(ec1 || ec2);
+            BEAST_EXPECT(! c.client.is_ktls_tx());
+            BEAST_EXPECT(! c.client.is_ktls_rx());
+        }
+
+        std::string s(5, '\0');
+        net::write(c.client, net::buffer("Hello", 5));
+        net::read(c.server, net::buffer(&s[0], s.size()));
+        BEAST_EXPECT(s == "Hello");
+
+        net::async_write(c.server, net::buffer("World", 5),
+            [](error_code ec, std::size_t)
+            {
+                if(ec)
+                    throw system_error{ec};
+            });
+        net::async_read(c.client, net::buffer(&s[0], s.size()),
+            [](error_code ec, std::size_t)
+            {
+                if(ec)
+                    throw system_error{ec};
+            });
+        c.ioc.run();
+        BEAST_EXPECT(s == "World");
+
+        // The offloaded read and shutdown paths need the kernel's
+        // tls module, so they only run where it is loaded.
+        if(offloaded)
+        {
+            error_code ec;
+            c.client.shutdown(ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            c.server.read_some(net::buffer(&s[0], s.size()), ec);
+            BEAST_EXPECTS(ec == net::error::eof, ec.message());
+
+            bool invoked = false;
+            c.server.async_shutdown(
+                [&](error_code ec)
+                {
+                    invoked = true;
+                    BEAST_EXPECTS(! ec, ec.message());
+                });
+            c.client.async_read_some(net::buffer(&s[0], s.size()),
+                [](error_code ec, std::size_t)
+                {
+                    if(ec != net::error::eof)
+                        throw system_error{ec};
+                });
+            c.ioc.restart();
+            c.ioc.run();
+            BEAST_EXPECT(invoked);
+        }
+    }
+
+    void
+    testKtlsShutdownWait()
+    {
+    #if BOOST_BEAST_HAS_KTLS
+        // A plain TCP socket ignores the record type, so the
+        // alert arrives as two bytes. This runs the waiting
+        // path of the asynchronous shutdown without the tls
+        // module: with the send buffer full, the operation
+        // must wait for room rather than block the thread.
+        net::io_context ioc;
+        net::ip::tcp::acceptor a(ioc,
+            {net::ip::make_address("127.0.0.1"), 0});
+        socket_type s1(ioc);
+        socket_type s2(ioc);
+        s1.connect(a.local_endpoint());
+        a.accept(s2);
+        s1.set_option(net::socket_base::send_buffer_size(4096));
+        s1.non_blocking(true);
+        std::string const fill(65536, '*');
+        std::size_t filled = 0;
+        for(;;)
+        {
+            error_code ec;
+            auto const n = s1.write_some(net::buffer(fill), ec);
+            if(ec == net::error::would_block)
+                break;
+            BEAST_EXPECTS(! ec, ec.message());
+            if(ec)
+                return;
+            filled += n;
+        }
+
+        bool invoked = false;
+        detail::run_ktls_shutdown_op{}(
+            [&](error_code ec)
+            {
+                invoked = true;
+                BEAST_EXPECTS(! ec, ec.message());
+            },
+            &s1);
+        ioc.poll();
+        BEAST_EXPECT(! invoked);
+
+        // Drain the peer until the alert arrives
+        std::string got;
+        std::string buf(65536, '\0');
+        while(got.size() < filled + 2)
+        {
+            auto const n = s2.read_some(net::buffer(&buf[0], buf.size()));
+            got.append(buf.data(), n);
+            ioc.poll();
+        }
+        ioc.run();
+        BEAST_EXPECT(invoked);
+        BEAST_EXPECT(got.size() == filled + 2);
+        BEAST_EXPECT(got.substr(filled) == std::string("\x01\x00", 2));
+    #endif
+    }
+
+    void
+    testKtlsUnsupported()
+    {
+        // TLS 1.3 keys are not available
+        {
+            connection c(net::ssl::context::tlsv13, nullptr);
+            error_code ec;
+            BEAST_EXPECT(! c.client.enable_ktls(ec));
+            BEAST_EXPECTS(ec == net::error::operation_not_supported,
+                ec.message());
+            BEAST_EXPECT(! c.client.enable_ktls());
+            net::write(c.client, net::buffer("Hello", 5));
+            std::string s(5, '\0');
+            net::read(c.server, net::buffer(&s[0], s.size()));
+            BEAST_EXPECT(s == "Hello");
+        }
+
+        // Nor is a cipher the kernel lacks
+        {
+            connection c(net::ssl::context::tlsv12,
+                "ECDHE-RSA-AES128-SHA256");
+            error_code ec;
+            BEAST_EXPECT(! c.server.enable_ktls(ec));
+            BEAST_EXPECTS(ec == net::error::operation_not_supported,
+                ec.message());
+        }
+
+        // Nor a stream without a socket
+        {
+            net::io_context ioc;
+            net::ssl::context ctx(net::ssl::context::tlsv12);
+            ssl_stream<socket_type> ss(ioc, ctx);
+            error_code ec;
+            BEAST_EXPECT(! ss.enable_ktls(ec));
+            BEAST_EXPECTS(ec == net::error::operation_not_supported,
+                ec.message());
+        }
+    }
+
+    // Records the direction of each install, and fails some
+    struct fake_ktls_socket
+    {
+        bool fail_rx;
+        bool fail_tx;
+        std::vector<bool> installed;
+
+        void
+        attach(error_code& ec)
+        {
+            ec = {};
+        }
+
+        void
+        install(bool send, detail::ktls_keys const&, error_code& ec)
+        {
+            installed.push_back(send);
+            if(send ? fail_tx : fail_rx)
+                ec = net::error::operation_not_supported;
+            else
+                ec = {};
+        }
+    };
+
+    void
+    testKtlsPartial()
+    {
+        // When the kernel cannot decrypt, nothing is installed
+        {
+            connection c(net::ssl::context::tlsv12,
+                "ECDHE-RSA-AES128-GCM-SHA256");
+            fake_ktls_socket sock{true, false, {}};
+            bool tx = false;
+            bool rx = false;
+            error_code ec;
+            detail::ktls_enable(
+                c.server.native_handle(), sock, tx, rx, ec);
+            BEAST_EXPECT(ec == net::error::operation_not_supported);
+            BEAST_EXPECT(! tx);
+            BEAST_EXPECT(! rx);
+            BEAST_EXPECT(sock.installed == std::vector<bool>{false});
+            BEAST_EXPECT(SSL_get_shutdown(
+                c.server.native_handle()) == 0);
+
+            // OpenSSL keeps both directions
+            net::write(c.server, net::buffer("Hello", 5));
+            std::string s(5, '\0');
+            net::read(c.client, net::buffer(&s[0], s.size()));
+            BEAST_EXPECT(s == "Hello");
+            net::write(c.client, net::buffer("World", 5));
+            net::read(c.server, net::buffer(&s[0], s.size()));
+            BEAST_EXPECT(s == "World");
+        }
+
+        // When it cannot encrypt, OpenSSL keeps sending but
+        // shuts down without reading the peer's close_notify
+        {
+            connection c(net::ssl::context::tlsv12,
+                "ECDHE-RSA-AES128-GCM-SHA256");
+            fake_ktls_socket sock{false, true, {}};
+            bool tx = false;
+            bool rx = false;
+            error_code ec;
+            detail::ktls_enable(
+                c.server.native_handle(), sock, tx, rx, ec);
+            BEAST_EXPECT(ec == net::error::operation_not_supported);
+            BEAST_EXPECT(! tx);
+            BEAST_EXPECT(rx);
+            BEAST_EXPECT((sock.installed ==
+                std::vector<bool>{false, true}));
+
+            net::write(c.server, net::buffer("Hello", 5));
+            c.server.shutdown(ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            std::string s(5, '\0');
+            net::read(c.client, net::buffer(&s[0], s.size()));
+            BEAST_EXPECT(s == "Hello");
+            c.client.read_some(net::buffer(&s[0], s.size()), ec);
+            BEAST_EXPECTS(ec == net::error::eof, ec.message());
+        }
+    }
+
+    void
+    run() override
+    {
+        testKtlsKeys();
+        testEnableKtls();
+        testKtlsUnsupported();
+        testKtlsShutdownWait();
+        testKtlsPartial();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,ssl,ssl_stream);
+
+} // beast
+} // boost
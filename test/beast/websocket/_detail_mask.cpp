@@ -0,0 +1,124 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/websocket/detail/mask.hpp>
+
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <array>
+#include <string>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+namespace detail {
+
+class mask_test
+    : public beast::unit_test::suite
+{
+public:
+    static
+    std::string
+    reference(std::string const& s, std::uint32_t key)
+    {
+        prepared_key k;
+        prepare_key(k, key);
+        std::string r = s;
+        for(std::size_t i = 0; i < r.size(); ++i)
+            r[i] = static_cast<char>(
+                static_cast<unsigned char>(r[i]) ^ k[i % 4]);
+        return r;
+    }
+
+    void
+    testMaskInplace()
+    {
+        std::string const s =
+            "Hello, world! The quick brown fox.";
+        for(std::size_t n = 0; n <= s.size(); ++n)
+        {
+            prepared_key key;
+            prepare_key(key, 0xdeadbeef);
+            std::string r = s;
+            // Mask in two pieces, carrying the key state
+            mask_inplace(net::buffer(&r[0], n), key);
+            mask_inplace(net::buffer(&r[n], s.size() - n), key);
+            BEAST_EXPECT(r == reference(s, 0xdeadbeef));
+        }
+    }
+
+    void
+    testMaskCopy()
+    {
+        std::string const s =
+            "Hello, world! The quick brown fox.";
+        auto const expected = reference(s, 0x12345678);
+        for(std::size_t i = 0; i <= s.size(); ++i)
+        {
+            for(std::size_t j = 0; j <= s.size(); ++j)
+            {
+                // Source and destination split at different points
+                std::array<net::const_buffer, 2> src{{
+                    net::buffer(s.data(), i),
+                    net::buffer(s.data() + i, s.size() - i)}};
+                std::string r(s.size(), '*');
+                std::array<net::mutable_buffer, 2> dest{{
+                    net::buffer(&r[0], j),
+                    net::buffer(&r[j], r.size() - j)}};
+                prepared_key key;
+                prepare_key(key, 0x12345678);
+                auto const n = mask_copy(
+                    dest, src, s.size(), key);
+                BEAST_EXPECT(n == s.size());
+                BEAST_EXPECT(r == expected);
+            }
+        }
+
+        // limited by n, carrying the key state
+        {
+            std::string r(s.size(), '*');
+            prepared_key key;
+            prepare_key(key, 0x12345678);
+            auto n = mask_copy(net::buffer(&r[0], r.size()),
+                net::buffer(s), 5, key);
+            BEAST_EXPECT(n == 5);
+            n = mask_copy(net::buffer(&r[5], r.size() - 5),
+                net::buffer(s.data() + 5, s.size() - 5),
+                    s.size(), key);
+            BEAST_EXPECT(n == s.size() - 5);
+            BEAST_EXPECT(r == expected);
+        }
+
+        // limited by the destination
+        {
+            char buf[3];
+            prepared_key key;
+            prepare_key(key, 0x12345678);
+            auto const n = mask_copy(net::buffer(buf),
+                net::buffer(s), s.size(), key);
+            BEAST_EXPECT(n == sizeof(buf));
+            BEAST_EXPECT(std::string(buf, n) ==
+                expected.substr(0, n));
+        }
+    }
+
+    void
+    run() override
+    {
+        testMaskInplace();
+        testMaskCopy();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,websocket,mask);
+
+} // detail
+} // websocket
+} // beast
+} // boost
@@ -496,6 +496,112 @@ public:
             "permessage-deflate");
     }
 
+    void
+    testZeroMask()
+    {
+        // Returns the frame the client sends for "Hello",
+        // after checking that the server reads it back.
+        auto const f =
+            [&](bool client, bool server, bool& negotiated)
+            {
+                net::io_context ioc;
+                stream<test::stream> wsc{ioc};
+                stream<test::stream> wss{ioc};
+                wsc.next_layer().connect(wss.next_layer());
+                zero_mask zm;
+                zm.client_enable = client;
+                wsc.set_option(zm);
+                zm = {};
+                zm.server_enable = server;
+                wss.set_option(zm);
+                response_type res;
+                wsc.async_handshake(res, "localhost", "/",
+                    test::success_handler());
+                wss.async_accept(test::success_handler());
+                ioc.run();
+                negotiated = http::ext_list{
+                    res[http::field::sec_websocket_extensions]
+                        }.exists("x-beast-zero-mask");
+                wsc.auto_fragment(false);
+                wsc.write(sbuf("Hello"));
+                std::string const frame(
+                    wss.next_layer().str());
+                flat_buffer b;
+                wss.read(b);
+                BEAST_EXPECT(buffers_to_string(b.data()) == "Hello");
+                return frame;
+            };
+
+        bool negotiated;
+
+        // default: masked with a random key
+        {
+            auto const s = f(false, false, negotiated);
+            BEAST_EXPECT(! negotiated);
+            BEAST_EXPECT(s.size() == 11);
+            BEAST_EXPECT(s.substr(0, 2) == "\x81\x85");
+            BEAST_EXPECT(s.substr(2, 4) != std::string(4, '\0'));
+            BEAST_EXPECT(s.substr(6) != "Hello");
+        }
+
+        // offered but not accepted
+        {
+            auto const s = f(true, false, negotiated);
+            BEAST_EXPECT(! negotiated);
+            BEAST_EXPECT(s.substr(2, 4) != std::string(4, '\0'));
+            BEAST_EXPECT(s.substr(6) != "Hello");
+        }
+
+        // accepted but not offered
+        {
+            auto const s = f(false, true, negotiated);
+            BEAST_EXPECT(! negotiated);
+            BEAST_EXPECT(s.substr(2, 4) != std::string(4, '\0'));
+        }
+
+        // negotiated: zero key, payload sent as-is
+        {
+            auto const s = f(true, true, negotiated);
+            BEAST_EXPECT(negotiated);
+            BEAST_EXPECT(s.size() == 11);
+            BEAST_EXPECT(s.substr(0, 2) == "\x81\x85");
+            BEAST_EXPECT(s.substr(2, 4) == std::string(4, '\0'));
+            BEAST_EXPECT(s.substr(6) == "Hello");
+        }
+
+        // negotiated alongside permessage-deflate
+        {
+            net::io_context ioc;
+            stream<test::stream> wsc{ioc};
+            stream<test::stream> wss{ioc};
+            wsc.next_layer().connect(wss.next_layer());
+            permessage_deflate pmd;
+            pmd.client_enable = true;
+            pmd.server_enable = true;
+            wsc.set_option(pmd);
+            wss.set_option(pmd);
+            zero_mask zm;
+            zm.client_enable = true;
+            zm.server_enable = true;
+            wsc.set_option(zm);
+            wss.set_option(zm);
+            response_type res;
+            wsc.async_handshake(res, "localhost", "/",
+                test::success_handler());
+            wss.async_accept(test::success_handler());
+            ioc.run();
+            http::ext_list list{
+                res[http::field::sec_websocket_extensions]};
+            BEAST_EXPECT(list.exists("permessage-deflate"));
+            BEAST_EXPECT(list.exists("x-beast-zero-mask"));
+            std::string const msg(1000, '*');
+            wsc.write(net::buffer(msg));
+            flat_buffer b;
+            wss.read(b);
+            BEAST_EXPECT(buffers_to_string(b.data()) == msg);
+        }
+    }
+
     void
     testMoveOnly()
     {
@@ -731,6 +837,7 @@ public:
         testExtRead();
         testExtWrite();
         testExtNegotiate();
+        testZeroMask();
         testMoveOnly();
         testAsync();
         testIssue1460();
@@ -16,6 +16,9 @@
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/strand.hpp>
 #include <boost/asio/write.hpp>
+#include <array>
+#include <functional>
+#include <string>
 
 namespace boost {
 namespace beast {
@@ -597,6 +600,413 @@ public:
         }
     }
 
+    void
+    testReadImmediate()
+    {
+        // Returns one character per message read: 'i' if the
+        // handler was invoked from within the initiating
+        // function, 'p' if it was posted or resumed by I/O.
+        auto const f =
+            [&](std::size_t limit)
+            {
+                net::io_context ioc;
+                stream<test::stream> wsc{ioc};
+                stream<test::stream> wss{ioc};
+                wsc.next_layer().connect(wss.next_layer());
+                wsc.async_handshake(
+                    "localhost", "/", [](error_code){});
+                wss.async_accept([](error_code){});
+                ioc.run();
+                ioc.restart();
+                for(int i = 0; i < 5; ++i)
+                    wsc.write(sbuf("*"));
+                wss.read_immediate_max(limit);
+                BEAST_EXPECT(wss.read_immediate_max() == limit);
+                std::string result;
+                flat_buffer b;
+                bool initiating = false;
+                std::function<void()> do_read;
+                do_read =
+                    [&]
+                    {
+                        initiating = true;
+                        wss.async_read(b,
+                            [&](error_code ec, std::size_t n)
+                            {
+                                BEAST_EXPECTS(! ec, ec.message());
+                                BEAST_EXPECT(n == 1);
+                                result.push_back(initiating ? 'i' : 'p');
+                                b.consume(b.size());
+                                if(result.size() < 5)
+                                    do_read();
+                            });
+                        initiating = false;
+                    };
+                do_read();
+                ioc.run();
+                return result;
+            };
+        BEAST_EXPECT(f(0) == "ppppp");
+        BEAST_EXPECT(f(2) == "piipi");
+        BEAST_EXPECT(f(10) == "piiii");
+
+        // An error found before any I/O is still posted
+        {
+            net::io_context ioc;
+            stream<test::stream> wsc{ioc};
+            stream<test::stream> wss{ioc};
+            wsc.next_layer().connect(wss.next_layer());
+            wsc.async_handshake(
+                "localhost", "/", [](error_code){});
+            wss.async_accept([](error_code){});
+            ioc.run();
+            ioc.restart();
+            flat_buffer b;
+            wsc.async_read(b, [](error_code, std::size_t){});
+            wss.async_close({}, [](error_code){});
+            ioc.run();
+            ioc.restart();
+            wss.read_immediate_max(10);
+            bool initiating = true;
+            bool invoked = false;
+            wss.async_read(b,
+                [&](error_code ec, std::size_t)
+                {
+                    invoked = true;
+                    BEAST_EXPECT(! initiating);
+                    BEAST_EXPECTS(ec == net::error::operation_aborted,
+                        ec.message());
+                });
+            initiating = false;
+            ioc.run();
+            BEAST_EXPECT(invoked);
+        }
+    }
+
+    void
+    testReadBurst()
+    {
+        // Frames are written raw by the server to the client
+        auto const make =
+            [&](net::io_context& ioc,
+                stream<test::stream>& wsc,
+                stream<test::stream>& wss)
+            {
+                wsc.next_layer().connect(wss.next_layer());
+                wsc.async_handshake(
+                    "localhost", "/", [](error_code){});
+                wss.async_accept([](error_code){});
+                ioc.run();
+                ioc.restart();
+            };
+
+        // buffered continuation frames are read together
+        {
+            net::io_context ioc;
+            stream<test::stream> wsc{ioc};
+            stream<test::stream> wss{ioc};
+            make(ioc, wsc, wss);
+            net::write(wss.next_layer(), sbuf(
+                "\x01\x01" "a"
+                "\x00\x01" "b"
+                "\x00\x00"
+                "\x00\x01" "c"
+                "\x80\x01" "d"));
+            char buf[16];
+            auto const n = wsc.read_some(net::buffer(buf));
+            BEAST_EXPECT(string_view(buf, n) == "abcd");
+            BEAST_EXPECT(wsc.is_message_done());
+        }
+
+        // stop at a control frame or a partial frame
+        {
+            net::io_context ioc;
+            stream<test::stream> wsc{ioc};
+            stream<test::stream> wss{ioc};
+            make(ioc, wsc, wss);
+            net::write(wss.next_layer(), sbuf(
+                "\x01\x01" "a"
+                "\x00\x01" "b"
+                "\x8a\x00"
+                "\x00\x01" "c"
+                "\x80\x02" "d"));
+            char buf[16];
+            std::size_t n = 0;
+            wsc.async_read_some(net::buffer(buf),
+                [&](error_code ec, std::size_t bytes_transferred)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    n = bytes_transferred;
+                });
+            ioc.run();
+            BEAST_EXPECT(string_view(buf, n) == "ab");
+            n = wsc.read_some(net::buffer(buf));
+            BEAST_EXPECT(string_view(buf, n) == "c");
+            n = wsc.read_some(net::buffer(buf));
+            BEAST_EXPECT(string_view(buf, n) == "d");
+            BEAST_EXPECT(! wsc.is_message_done());
+            net::write(wss.next_layer(), sbuf("e"));
+            n = wsc.read_some(net::buffer(buf));
+            BEAST_EXPECT(string_view(buf, n) == "e");
+            BEAST_EXPECT(wsc.is_message_done());
+        }
+
+        // stop when the caller's buffer is full
+        {
+            net::io_context ioc;
+            stream<test::stream> wsc{ioc};
+            stream<test::stream> wss{ioc};
+            make(ioc, wsc, wss);
+            net::write(wss.next_layer(), sbuf(
+                "\x01\x01" "a"
+                "\x00\x01" "b"
+                "\x80\x01" "c"));
+            char buf[2];
+            auto n = wsc.read_some(net::buffer(buf));
+            BEAST_EXPECT(string_view(buf, n) == "ab");
+            n = wsc.read_some(net::buffer(buf));
+            BEAST_EXPECT(string_view(buf, n) == "c");
+            BEAST_EXPECT(wsc.is_message_done());
+        }
+
+        // stop before a bad frame, which fails the next read
+        auto const bad =
+            [&](string_view frame, error_code const& result,
+                std::size_t limit)
+            {
+                net::io_context ioc;
+                stream<test::stream> wsc{ioc};
+                stream<test::stream> wss{ioc};
+                make(ioc, wsc, wss);
+                if(limit)
+                    wsc.read_message_max(limit);
+                std::string s(
+                    "\x01\x01" "a"
+                    "\x00\x01" "b", 6);
+                s.append(frame.data(), frame.size());
+                net::write(wss.next_layer(), net::buffer(s));
+                char buf[16];
+                std::size_t n = 0;
+                wsc.async_read_some(net::buffer(buf),
+                    [&](error_code ec, std::size_t bytes_transferred)
+                    {
+                        BEAST_EXPECTS(! ec, ec.message());
+                        n = bytes_transferred;
+                    });
+                ioc.run();
+                BEAST_EXPECT(string_view(buf, n) == "ab");
+                error_code ec;
+                wsc.read_some(net::buffer(buf), ec);
+                BEAST_EXPECTS(ec == result, ec.message());
+            };
+        bad({"\x40\x01" "c", 3}, error::bad_reserved_bits, 0);
+        bad({"\x80\x81" "\x01\x02\x03\x04" "c", 7},
+            error::bad_masked_frame, 0);
+        bad({"\x80\x7e\x00\x01" "c", 5}, error::bad_size, 0);
+        bad({"\x80\x02" "cd", 4}, error::message_too_big, 3);
+    }
+
+    void
+    testReadInto()
+    {
+        auto const make =
+            [&](net::io_context& ioc,
+                stream<test::stream>& wsc,
+                stream<test::stream>& wss)
+            {
+                wsc.next_layer().connect(wss.next_layer());
+                wsc.async_handshake(
+                    "localhost", "/", [](error_code){});
+                wss.async_accept([](error_code){});
+                ioc.run();
+                ioc.restart();
+            };
+
+        // large message, scattered, read mostly in place
+        {
+            net::io_context ioc;
+            stream<test::stream> wsc{ioc};
+            stream<test::stream> wss{ioc};
+            make(ioc, wsc, wss);
+            std::string s;
+            while(s.size() < 200000)
+                s += random_string();
+            s.resize(200000);
+            wss.binary(true);
+            wss.auto_fragment(false);
+            wss.write(net::buffer(s));
+            std::string d0(150000, 0);
+            std::string d1(60000, 0);
+            std::array<net::mutable_buffer, 2> const bs{{
+                net::buffer(&d0[0], d0.size()),
+                net::buffer(&d1[0], d1.size()) }};
+            auto const nread = wsc.next_layer().nread();
+            std::size_t n = 0;
+            wsc.async_read_into(bs,
+                [&](error_code ec, std::size_t bytes_written)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    n = bytes_written;
+                });
+            ioc.run();
+            BEAST_EXPECT(n == s.size());
+            BEAST_EXPECT(wsc.is_message_done());
+            BEAST_EXPECT(wsc.got_binary());
+            BEAST_EXPECT((d0 + d1).substr(0, n) == s);
+            BEAST_EXPECT(wsc.next_layer().nread() - nread <= 3);
+        }
+
+        // fragmented message
+        {
+            net::io_context ioc;
+            stream<test::stream> wsc{ioc};
+            stream<test::stream> wss{ioc};
+            make(ioc, wsc, wss);
+            net::write(wss.next_layer(), sbuf(
+                "\x01\x02" "ab"
+                "\x8a\x00"
+                "\x00\x00"
+                "\x80\x03" "cde"));
+            char buf[16];
+            auto const n = wsc.read_into(net::buffer(buf));
+            BEAST_EXPECT(string_view(buf, n) == "abcde");
+            BEAST_EXPECT(wsc.is_message_done());
+        }
+
+        // compressed message
+        {
+            net::io_context ioc;
+            stream<test::stream> wsc{ioc};
+            stream<test::stream> wss{ioc};
+            permessage_deflate pmd;
+            pmd.client_enable = true;
+            pmd.server_enable = true;
+            wsc.set_option(pmd);
+            wss.set_option(pmd);
+            make(ioc, wsc, wss);
+            std::string const s(20000, '*');
+            wss.write(net::buffer(s));
+            std::string d(s.size() + 1, 0);
+            auto const n = wsc.read_into(net::buffer(&d[0], d.size()));
+            BEAST_EXPECT(d.substr(0, n) == s);
+            BEAST_EXPECT(wsc.is_message_done());
+        }
+
+        // message which fills the buffers exactly,
+        // followed by an empty final frame
+        {
+            net::io_context ioc;
+            stream<test::stream> wsc{ioc};
+            stream<test::stream> wss{ioc};
+            make(ioc, wsc, wss);
+            net::write(wss.next_layer(), sbuf(
+                "\x01\x03" "abc"
+                "\x8a\x00"
+                "\x80\x00"
+                "\x82\x01" "x"));
+            char buf[3];
+            auto n = wsc.read_into(net::buffer(buf));
+            BEAST_EXPECT(string_view(buf, n) == "abc");
+            BEAST_EXPECT(wsc.is_message_done());
+            std::size_t m = 0;
+            wsc.async_read_into(net::buffer(buf, 1),
+                [&](error_code ec, std::size_t bytes_written)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    m = bytes_written;
+                });
+            ioc.run();
+            BEAST_EXPECT(string_view(buf, m) == "x");
+            BEAST_EXPECT(wsc.is_message_done());
+
+            net::write(wss.next_layer(), sbuf(
+                "\x01\x03" "abc"
+                "\x00\x00"
+                "\x80\x00"));
+            ioc.restart();
+            wsc.async_read_into(net::buffer(buf),
+                [&](error_code ec, std::size_t bytes_written)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    m = bytes_written;
+                });
+            ioc.run();
+            BEAST_EXPECT(string_view(buf, m) == "abc");
+            BEAST_EXPECT(wsc.is_message_done());
+        }
+
+        // compressed message which fills the buffers exactly
+        {
+            net::io_context ioc;
+            stream<test::stream> wsc{ioc};
+            stream<test::stream> wss{ioc};
+            permessage_deflate pmd;
+            pmd.client_enable = true;
+            pmd.server_enable = true;
+            wsc.set_option(pmd);
+            wss.set_option(pmd);
+            make(ioc, wsc, wss);
+            std::string const s(20000, '*');
+            wss.write(net::buffer(s));
+            wss.write(net::buffer(s));
+            std::string d(s.size(), 0);
+            auto const n = wsc.read_into(net::buffer(&d[0], d.size()));
+            BEAST_EXPECT(n == s.size());
+            BEAST_EXPECT(d == s);
+            BEAST_EXPECT(wsc.is_message_done());
+            std::size_t m = 0;
+            wsc.async_read_into(net::buffer(&d[0], d.size()),
+                [&](error_code ec, std::size_t bytes_written)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    m = bytes_written;
+                });
+            ioc.run();
+            BEAST_EXPECT(m == s.size());
+            BEAST_EXPECT(d == s);
+        }
+
+        // message too big for the buffers
+        {
+            net::io_context ioc;
+            stream<test::stream> wsc{ioc};
+            stream<test::stream> wss{ioc};
+            make(ioc, wsc, wss);
+            net::write(wss.next_layer(), sbuf(
+                "\x01\x03" "abc"
+                "\x80\x03" "def"));
+            char buf[4];
+            error_code ec;
+            auto const n = wsc.read_into(net::buffer(buf), ec);
+            BEAST_EXPECTS(ec == error::buffer_overflow, ec.message());
+            BEAST_EXPECT(n == 4);
+            BEAST_EXPECT(! wsc.is_open());
+        }
+
+        // message one byte too big, asynchronously
+        {
+            net::io_context ioc;
+            stream<test::stream> wsc{ioc};
+            stream<test::stream> wss{ioc};
+            make(ioc, wsc, wss);
+            net::write(wss.next_layer(), sbuf(
+                "\x01\x03" "abc"
+                "\x80\x01" "d"));
+            char buf[3];
+            std::size_t n = 0;
+            wsc.async_read_into(net::buffer(buf),
+                [&](error_code ec, std::size_t bytes_written)
+                {
+                    BEAST_EXPECTS(ec == error::buffer_overflow,
+                        ec.message());
+                    n = bytes_written;
+                });
+            ioc.run();
+            BEAST_EXPECT(n == 3);
+            BEAST_EXPECT(! wsc.is_open());
+        }
+    }
+
     void
     testMoveOnly()
     {
@@ -643,6 +1053,9 @@ public:
         testIssue954();
         testIssueBF1();
         testIssueBF2();
+        testReadImmediate();
+        testReadBurst();
+        testReadInto();
         testMoveOnly();
         testAsioHandlerInvoke();
     }
@@ -12,6 +12,9 @@
 
 #include <boost/beast/core/tcp_stream.hpp>
 #include <boost/asio/strand.hpp>
+#include <memory>
+#include <thread>
+#include <vector>
 
 #include "test.hpp"
 
@@ -73,6 +76,9 @@ public:
         stream<test::stream> ws{ioc_};
         ws.auto_fragment(true);
         ws.write_buffer_bytes(2048);
+        BEAST_EXPECT(ws.mask_buffer_bytes() == 0);
+        ws.mask_buffer_bytes(65536);
+        BEAST_EXPECT(ws.mask_buffer_bytes() == 65536);
         ws.binary(false);
         ws.read_message_max(1 * 1024 * 1024);
         try
@@ -164,6 +170,116 @@ public:
         }
     }
 
+    void
+    testRegistration()
+    {
+        // Streams created on one thread may be
+        // destroyed on another, in any order.
+        using ws_type = stream<test::stream>;
+        net::io_context ioc;
+        std::vector<std::unique_ptr<ws_type>> v[4];
+        std::vector<std::thread> threads;
+        for(auto& e : v)
+            threads.emplace_back(
+                [&ioc, &e]
+                {
+                    for(int i = 0; i < 1000; ++i)
+                    {
+                        e.emplace_back(new ws_type(ioc));
+                        if(i % 3 == 0)
+                            e.erase(e.begin() + i / 2 % e.size());
+                    }
+                });
+        for(auto& t : threads)
+            t.join();
+        threads.clear();
+        for(std::size_t i = 0; i < 4; ++i)
+            threads.emplace_back(
+                [&v, i]
+                {
+                    // Destroy another thread's streams
+                    auto& e = v[(i + 1) % 4];
+                    while(! e.empty())
+                        e.erase(e.begin() + e.size() / 2);
+                });
+        for(auto& t : threads)
+            t.join();
+        for(auto const& e : v)
+            BEAST_EXPECT(e.empty());
+    }
+
+    void
+    testImplCache()
+    {
+        // The next layer lives inside the implementation,
+        // so its address identifies the memory block.
+        using ws_type = stream<test::stream>;
+        BEAST_EXPECT(detail::impl_cache_max() == 0);
+        std::size_t const max = 64 * 1024;
+        stream_cache_max(max);
+        net::io_context ioc;
+        void const* p;
+        {
+            ws_type ws(ioc);
+            p = &ws.next_layer();
+        }
+        {
+            ws_type ws(ioc);
+            BEAST_EXPECT(&ws.next_layer() == p);
+        }
+
+        // Moved-from streams release nothing
+        {
+            ws_type ws1(ioc);
+            BEAST_EXPECT(&ws1.next_layer() == p);
+            ws_type ws2(std::move(ws1));
+            BEAST_EXPECT(&ws2.next_layer() == p);
+        }
+        {
+            ws_type ws(ioc);
+            BEAST_EXPECT(&ws.next_layer() == p);
+        }
+
+        // A limit of zero disables the cache
+        stream_cache_max(0);
+        BEAST_EXPECT(detail::impl_cache_max() == 0);
+        {
+            ws_type ws(ioc);
+            BEAST_EXPECT(&ws.next_layer() == p);
+        }
+        {
+            ws_type ws(ioc);
+        }
+        stream_cache_max(max);
+
+        // Memory freed on another thread goes to that thread's cache
+        {
+            std::unique_ptr<ws_type> ws(new ws_type(ioc));
+            std::thread t(
+                [&ws]
+                {
+                    ws.reset();
+                });
+            t.join();
+            BEAST_EXPECT(! ws);
+        }
+
+        // A stream destroyed after the thread's cache is gone,
+        // here by a thread_local constructed before the cache.
+        {
+            std::thread t(
+                [&ioc]
+                {
+                    thread_local std::unique_ptr<ws_type> late;
+                    std::unique_ptr<ws_type> early(new ws_type(ioc));
+                    late.reset(new ws_type(ioc));
+                    early.reset();
+                });
+            t.join();
+        }
+        stream_cache_max(0);
+    }
+
     void
     run() override
     {
@@ -196,6 +312,8 @@ public:
 
         testOptions();
         testJavadoc();
+        testRegistration();
+        testImplCache();
     }
 };
 
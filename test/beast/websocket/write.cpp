@@ -136,6 +136,38 @@ public:
             BEAST_EXPECT(buffers_to_string(b.data()) == s);
         });
 
+        // mask (large, staging larger than write buffer)
+        doTest<deflateSupported>(pmd,
+        [&](ws_type_t<deflateSupported>& ws)
+        {
+            ws.auto_fragment(false);
+            ws.write_buffer_bytes(16);
+            ws.mask_buffer_bytes(64);
+            std::string s;
+            for(std::size_t i = 0; i < 203; ++i)
+                s.push_back(static_cast<char>('a' + i % 26));
+            w.write(ws, net::buffer(s));
+            flat_buffer b;
+            w.read(ws, b);
+            BEAST_EXPECT(buffers_to_string(b.data()) == s);
+        });
+
+        // mask, autofrag, staging larger than write buffer
+        doTest<deflateSupported>(pmd,
+        [&](ws_type_t<deflateSupported>& ws)
+        {
+            ws.auto_fragment(true);
+            ws.write_buffer_bytes(16);
+            ws.mask_buffer_bytes(64);
+            std::string s;
+            for(std::size_t i = 0; i < 203; ++i)
+                s.push_back(static_cast<char>('a' + i % 26));
+            w.write(ws, net::buffer(s));
+            flat_buffer b;
+            w.read(ws, b);
+            BEAST_EXPECT(buffers_to_string(b.data()) == s);
+        });
+
         // mask, autofrag
         doTest<deflateSupported>(pmd,
         [&](ws_type_t<deflateSupported>& ws)
@@ -0,0 +1,364 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+//------------------------------------------------------------------------------
+//
+// bench-awaitable
+//
+//  Compare the cost of the coroutine styles available for HTTP servers
+//
+//  A keep-alive HTTP server is run in one of these modes:
+//
+//      spawn       net::spawn with http::async_read and http::async_write,
+//                  as in the "coro" examples
+//      awaitable   co_await http::async_read and http::async_write
+//                  with net::use_awaitable
+//      co_read     co_await http::co_read and http::co_write
+//
+//  Clients pipeline several requests at a time, so that the server
+//  usually finds the next request already in its buffer. Everything
+//  runs on one thread, so the results reflect the CPU cost per request.
+//  The last two modes require a compiler with support for co_await.
+//
+//------------------------------------------------------------------------------
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/version.hpp>
+#include <boost/beast/_experimental/http/awaitable.hpp>
+#include <boost/beast/_experimental/unit_test/dstream.hpp>
+#include <boost/asio.hpp>
+#include <boost/asio/spawn.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if BOOST_ASIO_HAS_CO_AWAIT
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#endif
+
+namespace beast = boost::beast;         // from <boost/beast.hpp>
+namespace http = beast::http;           // from <boost/beast/http.hpp>
+namespace net = boost::asio;            // from <boost/asio.hpp>
+using tcp = boost::asio::ip::tcp;       // from <boost/asio/ip/tcp.hpp>
+
+http::response<http::string_body>
+make_response(http::request<http::empty_body> const& req)
+{
+    http::response<http::string_body> res{
+        http::status::ok, req.version()};
+    res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+    res.set(http::field::content_type, "text/plain");
+    res.body() = "Hello, world!";
+    res.keep_alive(req.keep_alive());
+    res.prepare_payload();
+    return res;
+}
+
+void
+do_session_spawn(tcp::socket& sock, net::yield_context yield)
+{
+    beast::error_code ec;
+    beast::flat_buffer buffer;
+    for(;;)
+    {
+        http::request<http::empty_body> req;
+        http::async_read(sock, buffer, req, yield[ec]);
+        if(ec)
+            break;
+        auto const res = make_response(req);
+        http::async_write(sock, res, yield[ec]);
+        if(ec)
+            break;
+    }
+}
+
+#if BOOST_ASIO_HAS_CO_AWAIT
+
+net::awaitable<void>
+do_session_awaitable(tcp::socket& sock)
+{
+    beast::error_code ec;
+    beast::flat_buffer buffer;
+    for(;;)
+    {
+        http::request<http::empty_body> req;
+        co_await http::async_read(sock, buffer, req,
+            net::redirect_error(net::use_awaitable, ec));
+        if(ec)
+            break;
+        auto const res = make_response(req);
+        co_await http::async_write(sock, res,
+            net::redirect_error(net::use_awaitable, ec));
+        if(ec)
+            break;
+    }
+}
+
+net::awaitable<void>
+do_session_co_read(tcp::socket& sock)
+{
+    beast::error_code ec;
+    beast::flat_buffer buffer;
+    for(;;)
+    {
+        http::request<http::empty_body> req;
+        co_await http::co_read(sock, buffer, req, ec);
+        if(ec)
+            break;
+        auto const res = make_response(req);
+        co_await http::co_write(sock, res, ec);
+        if(ec)
+            break;
+    }
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+
+// Sends `pipeline` requests at a time, then reads the responses
+class client
+    : public std::enable_shared_from_this<client>
+{
+    tcp::socket& sock_;
+    std::string const& requests_;
+    std::size_t pipeline_;
+    std::size_t remain_;
+    std::size_t pending_ = 0;
+    beast::flat_buffer buffer_;
+    http::response<http::string_body> res_;
+
+public:
+    client(
+        tcp::socket& sock,
+        std::string const& requests,
+        std::size_t pipeline,
+        std::size_t count)
+        : sock_(sock)
+        , requests_(requests)
+        , pipeline_(pipeline)
+        , remain_(count)
+    {
+    }
+
+    void
+    run()
+    {
+        do_write();
+    }
+
+private:
+    void
+    do_write()
+    {
+        if(remain_ == 0)
+        {
+            // Closing lets the server session finish
+            beast::error_code ec;
+            sock_.shutdown(tcp::socket::shutdown_send, ec);
+            return;
+        }
+        pending_ = std::min(pipeline_, remain_);
+        remain_ -= pending_;
+        net::async_write(sock_, net::buffer(
+            requests_.data(), requests_.size() / pipeline_ * pending_),
+            beast::bind_front_handler(
+                &client::on_write,
+                shared_from_this()));
+    }
+
+    void
+    on_write(beast::error_code ec, std::size_t)
+    {
+        if(ec)
+            return fail(ec, "write");
+        do_read();
+    }
+
+    void
+    do_read()
+    {
+        res_ = {};
+        http::async_read(sock_, buffer_, res_,
+            beast::bind_front_handler(
+                &client::on_read,
+                shared_from_this()));
+    }
+
+    void
+    on_read(beast::error_code ec, std::size_t)
+    {
+        if(ec)
+            return fail(ec, "read");
+        if(--pending_ > 0)
+            return do_read();
+        do_write();
+    }
+
+    static
+    void
+    fail(beast::error_code ec, char const* what)
+    {
+        std::cerr << what << ": " << ec.message() << "\n";
+    }
+};
+
+//------------------------------------------------------------------------------
+
+enum class mode
+{
+    spawn,
+    awaitable,
+    co_read
+};
+
+double
+run_mode(
+    mode m,
+    std::size_t connections,
+    std::size_t pipeline,
+    std::size_t count,
+    std::string const& requests)
+{
+    net::io_context ioc{1};
+    tcp::acceptor acceptor(ioc,
+        tcp::endpoint{net::ip::make_address("127.0.0.1"), 0});
+    std::vector<tcp::socket> clients;
+    std::vector<tcp::socket> servers;
+    clients.reserve(connections);
+    servers.reserve(connections);
+    for(std::size_t i = 0; i < connections; ++i)
+    {
+        clients.emplace_back(ioc);
+        clients.back().connect(acceptor.local_endpoint());
+        clients.back().set_option(tcp::no_delay(true));
+        servers.emplace_back(acceptor.accept());
+        servers.back().set_option(tcp::no_delay(true));
+    }
+
+    for(auto& sock : servers)
+    {
+        switch(m)
+        {
+        case mode::spawn:
+            net::spawn(ioc,
+                [&sock](net::yield_context yield)
+                {
+                    do_session_spawn(sock, yield);
+                });
+            break;
+
+#if BOOST_ASIO_HAS_CO_AWAIT
+        case mode::awaitable:
+            net::co_spawn(ioc,
+                do_session_awaitable(sock), net::detached);
+            break;
+
+        case mode::co_read:
+            net::co_spawn(ioc,
+                do_session_co_read(sock), net::detached);
+            break;
+#endif
+
+        default:
+            break;
+        }
+    }
+    for(auto& sock : clients)
+        std::make_shared<client>(sock, requests,
+            pipeline, count / connections)->run();
+
+    auto const start = std::chrono::steady_clock::now();
+    ioc.run();
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+int
+main(int argc, char** argv)
+{
+    beast::unit_test::dstream dout(std::cerr);
+
+    try
+    {
+        // Check command line arguments.
+        if(argc != 5)
+        {
+            std::cerr <<
+                "Usage: bench-awaitable <connections> <pipeline> <requests> <trials>\n" <<
+                "Example:\n" <<
+                "    bench-awaitable 16 8 200000 3\n";
+            return EXIT_FAILURE;
+        }
+        auto const connections = std::max<std::size_t>(1,
+            static_cast<std::size_t>(std::atoi(argv[1])));
+        auto const pipeline = std::max<std::size_t>(1,
+            static_cast<std::size_t>(std::atoi(argv[2])));
+        auto const count = static_cast<std::size_t>(std::atoi(argv[3]));
+        auto const trials = std::max(1, std::atoi(argv[4]));
+
+        std::string requests;
+        {
+            http::request<http::empty_body> req{
+                http::verb::get, "/", 11};
+            req.set(http::field::host, "localhost");
+            req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+            std::ostringstream ss;
+            ss << req;
+            for(std::size_t i = 0; i < pipeline; ++i)
+                requests += ss.str();
+        }
+
+        struct
+        {
+            mode m;
+            char const* name;
+        }
+        const modes[] = {
+            { mode::spawn, "spawn" },
+#if BOOST_ASIO_HAS_CO_AWAIT
+            { mode::awaitable, "awaitable" },
+            { mode::co_read, "co_read" },
+#endif
+        };
+
+#if ! BOOST_ASIO_HAS_CO_AWAIT
+        dout << "co_await is not available, only spawn is measured\n";
+#endif
+        auto const total = count / connections * connections;
+        for(auto const& e : modes)
+        {
+            for(int i = 0; i < trials; ++i)
+            {
+                auto const elapsed = run_mode(
+                    e.m, connections, pipeline, count, requests);
+                dout <<
+                    e.name << ": " <<
+                    total << " requests in " << elapsed << "s, " <<
+                    static_cast<std::size_t>(total / elapsed) <<
+                    " requests/s" << std::endl;
+            }
+        }
+    }
+    catch(std::exception const& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,143 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#include <boost/beast/_experimental/http/chunk_writer.hpp>
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/core/buffer_traits.hpp>
+#include <boost/beast/http/chunk_encode.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/write.hpp>
+#include <chrono>
+#include <cstdint>
+
+namespace boost {
+namespace beast {
+
+// Measures the cost of sending many small chunks of a chunked
+// body: one write per chunk built with make_chunk, the same with
+// a chunk extension, and chunks batched by http::chunk_writer.
+// The stream discards what it is given and counts the writes.
+
+class chunked_test : public beast::unit_test::suite
+{
+public:
+    using size_type = std::uint64_t;
+
+    class null_stream
+    {
+        net::io_context ioc_;
+
+    public:
+        using executor_type =
+            net::io_context::executor_type;
+
+        std::size_t writes = 0;
+
+        executor_type
+        get_executor() noexcept
+        {
+            return ioc_.get_executor();
+        }
+
+        template<class ConstBufferSequence>
+        std::size_t
+        write_some(ConstBufferSequence const& buffers)
+        {
+            ++writes;
+            return buffer_bytes(buffers);
+        }
+
+        template<class ConstBufferSequence>
+        std::size_t
+        write_some(ConstBufferSequence const& buffers, error_code& ec)
+        {
+            ec = {};
+            ++writes;
+            return buffer_bytes(buffers);
+        }
+    };
+
+    class timer
+    {
+        using clock_type =
+            std::chrono::steady_clock;
+
+        clock_type::time_point when_;
+
+    public:
+        timer()
+            : when_(clock_type::now())
+        {
+        }
+
+        std::chrono::duration<double>
+        elapsed() const
+        {
+            return clock_type::now() - when_;
+        }
+    };
+
+    static size_type constexpr chunks = 2000000;
+
+    template<class F>
+    void
+    test(char const* what, F const& f)
+    {
+        for(int i = 0; i < 5; ++i)
+        {
+            null_stream s;
+            timer t;
+            f(s);
+            auto const elapsed = t.elapsed();
+            log << what <<
+                static_cast<size_type>(chunks / elapsed.count()) <<
+                " chunks/s in " << s.writes << " writes" << std::endl;
+        }
+    }
+
+    void
+    run() override
+    {
+        char const msg[] = "data: {\"seq\":12345,\"level\":\"info\"}\n\n";
+        auto const cb = net::buffer(msg, sizeof(msg) - 1);
+        test("make_chunk:     ",
+            [&](null_stream& s)
+            {
+                for(size_type i = 0; i < chunks; ++i)
+                    net::write(s, http::make_chunk(cb));
+            });
+        test("with extension: ",
+            [&](null_stream& s)
+            {
+                http::chunk_extensions ext;
+                ext.insert("seq");
+                for(size_type i = 0; i < chunks; ++i)
+                    net::write(s, http::make_chunk(cb, ext));
+            });
+        test("chunk_writer:   ",
+            [&](null_stream& s)
+            {
+                http::chunk_writer<null_stream> cw{s};
+                for(size_type i = 0; i < chunks; ++i)
+                {
+                    cw.append(cb);
+                    // Flush 32 chunks at a time
+                    if((i & 31) == 31)
+                        cw.flush();
+                }
+                cw.flush();
+            });
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,benchmarks,chunked);
+
+} // beast
+} // boost
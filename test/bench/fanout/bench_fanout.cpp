@@ -0,0 +1,307 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+//------------------------------------------------------------------------------
+//
+// bench-fanout
+//
+//  Measure the cost of broadcasting messages to many websocket sessions
+//
+//  Producer threads publish messages to every session, while the
+//  sessions write them on a single threaded io_context. The sessions
+//  receive messages in one of these modes:
+//
+//      post        net::post a function to the session for each message,
+//                  which appends it to a queue, as in the chat example
+//      channel     websocket::send_channel::try_send
+//      payload     websocket::send_channel::try_send with shared_payload
+//                  messages, so that no allocation is made per message
+//
+//  The peers are test streams, so the results reflect the CPU cost
+//  of delivering and writing each message rather than the network.
+//
+//------------------------------------------------------------------------------
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/_experimental/core/shared_payload.hpp>
+#include <boost/beast/_experimental/test/stream.hpp>
+#include <boost/beast/_experimental/unit_test/dstream.hpp>
+#include <boost/beast/_experimental/websocket/send_channel.hpp>
+#include <boost/asio.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace beast = boost::beast;         // from <boost/beast.hpp>
+namespace websocket = beast::websocket; // from <boost/beast/websocket.hpp>
+namespace net = boost::asio;            // from <boost/asio.hpp>
+
+using ws_type = websocket::stream<beast::test::stream>;
+using message = boost::shared_ptr<std::string const>;
+
+message
+make_message(std::size_t size, char c, message*)
+{
+    return boost::make_shared<std::string const>(size, c);
+}
+
+beast::shared_payload
+make_message(std::size_t size, char c, beast::shared_payload*)
+{
+    return beast::shared_payload(size,
+        [c](net::mutable_buffer b)
+        {
+            std::memset(b.data(), c, b.size());
+        });
+}
+
+// Receives messages with a posted function per message
+class post_session
+    : public boost::enable_shared_from_this<post_session>
+{
+public:
+    using message_type = message;
+
+private:
+    ws_type ws_;
+    std::vector<message> queue_;
+
+public:
+    explicit
+    post_session(net::io_context& ioc)
+        : ws_(ioc)
+    {
+    }
+
+    ws_type&
+    ws()
+    {
+        return ws_;
+    }
+
+    void
+    start()
+    {
+    }
+
+    // Called from any thread
+    bool
+    send(message const& m)
+    {
+        net::post(ws_.get_executor(),
+            beast::bind_front_handler(
+                &post_session::on_send,
+                shared_from_this(),
+                m));
+        return true;
+    }
+
+private:
+    void
+    on_send(message m)
+    {
+        queue_.push_back(m);
+        if(queue_.size() > 1)
+            return;
+        do_write();
+    }
+
+    void
+    do_write()
+    {
+        ws_.async_write(net::buffer(*queue_.front()),
+            beast::bind_front_handler(
+                &post_session::on_write,
+                shared_from_this()));
+    }
+
+    void
+    on_write(beast::error_code ec, std::size_t)
+    {
+        if(ec)
+        {
+            std::cerr << "write: " << ec.message() << "\n";
+            queue_.clear();
+            return;
+        }
+        queue_.erase(queue_.begin());
+        if(! queue_.empty())
+            do_write();
+    }
+};
+
+// Receives messages through a send_channel
+template<class Message>
+class channel_session
+    : public boost::enable_shared_from_this<channel_session<Message>>
+{
+    ws_type ws_;
+    websocket::send_channel<ws_type, Message> channel_;
+
+public:
+    using message_type = Message;
+
+    explicit
+    channel_session(net::io_context& ioc)
+        : ws_(ioc)
+        , channel_(ws_, 256)
+    {
+    }
+
+    ws_type&
+    ws()
+    {
+        return ws_;
+    }
+
+    void
+    start()
+    {
+        channel_.start(this->shared_from_this());
+    }
+
+    // Called from any thread
+    bool
+    send(Message const& m)
+    {
+        return channel_.try_send(m);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+template<class Session>
+double
+run_mode(
+    std::size_t sessions,
+    std::size_t producers,
+    std::size_t count,
+    std::size_t size)
+{
+    net::io_context ioc{1};
+
+    std::vector<boost::shared_ptr<Session>> v;
+    std::vector<std::unique_ptr<ws_type>> peers;
+    v.reserve(sessions);
+    peers.reserve(sessions);
+    for(std::size_t i = 0; i < sessions; ++i)
+    {
+        v.push_back(boost::make_shared<Session>(ioc));
+        peers.emplace_back(new ws_type(ioc));
+        peers.back()->next_layer().connect(v.back()->ws().next_layer());
+        peers.back()->async_handshake("localhost", "/",
+            [](beast::error_code ec)
+            {
+                if(ec)
+                    std::cerr << "handshake: " << ec.message() << "\n";
+            });
+        v.back()->ws().async_accept(
+            [](beast::error_code ec)
+            {
+                if(ec)
+                    std::cerr << "accept: " << ec.message() << "\n";
+            });
+    }
+    ioc.run();
+    ioc.restart();
+    for(auto& sp : v)
+        sp->start();
+
+    auto work = net::make_work_guard(ioc);
+    auto const start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for(std::size_t id = 0; id < producers; ++id)
+        threads.emplace_back(
+            [&, id]
+            {
+                for(std::size_t n = 0; n < count; ++n)
+                {
+                    auto const m = make_message(
+                        size, static_cast<char>('a' + id % 26),
+                        static_cast<typename Session::message_type*>(nullptr));
+                    for(auto& sp : v)
+                        while(! sp->send(m))
+                            std::this_thread::yield();
+                }
+            });
+    std::thread t(
+        [&]
+        {
+            for(auto& th : threads)
+                th.join();
+            work.reset();
+        });
+    ioc.run();
+    t.join();
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+int
+main(int argc, char** argv)
+{
+    beast::unit_test::dstream dout(std::cerr);
+
+    try
+    {
+        // Check command line arguments.
+        if(argc != 6)
+        {
+            std::cerr <<
+                "Usage: bench-fanout <sessions> <producers> <messages> <size> <trials>\n" <<
+                "Example:\n" <<
+                "    bench-fanout 10000 4 50 64 3\n";
+            return EXIT_FAILURE;
+        }
+        auto const sessions = std::max<std::size_t>(1,
+            static_cast<std::size_t>(std::atoi(argv[1])));
+        auto const producers = std::max<std::size_t>(1,
+            static_cast<std::size_t>(std::atoi(argv[2])));
+        auto const count = static_cast<std::size_t>(std::atoi(argv[3]));
+        auto const size = static_cast<std::size_t>(std::atoi(argv[4]));
+        auto const trials = std::max(1, std::atoi(argv[5]));
+
+        auto const total = sessions * producers * count;
+        auto const report =
+            [&](char const* name, double elapsed)
+            {
+                dout <<
+                    name << ": " <<
+                    total << " messages in " << elapsed << "s, " <<
+                    static_cast<std::size_t>(total / elapsed) <<
+                    " messages/s" << std::endl;
+            };
+        for(int i = 0; i < trials; ++i)
+            report("post", run_mode<post_session>(
+                sessions, producers, count, size));
+        for(int i = 0; i < trials; ++i)
+            report("channel", run_mode<channel_session<message>>(
+                sessions, producers, count, size));
+        for(int i = 0; i < trials; ++i)
+            report("payload", run_mode<channel_session<beast::shared_payload>>(
+                sessions, producers, count, size));
+    }
+    catch(std::exception const& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,585 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+//------------------------------------------------------------------------------
+//
+// httpload
+//
+//  Measure the latency of an HTTP server under a constant request rate
+//
+//  Requests are issued on a fixed schedule regardless of how quickly
+//  the server answers (an "open loop"). Latency is measured from the
+//  time each request was scheduled to be sent, rather than from when
+//  it was actually sent, so that a stalled server is charged for the
+//  requests it delayed. This avoids the "coordinated omission" error
+//  of closed-loop load generators, which wait for a response before
+//  sending the next request and so stop measuring exactly when the
+//  server is slowest. Both the corrected and the uncorrected (service
+//  time) distributions are reported.
+//
+//------------------------------------------------------------------------------
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/version.hpp>
+#include <boost/beast/_experimental/unit_test/dstream.hpp>
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace beast = boost::beast;         // from <boost/beast.hpp>
+namespace http = beast::http;           // from <boost/beast/http.hpp>
+namespace net = boost::asio;            // from <boost/asio.hpp>
+using tcp = boost::asio::ip::tcp;       // from <boost/asio/ip/tcp.hpp>
+
+using clock_type = std::chrono::steady_clock;
+
+//------------------------------------------------------------------------------
+
+// A log-linear latency histogram in microseconds.
+//
+// Values are grouped by power of two, and each group is divided
+// into linear sub-buckets, so the recorded value is accurate to
+// within 1/sub_buckets of its magnitude (about 1.5%) over the
+// whole range while using a fixed, small amount of memory.
+class histogram
+{
+    static std::size_t constexpr sub_bits = 6;
+    static std::size_t constexpr sub_buckets = 1 << sub_bits;
+    static std::size_t constexpr groups = 40;
+
+    std::vector<std::uint64_t> counts_;
+    std::uint64_t total_ = 0;
+    std::uint64_t max_ = 0;
+    double sum_ = 0;
+
+    static
+    std::size_t
+    index(std::uint64_t v)
+    {
+        if(v < sub_buckets)
+            return static_cast<std::size_t>(v);
+        std::size_t g = 0;
+        while((v >> g) >= 2 * sub_buckets)
+            ++g;
+        // v >> g is in [sub_buckets, 2 * sub_buckets)
+        return std::min<std::size_t>(
+            (g + 1) * sub_buckets +
+                static_cast<std::size_t>((v >> g) - sub_buckets),
+            groups * sub_buckets - 1);
+    }
+
+    // Highest value which maps to the bucket
+    static
+    std::uint64_t
+    value(std::size_t i)
+    {
+        if(i < sub_buckets)
+            return i;
+        auto const g = i / sub_buckets - 1;
+        auto const s = i % sub_buckets;
+        return ((std::uint64_t(sub_buckets + s + 1)) << g) - 1;
+    }
+
+public:
+    histogram()
+        : counts_(groups * sub_buckets)
+    {
+    }
+
+    void
+    insert(clock_type::duration d)
+    {
+        auto const us = static_cast<std::uint64_t>(std::max<
+            std::chrono::microseconds::rep>(0,
+            std::chrono::duration_cast<
+                std::chrono::microseconds>(d).count()));
+        ++counts_[index(us)];
+        ++total_;
+        sum_ += static_cast<double>(us);
+        max_ = std::max(max_, us);
+    }
+
+    void
+    merge(histogram const& other)
+    {
+        for(std::size_t i = 0; i < counts_.size(); ++i)
+            counts_[i] += other.counts_[i];
+        total_ += other.total_;
+        sum_ += other.sum_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    std::uint64_t
+    count() const
+    {
+        return total_;
+    }
+
+    std::uint64_t
+    max() const
+    {
+        return max_;
+    }
+
+    double
+    mean() const
+    {
+        return total_ ? sum_ / static_cast<double>(total_) : 0;
+    }
+
+    // Return the value at or below which `p` percent of samples lie
+    std::uint64_t
+    percentile(double p) const
+    {
+        if(total_ == 0)
+            return 0;
+        auto const want = static_cast<std::uint64_t>(
+            std::max(1.0, p / 100 * static_cast<double>(total_) + 0.5));
+        std::uint64_t seen = 0;
+        for(std::size_t i = 0; i < counts_.size(); ++i)
+        {
+            seen += counts_[i];
+            if(seen >= want)
+                return std::min(value(i), max_);
+        }
+        return max_;
+    }
+};
+
+class report
+{
+    std::mutex m_;
+
+public:
+    histogram corrected;
+    histogram uncorrected;
+    std::size_t sent = 0;
+    std::size_t errors = 0;
+    std::size_t connects = 0;
+    std::size_t bytes = 0;
+
+    void
+    insert(
+        histogram const& h0,
+        histogram const& h1,
+        std::size_t sent_,
+        std::size_t errors_,
+        std::size_t connects_,
+        std::size_t bytes_)
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        corrected.merge(h0);
+        uncorrected.merge(h1);
+        sent += sent_;
+        errors += errors_;
+        connects += connects_;
+        bytes += bytes_;
+    }
+};
+
+void
+fail(beast::error_code ec, char const* what)
+{
+    std::cerr << what << ": " << ec.message() << "\n";
+}
+
+//------------------------------------------------------------------------------
+
+struct settings
+{
+    tcp::endpoint ep;
+    std::string target;
+    double rate;                    // requests per second, all connections
+    clock_type::duration duration;
+    std::size_t connections;
+    std::size_t pipeline;           // maximum requests in flight
+    std::size_t body_size;          // request body, 0 for GET
+};
+
+// One keep-alive connection which sends its share of the schedule.
+//
+// Connection `k` of `n` sends requests k, k + n, k + 2n, ... where
+// request `i` is due at `start + i / rate`. When a request comes due
+// while the pipeline is full, it waits in the backlog and its latency
+// keeps growing, as it would for a real client.
+class connection
+    : public std::enable_shared_from_this<connection>
+{
+    struct in_flight
+    {
+        clock_type::time_point due;
+        clock_type::time_point sent;
+    };
+
+    settings const& cfg_;
+    report& rep_;
+    net::strand<net::io_context::executor_type> strand_;
+    beast::tcp_stream stream_;
+    net::steady_timer timer_;
+    http::request<http::string_body> req_;
+    http::response<http::string_body> res_;
+    beast::flat_buffer buffer_;
+
+    clock_type::time_point start_;
+    clock_type::time_point end_;
+    std::size_t next_;              // index of the next request
+    std::deque<clock_type::time_point> backlog_;
+    std::deque<in_flight> flight_;
+    bool connected_ = false;
+    bool connecting_ = false;
+    bool writing_ = false;
+    bool reading_ = false;
+    bool scheduled_ = true;         // more requests will come due
+
+    histogram corrected_;
+    histogram uncorrected_;
+    std::size_t sent_ = 0;
+    std::size_t errors_ = 0;
+    std::size_t connects_ = 0;
+    std::size_t bytes_ = 0;
+
+public:
+    connection(
+        net::io_context& ioc,
+        settings const& cfg,
+        report& rep,
+        std::size_t index,
+        clock_type::time_point start)
+        : cfg_(cfg)
+        , rep_(rep)
+        , strand_(ioc.get_executor())
+        , stream_(strand_)
+        , timer_(strand_)
+        , start_(start)
+        , end_(start + cfg.duration)
+        , next_(index)
+    {
+        req_.method(cfg.body_size > 0 ?
+            http::verb::post : http::verb::get);
+        req_.target(cfg.target);
+        req_.version(11);
+        req_.set(http::field::host, cfg.ep.address().to_string());
+        req_.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+        if(cfg.body_size > 0)
+        {
+            req_.set(http::field::content_type,
+                "application/octet-stream");
+            req_.body().assign(cfg.body_size, 'x');
+        }
+        req_.prepare_payload();
+        req_.keep_alive(true);
+    }
+
+    ~connection()
+    {
+        rep_.insert(corrected_, uncorrected_,
+            sent_, errors_, connects_, bytes_);
+    }
+
+    void
+    run()
+    {
+        net::dispatch(strand_,
+            beast::bind_front_handler(
+                &connection::do_connect,
+                shared_from_this()));
+        net::dispatch(strand_,
+            beast::bind_front_handler(
+                &connection::do_schedule,
+                shared_from_this()));
+    }
+
+private:
+    clock_type::time_point
+    due(std::size_t i) const
+    {
+        return start_ + std::chrono::duration_cast<
+            clock_type::duration>(std::chrono::duration<double>(
+                static_cast<double>(i) / cfg_.rate));
+    }
+
+    void
+    do_schedule()
+    {
+        auto const t = due(next_);
+        if(t >= end_)
+        {
+            scheduled_ = false;
+            return maybe_close();
+        }
+        timer_.expires_at(t);
+        timer_.async_wait(
+            beast::bind_front_handler(
+                &connection::on_due,
+                shared_from_this()));
+    }
+
+    void
+    on_due(beast::error_code ec)
+    {
+        if(ec)
+            return;
+
+        // Queue everything that is due, in case the timer was late
+        auto const now = clock_type::now();
+        for(auto t = due(next_); t <= now && t < end_; t = due(next_))
+        {
+            backlog_.push_back(t);
+            next_ += cfg_.connections;
+        }
+        do_write();
+        do_schedule();
+    }
+
+    void
+    do_connect()
+    {
+        if(connecting_)
+            return;
+        connecting_ = true;
+        ++connects_;
+        stream_.async_connect(cfg_.ep,
+            beast::bind_front_handler(
+                &connection::on_connect,
+                shared_from_this()));
+    }
+
+    void
+    on_connect(beast::error_code ec)
+    {
+        connecting_ = false;
+        if(ec)
+        {
+            fail(ec, "connect");
+            // Charge every waiting request as an error
+            errors_ += backlog_.size();
+            backlog_.clear();
+            scheduled_ = false;
+            timer_.cancel();
+            return;
+        }
+        stream_.socket().set_option(tcp::no_delay(true));
+        connected_ = true;
+        do_write();
+    }
+
+    void
+    do_write()
+    {
+        if( ! connected_ || writing_ ||
+            backlog_.empty() ||
+            flight_.size() >= cfg_.pipeline)
+            return;
+        writing_ = true;
+        flight_.push_back({backlog_.front(), clock_type::now()});
+        backlog_.pop_front();
+        http::async_write(stream_, req_,
+            beast::bind_front_handler(
+                &connection::on_write,
+                shared_from_this()));
+        do_read();
+    }
+
+    void
+    on_write(beast::error_code ec, std::size_t)
+    {
+        writing_ = false;
+        if(ec)
+            return on_error(ec, "write");
+        ++sent_;
+        do_write();
+    }
+
+    void
+    do_read()
+    {
+        if(reading_ || flight_.empty())
+            return;
+        reading_ = true;
+        res_ = http::response<http::string_body>{};
+        http::async_read(stream_, buffer_, res_,
+            beast::bind_front_handler(
+                &connection::on_read,
+                shared_from_this()));
+    }
+
+    void
+    on_read(beast::error_code ec, std::size_t)
+    {
+        reading_ = false;
+        if(ec)
+            return on_error(ec, "read");
+
+        auto const now = clock_type::now();
+        auto const f = flight_.front();
+        flight_.pop_front();
+        corrected_.insert(now - f.due);
+        uncorrected_.insert(now - f.sent);
+        bytes_ += res_.body().size();
+        if(res_.result_int() >= 400)
+            ++errors_;
+
+        if(! res_.keep_alive())
+        {
+            // The server closed the connection; pipelined
+            // requests after this one were never answered.
+            errors_ += flight_.size();
+            flight_.clear();
+            return reconnect();
+        }
+        do_read();
+        do_write();
+        maybe_close();
+    }
+
+    void
+    on_error(beast::error_code ec, char const* what)
+    {
+        if(ec != net::error::operation_aborted)
+            fail(ec, what);
+        errors_ += flight_.size();
+        flight_.clear();
+        reconnect();
+    }
+
+    // Close the socket, aborting any pending operation,
+    // and connect again once nothing is outstanding.
+    void
+    reconnect()
+    {
+        beast::error_code ec;
+        stream_.socket().close(ec);
+        connected_ = false;
+        buffer_.clear();
+        if(writing_ || reading_)
+            return;
+        if(! scheduled_ && backlog_.empty())
+            return;
+        do_connect();
+    }
+
+    void
+    maybe_close()
+    {
+        if( scheduled_ || ! backlog_.empty() ||
+            ! flight_.empty() || writing_ || reading_)
+            return;
+        beast::error_code ec;
+        stream_.socket().shutdown(tcp::socket::shutdown_both, ec);
+        stream_.socket().close(ec);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+void
+print(
+    beast::unit_test::dstream& dout,
+    char const* name,
+    histogram const& h)
+{
+    dout << name << " latency (us):\n";
+    for(double p : {50.0, 90.0, 99.0, 99.9, 99.99})
+        dout << "  p" << std::left << std::setw(8) << p <<
+            h.percentile(p) << "\n";
+    dout <<
+        "  max      " << h.max() << "\n" <<
+        "  mean     " << static_cast<std::uint64_t>(h.mean()) << "\n";
+}
+
+int
+main(int argc, char** argv)
+{
+    beast::unit_test::dstream dout(std::cerr);
+
+    try
+    {
+        // Check command line arguments.
+        if(argc != 10)
+        {
+            std::cerr <<
+                "Usage: bench-httpload <address> <port> <target> <rate> <seconds> "
+                    "<connections> <pipeline> <body-bytes> <threads>\n" <<
+                "Example:\n" <<
+                "    bench-httpload 127.0.0.1 8080 / 10000 10 64 1 0 4\n";
+            return EXIT_FAILURE;
+        }
+
+        settings cfg;
+        cfg.ep = tcp::endpoint{
+            net::ip::make_address(argv[1]),
+            static_cast<unsigned short>(std::atoi(argv[2]))};
+        cfg.target = argv[3];
+        cfg.rate = std::atof(argv[4]);
+        cfg.duration = std::chrono::duration_cast<clock_type::duration>(
+            std::chrono::duration<double>(std::atof(argv[5])));
+        cfg.connections = static_cast<std::size_t>(std::atoi(argv[6]));
+        cfg.pipeline = static_cast<std::size_t>(std::atoi(argv[7]));
+        cfg.body_size = static_cast<std::size_t>(std::atoi(argv[8]));
+        auto const threads = std::max<int>(1, std::atoi(argv[9]));
+        if(cfg.rate <= 0 || cfg.connections == 0 || cfg.pipeline == 0)
+        {
+            std::cerr << "rate, connections and pipeline must be positive\n";
+            return EXIT_FAILURE;
+        }
+
+        report rep;
+        net::io_context ioc{threads};
+
+        // Leave time to establish the connections
+        // before the first request comes due.
+        auto const start = clock_type::now() +
+            std::chrono::milliseconds(100);
+        for(std::size_t i = 0; i < cfg.connections; ++i)
+            std::make_shared<connection>(
+                ioc, cfg, rep, i, start)->run();
+
+        std::vector<std::thread> tv;
+        tv.reserve(threads - 1);
+        for(auto i = threads - 1; i > 0; --i)
+            tv.emplace_back([&ioc]{ ioc.run(); });
+        ioc.run();
+        for(auto& t : tv)
+            t.join();
+
+        auto const elapsed = std::chrono::duration<double>(
+            clock_type::now() - start).count();
+        dout <<
+            rep.sent << " requests sent, " <<
+            rep.corrected.count() << " responses, " <<
+            rep.errors << " errors, " <<
+            rep.connects << " connects\n" <<
+            "achieved " << static_cast<std::uint64_t>(
+                rep.corrected.count() / elapsed) <<
+            " responses/s of " << cfg.rate << " requested, " <<
+            rep.bytes << " body bytes\n";
+        print(dout, "corrected", rep.corrected);
+        print(dout, "uncorrected", rep.uncorrected);
+        dout.flush();
+    }
+    catch(std::exception const& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
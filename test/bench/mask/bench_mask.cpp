@@ -0,0 +1,168 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#include <boost/beast/websocket/detail/mask.hpp>
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define BEAST_BENCH_HAS_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BEAST_BENCH_HAS_RDTSC 1
+#else
+#define BEAST_BENCH_HAS_RDTSC 0
+#endif
+
+namespace boost {
+namespace beast {
+
+// Compares the two ways of moving masked client payload from the
+// stream's read buffer into the caller's buffer: unmask in place
+// then copy, or unmask while copying. The input is processed in
+// pieces the size of a websocket read buffer fill.
+
+class mask_test : public beast::unit_test::suite
+{
+public:
+    using size_type = std::uint64_t;
+
+    static std::size_t constexpr chunk = 1536;
+
+    class timer
+    {
+    public:
+        using clock_type =
+            std::chrono::steady_clock;
+
+    private:
+        clock_type::time_point when_;
+    #if BEAST_BENCH_HAS_RDTSC
+        std::uint64_t cycles_;
+    #endif
+
+    public:
+        timer()
+            : when_(clock_type::now())
+        #if BEAST_BENCH_HAS_RDTSC
+            , cycles_(__rdtsc())
+        #endif
+        {
+        }
+
+        std::chrono::duration<double>
+        elapsed() const
+        {
+            return clock_type::now() - when_;
+        }
+
+        std::uint64_t
+        cycles() const
+        {
+        #if BEAST_BENCH_HAS_RDTSC
+            return __rdtsc() - cycles_;
+        #else
+            return 0;
+        #endif
+        }
+    };
+
+    std::string
+    corpus(std::size_t n)
+    {
+        std::mt19937 rng;
+        std::string s;
+        s.reserve(n);
+        while(n--)
+            s.push_back(static_cast<char>(rng()));
+        return s;
+    }
+
+    void
+    twoPass(std::string& in, std::string& out)
+    {
+        websocket::detail::prepared_key key;
+        websocket::detail::prepare_key(key, 0x12345678);
+        for(std::size_t i = 0; i < in.size(); i += chunk)
+        {
+            auto const n = in.size() - i < chunk ?
+                in.size() - i : chunk;
+            websocket::detail::mask_inplace(
+                net::buffer(&in[i], n), key);
+            net::buffer_copy(net::buffer(&out[i], n),
+                net::buffer(&in[i], n));
+        }
+    }
+
+    void
+    fused(std::string& in, std::string& out)
+    {
+        websocket::detail::prepared_key key;
+        websocket::detail::prepare_key(key, 0x12345678);
+        for(std::size_t i = 0; i < in.size(); i += chunk)
+        {
+            auto const n = in.size() - i < chunk ?
+                in.size() - i : chunk;
+            websocket::detail::mask_copy(
+                net::buffer(&out[i], n),
+                net::buffer(&in[i], n), n, key);
+        }
+    }
+
+    template<class F>
+    void
+    test(char const* what, std::string& in,
+        std::string& out, F const& f)
+    {
+        for(int i = 0; i < 5; ++ i)
+        {
+            timer t;
+            for(int j = 0; j < 5; ++j)
+                f(in, out);
+            auto const elapsed = t.elapsed();
+            auto const cycles = t.cycles();
+            auto const bytes = 5 * size_type(in.size());
+            log << what <<
+                static_cast<size_type>(bytes / elapsed.count()) <<
+                " bytes/s";
+            if(cycles > 0)
+                log << ", " << double(bytes) / cycles <<
+                    " bytes/cycle";
+            log << std::endl;
+        }
+    }
+
+    void
+    run() override
+    {
+        auto in = corpus(32 * 1024 * 1024);
+        std::string out(in.size(), 0);
+        test("in place + copy: ", in, out,
+            [this](std::string& i, std::string& o)
+            {
+                twoPass(i, o);
+            });
+        test("fused:           ", in, out,
+            [this](std::string& i, std::string& o)
+            {
+                fused(i, o);
+            });
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,benchmarks,mask);
+
+} // beast
+} // boost
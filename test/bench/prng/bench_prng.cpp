@@ -0,0 +1,111 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#include <boost/beast/websocket/stream.hpp>
+#include <boost/beast/websocket/detail/prng.hpp>
+#include <boost/beast/_experimental/test/stream.hpp>
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <chrono>
+#include <cstdint>
+
+namespace boost {
+namespace beast {
+
+// Compares the secure (ChaCha) and fast (PCG) mask key
+// generators, first on their own and then as seen by a
+// client stream sending many small frames.
+
+class prng_test : public beast::unit_test::suite
+{
+public:
+    using size_type = std::uint64_t;
+
+    class timer
+    {
+        using clock_type =
+            std::chrono::steady_clock;
+
+        clock_type::time_point when_;
+
+    public:
+        timer()
+            : when_(clock_type::now())
+        {
+        }
+
+        std::chrono::duration<double>
+        elapsed() const
+        {
+            return clock_type::now() - when_;
+        }
+    };
+
+    void
+    testKeys(char const* what, bool secure)
+    {
+        size_type const n = 20000000;
+        for(int i = 0; i < 5; ++i)
+        {
+            auto const g = websocket::detail::make_prng(secure);
+            timer t;
+            for(size_type j = 0; j < n; ++j)
+                g();
+            auto const elapsed = t.elapsed();
+            log << what <<
+                static_cast<size_type>(n / elapsed.count()) <<
+                " keys/s" << std::endl;
+        }
+    }
+
+    void
+    testFrames(char const* what, bool secure)
+    {
+        size_type const n = 500000;
+        net::io_context ioc;
+        websocket::stream<test::stream> ws{ioc};
+        websocket::stream<test::stream> ts{ioc};
+        ws.next_layer().connect(ts.next_layer());
+        ts.async_accept([](error_code){});
+        ws.async_handshake("localhost", "/", [](error_code){});
+        ioc.run();
+        ws.secure_prng(secure);
+        ws.binary(true);
+        char const payload[16] = {};
+        for(int i = 0; i < 5; ++i)
+        {
+            timer t;
+            for(size_type j = 0; j < n; ++j)
+            {
+                ws.write(net::buffer(payload));
+                if((j & 1023) == 0)
+                    ts.next_layer().clear();
+            }
+            auto const elapsed = t.elapsed();
+            ts.next_layer().clear();
+            log << what <<
+                static_cast<size_type>(n / elapsed.count()) <<
+                " frames/s" << std::endl;
+        }
+    }
+
+    void
+    run() override
+    {
+        testKeys  ("secure: ", true);
+        testKeys  ("fast:   ", false);
+        testFrames("secure: ", true);
+        testFrames("fast:   ", false);
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,benchmarks,prng);
+
+} // beast
+} // boost
@@ -0,0 +1,178 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#include <boost/beast/_experimental/ssl/ssl_session_cache.hpp>
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/ssl/ssl_stream.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include "example/common/server_certificate.hpp"
+#include <chrono>
+
+namespace boost {
+namespace beast {
+
+// Measures TLS handshakes per second over loopback, with full
+// handshakes and with sessions resumed through ssl_session_cache
+// and ssl_client_session_store. Each connection is accepted,
+// connected, handshaken and shut down on one thread, so the
+// figure includes the work of both ends.
+
+class resumption_test : public beast::unit_test::suite
+{
+public:
+    using socket_type = net::ip::tcp::socket;
+
+    enum class mode
+    {
+        full,
+        session_id,
+        ticket
+    };
+
+    class timer
+    {
+        using clock_type =
+            std::chrono::steady_clock;
+
+        clock_type::time_point when_;
+
+    public:
+        timer()
+            : when_(clock_type::now())
+        {
+        }
+
+        std::chrono::duration<double>
+        elapsed() const
+        {
+            return clock_type::now() - when_;
+        }
+    };
+
+    static std::size_t constexpr connections = 1000;
+
+    net::io_context ioc_;
+    net::ip::tcp::acceptor acceptor_{ioc_,
+        {net::ip::make_address("127.0.0.1"), 0}};
+
+    // Returns true if the session was resumed
+    bool
+    connect(
+        net::ssl::context& server_ctx,
+        net::ssl::context& client_ctx,
+        ssl_client_session_store& store)
+    {
+        ssl_stream<socket_type> server(ioc_, server_ctx);
+        ssl_stream<socket_type> client(ioc_, client_ctx);
+        acceptor_.async_accept(server.next_layer(),
+            [](error_code ec)
+            {
+                if(ec)
+                    throw system_error{ec};
+            });
+        client.next_layer().async_connect(
+            acceptor_.local_endpoint(),
+            [](error_code ec)
+            {
+                if(ec)
+                    throw system_error{ec};
+            });
+        ioc_.run();
+        ioc_.restart();
+
+        store.prepare(client, "server");
+        server.async_handshake(net::ssl::stream_base::server,
+            [](error_code ec)
+            {
+                if(ec)
+                    throw system_error{ec};
+            });
+        client.async_handshake(net::ssl::stream_base::client,
+            [](error_code ec)
+            {
+                if(ec)
+                    throw system_error{ec};
+            });
+        ioc_.run();
+        ioc_.restart();
+
+        // TLS 1.3 tickets arrive after the handshake, and are
+        // received by the client when it reads close_notify.
+        server.async_shutdown([](error_code){});
+        client.async_shutdown([](error_code){});
+        ioc_.run();
+        ioc_.restart();
+        return ::SSL_session_reused(client.native_handle()) == 1;
+    }
+
+    void
+    test(
+        char const* what,
+        net::ssl::context::method method,
+        mode m)
+    {
+        net::ssl::context server_ctx(method);
+        net::ssl::context client_ctx(method);
+        load_server_certificate(server_ctx);
+
+        ssl_session_cache::options opt;
+        opt.tickets = m == mode::ticket;
+        opt.session_ids = m == mode::session_id;
+        ssl_session_cache cache(opt);
+        ssl_client_session_store store;
+        if(m != mode::full)
+            cache.install(server_ctx);
+        else
+        {
+            ::SSL_CTX_set_options(
+                server_ctx.native_handle(), SSL_OP_NO_TICKET);
+            ::SSL_CTX_set_session_cache_mode(
+                server_ctx.native_handle(), SSL_SESS_CACHE_OFF);
+        }
+        store.install(client_ctx);
+
+        // Warm up, and leave a session to resume
+        connect(server_ctx, client_ctx, store);
+
+        std::size_t resumed = 0;
+        timer t;
+        for(std::size_t i = 0; i < connections; ++i)
+            if(connect(server_ctx, client_ctx, store))
+                ++resumed;
+        auto const elapsed = t.elapsed();
+        log << what <<
+            static_cast<std::size_t>(connections / elapsed.count()) <<
+            " handshakes/s, " << resumed << " resumed" << std::endl;
+        if(m == mode::full)
+            BEAST_EXPECT(resumed == 0);
+        else
+            BEAST_EXPECT(resumed == connections);
+    }
+
+    void
+    run() override
+    {
+        test("TLS 1.2 full:       ",
+            net::ssl::context::tlsv12, mode::full);
+        test("TLS 1.2 session ID: ",
+            net::ssl::context::tlsv12, mode::session_id);
+        test("TLS 1.2 ticket:     ",
+            net::ssl::context::tlsv12, mode::ticket);
+        test("TLS 1.3 full:       ",
+            net::ssl::context::tlsv13, mode::full);
+        test("TLS 1.3 ticket:     ",
+            net::ssl::context::tlsv13, mode::ticket);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,benchmarks,resumption);
+
+} // beast
+} // boost
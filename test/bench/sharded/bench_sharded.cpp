@@ -0,0 +1,303 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+//------------------------------------------------------------------------------
+//
+// bench-sharded
+//
+//  Measure the request rate of a small HTTP server built on sharded_server
+//
+//  The server answers every request with a short plain text response,
+//  allocating message headers from the shard's arena. A closed-loop
+//  client running on its own threads keeps a fixed number of keep-alive
+//  connections busy for the requested time. Compare the results for
+//  one shard against one shard per core, and with and without
+//  SO_REUSEPORT, to see how the engine scales on a given machine.
+//
+//------------------------------------------------------------------------------
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/version.hpp>
+#include <boost/beast/_experimental/core/sharded_server.hpp>
+#include <boost/beast/_experimental/unit_test/dstream.hpp>
+#include <boost/asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace beast = boost::beast;         // from <boost/beast.hpp>
+namespace http = beast::http;           // from <boost/beast/http.hpp>
+namespace net = boost::asio;            // from <boost/asio.hpp>
+using tcp = boost::asio::ip::tcp;       // from <boost/asio/ip/tcp.hpp>
+
+using alloc_type = beast::arena_allocator<char>;
+using fields_type = http::basic_fields<alloc_type>;
+
+class session
+    : public std::enable_shared_from_this<session>
+{
+    tcp::socket sock_;
+    beast::shard_arena& arena_;
+    beast::flat_buffer buffer_;
+    http::request<http::empty_body, fields_type> req_;
+    http::response<http::string_body, fields_type> res_;
+
+public:
+    session(tcp::socket sock, beast::shard_arena& arena)
+        : sock_(std::move(sock))
+        , arena_(arena)
+        , req_(std::piecewise_construct,
+            std::make_tuple(),
+            std::make_tuple(alloc_type(arena)))
+        , res_(std::piecewise_construct,
+            std::make_tuple(),
+            std::make_tuple(alloc_type(arena)))
+    {
+    }
+
+    void
+    run()
+    {
+        do_read();
+    }
+
+private:
+    void
+    do_read()
+    {
+        req_ = http::request<http::empty_body, fields_type>(
+            std::piecewise_construct,
+            std::make_tuple(),
+            std::make_tuple(alloc_type(arena_)));
+        http::async_read(sock_, buffer_, req_,
+            beast::bind_front_handler(
+                &session::on_read,
+                shared_from_this()));
+    }
+
+    void
+    on_read(beast::error_code ec, std::size_t)
+    {
+        if(ec)
+            return;
+        res_ = http::response<http::string_body, fields_type>(
+            std::piecewise_construct,
+            std::make_tuple(),
+            std::make_tuple(alloc_type(arena_)));
+        res_.result(http::status::ok);
+        res_.version(req_.version());
+        res_.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+        res_.set(http::field::content_type, "text/plain");
+        res_.body() = "Hello, world!";
+        res_.keep_alive(req_.keep_alive());
+        res_.prepare_payload();
+        http::async_write(sock_, res_,
+            beast::bind_front_handler(
+                &session::on_write,
+                shared_from_this()));
+    }
+
+    void
+    on_write(beast::error_code ec, std::size_t)
+    {
+        if(ec || ! res_.keep_alive())
+            return;
+        do_read();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+class client
+    : public std::enable_shared_from_this<client>
+{
+    tcp::socket sock_;
+    tcp::endpoint ep_;
+    std::atomic<bool>& done_;
+    std::size_t& count_;
+    beast::flat_buffer buffer_;
+    http::request<http::empty_body> req_;
+    http::response<http::string_body> res_;
+
+public:
+    client(
+        net::io_context& ioc,
+        tcp::endpoint ep,
+        std::atomic<bool>& done,
+        std::size_t& count)
+        : sock_(net::make_strand(ioc))
+        , ep_(ep)
+        , done_(done)
+        , count_(count)
+    {
+        req_.method(http::verb::get);
+        req_.target("/");
+        req_.version(11);
+        req_.set(http::field::host, "localhost");
+        req_.keep_alive(true);
+    }
+
+    void
+    run()
+    {
+        sock_.async_connect(ep_,
+            beast::bind_front_handler(
+                &client::on_connect,
+                shared_from_this()));
+    }
+
+private:
+    void
+    on_connect(beast::error_code ec)
+    {
+        if(ec)
+        {
+            std::cerr << "connect: " << ec.message() << "\n";
+            return;
+        }
+        sock_.set_option(tcp::no_delay(true));
+        do_write();
+    }
+
+    void
+    do_write()
+    {
+        if(done_)
+            return;
+        http::async_write(sock_, req_,
+            beast::bind_front_handler(
+                &client::on_write,
+                shared_from_this()));
+    }
+
+    void
+    on_write(beast::error_code ec, std::size_t)
+    {
+        if(ec)
+            return;
+        res_ = {};
+        http::async_read(sock_, buffer_, res_,
+            beast::bind_front_handler(
+                &client::on_read,
+                shared_from_this()));
+    }
+
+    void
+    on_read(beast::error_code ec, std::size_t)
+    {
+        if(ec)
+            return;
+        ++count_;
+        do_write();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+int
+main(int argc, char** argv)
+{
+    beast::unit_test::dstream dout(std::cerr);
+
+    try
+    {
+        // Check command line arguments.
+        if(argc != 6)
+        {
+            std::cerr <<
+                "Usage: bench-sharded <shards> <reuse-port:0|1> <connections> <client-threads> <seconds>\n" <<
+                "Example:\n" <<
+                "    bench-sharded 0 1 64 2 5\n";
+            return EXIT_FAILURE;
+        }
+
+        beast::sharded_server::options opt;
+        opt.shards  = static_cast<std::size_t>(std::atoi(argv[1]));
+        opt.reuse_port = std::atoi(argv[2]) != 0;
+        auto const connections = static_cast<std::size_t>(std::atoi(argv[3]));
+        auto const threads = std::max<int>(1, std::atoi(argv[4]));
+        auto const seconds = std::atof(argv[5]);
+
+        beast::sharded_server server(
+            tcp::endpoint{net::ip::make_address("127.0.0.1"), 0},
+            [](beast::sharded_server::shard& s, tcp::socket sock)
+            {
+                sock.set_option(tcp::no_delay(true));
+                std::make_shared<session>(
+                    std::move(sock), s.arena())->run();
+            },
+            opt);
+        std::thread st([&server]{ server.run(); });
+
+        std::atomic<bool> done(false);
+        std::vector<std::size_t> counts(connections);
+        net::io_context ioc{threads};
+        for(std::size_t i = 0; i < connections; ++i)
+            std::make_shared<client>(ioc,
+                server.local_endpoint(), done, counts[i])->run();
+
+        net::steady_timer timer(ioc);
+        timer.expires_after(std::chrono::duration_cast<
+            net::steady_timer::duration>(
+                std::chrono::duration<double>(seconds)));
+        timer.async_wait(
+            [&](beast::error_code)
+            {
+                done = true;
+            });
+
+        auto const start = std::chrono::steady_clock::now();
+        std::vector<std::thread> tv;
+        tv.reserve(threads - 1);
+        for(auto i = threads - 1; i > 0; --i)
+            tv.emplace_back([&ioc]{ ioc.run(); });
+        ioc.run();
+        for(auto& t : tv)
+            t.join();
+        auto const elapsed = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        server.stop();
+        st.join();
+
+        std::size_t total = 0;
+        for(auto n : counts)
+            total += n;
+        dout <<
+            server.size() << " shards" <<
+            (server.reuse_port() ? " (SO_REUSEPORT), " : ", ") <<
+            total << " requests in " << elapsed << "s, " <<
+            static_cast<std::size_t>(total / elapsed) << " requests/s\n";
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        for(std::size_t i = 0; i < server.size(); ++i)
+        {
+            auto& s = server.get_shard(i);
+            dout << "  shard " << i << ": " <<
+                s.accepted() << " connections\n";
+            hits += s.arena().hits();
+            misses += s.arena().misses();
+        }
+        dout << "arena: " << hits << " hits, " <<
+            misses << " misses\n";
+        dout.flush();
+    }
+    catch(std::exception const& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
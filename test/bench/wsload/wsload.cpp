@@ -13,12 +13,19 @@
 //
 //  Measure the performance of a WebSocket server
 //
+//  Each connection sends <burst> messages, then reads their echoes.
+//  The optional <immediate> argument sets read_immediate_max on the
+//  client streams. The optional <fragment> argument sends each message
+//  as a run of frames of at most that many bytes, to measure the cost
+//  of many tiny frames arriving together.
+//
 //------------------------------------------------------------------------------
 
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/beast/_experimental/unit_test/dstream.hpp>
 #include <boost/asio.hpp>
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstdlib>
@@ -109,6 +116,11 @@ class connection
     websocket::stream<tcp::socket> ws_;
     tcp::endpoint ep_;
     std::size_t messages_;
+    std::size_t burst_;
+    std::size_t fragment_;
+    std::size_t pending_ = 0;
+    std::size_t size_ = 0;
+    std::size_t sent_ = 0;
     report& rep_;
     test_buffer const& tb_;
     net::strand<
@@ -123,12 +135,17 @@ public:
         net::io_context& ioc,
         tcp::endpoint const& ep,
         std::size_t messages,
+        std::size_t burst,
+        std::size_t immediate,
+        std::size_t fragment,
         bool deflate,
         report& rep,
         test_buffer const& tb)
         : ws_(ioc)
         , ep_(ep)
         , messages_(messages)
+        , burst_(burst)
+        , fragment_(fragment)
         , rep_(rep)
         , tb_(tb)
         , strand_(ioc.get_executor())
@@ -139,6 +156,7 @@ public:
         ws_.binary(true);
         ws_.auto_fragment(false);
         ws_.write_buffer_bytes(64 * 1024);
+        ws_.read_immediate_max(immediate);
     }
 
     ~connection()
@@ -184,26 +202,45 @@ private:
     {
         std::geometric_distribution<std::size_t> dist{
             double(4) / beast::buffer_bytes(tb_)};
-        ws_.async_write_some(true,
-            beast::buffers_prefix(dist(rng_), tb_),
+        size_ = (std::min)(dist(rng_), beast::buffer_bytes(tb_));
+        sent_ = 0;
+        do_write_frame();
+    }
+
+    void
+    do_write_frame()
+    {
+        auto n = size_ - sent_;
+        if(fragment_ > 0)
+            n = (std::min)(n, fragment_);
+        ws_.async_write_some(sent_ + n == size_,
+            net::buffer(*tb_.begin() + sent_, n),
             beast::bind_front_handler(
                 &connection::on_write,
                 this->shared_from_this()));
     }
 
     void
-    on_write(beast::error_code ec, std::size_t)
+    on_write(beast::error_code ec, std::size_t bytes_transferred)
     {
         if(ec)
             return fail(ec, "write");
 
-        if(messages_--)
-            return do_read();
-
-        ws_.async_close({},
-            beast::bind_front_handler(
-                &connection::on_close,
-                this->shared_from_this()));
+        sent_ += bytes_transferred;
+        if(sent_ < size_)
+            return do_write_frame();
+
+        if(messages_ == 0)
+            return ws_.async_close({},
+                beast::bind_front_handler(
+                    &connection::on_close,
+                    this->shared_from_this()));
+
+        // Send up to `burst_` messages before reading the echoes
+        --messages_;
+        if(++pending_ < burst_ && messages_ > 0)
+            return do_write();
+        do_read();
     }
 
     void
@@ -224,6 +261,8 @@ private:
         ++count_;
         bytes_ += buffer_.size();
         buffer_.consume(buffer_.size());
+        if(--pending_ > 0)
+            return do_read();
         do_write();
     }
 
@@ -277,10 +316,10 @@ main(int argc, char** argv)
     try
     {
         // Check command line arguments.
-        if(argc != 8)
+        if(argc < 8 || argc > 11)
         {
             std::cerr <<
-                "Usage: bench-wsload <address> <port> <trials> <messages> <workers> <threads> <compression:0|1>";
+                "Usage: bench-wsload <address> <port> <trials> <messages> <workers> <threads> <compression:0|1> [<burst> [<immediate> [<fragment>]]]";
             return EXIT_FAILURE;
         }
 
@@ -291,6 +330,12 @@ main(int argc, char** argv)
         auto const workers = static_cast<std::size_t>(std::atoi(argv[5]));
         auto const threads = static_cast<std::size_t>(std::atoi(argv[6]));
         auto const deflate = std::atoi(argv[7]) != 0;
+        auto const burst   = argc > 8 ? std::max<std::size_t>(1,
+            static_cast<std::size_t>(std::atoi(argv[8]))) : 1;
+        auto const immediate = argc > 9 ?
+            static_cast<std::size_t>(std::atoi(argv[9])) : 0;
+        auto const fragment = argc > 10 ?
+            static_cast<std::size_t>(std::atoi(argv[10])) : 0;
         auto const work = (messages + workers - 1) / workers;
         test_buffer tb;
         for(auto i = trials; i != 0; --i)
@@ -304,6 +349,9 @@ main(int argc, char** argv)
                     ioc,
                     tcp::endpoint{address, port},
                     work,
+                    burst,
+                    immediate,
+                    fragment,
                     deflate,
                     rep,
                     tb);
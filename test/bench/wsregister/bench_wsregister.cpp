@@ -0,0 +1,124 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+//------------------------------------------------------------------------------
+//
+// bench-wsregister
+//
+//  Measure the cost of constructing and destroying websocket streams
+//  from many threads at once, as during a reconnect storm
+//
+//  Every stream registers with a service owned by the execution
+//  context, so that shutting down the context can shut down the
+//  streams. For each thread count from 1 up to the maximum, all
+//  threads repeatedly construct and destroy streams on one shared
+//  io_context. With registration free of contention, the total rate
+//  scales with the number of threads, up to the number of cores.
+//
+//  Each thread count is run twice, first with the per-thread cache
+//  of stream memory disabled and then with it enabled, to show the
+//  cost of returning the implementation to the heap every time.
+//
+//------------------------------------------------------------------------------
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/_experimental/unit_test/dstream.hpp>
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace beast = boost::beast;         // from <boost/beast.hpp>
+namespace websocket = beast::websocket; // from <boost/beast/websocket.hpp>
+namespace net = boost::asio;            // from <boost/asio.hpp>
+using tcp = boost::asio::ip::tcp;       // from <boost/asio/ip/tcp.hpp>
+
+double
+run_threads(
+    net::io_context& ioc,
+    std::size_t threads,
+    std::size_t count)
+{
+    auto const start = std::chrono::steady_clock::now();
+    std::vector<std::thread> v;
+    v.reserve(threads);
+    for(std::size_t i = 0; i < threads; ++i)
+        v.emplace_back(
+            [&ioc, count]
+            {
+                for(std::size_t n = 0; n < count; ++n)
+                    websocket::stream<tcp::socket> ws(ioc);
+            });
+    for(auto& t : v)
+        t.join();
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+int
+main(int argc, char** argv)
+{
+    beast::unit_test::dstream dout(std::cerr);
+
+    try
+    {
+        // Check command line arguments.
+        if(argc != 4)
+        {
+            std::cerr <<
+                "Usage: bench-wsregister <max-threads> <streams-per-thread> <trials>\n" <<
+                "Example:\n" <<
+                "    bench-wsregister 32 100000 3\n";
+            return EXIT_FAILURE;
+        }
+        auto const max_threads = std::max<std::size_t>(1,
+            static_cast<std::size_t>(std::atoi(argv[1])));
+        auto const count = static_cast<std::size_t>(std::atoi(argv[2]));
+        auto const trials = std::max(1, std::atoi(argv[3]));
+
+        std::size_t const cache_max = 256 * 1024;
+        net::io_context ioc;
+
+        // Create the services up front
+        websocket::stream<tcp::socket>{ioc};
+
+        for(std::size_t threads = 1;; threads *= 2)
+        {
+            threads = std::min(threads, max_threads);
+            for(std::size_t cache : {std::size_t(0), cache_max})
+            {
+                websocket::stream_cache_max(cache);
+                for(int i = 0; i < trials; ++i)
+                {
+                    auto const elapsed = run_threads(ioc, threads, count);
+                    auto const total = threads * count;
+                    dout <<
+                        threads << " threads, cache " <<
+                        (cache ? "on" : "off") << ": " <<
+                        total << " streams in " << elapsed << "s, " <<
+                        static_cast<std::size_t>(total / elapsed) <<
+                        " streams/s" << std::endl;
+                }
+            }
+            if(threads == max_threads)
+                break;
+        }
+    }
+    catch(std::exception const& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,263 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+//------------------------------------------------------------------------------
+//
+// wsserver
+//
+//  A WebSocket echo server for use with bench-wsload, which schedules
+//  sessions either with strands on a shared io_context ("strand"), or
+//  with the executors of a work_stealing_pool ("steal").
+//
+//  Run the server, then the load generator, for example:
+//
+//      bench-wsserver 127.0.0.1 8080 4 steal
+//      bench-wsload 127.0.0.1 8080 5 100000 1000 2 0
+//
+//  and repeat with "strand" to compare. Press Ctrl-C to stop the server.
+//
+//  The optional last argument sets websocket::stream::read_immediate_max
+//  on every session. Use it together with the <burst> argument of
+//  bench-wsload, so that messages are waiting in the read buffer:
+//
+//      bench-wsserver 127.0.0.1 8080 1 strand 16
+//      bench-wsload 127.0.0.1 8080 5 100000 100 1 0 16 16
+//
+//------------------------------------------------------------------------------
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/_experimental/core/work_stealing_pool.hpp>
+#include <boost/beast/_experimental/unit_test/dstream.hpp>
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace beast = boost::beast;         // from <boost/beast.hpp>
+namespace websocket = beast::websocket; // from <boost/beast/websocket.hpp>
+namespace net = boost::asio;            // from <boost/asio.hpp>
+using tcp = boost::asio::ip::tcp;       // from <boost/asio/ip/tcp.hpp>
+
+void
+fail(beast::error_code ec, char const* what)
+{
+    if(ec == websocket::error::closed ||
+        ec == net::error::operation_aborted)
+        return;
+    std::cerr << what << ": " << ec.message() << "\n";
+}
+
+// Echoes every message back to the client
+template<class Executor>
+class session
+    : public std::enable_shared_from_this<session<Executor>>
+{
+    websocket::stream<beast::basic_stream<tcp, Executor>> ws_;
+    beast::flat_buffer buffer_;
+
+public:
+    session(
+        net::basic_stream_socket<tcp, Executor>&& sock,
+        std::size_t immediate)
+        : ws_(std::move(sock))
+    {
+        websocket::permessage_deflate pmd;
+        pmd.server_enable = true;
+        ws_.set_option(pmd);
+        ws_.auto_fragment(false);
+        ws_.read_message_max(64 * 1024 * 1024);
+        ws_.read_immediate_max(immediate);
+    }
+
+    void
+    run()
+    {
+        ws_.async_accept(
+            beast::bind_front_handler(
+                &session::on_accept,
+                this->shared_from_this()));
+    }
+
+private:
+    void
+    on_accept(beast::error_code ec)
+    {
+        if(ec)
+            return fail(ec, "accept");
+        do_read();
+    }
+
+    void
+    do_read()
+    {
+        ws_.async_read(buffer_,
+            beast::bind_front_handler(
+                &session::on_read,
+                this->shared_from_this()));
+    }
+
+    void
+    on_read(beast::error_code ec, std::size_t)
+    {
+        if(ec)
+            return fail(ec, "read");
+        ws_.text(ws_.got_text());
+        ws_.async_write(buffer_.data(),
+            beast::bind_front_handler(
+                &session::on_write,
+                this->shared_from_this()));
+    }
+
+    void
+    on_write(beast::error_code ec, std::size_t)
+    {
+        if(ec)
+            return fail(ec, "write");
+        buffer_.consume(buffer_.size());
+        do_read();
+    }
+};
+
+// Accepts connections, giving each one a new session executor
+template<class MakeExecutor>
+class listener
+    : public std::enable_shared_from_this<listener<MakeExecutor>>
+{
+    using executor_type = decltype(
+        std::declval<MakeExecutor&>()());
+
+    net::io_context& ioc_;
+    tcp::acceptor acceptor_;
+    MakeExecutor make_executor_;
+    std::size_t immediate_;
+
+public:
+    listener(
+        net::io_context& ioc,
+        tcp::endpoint ep,
+        MakeExecutor make_executor,
+        std::size_t immediate)
+        : ioc_(ioc)
+        , acceptor_(ioc, ep)
+        , make_executor_(make_executor)
+        , immediate_(immediate)
+    {
+    }
+
+    void
+    run()
+    {
+        acceptor_.async_accept(make_executor_(),
+            beast::bind_front_handler(
+                &listener::on_accept,
+                this->shared_from_this()));
+    }
+
+private:
+    void
+    on_accept(
+        beast::error_code ec,
+        net::basic_stream_socket<tcp, executor_type> sock)
+    {
+        if(ec)
+            return fail(ec, "accept");
+        sock.set_option(tcp::no_delay(true));
+        std::make_shared<session<executor_type>>(
+            std::move(sock), immediate_)->run();
+        run();
+    }
+};
+
+template<class MakeExecutor>
+void
+listen(
+    net::io_context& ioc,
+    tcp::endpoint ep,
+    MakeExecutor make_executor,
+    std::size_t immediate)
+{
+    std::make_shared<listener<MakeExecutor>>(
+        ioc, ep, make_executor, immediate)->run();
+}
+
+int
+main(int argc, char** argv)
+{
+    beast::unit_test::dstream dout(std::cerr);
+
+    // Check command line arguments.
+    if(argc < 5 || argc > 6 || (
+        std::strcmp(argv[4], "strand") != 0 &&
+        std::strcmp(argv[4], "steal") != 0))
+    {
+        std::cerr <<
+            "Usage: bench-wsserver <address> <port> <threads> <strand|steal> [<immediate>]\n";
+        return EXIT_FAILURE;
+    }
+    auto const address = net::ip::make_address(argv[1]);
+    auto const port = static_cast<unsigned short>(std::atoi(argv[2]));
+    auto const threads = std::max<int>(1, std::atoi(argv[3]));
+    bool const steal = std::strcmp(argv[4], "steal") == 0;
+    auto const immediate = argc > 5 ?
+        static_cast<std::size_t>(std::atoi(argv[5])) : 0;
+
+    // Runs the acceptor, and in "strand" mode, the sessions
+    net::io_context ioc{threads};
+    std::unique_ptr<beast::work_stealing_pool> pool;
+    if(steal)
+    {
+        pool.reset(new beast::work_stealing_pool(
+            static_cast<std::size_t>(threads)));
+        listen(ioc, tcp::endpoint{address, port},
+            [&pool]
+            {
+                return pool->make_executor();
+            }, immediate);
+    }
+    else
+    {
+        listen(ioc, tcp::endpoint{address, port},
+            [&ioc]
+            {
+                return net::make_strand(ioc);
+            }, immediate);
+    }
+
+    net::signal_set signals(ioc, SIGINT, SIGTERM);
+    signals.async_wait(
+        [&](beast::error_code, int)
+        {
+            ioc.stop();
+            if(pool)
+                pool->stop();
+        });
+
+    // In "steal" mode the pool's workers run the
+    // sessions, and one thread is enough for accepting.
+    auto const n = steal ? 1 : threads;
+    std::vector<std::thread> v;
+    v.reserve(n - 1);
+    for(auto i = n - 1; i > 0; --i)
+        v.emplace_back([&ioc]{ ioc.run(); });
+    ioc.run();
+    for(auto& t : v)
+        t.join();
+
+    if(pool)
+    {
+        pool->join();
+        dout << pool->steals() << " sessions stolen" << std::endl;
+    }
+    return EXIT_SUCCESS;
+}